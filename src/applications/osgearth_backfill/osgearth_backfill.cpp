@@ -13,8 +13,8 @@
 #include <osgEarth/ImageUtils>
 #include <osgEarth/Registry>
 #include <osgEarth/StringUtils>
-#include <osgEarthUtil/TMS>
-#include <osgEarthUtil/TMSBackFiller>
+#include <osgEarth/TMS>
+#include <osgEarth/TMSBackFiller>
 
 
 #include <iostream>
@@ -22,7 +22,7 @@
 
 using namespace osgEarth;
 using namespace osgEarth::Util;
-using namespace osgEarth::Util::TMS;
+using namespace osgEarth::Contrib;
 
 /** Prints an error message, usage information, and returns -1. */
 int
@@ -41,6 +41,8 @@ usage( const std::string& msg = "" )
         << "            [--min-level <num>]             : The minimum level to stop backfilling to.  (default=0)\n"
         << "            [--max-level <num>]             : The level to start backfilling from(default=inf)\n"                
         << "            [--db-options]                : db options string to pass to the image writer in quotes (e.g., \"JPEG_QUALITY 60\")\n"
+        << "            [--filter <box|bilinear|mode>]  : downsampling filter; use mode for coverage data (default=box)\n"
+        << "            [--threads <num>]               : number of threads building tiles (default=number of cores)\n"
         << std::endl
         << "         [--quiet]               : suppress progress output" << std::endl;
 
@@ -93,6 +95,21 @@ main(int argc, char** argv)
 
     osg::ref_ptr<osgDB::Options> options = new osgDB::Options(dbOptions);
 
+    TMSBackFiller::Filter filter = TMSBackFiller::FILTER_BOX;
+    std::string filterName;
+    if (args.read("--filter", filterName))
+    {
+        if (filterName == "bilinear")
+            filter = TMSBackFiller::FILTER_BILINEAR;
+        else if (filterName == "mode")
+            filter = TMSBackFiller::FILTER_MODE;
+        else if (filterName != "box")
+            return usage("Unknown filter " + filterName);
+    }
+
+    unsigned threads = std::max(std::thread::hardware_concurrency(), 1u);
+    args.read("--threads", threads);
+
 
     std::string tmsPath;
 
@@ -115,5 +132,8 @@ main(int argc, char** argv)
     backfiller.setMinLevel( minLevel );
     backfiller.setMaxLevel( maxLevel );
     backfiller.setBounds( bounds );
+    backfiller.setFilter( filter );
+    backfiller.setNumThreads( threads );
+    backfiller.setVerbose( verbose );
     backfiller.process( tmsPath, options.get() );
 }
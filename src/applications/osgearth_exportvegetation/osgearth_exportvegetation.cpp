@@ -16,6 +16,8 @@
 
 #define LC "[exportvegetation] "
 
+#define EXPORT_POOL_NAME "oe.exportvegetation"
+
 using namespace osgEarth;
 using namespace osgEarth::Procedural;
 using namespace osgEarth::Util;
@@ -31,6 +33,8 @@ usage(const char* name, const std::string& error)
         << "\n  --extents swlong swlat nelong nelat  ; extents in degrees"
         << "\n  --out out.shp                        ; output features"
         << "\n  --include-asset-property <name>      ; include asset property name as attribute (optional)"
+        << "\n  --threads n                          ; number of tiles to generate at once (optional)"
+        << "\n  --verify                             ; check that parallel and serial generation match, then exit"
         << std::endl;
 
     return -1;
@@ -44,9 +48,12 @@ struct App
     VegetationFeatureGenerator featureGen;
     osg::ref_ptr<OGRFeatureSource> outfs;
 
-    Threading::Mutexed<std::queue<FeatureList*> > outputQueue;
+    // finished tiles, indexed by their position in the key list
+    Threading::Mutexed<std::map<unsigned, FeatureList*> > outputs;
     Threading::Event outputReady;
     bool debug;
+    bool verify;
+    unsigned numThreads;
 
     App() { }
 
@@ -64,13 +71,19 @@ struct App
         std::string layername;
         arguments.read("--layer", layername);
 
+        verify = arguments.read("--verify");
+
+        numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+        arguments.read("--threads", numThreads);
+        numThreads = std::max(numThreads, 1u);
+
         double xmin, ymin, xmax, ymax;
         if (!arguments.read("--extents", xmin, ymin, xmax, ymax))
             return usage(argv[0], "Missing --extents");
         extent = GeoExtent(SpatialReference::get("wgs84"), xmin, ymin, xmax, ymax);
 
         std::string outfile;
-        if (!arguments.read("--out", outfile))
+        if (!arguments.read("--out", outfile) && !verify)
             return usage(argv[0], "Missing --out");
 
         osg::ref_ptr<osg::Node> node = osgDB::readNodeFiles(arguments);
@@ -94,6 +107,7 @@ struct App
 
         featureGen.setMap(map);
         featureGen.setLayer(veglayer);
+        featureGen.setNumThreads(numThreads);
 
         if (featureGen.getStatus().isError())
             return usage(argv[0], featureGen.getStatus().message());
@@ -113,6 +127,9 @@ struct App
             outSchema[prop] = ATTRTYPE_STRING;
         }
 
+        if (verify)
+            return 0;
+
         outfs = new OGRFeatureSource();
         outfs->setOGRDriver("ESRI Shapefile");
         outfs->setURL(outfile);
@@ -122,19 +139,89 @@ struct App
         return 0; 
     }
 
-    void exportKey(const TileKey& key)
+    void exportKey(unsigned index, const TileKey& key)
     {
         std::cout << " Key = " << key.str() << std::endl;
 
-        // even if the output if empty, we still must push a FeatureList
-        // to the output queue b/c it's expecting an exact number of keys.
+        // even if the output if empty, we still must store a FeatureList
+        // b/c the writer consumes every key index in order.
         FeatureList* output = new FeatureList();
         featureGen.getFeatures(key, *output);
 
-        outputQueue.lock();
-        outputQueue.push(output);
+        outputs.lock();
+        outputs[index] = output;
         outputReady.set();
-        outputQueue.unlock();
+        outputs.unlock();
+    }
+
+    // Generates the extent serially and in parallel and compares the results
+    // feature by feature. Returns the number of mismatches.
+    int runVerify()
+    {
+        FeatureList serial, parallel;
+
+        // bypass the placement cache, or the parallel pass would just
+        // read back what the serial pass stored.
+        veglayer->options().placementCacheSize() = 0u;
+
+        featureGen.setNumThreads(1u);
+        Status s = featureGen.getFeatures(extent, serial);
+        if (s.isError())
+        {
+            OE_WARN << LC << s.message() << std::endl;
+            return 1;
+        }
+
+        featureGen.setNumThreads(numThreads);
+        s = featureGen.getFeatures(extent, parallel);
+        if (s.isError())
+        {
+            OE_WARN << LC << s.message() << std::endl;
+            return 1;
+        }
+
+        int mismatches = 0;
+
+        if (serial.size() != parallel.size())
+        {
+            std::cout << "Feature count differs: serial=" << serial.size()
+                << " parallel=" << parallel.size() << std::endl;
+            ++mismatches;
+        }
+
+        for (unsigned i = 0; i < std::min(serial.size(), parallel.size()); ++i)
+        {
+            const Feature* a = serial[i].get();
+            const Feature* b = parallel[i].get();
+
+            bool same =
+                a->getGeometry() && b->getGeometry() &&
+                a->getGeometry()->size() == b->getGeometry()->size() &&
+                a->getAttrs().size() == b->getAttrs().size();
+
+            for (unsigned j = 0; same && j < a->getGeometry()->size(); ++j)
+                same = (*a->getGeometry())[j] == (*b->getGeometry())[j];
+
+            for (auto& attr : a->getAttrs())
+            {
+                if (!same) break;
+                same = b->hasAttr(attr.first) && b->getString(attr.first) == attr.second.getString();
+            }
+
+            if (!same)
+            {
+                if (mismatches < 10)
+                    std::cout << "Feature " << i << " differs" << std::endl;
+                ++mismatches;
+            }
+        }
+
+        std::cout
+            << (mismatches == 0 ? "PASS" : "FAIL")
+            << ": " << serial.size() << " features, " << mismatches << " mismatches"
+            << " (" << numThreads << " threads)" << std::endl;
+
+        return mismatches;
     }
 };
 
@@ -148,6 +235,9 @@ main(int argc, char** argv)
     if (app.open(argc, argv) < 0)
         return -1;
 
+    if (app.verify)
+        return app.runVerify() == 0 ? 0 : 1;
+
     // find all intersecting tile keys
     std::vector<TileKey> keys;
     unsigned lod = app.veglayer->options().group("trees").lod().get();
@@ -157,28 +247,38 @@ main(int argc, char** argv)
 
     std::cout << "Exporting " << keys.size() << " keys.." << std::endl;
 
-    for(const auto key : keys)
+    jobs::get_pool(EXPORT_POOL_NAME)->set_concurrency(app.numThreads);
+
+    jobs::context job;
+    job.name = "Export vegetation";
+    job.pool = jobs::get_pool(EXPORT_POOL_NAME);
+
+    for(unsigned k = 0; k < keys.size(); ++k)
     {
-        jobs::dispatch([&app, key]() { app.exportKey(key); });
+        TileKey key = keys[k];
+        jobs::dispatch([&app, k, key]() { app.exportKey(k, key); }, job);
     }
-    
 
     unsigned totalFeatures = 0u;
     std::vector<TimeSpan> writeTimes;
 
+    // Write tiles in key order, regardless of the order they finish in,
+    // so the output file is the same for any number of threads.
     for(unsigned i=0; i<keys.size(); )
     {
         app.outputReady.waitAndReset();
 
         std::vector<FeatureList*> outputs;
 
-        app.outputQueue.lock();
-        while(!app.outputQueue.empty())
+        app.outputs.lock();
+        for(auto iter = app.outputs.find(i);
+            iter != app.outputs.end();
+            iter = app.outputs.find(i + (unsigned)outputs.size()))
         {
-            outputs.push_back(app.outputQueue.front());
-            app.outputQueue.pop();
+            outputs.push_back(iter->second);
+            app.outputs.erase(iter);
         }
-        app.outputQueue.unlock();
+        app.outputs.unlock();
 
         for(unsigned j=0; j<outputs.size(); ++j)
         {
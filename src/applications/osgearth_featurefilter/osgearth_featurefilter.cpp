@@ -40,6 +40,8 @@ public:
     }
 
 
+    const char* name() const override { return "ChangeAttributeFilter"; }
+
     virtual FilterContext push( FeatureList& input, FilterContext& context )
     {
         for (FeatureList::iterator itr = input.begin(); itr != input.end(); itr++)
@@ -6,20 +6,321 @@
 #include <osgEarth/MapNode>
 #include <osgEarth/ImageLayer>
 #include <osgEarth/ElevationLayer>
+#include <osgEarth/ImageUtils>
+#include <osgEarth/ImageToHeightFieldConverter>
+#include <osgEarth/Containers>
+#include <osgEarth/StringUtils>
 #include <osgEarth/GDAL>
+#include <osgEarth/Threading>
 #include "httplib.h"
+#include <array>
+#include <atomic>
+#include <chrono>
 
 using namespace osgEarth;
+using namespace osgEarth::Util;
 using namespace httplib;
 
 int
 usage(const char* name, const char* message)
 {
     std::cerr << "Error: " << message << std::endl;
-    std::cerr << "Usage: " << name << " file.earth" << std::endl;
+    std::cerr
+        << "Usage: " << name << " file.earth" << std::endl
+        << "    --host <host>                : address to listen on (default 0.0.0.0)" << std::endl
+        << "    --port <port>                : port to listen on (default 1234)" << std::endl
+        << "    --threads <num>              : number of request threads" << std::endl
+        << "    --format <ext>               : default image format: png, jpg, webp or lerc (default png)" << std::endl
+        << "    --elevation-format <ext>     : default elevation format: tif or lerc (default tif)" << std::endl
+        << "    --cache-size <num>           : number of encoded tiles to keep in memory; 0 disables (default 4096)" << std::endl
+        << "    --no-passthrough             : always decode and re-encode source imagery" << std::endl
+        << "    --verbose                    : log every request" << std::endl
+        << std::endl
+        << "Requests:" << std::endl
+        << "    /layer/<name>/<z>/<x>/<y>[.<ext>]" << std::endl
+        << "    /elevation/<z>/<x>/<y>[.<ext>]" << std::endl
+        << "    /metrics" << std::endl;
     return -1;
 }
 
+namespace
+{
+    //! Output format for a response
+    struct Codec
+    {
+        std::string ext;       // osgDB ReaderWriter extension
+        std::string mimeType;
+    };
+
+    const Codec* findCodec(const std::string& name)
+    {
+        static const std::vector<std::pair<std::string, Codec>> codecs = {
+            { "png",  { "png",  "image/png" } },
+            { "jpg",  { "jpg",  "image/jpeg" } },
+            { "jpeg", { "jpg",  "image/jpeg" } },
+            { "webp", { "webp", "image/webp" } },
+            { "lerc", { "lerc", "application/octet-stream" } },
+            { "tif",  { "tif",  "image/tiff" } },
+            { "tiff", { "tif",  "image/tiff" } }
+        };
+        std::string lower = toLower(name);
+        for (auto& codec : codecs)
+            if (codec.first == lower)
+                return &codec.second;
+        return nullptr;
+    }
+
+    //! Detects the format of an encoded image from its leading bytes
+    std::string sniffFormat(const std::string& bytes)
+    {
+        if (bytes.size() >= 8 && bytes.compare(0, 8, "\x89PNG\r\n\x1a\n", 8) == 0)
+            return "png";
+        if (bytes.size() >= 3 && bytes.compare(0, 3, "\xFF\xD8\xFF", 3) == 0)
+            return "jpg";
+        if (bytes.size() >= 12 && bytes.compare(0, 4, "RIFF") == 0 && bytes.compare(8, 4, "WEBP") == 0)
+            return "webp";
+        return {};
+    }
+
+    //! An encoded response, ready to send
+    struct Encoded
+    {
+        std::string content;
+        std::string mimeType;
+        std::string etag;
+    };
+    using EncodedPtr = std::shared_ptr<const Encoded>;
+
+    EncodedPtr makeEncoded(std::string&& content, const std::string& mimeType)
+    {
+        auto e = std::make_shared<Encoded>();
+        e->etag = "\"" + hashToString(content) + "-" + std::to_string(content.size()) + "\"";
+        e->content = std::move(content);
+        e->mimeType = mimeType;
+        return e;
+    }
+
+    //! Whether the request's If-None-Match header matches an ETag
+    bool matchesETag(const Request& req, const std::string& etag)
+    {
+        if (!req.has_header("If-None-Match"))
+            return false;
+
+        for (auto& t : StringTokenizer()
+            .delim(",")
+            .tokenize(req.get_header_value("If-None-Match")))
+        {
+            if (t == "*")
+                return true;
+            if (t == etag || (startsWith(t, "W/") && t.compare(2, std::string::npos, etag) == 0))
+                return true;
+        }
+        return false;
+    }
+
+    //! Request latency histogram in the Prometheus format
+    class Histogram
+    {
+    public:
+        void record(double seconds)
+        {
+            unsigned i = 0;
+            while (i < bounds.size() && seconds > bounds[i])
+                ++i;
+            _buckets[i]++;
+            _count++;
+            _sumMicros += (std::uint64_t)(seconds * 1e6);
+        }
+
+        void write(std::ostream& out, const std::string& name, const std::string& label) const
+        {
+            std::uint64_t cumulative = 0u;
+            for (unsigned i = 0; i < bounds.size(); ++i)
+            {
+                cumulative += _buckets[i];
+                out << name << "_bucket{" << label << ",le=\"" << bounds[i] << "\"} " << cumulative << "\n";
+            }
+            cumulative += _buckets[bounds.size()];
+            out << name << "_bucket{" << label << ",le=\"+Inf\"} " << cumulative << "\n";
+            out << name << "_sum{" << label << "} " << (double)_sumMicros * 1e-6 << "\n";
+            out << name << "_count{" << label << "} " << _count << "\n";
+        }
+
+    private:
+        static constexpr std::array<double, 12> bounds = {
+            0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0 };
+        std::array<std::atomic<std::uint64_t>, bounds.size() + 1> _buckets = {};
+        std::atomic<std::uint64_t> _count = { 0u };
+        std::atomic<std::uint64_t> _sumMicros = { 0u };
+    };
+
+    //! Writes a job pool latency histogram in the Prometheus format
+    void writeJobHistogram(std::ostream& out, const std::string& name, const std::string& pool, const jobs::histogram_t& h)
+    {
+        std::string label = "pool=\"" + (pool.empty() ? std::string("default") : pool) + "\"";
+        std::uint64_t cumulative = 0u;
+        for (unsigned i = 0; i + 1 < h.num_buckets; ++i)
+        {
+            cumulative += h.buckets[i];
+            out << name << "_bucket{" << label << ",le=\"" << (double)h.bucket_upper_us(i) * 1e-6 << "\"} " << cumulative << "\n";
+        }
+        cumulative += h.buckets[h.num_buckets - 1];
+        out << name << "_bucket{" << label << ",le=\"+Inf\"} " << cumulative << "\n";
+        out << name << "_sum{" << label << "} " << (double)h.total_us * 1e-6 << "\n";
+        out << name << "_count{" << label << "} " << cumulative << "\n";
+    }
+
+    //! Server-wide counters, reported at /metrics
+    struct Metrics
+    {
+        std::atomic<std::uint64_t> cacheHits = { 0u };
+        std::atomic<std::uint64_t> cacheMisses = { 0u };
+        std::atomic<std::uint64_t> passthrough = { 0u };
+        std::atomic<std::uint64_t> encoded = { 0u };
+        std::atomic<std::uint64_t> notModified = { 0u };
+        std::array<std::atomic<std::uint64_t>, 6> responses = {}; // 1xx..5xx, other
+        Histogram layerLatency;
+        Histogram elevationLatency;
+
+        void countResponse(const Response& res)
+        {
+            // httplib fills in 200 after the handler returns
+            int status = res.status == -1 ? 200 : res.status;
+            int i = status / 100 - 1;
+            responses[i >= 0 && i < 5 ? i : 5]++;
+        }
+
+        std::string toString() const
+        {
+            std::ostringstream out;
+            out << "# TYPE osgearth_server_responses_total counter\n";
+            for (unsigned i = 0; i < 5; ++i)
+                out << "osgearth_server_responses_total{code=\"" << (i + 1) << "xx\"} " << responses[i] << "\n";
+            out << "osgearth_server_responses_total{code=\"other\"} " << responses[5] << "\n";
+            out << "# TYPE osgearth_server_not_modified_total counter\n"
+                << "osgearth_server_not_modified_total " << notModified << "\n";
+            out << "# TYPE osgearth_server_cache_hits_total counter\n"
+                << "osgearth_server_cache_hits_total " << cacheHits << "\n";
+            out << "# TYPE osgearth_server_cache_misses_total counter\n"
+                << "osgearth_server_cache_misses_total " << cacheMisses << "\n";
+            out << "# TYPE osgearth_server_passthrough_total counter\n"
+                << "osgearth_server_passthrough_total " << passthrough << "\n";
+            out << "# TYPE osgearth_server_encoded_total counter\n"
+                << "osgearth_server_encoded_total " << encoded << "\n";
+            out << "# TYPE osgearth_server_request_duration_seconds histogram\n";
+            layerLatency.write(out, "osgearth_server_request_duration_seconds", "route=\"layer\"");
+            elevationLatency.write(out, "osgearth_server_request_duration_seconds", "route=\"elevation\"");
+
+            out << "# TYPE osgearth_server_job_queue_wait_seconds histogram\n";
+            for (auto* pool : jobs::get_metrics()->all())
+                if (pool)
+                    writeJobHistogram(out, "osgearth_server_job_queue_wait_seconds", pool->name, pool->latency_snapshot().queue_wait);
+            out << "# TYPE osgearth_server_job_run_seconds histogram\n";
+            for (auto* pool : jobs::get_metrics()->all())
+                if (pool)
+                    writeJobHistogram(out, "osgearth_server_job_run_seconds", pool->name, pool->latency_snapshot().run_time);
+
+            return out.str();
+        }
+    };
+
+    //! Encodes an image with the ReaderWriter for a codec
+    bool encodeImage(const osg::Image* image, const Codec& codec, std::string& output)
+    {
+        osg::ref_ptr<const osg::Image> source = image;
+
+        // JPEG has no alpha channel
+        if (codec.ext == "jpg" && image->getPixelFormat() != GL_RGB)
+        {
+            source = ImageUtils::convertToRGB8(image);
+            if (!source.valid())
+                return false;
+        }
+
+        auto rw = osgDB::Registry::instance()->getReaderWriterForExtension(codec.ext);
+        if (!rw)
+            return false;
+
+        std::stringstream buf;
+        if (!rw->writeImage(*source, buf).success())
+            return false;
+
+        output = buf.str();
+        return true;
+    }
+
+    //! Encodes a heightfield as a GeoTIFF or a 32-bit float LERC image
+    //! Whether encodeHeightField() supports a codec
+    bool isElevationCodec(const Codec& codec)
+    {
+        return codec.ext == "tif" || codec.ext == "lerc";
+    }
+
+    bool encodeHeightField(const osg::HeightField* hf, const Codec& codec, std::string& output)
+    {
+        if (codec.ext == "tif")
+        {
+            output = osgEarth::GDAL_detail::heightFieldToTiff(hf);
+            return !output.empty();
+        }
+        else if (codec.ext == "lerc")
+        {
+            osg::ref_ptr<osg::Image> image = ImageToHeightFieldConverter().convertToR32F(hf);
+            return image.valid() && encodeImage(image.get(), codec, output);
+        }
+        return false;
+    }
+
+    //! Parses the z/x/y path parameters, with an optional ".ext" suffix on y
+    bool parseTile(const Request& req, const Profile* profile, TileKey& key, std::string& ext)
+    {
+        std::string y = req.path_params.at("y");
+        auto dot = y.find('.');
+        if (dot != std::string::npos)
+        {
+            ext = y.substr(dot + 1);
+            y = y.substr(0, dot);
+        }
+        if (req.has_param("format"))
+        {
+            ext = req.get_param_value("format");
+        }
+
+        unsigned tz, tx, ty;
+        try {
+            tz = std::stoul(req.path_params.at("z"));
+            tx = std::stoul(req.path_params.at("x"));
+            ty = std::stoul(y);
+        }
+        catch (...) {
+            return false;
+        }
+
+        unsigned cols = 0, rows = 0;
+        profile->getNumTiles(tz, cols, rows);
+        if (tx >= cols || ty >= rows)
+            return false;
+
+        key = TileKey(tz, tx, ty, profile);
+        return true;
+    }
+
+    //! Sends an encoded response, or a 304 if the client already has it
+    void respond(const Request& req, Response& res, const Encoded& encoded, Metrics& metrics)
+    {
+        res.set_header("ETag", encoded.etag);
+        if (matchesETag(req, encoded.etag))
+        {
+            res.status = 304;
+            metrics.notModified++;
+        }
+        else
+        {
+            res.set_content(encoded.content, encoded.mimeType);
+        }
+    }
+}
+
 
 int
 main(int argc, char** argv)
@@ -40,6 +341,24 @@ main(int argc, char** argv)
     unsigned int threads = std::max(std::thread::hardware_concurrency() - 1, 8u);
     arguments.read("--threads", threads);
 
+    std::string format = "png";
+    arguments.read("--format", format);
+    const Codec* defaultImageCodec = findCodec(format);
+    if (!defaultImageCodec || defaultImageCodec->ext == "tif")
+        return usage(argv[0], "Unsupported --format");
+
+    std::string elevationFormat = "tif";
+    arguments.read("--elevation-format", elevationFormat);
+    const Codec* defaultElevationCodec = findCodec(elevationFormat);
+    if (!defaultElevationCodec || !isElevationCodec(*defaultElevationCodec))
+        return usage(argv[0], "Unsupported --elevation-format");
+
+    unsigned int cacheSize = 4096;
+    arguments.read("--cache-size", cacheSize);
+
+    bool passthrough = !arguments.read("--no-passthrough");
+    bool verbose = arguments.read("--verbose");
+
     // Load the earth file:
     osg::ref_ptr<osg::Node> node = osgDB::readNodeFiles(arguments);
     if (!node.valid())
@@ -50,90 +369,202 @@ main(int argc, char** argv)
     if (!mapNode)
         return usage(argv[0], "No MapNode in file");
 
+    // Encoded responses keyed by route/layer/z/x/y/format
+    LRUCache<std::string, EncodedPtr> responseCache(std::max(cacheSize, 1u));
+
+    auto getCached = [&](const std::string& cacheKey) -> EncodedPtr
+    {
+        if (cacheSize > 0)
+        {
+            auto cached = responseCache.get(cacheKey);
+            if (cached.has_value())
+                return cached.value();
+        }
+        return nullptr;
+    };
+
+    auto putCached = [&](const std::string& cacheKey, EncodedPtr encoded)
+    {
+        if (cacheSize > 0)
+            responseCache.insert(cacheKey, encoded);
+    };
+
+    Metrics metrics;
+
+    // Wraps a handler to time it and count its response code
+    auto timed = [&metrics](Histogram& latency, std::function<void(const Request&, Response&)> handler)
+    {
+        return [&metrics, &latency, handler](const Request& req, Response& res)
+        {
+            auto t0 = std::chrono::steady_clock::now();
+            handler(req, res);
+            latency.record(std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count());
+            metrics.countResponse(res);
+        };
+    };
+
     Server svr;
     svr.new_task_queue = [&threads] { return new ThreadPool(threads); };
 
-    svr.Get("/layer/:layer/:z/:x/:y", [&mapNode](const Request& req, Response& res) {
+    svr.Get("/layer/:layer/:z/:x/:y", timed(metrics.layerLatency, [&](const Request& req, Response& res) {
         auto layerName = req.path_params.at("layer");
-        auto z = req.path_params.at("z");
-        auto x = req.path_params.at("x");
-        auto y = req.path_params.at("y");  
 
-        std::cout 
-            << "/layer/"<< layerName
-            << "/" << z
-            << "/" << x
-            << "/" << y << std::endl;
+        if (verbose)
+            std::cout << req.path << std::endl;
 
         osgEarth::Layer* layer = mapNode->getMap()->getLayerByName<osgEarth::Layer>(layerName);
-        if (layer != nullptr)
+        ImageLayer* imageLayer = dynamic_cast<ImageLayer*>(layer);
+        ElevationLayer* elevationLayer = dynamic_cast<ElevationLayer*>(layer);
+        TileLayer* tileLayer = imageLayer ? static_cast<TileLayer*>(imageLayer) : static_cast<TileLayer*>(elevationLayer);
+
+        if (!tileLayer || !tileLayer->getProfile())
+        {
+            res.set_content(layerName + " Not Found", "text/plain");
+            res.status = 404;
+            return;
+        }
+
+        TileKey key;
+        std::string ext;
+        if (!parseTile(req, tileLayer->getProfile(), key, ext))
         {
-            ImageLayer* imageLayer = dynamic_cast<ImageLayer*>(layer);
-            ElevationLayer* elevationLayer = dynamic_cast<ElevationLayer*>(layer);
-            if (imageLayer)
+            res.status = 404;
+            return;
+        }
+
+        const Codec* codec = ext.empty() ? (imageLayer ? defaultImageCodec : defaultElevationCodec) : findCodec(ext);
+        if (!codec || (elevationLayer && !isElevationCodec(*codec)))
+        {
+            res.set_content("Unsupported format " + ext, "text/plain");
+            res.status = 400;
+            return;
+        }
+
+        std::string cacheKey = "layer/" + layerName + "/" + key.str() + "/" + codec->ext;
+        EncodedPtr encoded = getCached(cacheKey);
+        if (encoded)
+        {
+            metrics.cacheHits++;
+            respond(req, res, *encoded, metrics);
+            return;
+        }
+        metrics.cacheMisses++;
+
+        std::string content;
+        bool ok = false;
+
+        if (imageLayer)
+        {
+            // Send the source bytes as-is when they are already in the requested format:
+            if (passthrough)
+            {
+                ReadResult r = imageLayer->readEncodedImage(key, nullptr);
+                if (r.succeeded() && sniffFormat(r.getString()) == codec->ext)
+                {
+                    content = r.getString();
+                    ok = true;
+                    metrics.passthrough++;
+                }
+            }
+
+            if (!ok)
             {
-                auto image = imageLayer->createImage(osgEarth::TileKey(std::stoi(z), std::stoi(x), std::stoi(y), imageLayer->getProfile()));
+                auto image = imageLayer->createImage(key);
                 if (image.valid())
                 {
-                    auto rw = osgDB::Registry::instance()->getReaderWriterForExtension("png");
-                    if (rw)
+                    ok = encodeImage(image.getImage(), *codec, content);
+                    if (!ok)
                     {
-                        std::stringstream buf;
-                        rw->writeImage(*image.getImage(), buf);
-                        res.set_content(buf.str(), "image/png");
+                        res.status = 500;
+                        return;
                     }
-                }
-                else
-                {
-                    res.status = 404;
+                    metrics.encoded++;
                 }
             }
-            else if (elevationLayer)
-            {                
-                auto heightField = elevationLayer->createHeightField(osgEarth::TileKey(std::stoi(z), std::stoi(x), std::stoi(y), elevationLayer->getProfile()));
-                if (heightField.valid())
-                {
-                    std::string content = osgEarth::GDAL_detail::heightFieldToTiff(heightField.getHeightField());
-                    res.set_content(content, "image/tiff");
-                }
-                else
+        }
+        else
+        {
+            auto heightField = elevationLayer->createHeightField(key);
+            if (heightField.valid())
+            {
+                ok = encodeHeightField(heightField.getHeightField(), *codec, content);
+                if (!ok)
                 {
-                    res.status = 404;
+                    res.status = 500;
+                    return;
                 }
+                metrics.encoded++;
             }
-            
         }
-        else
+
+        if (!ok)
         {
-            res.set_content(layerName + " Not Found", "text/plain");
             res.status = 404;
-        }        
-    });
+            return;
+        }
 
-    svr.Get("/elevation/:z/:x/:y", [&mapNode](const Request& req, Response& res) {
-        auto z = req.path_params.at("z");
-        auto x = req.path_params.at("x");
-        auto y = req.path_params.at("y");
+        encoded = makeEncoded(std::move(content), codec->mimeType);
+        putCached(cacheKey, encoded);
+        respond(req, res, *encoded, metrics);
+    }));
 
-        std::cout
-            << "/elevation/"
-            << "/" << z
-            << "/" << x
-            << "/" << y << std::endl;
+    svr.Get("/elevation/:z/:x/:y", timed(metrics.elevationLatency, [&](const Request& req, Response& res) {
+
+        if (verbose)
+            std::cout << req.path << std::endl;
+
+        TileKey key;
+        std::string ext;
+        if (!parseTile(req, mapNode->getMap()->getProfile(), key, ext))
+        {
+            res.status = 404;
+            return;
+        }
+
+        const Codec* codec = ext.empty() ? defaultElevationCodec : findCodec(ext);
+        if (!codec || !isElevationCodec(*codec))
+        {
+            res.set_content("Unsupported format " + ext, "text/plain");
+            res.status = 400;
+            return;
+        }
+
+        std::string cacheKey = "elevation/" + key.str() + "/" + codec->ext;
+        EncodedPtr encoded = getCached(cacheKey);
+        if (encoded)
+        {
+            metrics.cacheHits++;
+            respond(req, res, *encoded, metrics);
+            return;
+        }
+        metrics.cacheMisses++;
 
         osg::ref_ptr<ElevationTile> elevTex;
-        if (mapNode->getMap()->getElevationPool()->getTile(osgEarth::TileKey(std::stoi(z), std::stoi(x), std::stoi(y), mapNode->getMap()->getProfile()), false, elevTex, nullptr, nullptr))
+        if (mapNode->getMap()->getElevationPool()->getTile(key, false, elevTex, nullptr, nullptr))
         {
-            std::string content = osgEarth::GDAL_detail::heightFieldToTiff(elevTex->getHeightField());
-            res.set_content(content, "image/tiff");
+            std::string content;
+            if (!encodeHeightField(elevTex->getHeightField(), *codec, content))
+            {
+                res.status = 500;
+                return;
+            }
+            metrics.encoded++;
+
+            encoded = makeEncoded(std::move(content), codec->mimeType);
+            putCached(cacheKey, encoded);
+            respond(req, res, *encoded, metrics);
         }
         else
         {
             res.status = 404;
         }
-        });
+    }));
+
+    svr.Get("/metrics", [&metrics](const Request& req, Response& res) {
+        res.set_content(metrics.toString(), "text/plain; version=0.0.4");
+    });
 
     svr.listen(host, port);
 
     return 0;
-}
\ No newline at end of file
+}
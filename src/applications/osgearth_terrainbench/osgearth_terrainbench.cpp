@@ -0,0 +1,490 @@
+/* osgEarth
+* Copyright 2025 Pelican Mapping
+* MIT License
+*/
+
+#include <osgEarth/Notify>
+#include <osgEarth/MapNode>
+#include <osgEarth/TerrainEngineNode>
+#include <osgEarth/GeoData>
+#include <osgEarth/TileLayer>
+#include <osgEarth/MemoryUtils>
+#include <osgEarth/JsonUtils>
+#include <osgEarth/Threading>
+#include <osgUtil/SceneView>
+#include <osg/ArgumentParser>
+#include <osg/FrameStamp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#define LC "[terrainbench] "
+
+using namespace osgEarth;
+using namespace osgEarth::Util;
+
+int
+usage(const char* name, const std::string& error)
+{
+    OE_NOTICE
+        << "Replays a recorded camera path against a terrain without drawing it,"
+        << "\nand measures how long the view takes to reach full resolution, the tile"
+        << "\nload rate, job queue depths, cache hit rates and peak memory."
+        << "\nError: " << error
+        << "\nUsage:"
+        << "\n" << name
+        << "\n  <earthfile>              ; earth file to load"
+        << "\n  --path <file>            ; camera path, one keyframe per line:"
+        << "\n                           ;   time(s) lat lon alt(m) heading pitch (degrees)"
+        << "\n  [--prefetch]             ; enable predictive tile prefetching"
+        << "\n  [--horizon <s>]          ; prefetch horizon in seconds"
+        << "\n  [--max-prefetch <n>]     ; maximum number of prefetched tiles"
+        << "\n  [--fps <n>]              ; frame rate of the replay (default 60)"
+        << "\n  [--size <w> <h>]         ; viewport size (default 1920 1080)"
+        << "\n  [--fov <degrees>]        ; vertical field of view (default 30)"
+        << "\n  [--timeout <s>]          ; longest wait for full resolution (default 120)"
+        << "\n  [--json <file>]          ; also write the results as JSON (- for stdout)"
+        << std::endl;
+
+    return -1;
+}
+
+namespace
+{
+    //! One keyframe of a recorded camera path
+    struct Keyframe
+    {
+        double time, lat, lon, alt, heading, pitch;
+    };
+
+    bool readPath(const std::string& filename, std::vector<Keyframe>& path)
+    {
+        std::ifstream in(filename.c_str());
+        if (!in.is_open())
+            return false;
+
+        std::string line;
+        while (std::getline(in, line))
+        {
+            if (line.empty() || line[0] == '#')
+                continue;
+
+            Keyframe k;
+            std::istringstream buf(line);
+            if (buf >> k.time >> k.lat >> k.lon >> k.alt >> k.heading >> k.pitch)
+                path.push_back(k);
+        }
+
+        std::stable_sort(path.begin(), path.end(),
+            [](const Keyframe& lhs, const Keyframe& rhs) { return lhs.time < rhs.time; });
+
+        return !path.empty();
+    }
+
+    //! Shortest signed angle (degrees) from a to b
+    double turn(double a, double b)
+    {
+        return fmod(b - a + 540.0, 360.0) - 180.0;
+    }
+
+    //! Camera pose at time t, interpolated linearly between keyframes
+    Keyframe sample(const std::vector<Keyframe>& path, double t)
+    {
+        if (t <= path.front().time)
+            return path.front();
+        if (t >= path.back().time)
+            return path.back();
+
+        auto next = std::upper_bound(path.begin(), path.end(), t,
+            [](double time, const Keyframe& k) { return time < k.time; });
+        const Keyframe& a = *(next - 1);
+        const Keyframe& b = *next;
+
+        double u = (t - a.time) / (b.time - a.time);
+        Keyframe k;
+        k.time = t;
+        k.lat = a.lat + (b.lat - a.lat) * u;
+        k.lon = a.lon + turn(a.lon, b.lon) * u;
+        k.alt = a.alt + (b.alt - a.alt) * u;
+        k.heading = a.heading + turn(a.heading, b.heading) * u;
+        k.pitch = a.pitch + (b.pitch - a.pitch) * u;
+        return k;
+    }
+
+    //! View matrix for a camera at a keyframe pose
+    osg::Matrixd viewMatrix(const Keyframe& k, const SpatialReference* mapSRS)
+    {
+        GeoPoint point(mapSRS->getGeographicSRS(), k.lon, k.lat, k.alt, ALTMODE_ABSOLUTE);
+        osg::Matrixd local2world;
+        point.transform(mapSRS).createLocalToWorld(local2world);
+
+        // The camera looks down -Z with +Y up. Tip it level facing north,
+        // then apply the pitch (negative is down) and the heading (clockwise).
+        osg::Matrixd camera =
+            osg::Matrixd::rotate(osg::DegreesToRadians(90.0 + k.pitch), osg::X_AXIS) *
+            osg::Matrixd::rotate(osg::DegreesToRadians(-k.heading), osg::Z_AXIS) *
+            local2world;
+
+        return osg::Matrixd::inverse(camera);
+    }
+
+    //! Queue depths of one job pool, sampled once per frame
+    struct PoolSamples
+    {
+        unsigned peakPending = 0u;
+        unsigned peakRunning = 0u;
+        double pendingSum = 0.0;
+        unsigned samples = 0u;
+    };
+
+    //! Tracks the stretches of time the view spends below full resolution
+    struct Episodes
+    {
+        std::vector<double> durations;
+        double start = -1.0;
+
+        void update(bool fullRes, double time)
+        {
+            if (!fullRes && start < 0.0)
+                start = time;
+            else if (fullRes && start >= 0.0)
+                finish(time);
+        }
+
+        void finish(double time)
+        {
+            if (start >= 0.0)
+                durations.push_back(time - start);
+            start = -1.0;
+        }
+    };
+}
+
+int
+main(int argc, char** argv)
+{
+    osgEarth::initialize();
+
+    osg::ArgumentParser arguments(&argc, argv);
+
+    if (arguments.read("--help"))
+        return usage(argv[0], "");
+
+    std::string pathFile;
+    if (!arguments.read("--path", pathFile))
+        return usage(argv[0], "Missing --path");
+
+    std::vector<Keyframe> path;
+    if (!readPath(pathFile, path))
+        return usage(argv[0], "No keyframes in " + pathFile);
+
+    bool prefetch = arguments.read("--prefetch");
+    float horizon = 0.0f;
+    arguments.read("--horizon", horizon);
+    unsigned maxPrefetch = 0u;
+    arguments.read("--max-prefetch", maxPrefetch);
+    double fps = 60.0;
+    arguments.read("--fps", fps);
+    int width = 1920, height = 1080;
+    arguments.read("--size", width, height);
+    double fov = 30.0;
+    arguments.read("--fov", fov);
+    double timeout = 120.0;
+    arguments.read("--timeout", timeout);
+    std::string jsonFile;
+    arguments.read("--json", jsonFile);
+
+    osg::ref_ptr<MapNode> mapNode = MapNode::load(arguments);
+    if (!mapNode.valid())
+        return usage(argv[0], "No earth file");
+
+    // The terrain engine starts on the first traversal, so these still apply:
+    TerrainOptionsAPI terrainOptions = mapNode->getTerrainOptions();
+    terrainOptions.setPrefetch(prefetch);
+    if (horizon > 0.0f)
+        terrainOptions.setPrefetchHorizon(horizon);
+    if (maxPrefetch > 0u)
+        terrainOptions.setMaxPrefetchTiles(maxPrefetch);
+
+    // Update and cull only; nothing is drawn, so no graphics context is needed.
+    osg::ref_ptr<osgUtil::SceneView> sceneView = new osgUtil::SceneView();
+    sceneView->setDefaults(osgUtil::SceneView::NO_SCENEVIEW_LIGHT);
+    sceneView->setSceneData(mapNode.get());
+    sceneView->setViewport(0, 0, width, height);
+    sceneView->setProjectionMatrixAsPerspective(fov, (double)width / (double)height, 1.0, 1e10);
+
+    osg::ref_ptr<osg::FrameStamp> frameStamp = new osg::FrameStamp();
+    sceneView->setFrameStamp(frameStamp.get());
+
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point t0 = Clock::now();
+    auto elapsed = [&]() { return std::chrono::duration<double>(Clock::now() - t0).count(); };
+
+    unsigned frame = 0u;
+    unsigned awaiting = 0u;
+    TerrainEngine* engine = nullptr;
+    std::map<std::string, PoolSamples> pools;
+    std::uint64_t peakTileBytes = 0u;
+
+    // Runs one frame with the camera at the given path time and paces the
+    // loop to the frame rate. Returns true if the view is at full resolution.
+    auto runFrame = [&](double pathTime)
+        {
+            double now = elapsed();
+            frameStamp->setFrameNumber(frame++);
+            frameStamp->setReferenceTime(now);
+            frameStamp->setSimulationTime(now);
+
+            sceneView->setViewMatrix(viewMatrix(sample(path, pathTime), mapNode->getMapSRS()));
+            sceneView->update();
+            sceneView->cull();
+
+            std::this_thread::sleep_until(t0 + std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>((double)frame / fps)));
+
+            for (auto* pool : jobs::get_metrics()->all())
+            {
+                if (!pool)
+                    continue;
+                PoolSamples& samples = pools[pool->name];
+                samples.peakPending = std::max(samples.peakPending, (unsigned)pool->pending);
+                samples.peakRunning = std::max(samples.peakRunning, (unsigned)pool->running);
+                samples.pendingSum += pool->pending;
+                ++samples.samples;
+            }
+
+            if (!engine)
+                engine = mapNode->getTerrainEngine();
+            if (!engine)
+                return false;
+
+            auto residency = engine->getResidencyStats();
+            peakTileBytes = std::max(peakTileBytes, residency.cpuBytes + residency.gpuBytes);
+
+            // Loaded tiles leave the count when they're queued to merge,
+            // so the merge queues must drain too.
+            auto merges = engine->getMergeStats();
+            awaiting = engine->getNumTilesAwaitingData();
+            return
+                frame > 2u &&
+                awaiting == 0u &&
+                merges.mergeQueueDepth == 0u &&
+                merges.compileQueueDepth == 0u;
+        };
+
+    // 1. Hold the first pose until the view reaches full resolution:
+    double initialLoad = -1.0;
+    while (elapsed() < timeout)
+    {
+        if (runFrame(path.front().time))
+        {
+            initialLoad = elapsed();
+            break;
+        }
+    }
+
+    if (!engine)
+    {
+        OE_WARN << LC << "No terrain engine" << std::endl;
+        return -1;
+    }
+
+    std::uint64_t initialMerges = engine->getMergeStats().totalMerges;
+
+    // 2. Play the path in real time:
+    Episodes episodes;
+    unsigned pathFrames = 0u, fullResFrames = 0u;
+    double awaitingSum = 0.0;
+    double duration = path.back().time - path.front().time;
+    double playStart = elapsed();
+
+    for (double t = 0.0; t <= duration; t = elapsed() - playStart)
+    {
+        bool fullRes = runFrame(path.front().time + t);
+        ++pathFrames;
+        if (fullRes)
+            ++fullResFrames;
+        awaitingSum += awaiting;
+        episodes.update(fullRes, elapsed());
+    }
+
+    // 3. Hold the last pose until the view catches up:
+    double pathEnd = elapsed();
+    double settle = -1.0;
+    while (elapsed() - pathEnd < timeout)
+    {
+        bool fullRes = runFrame(path.back().time);
+        episodes.update(fullRes, elapsed());
+        if (fullRes)
+        {
+            settle = elapsed() - pathEnd;
+            break;
+        }
+    }
+    episodes.finish(elapsed());
+
+    double meanEpisode = 0.0, maxEpisode = 0.0;
+    for (double d : episodes.durations)
+    {
+        meanEpisode += d;
+        maxEpisode = std::max(maxEpisode, d);
+    }
+    if (!episodes.durations.empty())
+        meanEpisode /= (double)episodes.durations.size();
+
+    double runTime = elapsed();
+    double pathTime = pathEnd - playStart;
+    auto prefetchStats = engine->getPrefetchStats();
+    auto mergeStats = engine->getMergeStats();
+    auto residency = engine->getResidencyStats();
+    std::uint64_t pathMerges = mergeStats.totalMerges - initialMerges;
+
+    // Cache lookups summed over the map's tile layers:
+    TileLayer::CacheStats cacheStats;
+    TileLayerVector tileLayers;
+    mapNode->getMap()->getLayers(tileLayers);
+    for (auto& layer : tileLayers)
+    {
+        auto stats = layer->getCacheStats();
+        cacheStats.memCacheHits += stats.memCacheHits;
+        cacheStats.memCacheMisses += stats.memCacheMisses;
+        cacheStats.cacheHits += stats.cacheHits;
+        cacheStats.cacheMisses += stats.cacheMisses;
+    }
+
+    auto ratio = [](unsigned hits, unsigned misses)
+        {
+            return hits + misses > 0u ? (double)hits / (double)(hits + misses) : 0.0;
+        };
+
+    const double MB = 1048576.0;
+    double peakMemory = (double)Memory::getProcessPeakPhysicalUsage() / MB;
+
+    if (jsonFile != "-")
+    {
+        std::cout << std::fixed << std::setprecision(3)
+            << "Prefetch:                  " << (prefetch ? "on" : "off") << "\n"
+            << "Initial load:              " << initialLoad << " s\n"
+            << "Path:                      " << duration << " s, " << pathFrames << " frames\n"
+            << "Frames at full resolution: " << (pathFrames > 0 ? 100.0 * fullResFrames / pathFrames : 0.0) << " %\n"
+            << "Tiles awaiting data:       " << (pathFrames > 0 ? awaitingSum / pathFrames : 0.0) << " per frame\n"
+            << "Time to full resolution:   " << episodes.durations.size() << " times, mean "
+            << meanEpisode << " s, max " << maxEpisode << " s\n"
+            << "Settle after path:         " << settle << " s\n"
+            << "Tiles merged:              " << mergeStats.totalMerges << " ("
+            << (pathTime > 0.0 ? (double)pathMerges / pathTime : 0.0) << " per second along the path)\n"
+            << "Cache hit rate:            " << 100.0 * ratio(cacheStats.memCacheHits, cacheStats.memCacheMisses) << " % memory, "
+            << 100.0 * ratio(cacheStats.cacheHits, cacheStats.cacheMisses) << " % persistent\n"
+            << "Peak tile memory:          " << (double)peakTileBytes / MB << " MB\n"
+            << "Peak process memory:       " << peakMemory << " MB\n";
+
+        for (auto& pool : pools)
+        {
+            std::cout
+                << "Pool " << std::left << std::setw(22) << ("\"" + pool.first + "\":") << std::right
+                << "pending mean " << (pool.second.samples > 0 ? pool.second.pendingSum / pool.second.samples : 0.0)
+                << ", peak " << pool.second.peakPending
+                << "; running peak " << pool.second.peakRunning << "\n";
+        }
+
+        if (prefetch)
+        {
+            std::cout
+                << "Prefetches:                " << prefetchStats.issued << " issued, "
+                << prefetchStats.used << " used, "
+                << prefetchStats.canceled << " canceled, "
+                << prefetchStats.expired << " expired\n";
+        }
+    }
+
+    if (!jsonFile.empty())
+    {
+        Json::Value root(Json::objectValue);
+        root["path_file"] = pathFile;
+        root["prefetch"] = prefetch;
+        root["run_time_s"] = runTime;
+        root["initial_load_s"] = initialLoad;
+        root["path_duration_s"] = duration;
+        root["path_frames"] = pathFrames;
+        root["full_res_frame_ratio"] = pathFrames > 0 ? (double)fullResFrames / pathFrames : 0.0;
+        root["mean_tiles_awaiting_data"] = pathFrames > 0 ? awaitingSum / pathFrames : 0.0;
+        root["settle_s"] = settle;
+
+        Json::Value ttfr(Json::objectValue);
+        ttfr["count"] = (unsigned)episodes.durations.size();
+        ttfr["mean_s"] = meanEpisode;
+        ttfr["max_s"] = maxEpisode;
+        root["time_to_full_res"] = ttfr;
+
+        Json::Value tiles(Json::objectValue);
+        tiles["merged"] = (double)mergeStats.totalMerges;
+        tiles["merged_along_path"] = (double)pathMerges;
+        tiles["per_second_along_path"] = pathTime > 0.0 ? (double)pathMerges / pathTime : 0.0;
+        tiles["per_second_overall"] = runTime > 0.0 ? (double)mergeStats.totalMerges / runTime : 0.0;
+        tiles["resident"] = residency.tiles;
+        tiles["budget_evictions"] = (double)residency.evictions;
+        root["tiles"] = tiles;
+
+        Json::Value cache(Json::objectValue);
+        cache["memory_hits"] = cacheStats.memCacheHits;
+        cache["memory_misses"] = cacheStats.memCacheMisses;
+        cache["memory_hit_rate"] = ratio(cacheStats.memCacheHits, cacheStats.memCacheMisses);
+        cache["hits"] = cacheStats.cacheHits;
+        cache["misses"] = cacheStats.cacheMisses;
+        cache["hit_rate"] = ratio(cacheStats.cacheHits, cacheStats.cacheMisses);
+        root["cache"] = cache;
+
+        Json::Value poolsJson(Json::objectValue);
+        for (auto& pool : pools)
+        {
+            Json::Value p(Json::objectValue);
+            p["pending_mean"] = pool.second.samples > 0 ? pool.second.pendingSum / pool.second.samples : 0.0;
+            p["pending_peak"] = pool.second.peakPending;
+            p["running_peak"] = pool.second.peakRunning;
+            poolsJson[pool.first] = p;
+        }
+        root["job_pools"] = poolsJson;
+
+        Json::Value memory(Json::objectValue);
+        memory["peak_process_mb"] = peakMemory;
+        memory["peak_tile_mb"] = (double)peakTileBytes / MB;
+        memory["tile_budget_mb"] = (double)residency.budgetBytes / MB;
+        root["memory"] = memory;
+
+        if (prefetch)
+        {
+            Json::Value pf(Json::objectValue);
+            pf["issued"] = (double)prefetchStats.issued;
+            pf["used"] = (double)prefetchStats.used;
+            pf["canceled"] = (double)prefetchStats.canceled;
+            pf["expired"] = (double)prefetchStats.expired;
+            root["prefetch_stats"] = pf;
+        }
+
+        std::string json = Json::StyledWriter().write(root);
+        if (jsonFile == "-")
+        {
+            std::cout << json;
+        }
+        else
+        {
+            std::ofstream out(jsonFile.c_str());
+            if (!out.is_open())
+            {
+                OE_WARN << LC << "Cannot write " << jsonFile << std::endl;
+                return -1;
+            }
+            out << json;
+        }
+    }
+
+    std::cout << std::flush;
+    return 0;
+}
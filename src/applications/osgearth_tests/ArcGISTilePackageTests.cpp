@@ -0,0 +1,218 @@
+/* osgEarth
+* Copyright 2025 Pelican Mapping
+* MIT License
+*/
+
+#include <osgEarth/catch.hpp>
+
+#include <osgEarth/ArcGISTilePackage>
+#include <osgEarth/FileUtils>
+#include <osgDB/FileNameUtils>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+using namespace osgEarth;
+using namespace osgEarth::ArcGIS;
+
+namespace
+{
+    const unsigned BUNDLE_SIZE = 128u;
+
+    //! Deterministic payload for tile "index"; an empty string means no tile.
+    std::string tilePayload(unsigned index, unsigned size)
+    {
+        if (index % 7 == 3)
+            return {};
+
+        std::string data(size + (index % 13), '\0');
+        for (unsigned i = 0; i < data.size(); ++i)
+            data[i] = (char)((index * 31u + i) & 0xff);
+        return data;
+    }
+
+    void writeLE(std::ostream& out, unsigned long long value, unsigned bytes)
+    {
+        for (unsigned i = 0; i < bytes; ++i)
+            out.put((char)((value >> (8u * i)) & 0xff));
+    }
+
+    //! Writes a compact v2 bundle holding every tile of tilePayload() at the
+    //! given level and returns the root directory (the one holding L##).
+    std::string createCompactV2Bundle(const std::string& name, unsigned lod, unsigned payloadSize)
+    {
+        std::string rootDir = osgDB::concatPaths(getTempPath(), name) + "/";
+        char levelDir[8];
+        snprintf(levelDir, sizeof(levelDir), "L%02u", lod);
+        std::string bundleFile = rootDir + levelDir + "/R0000C0000.bundle";
+        makeDirectoryForFile(bundleFile);
+
+        const unsigned numEntries = BUNDLE_SIZE * BUNDLE_SIZE;
+        const unsigned long long dataStart = 64ull + numEntries * 8ull;
+
+        std::vector<unsigned long long> index(numEntries, 0ull);
+        std::string body;
+        for (unsigned i = 0; i < numEntries; ++i)
+        {
+            std::string tile = tilePayload(i, payloadSize);
+            if (!tile.empty())
+            {
+                // each tile is preceded by its 4-byte size; the index points past it
+                std::ostringstream size;
+                writeLE(size, tile.size(), 4);
+                body += size.str();
+                unsigned long long offset = dataStart + body.size();
+                index[i] = offset + ((unsigned long long)tile.size() << 40);
+                body += tile;
+            }
+        }
+
+        std::ofstream out(bundleFile.c_str(), std::ios::binary | std::ios::trunc);
+        std::string header(64, '\0');
+        out.write(header.data(), header.size());
+        for (auto entry : index)
+            writeLE(out, entry, 8);
+        out.write(body.data(), body.size());
+        return rootDir;
+    }
+
+    //! Deletes a test bundle's directory tree when it goes out of scope.
+    //! Declare it before anything that maps the bundle.
+    struct TempDirectory
+    {
+        std::string path;
+
+        ~TempDirectory()
+        {
+            std::error_code ec;
+            std::filesystem::remove_all(path, ec);
+        }
+    };
+
+    //! Index of tile (x, y) in a v2 bundle at the origin
+    inline unsigned tileIndex(unsigned x, unsigned y)
+    {
+        return BUNDLE_SIZE * y + x;
+    }
+}
+
+TEST_CASE("ArcGIS BundleCache reads tiles from a mapped compact v2 bundle")
+{
+    const unsigned lod = 5u;
+    TempDirectory temp{ createCompactV2Bundle("osgearth_tpk_test", lod, 256u) };
+    const std::string& rootDir = temp.path;
+
+    BundleCache cache(rootDir, STORAGE_FORMAT_COMPACTV2, BUNDLE_SIZE, 4u);
+
+    auto bundle = cache.getBundle(lod, 0, 0);
+    REQUIRE(bundle != nullptr);
+    REQUIRE(bundle->valid());
+
+    for (unsigned y = 0; y < BUNDLE_SIZE; y += 9)
+    {
+        for (unsigned x = 0; x < BUNDLE_SIZE; x += 5)
+        {
+            std::string expected = tilePayload(tileIndex(x, y), 256u);
+            const char* data = nullptr;
+            std::size_t size = 0u;
+            bool found = bundle->getTileData(tileIndex(x, y), data, size);
+            REQUIRE(found == !expected.empty());
+            if (found)
+            {
+                REQUIRE(std::string(data, size) == expected);
+            }
+        }
+    }
+
+    SECTION("Missing bundles are cached as null")
+    {
+        REQUIRE(cache.getBundle(lod, BUNDLE_SIZE, 0) == nullptr);
+        REQUIRE(cache.getBundle(lod + 1, 0, 0) == nullptr);
+        REQUIRE(cache.getBundle(lod, BUNDLE_SIZE, 0) == nullptr);
+    }
+
+    SECTION("Threads share one open bundle")
+    {
+        std::vector<std::thread> threads;
+        std::atomic_int mismatches(0);
+        for (unsigned t = 0; t < 8; ++t)
+        {
+            threads.emplace_back([&, t]()
+                {
+                    for (unsigned i = t; i < BUNDLE_SIZE * BUNDLE_SIZE; i += 8)
+                    {
+                        auto shared = cache.getBundle(lod, i % BUNDLE_SIZE, i / BUNDLE_SIZE);
+                        const char* data = nullptr;
+                        std::size_t size = 0u;
+                        std::string expected = tilePayload(i, 256u);
+                        bool found = shared && shared->getTileData(i, data, size);
+                        if (found != !expected.empty() || (found && std::string(data, size) != expected))
+                            ++mismatches;
+                    }
+                });
+        }
+        for (auto& thread : threads)
+            thread.join();
+
+        REQUIRE(mismatches == 0);
+        REQUIRE(cache.getStats().opens == 1u);
+    }
+}
+
+TEST_CASE("ArcGIS BundleCache read throughput", "[.benchmark]")
+{
+    const unsigned lod = 5u;
+    const unsigned payloadSize = 16384u;
+    TempDirectory temp{ createCompactV2Bundle("osgearth_tpk_benchmark", lod, payloadSize) };
+    const std::string& rootDir = temp.path;
+
+    BundleCache cache(rootDir, STORAGE_FORMAT_COMPACTV2, BUNDLE_SIZE, 32u);
+    std::string bundleFile = cache.getBundleFileName(lod, 0, 0);
+    const unsigned numTiles = BUNDLE_SIZE * BUNDLE_SIZE;
+
+    for (bool cached : { false, true })
+    {
+        std::uint64_t bytes = 0u;
+        unsigned tiles = 0u;
+
+        auto read = [&](const Bundle& bundle, unsigned i)
+            {
+                const char* data = nullptr;
+                std::size_t size = 0u;
+                if (bundle.getTileData(i, data, size))
+                {
+                    // touch the bytes so the slice is really read
+                    bytes += size + (unsigned char)data[size - 1];
+                    ++tiles;
+                }
+            };
+
+        auto t0 = std::chrono::steady_clock::now();
+        for (unsigned i = 0; i < numTiles; ++i)
+        {
+            if (cached)
+            {
+                auto bundle = cache.getBundle(lod, i % BUNDLE_SIZE, i / BUNDLE_SIZE);
+                if (bundle)
+                    read(*bundle, i);
+            }
+            else
+            {
+                // the old per-tile pattern: open the bundle and parse its index every time
+                BundleReader2 reader(bundleFile, BUNDLE_SIZE);
+                read(reader, i);
+            }
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+        REQUIRE(tiles > 0u);
+        std::cout << (cached ? "Cached bundle: " : "Open per tile: ")
+            << (unsigned)((double)tiles / seconds) << " tiles/s, "
+            << (unsigned)((double)bytes / seconds / 1048576.0) << " MB/s" << std::endl;
+    }
+}
@@ -7,7 +7,10 @@
 #include <osgEarth/GeoData>
 #include <osgEarth/Registry>
 #include <osgEarth/MemCache>
+#include <osgEarth/TieredCache>
 #include <osgEarth/Containers>  // For osgEarth::LRUCache
+#include <osgEarth/DateTime>
+#include <map>
 
 using namespace osgEarth;
 
@@ -65,6 +68,208 @@ TEST_CASE("Cache")
     }
 }
 
+TEST_CASE("TieredCache")
+{
+    osg::ref_ptr<MemCache> fast = new MemCache(8);
+    osg::ref_ptr<MemCache> slow = new MemCache(64);
+
+    osg::ref_ptr<TieredCache> cache = new TieredCache();
+    cache->addTier(fast.get());
+    cache->addTier(slow.get());
+    REQUIRE(cache->getStatus().isOK());
+    REQUIRE(cache->getNumTiers() == 2u);
+
+    osg::ref_ptr<CacheBin> bin = cache->addBin("test_bin");
+    REQUIRE(bin.valid());
+
+    SECTION("Write goes to every tier")
+    {
+        REQUIRE(bin->write("key", new StringObject("value"), 0L));
+        REQUIRE(fast->addBin("test_bin")->readString("key", 0L).getString() == "value");
+        REQUIRE(slow->addBin("test_bin")->readString("key", 0L).getString() == "value");
+    }
+
+    SECTION("Read-through promotion")
+    {
+        // record only exists in the slow tier:
+        REQUIRE(slow->addBin("test_bin")->write("key", new StringObject("value"), 0L));
+        REQUIRE(fast->addBin("test_bin")->readString("key", 0L).failed());
+
+        ReadResult r = bin->readString("key", 0L);
+        REQUIRE(r.succeeded());
+        REQUIRE(r.getString() == "value");
+
+        // now promoted to the fast tier:
+        REQUIRE(fast->addBin("test_bin")->readString("key", 0L).getString() == "value");
+
+        auto stats = cache->getTierStats();
+        REQUIRE(stats.size() == 2u);
+        REQUIRE(stats[0].misses == 1u);
+        REQUIRE(stats[0].promotions == 1u);
+        REQUIRE(stats[1].hits == 1u);
+
+        // second read is served by the fast tier:
+        REQUIRE(bin->readString("key", 0L).succeeded());
+        stats = cache->getTierStats();
+        REQUIRE(stats[0].hits == 1u);
+        REQUIRE(stats[1].reads == 1u);
+    }
+
+    SECTION("Miss and remove")
+    {
+        REQUIRE(bin->readString("missing", 0L).failed());
+        REQUIRE(bin->getRecordStatus("missing") == CacheBin::STATUS_NOT_FOUND);
+
+        REQUIRE(bin->write("key", new StringObject("value"), 0L));
+        REQUIRE(bin->getRecordStatus("key") == CacheBin::STATUS_OK);
+        REQUIRE(bin->remove("key"));
+        REQUIRE(slow->addBin("test_bin")->readString("key", 0L).failed());
+    }
+
+    SECTION("Policy")
+    {
+        // a read-only shared tier is never written to
+        osg::ref_ptr<MemCache> shared = new MemCache();
+        TieredCacheOptions::Tier policy;
+        policy.writable() = false;
+
+        osg::ref_ptr<TieredCache> cache2 = new TieredCache();
+        cache2->addTier(new MemCache());
+        cache2->addTier(shared.get(), policy);
+
+        osg::ref_ptr<CacheBin> bin2 = cache2->addBin("test_bin");
+        REQUIRE(bin2->write("key", new StringObject("value"), 0L));
+        REQUIRE(shared->addBin("test_bin")->readString("key", 0L).failed());
+    }
+}
+
+TEST_CASE("TieredCache from config")
+{
+    Config conf("cache");
+    conf.set("driver", "tiered");
+    Config tier1("tier");
+    tier1.set("driver", "memory");
+    tier1.set("max_size", 32);
+    conf.add(tier1);
+    Config tier2("tier");
+    tier2.set("driver", "memory");
+    tier2.set("promote", false);
+    conf.add(tier2);
+
+    TieredCacheOptions options{ ConfigOptions(conf) };
+    REQUIRE(options.tiers().size() == 2u);
+    REQUIRE(options.tiers()[0].maxSize() == 32u);
+    REQUIRE(options.tiers()[1].promote() == false);
+
+    osg::ref_ptr<Cache> cache = Util::CacheFactory::create(CacheOptions(ConfigOptions(conf)));
+    REQUIRE(cache.valid());
+    REQUIRE(dynamic_cast<TieredCache*>(cache.get()) != nullptr);
+    REQUIRE(static_cast<TieredCache*>(cache.get())->getNumTiers() == 2u);
+}
+
+namespace
+{
+    //! MemCache whose records all report the same last-modified time,
+    //! like files in a filesystem cache written at that time.
+    class AgedCache : public MemCache
+    {
+    public:
+        AgedCache(TimeStamp lastModified) : _lastModified(lastModified) { }
+
+        CacheBin* addBin(const std::string& binID) override
+        {
+            osg::ref_ptr<CacheBin>& bin = _aged[binID];
+            if (!bin.valid())
+                bin = new AgedBin(MemCache::addBin(binID), _lastModified);
+            return bin.get();
+        }
+
+    private:
+        struct AgedBin : public CacheBin
+        {
+            AgedBin(CacheBin* bin, TimeStamp t) : CacheBin(bin->getID()), _bin(bin), _t(t) { }
+
+            ReadResult stamp(ReadResult r) { if (r.succeeded()) r.setLastModifiedTime(_t); return r; }
+            ReadResult readObject(const std::string& key, const osgDB::Options* dbo) override { return stamp(_bin->readObject(key, dbo)); }
+            ReadResult readImage(const std::string& key, const osgDB::Options* dbo) override { return stamp(_bin->readImage(key, dbo)); }
+            ReadResult readString(const std::string& key, const osgDB::Options* dbo) override { return stamp(_bin->readString(key, dbo)); }
+            bool write(const std::string& key, const osg::Object* object, const Config& meta, const osgDB::Options* dbo) override { return _bin->write(key, object, meta, dbo); }
+            RecordStatus getRecordStatus(const std::string& key) override { return _bin->getRecordStatus(key); }
+            bool remove(const std::string& key) override { return _bin->remove(key); }
+            bool touch(const std::string& key) override { return _bin->touch(key); }
+
+            osg::ref_ptr<CacheBin> _bin;
+            TimeStamp _t;
+        };
+
+        TimeStamp _lastModified;
+        std::map<std::string, osg::ref_ptr<CacheBin>> _aged;
+    };
+}
+
+TEST_CASE("TieredCache does not refresh expired records")
+{
+    const TimeStamp hourAgo = DateTime().asTimeStamp() - 3600;
+
+    // fast tier only keeps records younger than a minute;
+    // the slow tier holds an hour-old copy and has no age limit.
+    TieredCacheOptions::Tier fastPolicy;
+    fastPolicy.maxAge() = 60.0;
+
+    osg::ref_ptr<MemCache> fast = new MemCache(8);
+    osg::ref_ptr<AgedCache> slow = new AgedCache(hourAgo);
+    slow->addBin("test_bin")->write("key", new StringObject("value"), 0L);
+
+    osg::ref_ptr<TieredCache> cache = new TieredCache();
+    cache->addTier(fast.get(), fastPolicy);
+    cache->addTier(slow.get());
+    osg::ref_ptr<CacheBin> bin = cache->addBin("test_bin");
+
+    // the read is served by the slow tier; a copy would keep the original
+    // time and already be expired in the fast tier, so it is not promoted:
+    ReadResult r = bin->readString("key", 0L);
+    REQUIRE(r.getString() == "value");
+    REQUIRE(r.lastModifiedTime() == hourAgo);
+    REQUIRE(cache->getTierStats()[0].promotions == 0u);
+
+    // so later reads miss the fast tier instead of rewriting it each time:
+    r = bin->readString("key", 0L);
+    REQUIRE(r.succeeded());
+    REQUIRE(r.lastModifiedTime() == hourAgo);
+    REQUIRE(r.metadata().hasChild("tiered_cache_time") == false);
+
+    auto stats = cache->getTierStats();
+    REQUIRE(stats[0].promotions == 0u);
+    REQUIRE(stats[0].expired == 0u);
+    REQUIRE(stats[0].misses == 2u);
+    REQUIRE(stats[0].hits == 0u);
+    REQUIRE(stats[1].hits == 2u);
+
+    SECTION("A record still fresh for the fast tier is promoted")
+    {
+        const TimeStamp recently = DateTime().asTimeStamp() - 10;
+        osg::ref_ptr<AgedCache> recent = new AgedCache(recently);
+        recent->addBin("test_bin")->write("key", new StringObject("value"), 0L);
+
+        osg::ref_ptr<TieredCache> cache2 = new TieredCache();
+        cache2->addTier(new MemCache(8), fastPolicy);
+        cache2->addTier(recent.get());
+        osg::ref_ptr<CacheBin> bin2 = cache2->addBin("test_bin");
+
+        REQUIRE(bin2->readString("key", 0L).succeeded());
+        REQUIRE(bin2->readString("key", 0L).lastModifiedTime() == recently);
+
+        auto stats2 = cache2->getTierStats();
+        REQUIRE(stats2[0].promotions == 1u);
+        REQUIRE(stats2[0].hits == 1u);
+    }
+
+    // a layer with a max_age of a minute still sees an expired record:
+    CachePolicy policy;
+    policy.maxAge() = 60;
+    REQUIRE(policy.isExpired(r.lastModifiedTime()));
+}
+
 TEST_CASE("LRUCache")
 {
     SECTION("LRUCache_BasicEviction")
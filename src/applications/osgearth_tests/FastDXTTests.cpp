@@ -0,0 +1,147 @@
+/* osgEarth
+* Copyright 2025 Pelican Mapping
+* MIT License
+*/
+#include <osgEarth/catch.hpp>
+#include <osg/Image>
+#include <osg/Texture>
+#include <osgDB/Registry>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+
+namespace
+{
+    const char* THREADS_VAR = "OSGEARTH_FASTDXT_THREADS";
+
+    //! The plugin reads this before each image
+    void setFastDXTThreads(unsigned value)
+    {
+        std::string text = value > 0u ? std::to_string(value) : std::string();
+#ifdef _WIN32
+        _putenv_s(THREADS_VAR, text.c_str());
+#else
+        if (value > 0u)
+            setenv(THREADS_VAR, text.c_str(), 1);
+        else
+            unsetenv(THREADS_VAR);
+#endif
+    }
+
+    osgDB::ImageProcessor* getFastDXT()
+    {
+        return osgDB::Registry::instance()->getImageProcessorForExtension("fastdxt");
+    }
+
+    //! Noisy RGBA image with smooth gradients, so blocks use varied endpoints
+    osg::ref_ptr<osg::Image> makeImage(int size)
+    {
+        std::mt19937 rng(7);
+        osg::ref_ptr<osg::Image> image = new osg::Image();
+        image->allocateImage(size, size, 1, GL_RGBA, GL_UNSIGNED_BYTE);
+        image->setInternalTextureFormat(GL_RGBA8);
+        for (int t = 0; t < size; ++t)
+        {
+            unsigned char* row = image->data(0, t);
+            for (int s = 0; s < size; ++s)
+            {
+                row[4 * s + 0] = (unsigned char)((s * 255) / size);
+                row[4 * s + 1] = (unsigned char)((t * 255) / size);
+                row[4 * s + 2] = (unsigned char)(rng() & 0xff);
+                row[4 * s + 3] = (unsigned char)(128 + (rng() & 0x7f));
+            }
+        }
+        return image;
+    }
+
+    osg::ref_ptr<osg::Image> compress(osgDB::ImageProcessor* ip, const osg::Image* input, osg::Texture::InternalFormatMode mode, unsigned numThreads)
+    {
+        setFastDXTThreads(numThreads);
+        osg::ref_ptr<osg::Image> output = new osg::Image(*input, osg::CopyOp::DEEP_COPY_ALL);
+        ip->compress(*output, mode, true, true, ip->USE_CPU, ip->FASTEST);
+        setFastDXTThreads(0u);
+        return output;
+    }
+
+    const osg::Texture::InternalFormatMode MODES[] = {
+        osg::Texture::USE_S3TC_DXT1_COMPRESSION,
+        osg::Texture::USE_S3TC_DXT5_COMPRESSION,
+        osg::Texture::USE_RGTC2_COMPRESSION
+    };
+
+    const char* modeName(osg::Texture::InternalFormatMode mode)
+    {
+        return
+            mode == osg::Texture::USE_S3TC_DXT1_COMPRESSION ? "DXT1" :
+            mode == osg::Texture::USE_S3TC_DXT5_COMPRESSION ? "DXT5" : "BC5";
+    }
+}
+
+TEST_CASE("FastDXT output does not depend on the number of threads")
+{
+    osgDB::ImageProcessor* ip = getFastDXT();
+    if (!ip)
+    {
+        WARN("No fastdxt plugin; skipping");
+        return;
+    }
+
+    // big enough that level 0 is split into bands
+    osg::ref_ptr<osg::Image> image = makeImage(1024);
+
+    for (auto mode : MODES)
+    {
+        INFO(modeName(mode));
+
+        osg::ref_ptr<osg::Image> serial = compress(ip, image.get(), mode, 1u);
+        REQUIRE(serial->isCompressed());
+        REQUIRE(serial->getNumMipmapLevels() > 1u);
+
+        for (unsigned numThreads : { 2u, 3u, 8u })
+        {
+            INFO(numThreads << " threads");
+
+            osg::ref_ptr<osg::Image> parallel = compress(ip, image.get(), mode, numThreads);
+            REQUIRE(parallel->isCompressed());
+            REQUIRE(parallel->getNumMipmapLevels() == serial->getNumMipmapLevels());
+            REQUIRE(parallel->getTotalSizeInBytesIncludingMipmaps() == serial->getTotalSizeInBytesIncludingMipmaps());
+            REQUIRE(::memcmp(parallel->data(), serial->data(), serial->getTotalSizeInBytesIncludingMipmaps()) == 0);
+        }
+    }
+}
+
+TEST_CASE("FastDXT compression speed", "[.benchmark]")
+{
+    osgDB::ImageProcessor* ip = getFastDXT();
+    if (!ip)
+    {
+        WARN("No fastdxt plugin; skipping");
+        return;
+    }
+
+    const int size = 2048;
+    const int runs = 5;
+    osg::ref_ptr<osg::Image> image = makeImage(size);
+    double megapixels = (double)size * (double)size * 1e-6;
+
+    unsigned maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+
+    for (auto mode : MODES)
+    {
+        for (unsigned numThreads : { 1u, maxThreads })
+        {
+            auto t0 = std::chrono::steady_clock::now();
+            for (int i = 0; i < runs; ++i)
+                REQUIRE(compress(ip, image.get(), mode, numThreads)->isCompressed());
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count() / runs;
+
+            std::cout << modeName(mode) << ", " << numThreads << " threads: "
+                << ms / megapixels << " ms/MP (level 0, with mipmaps)" << std::endl;
+        }
+    }
+}
@@ -8,13 +8,121 @@
 #include <osgEarth/Feature>
 #include <osgEarth/Geometry>
 #include <osgEarth/GeometryUtils>
+#include <osgEarth/FeatureBatch>
+#include <osgEarth/ResampleFilter>
+#include <osgEarth/OGRFeatureSource>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <new>
 
 using namespace osgEarth;
 
 using Vec = std::vector<osg::Vec3d>;
 
+// Counts the calling thread's heap allocations while an AllocationCounter is
+// alive. Otherwise operator new behaves exactly like the default one.
+static thread_local std::size_t* t_allocations = nullptr;
+
 namespace
 {
+    struct AllocationCounter
+    {
+        std::size_t count = 0u;
+        AllocationCounter() { t_allocations = &count; }
+        ~AllocationCounter() { t_allocations = nullptr; }
+    };
+}
+
+void* operator new(std::size_t size)
+{
+    if (t_allocations)
+        ++(*t_allocations);
+
+    for (;;)
+    {
+        if (void* ptr = std::malloc(size > 0u ? size : 1u))
+            return ptr;
+
+        std::new_handler handler = std::get_new_handler();
+        if (!handler)
+            throw std::bad_alloc();
+        handler();
+    }
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+namespace
+{
+    // writes "count" square polygons with a few attributes to a GeoPackage
+    void createTestGeoPackage(const std::string& url, unsigned count)
+    {
+        auto* wgs84 = osgEarth::SpatialReference::create("wgs84");
+
+        FeatureSchema schema;
+        schema["name"] = ATTRTYPE_STRING;
+        schema["value"] = ATTRTYPE_DOUBLE;
+        schema["index"] = ATTRTYPE_INT;
+
+        osg::ref_ptr<OGRFeatureSource> output = new OGRFeatureSource();
+        output->setURL(url);
+        output->setOGRDriver("GPKG");
+        output->setLayer("test");
+
+        osg::ref_ptr<FeatureProfile> profile = new FeatureProfile(GeoExtent(wgs84, -180, -90, 180, 90));
+        REQUIRE(output->create(profile.get(), schema, Geometry::TYPE_POLYGON, nullptr).isOK());
+
+        for (unsigned i = 0; i < count; ++i)
+        {
+            double x = -180.0 + (double)(i % 360), y = -80.0 + (double)((i / 360) % 160);
+            osg::ref_ptr<Geometry> poly = new osgEarth::Polygon();
+            poly->push_back(x, y);
+            poly->push_back(x + 0.5, y);
+            poly->push_back(x + 0.5, y + 0.5);
+            poly->push_back(x, y + 0.5);
+
+            osg::ref_ptr<Feature> feature = new Feature(poly.get(), wgs84);
+            feature->set("name", "feature " + std::to_string(i));
+            feature->set("value", (double)i * 0.5);
+            feature->set("index", (long long)i);
+            output->insertFeature(feature.get());
+        }
+
+        output->close();
+    }
+
+    // reads every feature; "readArrowStream" reports which path the cursor took
+    FeatureList readAll(const std::string& url, bool useArrowStream, const std::string& attributes = {}, bool* readArrowStream = nullptr)
+    {
+        osg::ref_ptr<OGRFeatureSource> input = new OGRFeatureSource();
+        input->setURL(url);
+        input->setUseArrowStream(useArrowStream);
+        if (!attributes.empty())
+            input->setAttributes(attributes);
+        REQUIRE(input->open().isOK());
+
+        FeatureList output;
+        auto cursor = input->createFeatureCursor();
+        if (cursor.valid())
+            cursor->fill(output);
+
+        REQUIRE(input->getNumArrowStreamCursors() + input->getNumGetNextFeatureCursors() == 1u);
+        if (readArrowStream)
+            *readArrowStream = input->getNumArrowStreamCursors() > 0u;
+
+        return output;
+    }
+
     template<class A, class B>
     inline bool polygons_equivalent(const A& v1, const B& v2)
     {
@@ -215,3 +323,325 @@ TEST_CASE("Feature handles attributes correctly.")
         REQUIRE(feature->getBool("bool") == false);
     }
 }
+
+TEST_CASE("Feature::copyOnWrite shares data until modified")
+{
+    osg::ref_ptr<Feature> original = new Feature(GeometryUtils::geometryFromWKT("LINESTRING(0 0, 1 1)"), osgEarth::SpatialReference::create("wgs84"));
+    original->set("name", std::string("road"));
+
+    osg::ref_ptr<Feature> copy = original->copyOnWrite();
+    const Feature* const_copy = copy.get();
+
+    SECTION("Copies share the original geometry and attributes") {
+        REQUIRE(const_copy->getGeometry() == static_cast<const Feature*>(original.get())->getGeometry());
+        REQUIRE(copy->getString("name") == "road");
+    }
+
+    SECTION("Modifying attributes does not affect the original") {
+        copy->set("name", std::string("bridge"));
+        REQUIRE(copy->getString("name") == "bridge");
+        REQUIRE(original->getString("name") == "road");
+    }
+
+    SECTION("Modifying geometry does not affect the original") {
+        copy->getGeometry()->push_back(osg::Vec3d(2, 2, 0));
+        REQUIRE(copy->getGeometry()->size() == 3);
+        REQUIRE(static_cast<const Feature*>(original.get())->getGeometry()->size() == 2);
+    }
+
+    SECTION("Expressions see the shared attributes") {
+        original->set("lanes", 4);
+        osg::ref_ptr<Feature> handle = original->copyOnWrite();
+
+        FilterContext cx;
+        REQUIRE(StringExpression("[name]").eval(handle.get(), cx) == "road");
+        REQUIRE(StringExpression("feature.properties.name").eval(handle.get(), cx) == "road");
+        REQUIRE(NumericExpression("[lanes]").eval(handle.get(), cx) == 4.0);
+    }
+}
+
+TEST_CASE("Feature::copyOnWrite allocations", "[.benchmark]")
+{
+    const unsigned count = 10000u;
+    auto* wgs84 = osgEarth::SpatialReference::create("wgs84");
+
+    FeatureList originals;
+    for (unsigned i = 0; i < count; ++i)
+    {
+        osg::ref_ptr<Geometry> line = new LineString();
+        for (unsigned p = 0; p < 50u; ++p)
+            line->push_back(osg::Vec3d(p, i, 0));
+
+        osg::ref_ptr<Feature> f = new Feature(line.get(), wgs84, Style(), i);
+        f->set("name", "feature " + std::to_string(i));
+        f->set("highway", std::string("residential"));
+        f->set("lanes", 2);
+        f->set("width", 7.5);
+        f->set("oneway", false);
+        originals.push_back(f);
+    }
+
+    auto measure = [&](const char* label, const std::function<Feature*(const Feature*)>& copy)
+    {
+        FeatureList copies;
+        copies.reserve(count);
+
+        std::size_t allocs = 0u;
+        auto t0 = std::chrono::steady_clock::now();
+        {
+            AllocationCounter counter;
+            for (auto& f : originals)
+                copies.emplace_back(copy(f.get()));
+            allocs = counter.count;
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+        std::cout << label << ": " << (double)allocs / (double)count << " allocations/feature, "
+            << 1e6 * seconds / (double)count << " us/feature" << std::endl;
+        return allocs;
+    };
+
+    // the deep copy FeatureSource used to make on every cache insert and hit:
+    std::size_t deep = measure("Deep copy", [](const Feature* f) { return new Feature(*f); });
+    std::size_t cow = measure("Copy-on-write", [](const Feature* f) { return f->copyOnWrite(); });
+    measure("Copy-on-write + set", [](const Feature* f) { Feature* c = f->copyOnWrite(); c->set("lanes", 3); return c; });
+
+    // only counted where the test's operator new is also used by osgEarth
+    // (it is not across Windows DLL boundaries)
+    REQUIRE(cow <= deep);
+}
+
+TEST_CASE("FeatureBatch round-trips features")
+{
+    auto* wgs84 = osgEarth::SpatialReference::create("wgs84");
+
+    FeatureList input;
+    input.push_back(new Feature(GeometryUtils::geometryFromWKT("POLYGON((0 0, 10 0, 10 10, 0 10),(2 2, 4 2, 4 4, 2 4))"), wgs84, Style(), 1));
+    input.push_back(new Feature(GeometryUtils::geometryFromWKT("MULTILINESTRING((0 0, 1 1),(2 2, 3 3, 4 4))"), wgs84, Style(), 2));
+    input[0]->set("name", std::string("block"));
+    input[0]->set("height", 12.5);
+    input[1]->set("lanes", 4);
+
+    FeatureBatch batch(input);
+    REQUIRE(batch.size() == 2);
+    REQUIRE(batch.getNumParts() == 4);
+    REQUIRE(batch.coords().size() == 13);
+    REQUIRE(batch.isHole(1));
+
+    FeatureList output;
+    batch.toFeatures(output);
+    REQUIRE(output.size() == 2);
+
+    const Geometry* poly = static_cast<const Feature*>(output[0].get())->getGeometry();
+    REQUIRE(poly->getType() == Geometry::TYPE_POLYGON);
+    REQUIRE(static_cast<const Polygon*>(poly)->getHoles().size() == 1);
+    REQUIRE(output[0]->getFID() == 1);
+    REQUIRE(output[0]->getString("name") == "block");
+    REQUIRE(output[0]->getDouble("height") == 12.5);
+    REQUIRE(output[0]->isSet("lanes") == false);
+
+    const Geometry* lines = static_cast<const Feature*>(output[1].get())->getGeometry();
+    REQUIRE(lines->getType() == Geometry::TYPE_MULTI);
+    REQUIRE(lines->getNumComponents() == 2);
+    REQUIRE(output[1]->getInt("lanes") == 4);
+}
+
+TEST_CASE("ResampleFilter batch path matches the per-feature path")
+{
+    auto* wgs84 = osgEarth::SpatialReference::create("wgs84");
+
+    FeatureList features;
+    features.push_back(new Feature(GeometryUtils::geometryFromWKT("LINESTRING(0 0, 10 0, 10.1 0, 10.2 0, 25 0)"), wgs84));
+    features.push_back(new Feature(GeometryUtils::geometryFromWKT("POLYGON((0 0, 5 0, 5 5, 0 5))"), wgs84));
+
+    FeatureBatch batch(features);
+
+    FilterContext cx;
+    ResampleFilter filter(0.5, 2.0);
+    filter.push(features, cx);
+    filter.pushBatch(batch, cx);
+
+    FeatureList fromBatch;
+    batch.toFeatures(fromBatch);
+    REQUIRE(fromBatch.size() == features.size());
+
+    for (unsigned i = 0; i < features.size(); ++i)
+    {
+        const Feature* a = features[i].get();
+        const Feature* b = fromBatch[i].get();
+        REQUIRE(a->getGeometry()->asVector() == b->getGeometry()->asVector());
+    }
+}
+
+TEST_CASE("ResampleFilter batch throughput", "[.benchmark]")
+{
+    auto* wgs84 = osgEarth::SpatialReference::create("wgs84");
+    const unsigned count = 20000;
+
+    auto makeFeatures = [&]()
+    {
+        FeatureList features;
+        for (unsigned i = 0; i < count; ++i)
+        {
+            osg::ref_ptr<Geometry> line = new LineString();
+            for (int k = 0; k < 16; ++k)
+                line->push_back(osg::Vec3d(k * 1.5, i * 0.01, 0));
+            features.push_back(new Feature(line.get(), wgs84, Style(), i));
+        }
+        return features;
+    };
+
+    ResampleFilter filter(0.5, 2.0);
+    FilterContext cx;
+
+    FeatureList perFeature = makeFeatures();
+    auto t0 = std::chrono::steady_clock::now();
+    filter.push(perFeature, cx);
+    double perFeatureSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    FeatureList batched = makeFeatures();
+    t0 = std::chrono::steady_clock::now();
+    FeatureBatch batch(batched);
+    auto t1 = std::chrono::steady_clock::now();
+    filter.pushBatch(batch, cx);
+    auto t2 = std::chrono::steady_clock::now();
+    FeatureList fromBatch;
+    batch.toFeatures(fromBatch);
+    auto t3 = std::chrono::steady_clock::now();
+
+    REQUIRE(fromBatch.size() == perFeature.size());
+    REQUIRE(fromBatch.back()->getGeometry()->asVector() == perFeature.back()->getGeometry()->asVector());
+
+    auto rate = [&](double seconds) { return (unsigned)((double)count / seconds); };
+    std::cout
+        << "push: " << rate(perFeatureSeconds) << " features/s; "
+        << "pushBatch: " << rate(std::chrono::duration<double>(t2 - t1).count()) << " features/s, "
+        << rate(std::chrono::duration<double>(t3 - t0).count()) << " features/s with conversions" << std::endl;
+}
+
+TEST_CASE("FeatureFilterChain parallel push preserves feature order")
+{
+    auto* wgs84 = osgEarth::SpatialReference::create("wgs84");
+
+    FeatureList sequential, parallel;
+    for (int i = 0; i < 100; ++i)
+    {
+        osg::ref_ptr<Geometry> line = new LineString();
+        line->push_back(osg::Vec3d(0, i, 0));
+        line->push_back(osg::Vec3d(10, i, 0));
+        sequential.push_back(new Feature(line.get(), wgs84, Style(), i));
+        parallel.push_back(new Feature(line->clone(), wgs84, Style(), i));
+    }
+
+    FilterContext cx;
+    auto timings = std::make_shared<FilterTimings>();
+    cx.setTimings(timings);
+
+    ResampleFilter filter(0.5, 2.0);
+    FeatureFilterChain::push(&filter, sequential, cx, false);
+    FeatureFilterChain::push(&filter, parallel, cx, true, 10u);
+
+    REQUIRE(parallel.size() == sequential.size());
+    for (unsigned i = 0; i < sequential.size(); ++i)
+    {
+        REQUIRE(parallel[i]->getFID() == sequential[i]->getFID());
+        REQUIRE(parallel[i]->getGeometry()->asVector() == sequential[i]->getGeometry()->asVector());
+    }
+
+    REQUIRE(timings->size() == 2);
+    REQUIRE(timings->front().chunks == 1u);
+    REQUIRE(timings->back().chunks > 1u);
+    REQUIRE(timings->back().features == 100u);
+    REQUIRE(timings->back().filter == "ResampleFilter");
+
+    SECTION("Fewer features than one chunk still report one chunk")
+    {
+        FeatureList few(parallel.begin(), parallel.begin() + 5);
+        timings->clear();
+        FeatureFilterChain::push(&filter, few, cx, true, 10u);
+        REQUIRE(few.size() == 5u);
+        REQUIRE(timings->size() == 1);
+        REQUIRE(timings->front().chunks == 1u);
+    }
+
+    SECTION("Perturbed points do not depend on chunking")
+    {
+        struct PerturbedResampleFilter : public ResampleFilter
+        {
+            PerturbedResampleFilter() : ResampleFilter(0.5, 2.0) { _perturbThresh = 0.1; }
+        };
+        PerturbedResampleFilter perturbed;
+
+        FeatureList a, b;
+        for (auto& feature : sequential)
+        {
+            a.push_back(new Feature(*feature));
+            b.push_back(new Feature(*feature));
+        }
+
+        FeatureFilterChain::push(&perturbed, a, cx, false);
+        FeatureFilterChain::push(&perturbed, b, cx, true, 10u);
+
+        for (unsigned i = 0; i < a.size(); ++i)
+            REQUIRE(a[i]->getGeometry()->asVector() == b[i]->getGeometry()->asVector());
+    }
+}
+
+TEST_CASE("OGRFeatureSource Arrow stream reads the same features as OGR_L_GetNextFeature")
+{
+    const std::string url = "/vsimem/osgearth_arrow_test.gpkg";
+    createTestGeoPackage(url, 500);
+
+    bool classicReadArrow = true, arrowReadArrow = false;
+    FeatureList classic = readAll(url, false, {}, &classicReadArrow);
+    FeatureList arrow = readAll(url, true, {}, &arrowReadArrow);
+
+    // the option is off by default and never takes the Arrow path
+    REQUIRE_FALSE(classicReadArrow);
+
+    // GDAL 3.6-3.7 and GDAL built without GPKG fast streams fall back
+    if (!arrowReadArrow)
+        WARN("GDAL has no fast Arrow stream for GPKG; only the fallback path was compared");
+
+    REQUIRE(classic.size() == 500);
+    REQUIRE(arrow.size() == classic.size());
+
+    for (unsigned i = 0; i < classic.size(); ++i)
+    {
+        REQUIRE(arrow[i]->getFID() == classic[i]->getFID());
+        REQUIRE(arrow[i]->getGeometry()->asVector() == classic[i]->getGeometry()->asVector());
+        REQUIRE(arrow[i]->getString("name") == classic[i]->getString("name"));
+        REQUIRE(arrow[i]->getDouble("value") == classic[i]->getDouble("value"));
+        REQUIRE(arrow[i]->getInt("index") == classic[i]->getInt("index"));
+    }
+
+    SECTION("Attribute subset")
+    {
+        bool subsetReadArrow = false;
+        FeatureList subset = readAll(url, true, "name", &subsetReadArrow);
+        REQUIRE(subsetReadArrow == arrowReadArrow);
+        REQUIRE(subset.size() == classic.size());
+        REQUIRE(subset.front()->hasAttr("name"));
+        REQUIRE_FALSE(subset.front()->hasAttr("value"));
+        REQUIRE_FALSE(subset.front()->hasAttr("index"));
+    }
+}
+
+TEST_CASE("OGRFeatureSource ingest rate", "[.benchmark]")
+{
+    const std::string url = "/vsimem/osgearth_arrow_benchmark.gpkg";
+    const unsigned count = 200000;
+    createTestGeoPackage(url, count);
+
+    for (bool useArrowStream : { false, true })
+    {
+        auto t0 = std::chrono::steady_clock::now();
+        bool readArrowStream = false;
+        FeatureList features = readAll(url, useArrowStream, {}, &readArrowStream);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+        REQUIRE(features.size() == count);
+        std::cout << (readArrowStream ? "Arrow stream: " : "GetNextFeature: ")
+            << (unsigned)((double)count / seconds) << " features/s" << std::endl;
+    }
+}
@@ -8,6 +8,8 @@
 #include <osgEarth/ImageLayer>
 #include <osgEarth/Registry>
 #include <osgEarth/GDAL>
+#include <thread>
+#include <atomic>
 
 using namespace osgEarth;
 
@@ -50,4 +52,35 @@ TEST_CASE("Attribution works")
 
     REQUIRE(status.isOK());
     REQUIRE(layer->getAttribution() == attribution);
-}
\ No newline at end of file
+}
+
+TEST_CASE("GDAL layers share a bounded pool of datasets")
+{
+    osg::ref_ptr<GDALImageLayer> layer = new GDALImageLayer();
+    layer->setURL("../data/world.tif");
+    layer->setMaxOpenDatasets(2u);
+
+    REQUIRE(layer->open().isOK());
+
+    std::atomic_int valid(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t)
+    {
+        threads.emplace_back([&, t]()
+            {
+                TileKey key(2, t, 1, layer->getProfile());
+                if (layer->createImage(key).valid())
+                    ++valid;
+            });
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    auto stats = layer->getDriverPoolStats();
+    REQUIRE(valid == 8);
+    REQUIRE(stats.capacity == 2u);
+    REQUIRE(stats.open <= 2u);
+    REQUIRE(stats.opens <= 2u);
+    REQUIRE(stats.leases == 8u);
+    REQUIRE(stats.leased == 0u);
+}
@@ -0,0 +1,85 @@
+/* osgEarth
+* Copyright 2025 Pelican Mapping
+* MIT License
+*/
+#include <osgEarth/catch.hpp>
+#include <osgEarth/ImageUtils>
+#include <osg/GLU>
+#include <osg/Image>
+#include <cstring>
+#include <random>
+
+using namespace osgEarth;
+using namespace osgEarth::Util;
+
+namespace
+{
+    osg::Image* makeImage(int s, int t, GLenum pixelFormat, GLenum dataType)
+    {
+        osg::Image* image = new osg::Image();
+        image->allocateImage(s, t, 1, pixelFormat, dataType);
+        image->setInternalTextureFormat(pixelFormat);
+        return image;
+    }
+}
+
+TEST_CASE("ImageUtils::mipmapImage matches gluScaleImage for 8-bit images")
+{
+    std::mt19937 rng(42);
+
+    for (GLenum pixelFormat : { GL_RED, GL_RG, GL_RGB, GL_RGBA })
+    {
+        osg::ref_ptr<osg::Image> image = makeImage(64, 32, pixelFormat, GL_UNSIGNED_BYTE);
+        for (unsigned i = 0; i < image->getTotalSizeInBytes(); ++i)
+            image->data()[i] = (unsigned char)(rng() & 0xff);
+
+        osg::ref_ptr<const osg::Image> mipmapped = ImageUtils::mipmapImage(image.get(), 1);
+        REQUIRE(mipmapped->getNumMipmapLevels() > 1u);
+
+        osg::PixelStorageModes psm;
+        psm.pack_alignment = image->getPacking();
+        psm.unpack_alignment = image->getPacking();
+
+        for (unsigned level = 1; level < mipmapped->getNumMipmapLevels(); ++level)
+        {
+            int s = image->s() >> level, t = image->t() >> level;
+            if (s < 1 || t < 1)
+                break;
+
+            int components = osg::Image::computeNumComponents(pixelFormat);
+            std::vector<unsigned char> expected(s * t * components);
+
+            osg::gluScaleImage(
+                &psm, pixelFormat,
+                s * 2, t * 2, GL_UNSIGNED_BYTE, mipmapped->getMipmapData(level - 1),
+                s, t, GL_UNSIGNED_BYTE, expected.data());
+
+            REQUIRE(::memcmp(expected.data(), mipmapped->getMipmapData(level), expected.size()) == 0);
+        }
+    }
+}
+
+TEST_CASE("ImageUtils::mipmapImage averages float images at full precision")
+{
+    // Values outside [0..1] must survive; multiples of 0.25 keep the averages exact.
+    osg::ref_ptr<osg::Image> image = makeImage(16, 16, GL_RED, GL_FLOAT);
+    float* data = reinterpret_cast<float*>(image->data());
+    for (int i = 0; i < 16 * 16; ++i)
+        data[i] = -100.0f + 0.25f * (float)i;
+
+    osg::ref_ptr<const osg::Image> mipmapped = ImageUtils::mipmapImage(image.get(), 1);
+    REQUIRE(mipmapped->getNumMipmapLevels() > 1u);
+
+    const float* level1 = reinterpret_cast<const float*>(mipmapped->getMipmapData(1));
+    for (int t = 0; t < 8; ++t)
+    {
+        for (int s = 0; s < 8; ++s)
+        {
+            float expected = 0.25f * (
+                data[(2 * t) * 16 + 2 * s] + data[(2 * t) * 16 + 2 * s + 1] +
+                data[(2 * t + 1) * 16 + 2 * s] + data[(2 * t + 1) * 16 + 2 * s + 1]);
+
+            REQUIRE(level1[t * 8 + s] == expected);
+        }
+    }
+}
@@ -0,0 +1,154 @@
+/* osgEarth
+* Copyright 2025 Pelican Mapping
+* MIT License
+*/
+
+#include <osgEarth/catch.hpp>
+#include <osgEarth/Map>
+#include <osgEarth/ImageLayer>
+#include <osgEarth/ImageUtils>
+#include <osgEarthProcedural/LifeMapLayer>
+#include <functional>
+#include <cstring>
+
+using namespace osgEarth;
+using namespace osgEarth::Procedural;
+
+namespace
+{
+    // Image layer that fills every tile with a color function of (u,v).
+    class PatternImageLayer : public ImageLayer
+    {
+    public:
+        META_Layer(osgEarth, PatternImageLayer, Options, ImageLayer, lifemaptestpattern);
+
+        std::function<osg::Vec4(double, double)> pattern;
+
+    protected:
+        Status openImplementation() override
+        {
+            Status parent = super::openImplementation();
+            if (parent.isError())
+                return parent;
+
+            setProfile(Profile::create(Profile::GLOBAL_GEODETIC));
+            return Status::OK();
+        }
+
+        GeoImage createImageImplementation(const TileKey& key, ProgressCallback* progress) const override
+        {
+            osg::ref_ptr<osg::Image> image = new osg::Image();
+            image->allocateImage(256, 256, 1, GL_RGBA, GL_UNSIGNED_BYTE);
+            ImageUtils::PixelWriter write(image.get());
+            for (int t = 0; t < image->t(); ++t)
+                for (int s = 0; s < image->s(); ++s)
+                    write(pattern((s + 0.5) / 256.0, (t + 0.5) / 256.0), s, t);
+            return GeoImage(image.get(), key.getExtent());
+        }
+    };
+
+    const unsigned char* pixel(const GeoImage& image, unsigned s, unsigned t)
+    {
+        return image.getImage()->data(s, t);
+    }
+}
+
+TEST_CASE("LifeMapLayer color and mask weighting matches reference values")
+{
+    osg::ref_ptr<Map> map = new Map();
+
+    // green on the left half, red on the right half
+    osg::ref_ptr<PatternImageLayer> color = new PatternImageLayer();
+    color->pattern = [](double u, double v) {
+        return u < 0.5 ? osg::Vec4(0, 1, 0, 1) : osg::Vec4(1, 0, 0, 1);
+    };
+    map->addLayer(color.get());
+
+    // density mask of one half
+    osg::ref_ptr<PatternImageLayer> mask = new PatternImageLayer();
+    mask->pattern = [](double u, double v) { return osg::Vec4(0.5, 0.5, 0.5, 1); };
+    map->addLayer(mask.get());
+
+    osg::ref_ptr<LifeMapLayer> lifemap = new LifeMapLayer();
+    lifemap->setColorLayer(color.get());
+    lifemap->setMaskLayer(mask.get());
+    lifemap->setColorWeight(1.0f);
+    lifemap->setNoiseWeight(0.0f);
+    lifemap->setTerrainWeight(0.0f);
+    map->addLayer(lifemap.get());
+    REQUIRE(lifemap->isOpen());
+
+    TileKey key(14, 17117, 4120, lifemap->getProfile());
+    GeoImage image = lifemap->createImage(key);
+    REQUIRE(image.valid());
+    REQUIRE(image.getImage()->s() == 256);
+    REQUIRE(image.getImage()->t() == 256);
+
+    // Reference values, from the HSL weighting rules scaled by the mask:
+    //   green: rugged=(1/3)^5, dense=1, lush=0.5
+    //   red:   rugged=1, dense=(1/3)^2, lush=(1/3)^2*0.5
+    const float m = 127.0f / 255.0f;
+    auto expected = [m](float value) { return (int)(value * m * 255.0f); };
+
+    for (unsigned t : { 16u, 128u, 240u })
+    {
+        const unsigned char* green = pixel(image, 64, t);
+        CHECK(std::abs(green[LIFEMAP_RUGGED] - expected(1.0f / 243.0f)) <= 1);
+        CHECK(std::abs(green[LIFEMAP_DENSE] - expected(1.0f)) <= 1);
+        CHECK(std::abs(green[LIFEMAP_LUSH] - expected(0.5f)) <= 1);
+        CHECK(green[3] == 0);
+
+        const unsigned char* red = pixel(image, 192, t);
+        CHECK(std::abs(red[LIFEMAP_RUGGED] - expected(1.0f)) <= 1);
+        CHECK(std::abs(red[LIFEMAP_DENSE] - expected(1.0f / 9.0f)) <= 1);
+        CHECK(std::abs(red[LIFEMAP_LUSH] - expected(0.5f / 9.0f)) <= 1);
+        CHECK(red[3] == 0);
+    }
+}
+
+TEST_CASE("LifeMapLayer parallel rasterization matches serial")
+{
+    osg::ref_ptr<Map> map = new Map();
+
+    osg::ref_ptr<PatternImageLayer> color = new PatternImageLayer();
+    color->pattern = [](double u, double v) {
+        return osg::Vec4(u, v, 0.5 * (u + v), 1);
+    };
+    map->addLayer(color.get());
+
+    osg::ref_ptr<PatternImageLayer> water = new PatternImageLayer();
+    water->pattern = [](double u, double v) {
+        return u * v < 0.25 ? osg::Vec4(1, 1, 1, 1) : osg::Vec4(0, 0, 0, 1);
+    };
+    map->addLayer(water.get());
+
+    // same inputs, one serial and one threaded; noise stays on so both
+    // noise octaves are exercised at this LOD.
+    osg::ref_ptr<LifeMapLayer> layers[2];
+    for (unsigned i = 0; i < 2; ++i)
+    {
+        layers[i] = new LifeMapLayer();
+        layers[i]->setName(i == 0 ? "serial" : "parallel");
+        layers[i]->setColorLayer(color.get());
+        layers[i]->setWaterLayer(water.get());
+        layers[i]->setTerrainWeight(0.0f);
+        layers[i]->options().threads() = (i == 0 ? 1u : 4u);
+        map->addLayer(layers[i].get());
+        REQUIRE(layers[i]->isOpen());
+    }
+
+    for (auto& key : {
+        TileKey(14, 17117, 4120, layers[0]->getProfile()),
+        TileKey(9, 535, 128, layers[0]->getProfile()) })
+    {
+        GeoImage serial = layers[0]->createImage(key);
+        GeoImage parallel = layers[1]->createImage(key);
+        REQUIRE(serial.valid());
+        REQUIRE(parallel.valid());
+
+        const osg::Image* a = serial.getImage();
+        const osg::Image* b = parallel.getImage();
+        REQUIRE(a->getTotalSizeInBytes() == b->getTotalSizeInBytes());
+        CHECK(std::memcmp(a->data(), b->data(), a->getTotalSizeInBytes()) == 0);
+    }
+}
@@ -0,0 +1,114 @@
+/* osgEarth
+* Copyright 2025 Pelican Mapping
+* MIT License
+*/
+#include <osgEarth/catch.hpp>
+#include <osgEarth/Utils>
+#include <vector>
+
+using namespace osgEarth;
+using namespace osgEarth::Util;
+
+namespace
+{
+    // the tracker needs a nullable type for its sentry entry
+    using Tracker = SentryTracker<const int*>;
+    const int VALUES[6] = { 0, 1, 2, 3, 4, 5 };
+
+    // Tracks 1..5, then runs a cycle in which only 2 and 4 are used,
+    // leaving 5, 3, 1 behind the sentry with 1 the oldest.
+    struct Fixture
+    {
+        Tracker tracker;
+        void* tokens[6] = { };
+
+        Fixture()
+        {
+            for (int i = 1; i <= 5; ++i)
+                tokens[i] = tracker.use(&VALUES[i], nullptr);
+
+            // end the first cycle without disposing anything
+            tracker.flush(~0u, [](const int*&) { return false; });
+
+            tracker.use(&VALUES[2], tokens[2]);
+            tracker.use(&VALUES[4], tokens[4]);
+        }
+    };
+}
+
+TEST_CASE("SentryTracker flushOldest visits unused entries oldest first")
+{
+    Fixture f;
+    REQUIRE(f.tracker.size() == 5u);
+
+    std::vector<int> visited;
+    f.tracker.flushOldest(~0u, [&](const int*& value) { visited.push_back(*value); return false; });
+
+    // entries used this cycle are never visited
+    REQUIRE(visited == std::vector<int>({ 1, 3, 5 }));
+    REQUIRE(f.tracker.size() == 5u);
+}
+
+TEST_CASE("SentryTracker flushOldest stops after maxCount disposals")
+{
+    Fixture f;
+
+    std::vector<int> visited;
+    f.tracker.flushOldest(2u, [&](const int*& value) { visited.push_back(*value); return true; });
+
+    REQUIRE(visited == std::vector<int>({ 1, 3 }));
+    REQUIRE(f.tracker.size() == 3u);
+
+    SECTION("A later flush continues with the next oldest")
+    {
+        visited.clear();
+        f.tracker.flushOldest(1u, [&](const int*& value) { visited.push_back(*value); return *value == 5; });
+        REQUIRE(visited == std::vector<int>({ 5 }));
+        REQUIRE(f.tracker.size() == 2u);
+    }
+}
+
+TEST_CASE("SentryTracker flushOldest skips entries the callback keeps")
+{
+    Fixture f;
+
+    std::vector<int> visited;
+    f.tracker.flushOldest(1u, [&](const int*& value) { visited.push_back(*value); return *value == 5; });
+
+    // 1 and 3 are kept and do not count toward the limit
+    REQUIRE(visited == std::vector<int>({ 1, 3, 5 }));
+    REQUIRE(f.tracker.size() == 4u);
+
+    // the sentry stays put, so the survivors are still behind it
+    visited.clear();
+    f.tracker.flushOldest(~0u, [&](const int*& value) { visited.push_back(*value); return false; });
+    REQUIRE(visited == std::vector<int>({ 1, 3 }));
+
+    SECTION("Tokens of the survivors stay valid")
+    {
+        f.tracker.use(&VALUES[3], f.tokens[3]);
+
+        visited.clear();
+        f.tracker.flushOldest(~0u, [&](const int*& value) { visited.push_back(*value); return true; });
+        REQUIRE(visited == std::vector<int>({ 1 }));
+        REQUIRE(f.tracker.size() == 3u);
+    }
+}
+
+TEST_CASE("SentryTracker flushOldest with nothing behind the sentry")
+{
+    Tracker tracker;
+
+    std::vector<int> visited;
+    auto record = [&](const int*& value) { visited.push_back(*value); return true; };
+
+    tracker.flushOldest(~0u, record);
+    REQUIRE(visited.empty());
+
+    // new entries go in front of the sentry, as if used this cycle
+    tracker.use(&VALUES[1], nullptr);
+    tracker.use(&VALUES[2], nullptr);
+    tracker.flushOldest(~0u, record);
+    REQUIRE(visited.empty());
+    REQUIRE(tracker.size() == 2u);
+}
@@ -4,8 +4,18 @@
 */
 
 #include <osgEarth/catch.hpp>
+#include <algorithm>
+#include <cfloat>
 #include <cmath>
+#include <chrono>
+#include <iostream>
+#include <vector>
 #include <osgEarth/SpatialReference>
+#include <osgEarth/AnalyticTransforms>
+#include <osgEarth/VerticalDatum>
+#include <osgEarth/GeoData>
+#include <osg/Shape>
+#include <osgEarth/HeightFieldUtils>
 
 using namespace osgEarth;
 
@@ -17,7 +27,42 @@ namespace
             if (!osg::equivalent(a[i], b[i])) return false;
         return true;
     }
-                
+
+    // Transforms the points with and without the analytic fast path
+    // and returns the largest difference in X or Y.
+    double compareWithPROJ(const SpatialReference* from, const SpatialReference* to, const std::vector<osg::Vec3d>& input)
+    {
+        std::vector<osg::Vec3d> analytic(input), proj(input);
+
+        Util::AnalyticTransforms::setEnabled(true);
+        bool ok1 = from->transform(analytic, to);
+        Util::AnalyticTransforms::setEnabled(false);
+        bool ok2 = from->transform(proj, to);
+        Util::AnalyticTransforms::setEnabled(true);
+
+        if (!ok1 || !ok2)
+            return DBL_MAX;
+
+        double maxError = 0.0;
+        for (unsigned i = 0; i < input.size(); ++i)
+        {
+            maxError = std::max(maxError, std::abs(analytic[i].x() - proj[i].x()));
+            maxError = std::max(maxError, std::abs(analytic[i].y() - proj[i].y()));
+        }
+        return maxError;
+    }
+
+    std::vector<osg::Vec3d> makeGrid(double xmin, double ymin, double xmax, double ymax, unsigned n)
+    {
+        std::vector<osg::Vec3d> points;
+        for (unsigned j = 0; j < n; ++j)
+            for (unsigned i = 0; i < n; ++i)
+                points.emplace_back(
+                    xmin + (xmax - xmin) * (double)i / (double)(n - 1),
+                    ymin + (ymax - ymin) * (double)j / (double)(n - 1),
+                    0.0);
+        return points;
+    }
 }
 
 TEST_CASE("Parsing doubles") {
@@ -159,6 +204,69 @@ TEST_CASE("Vertical Datum Tests") {
     REQUIRE(osg::equivalent(output.z(), 0.0, eps));
 }
 
+TEST_CASE("Batched geoid conversion") {
+    // synthetic 1-degree geoid with a smooth, non-planar surface:
+    osg::ref_ptr<osg::HeightField> hf = new osg::HeightField();
+    hf->allocate(361, 181);
+    hf->setOrigin(osg::Vec3d(-180.0, -90.0, 0.0));
+    hf->setXInterval(1.0);
+    hf->setYInterval(1.0);
+    for (unsigned r = 0; r < hf->getNumRows(); ++r)
+        for (unsigned c = 0; c < hf->getNumColumns(); ++c)
+            hf->setHeight(c, r, 50.0f * sin(0.05 * c) * cos(0.07 * r));
+
+    osg::ref_ptr<Geoid> geoid = new Geoid();
+    geoid->setName("test");
+    geoid->setHeightField(hf.get());
+    REQUIRE(geoid->isValid());
+
+    SECTION("Batch heights match single queries") {
+        std::vector<double> lat, lon;
+        for (int i = 0; i < 1000; ++i) {
+            lon.push_back(-180.0 + 0.3607 * i);
+            lat.push_back(-90.0 + 0.1803 * i);
+        }
+        lon.push_back(200.0); lat.push_back(0.0); // outside
+
+        std::vector<float> heights(lat.size());
+        geoid->getHeights(lat.data(), lon.data(), lat.size(), heights.data());
+        for (unsigned i = 0; i < lat.size(); ++i) {
+            float expected = 0.0f;
+            if (lon[i] <= 180.0) {
+                expected = Util::HeightFieldUtils::getHeightAtNormalizedLocation(
+                    hf.get(), (lon[i] + 180.0) / 360.0, (lat[i] + 90.0) / 180.0, INTERP_BILINEAR);
+            }
+            REQUIRE(std::abs(heights[i] - expected) < 1e-4f);
+        }
+    }
+
+    SECTION("Tile offset grid matches per-sample conversion") {
+        osg::ref_ptr<VerticalDatum> vdatum = new VerticalDatum("test", "test", geoid.get());
+        GeoExtent extent(SpatialReference::get("wgs84"), 10.0, 20.0, 12.5, 21.25);
+
+        osg::ref_ptr<osg::HeightField> tile = new osg::HeightField();
+        tile->allocate(17, 9);
+        for (unsigned i = 0; i < tile->getHeightList().size(); ++i)
+            tile->getHeightList()[i] = (float)i;
+        tile->setHeight(3, 3, NO_DATA_VALUE);
+
+        osg::ref_ptr<osg::HeightField> expected = new osg::HeightField(*tile, osg::CopyOp::DEEP_COPY_ALL);
+        double xstep = extent.width() / 16.0, ystep = extent.height() / 8.0;
+        for (unsigned r = 0; r < 9; ++r) {
+            for (unsigned c = 0; c < 17; ++c) {
+                float h = expected->getHeight(c, r);
+                if (h != NO_DATA_VALUE)
+                    expected->setHeight(c, r, vdatum->msl2hae(extent.south() + ystep * r, extent.west() + xstep * c, h));
+            }
+        }
+
+        REQUIRE(VerticalDatum::transform(vdatum.get(), nullptr, extent, tile.get()));
+        for (unsigned i = 0; i < tile->getHeightList().size(); ++i)
+            REQUIRE(std::abs(tile->getHeightList()[i] - expected->getHeightList()[i]) < 1e-3f);
+        REQUIRE(tile->getHeight(3, 3) == NO_DATA_VALUE);
+    }
+}
+
 TEST_CASE("getGeographicsSRS") {
     const SpatialReference* mercator = SpatialReference::get("spherical-mercator", "egm96");
     const SpatialReference* geo = mercator->getGeographicSRS();
@@ -208,3 +316,139 @@ TEST_CASE("MFE SRS") {
     REQUIRE(p_wgs84.x() == -157.0);
     REQUIRE(p_wgs84.y() == 21.0);
 }
+
+TEST_CASE("Analytic transforms match PROJ") {
+    const SpatialReference* wgs84 = SpatialReference::get("wgs84");
+    const SpatialReference* sm = SpatialReference::get("spherical-mercator");
+    const SpatialReference* utm32n = SpatialReference::get("+proj=utm +zone=32 +datum=WGS84 +units=m +no_defs");
+    const SpatialReference* utm19s = SpatialReference::get("+proj=utm +zone=19 +south +datum=WGS84 +units=m +no_defs");
+
+    SECTION("Built-in transforms are detected") {
+        REQUIRE(Util::AnalyticTransforms::get(wgs84, sm) != nullptr);
+        REQUIRE(Util::AnalyticTransforms::get(sm, wgs84) != nullptr);
+        REQUIRE(Util::AnalyticTransforms::get(wgs84, utm32n) != nullptr);
+        REQUIRE(Util::AnalyticTransforms::get(utm19s, wgs84) != nullptr);
+        REQUIRE(Util::AnalyticTransforms::get(wgs84, SpatialReference::get("plate-carree")) == nullptr);
+    }
+
+    SECTION("WGS84 <-> Spherical Mercator") {
+        auto geo = makeGrid(-180.0, -85.0, 180.0, 85.0, 64);
+        REQUIRE(compareWithPROJ(wgs84, sm, geo) < 1e-4);
+
+        auto merc = makeGrid(-20037508.34, -20037508.34, 20037508.34, 20037508.34, 64);
+        REQUIRE(compareWithPROJ(sm, wgs84, merc) < 1e-9);
+    }
+
+    SECTION("WGS84 <-> UTM") {
+        auto geo = makeGrid(3.0, -80.0, 15.0, 84.0, 64);
+        REQUIRE(compareWithPROJ(wgs84, utm32n, geo) < 1e-4);
+
+        auto utm = makeGrid(200000.0, 1000000.0, 800000.0, 9000000.0, 64);
+        REQUIRE(compareWithPROJ(utm19s, wgs84, utm) < 1e-9);
+    }
+}
+
+TEST_CASE("Analytic transform throughput", "[.benchmark]") {
+    const SpatialReference* wgs84 = SpatialReference::get("wgs84");
+    const SpatialReference* sm = SpatialReference::get("spherical-mercator");
+    const SpatialReference* utm = SpatialReference::get("+proj=utm +zone=32 +datum=WGS84 +units=m +no_defs");
+    auto input = makeGrid(5.0, 30.0, 13.0, 60.0, 1000);
+
+    for (auto to : { sm, utm })
+    {
+        for (bool analytic : { false, true })
+        {
+            Util::AnalyticTransforms::setEnabled(analytic);
+            std::vector<osg::Vec3d> points(input);
+            auto t0 = std::chrono::steady_clock::now();
+            REQUIRE(wgs84->transform(points, to));
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            std::cout << to->getName() << (analytic ? " (analytic): " : " (PROJ): ")
+                << seconds * 1e6 / (double)input.size() << " s per million points" << std::endl;
+        }
+    }
+    Util::AnalyticTransforms::setEnabled(true);
+}
+
+TEST_CASE("SRS interned IDs and Transformer") {
+    const SpatialReference* wgs84 = SpatialReference::get("wgs84");
+    const SpatialReference* sm = SpatialReference::get("spherical-mercator");
+    const SpatialReference* utm = SpatialReference::get("+proj=utm +zone=32 +datum=WGS84 +units=m +no_defs");
+
+    SECTION("Interned IDs") {
+        REQUIRE(wgs84->getInternedID() != 0u);
+        REQUIRE(wgs84->getInternedID() == SpatialReference::get("wgs84")->getInternedID());
+        REQUIRE(wgs84->getInternedID() != sm->getInternedID());
+        REQUIRE(sm->getInternedID() != utm->getInternedID());
+    }
+
+    SECTION("Transformer matches SpatialReference::transform") {
+        SpatialReference::Transformer toUTM(wgs84, utm);
+        SpatialReference::Transformer toGeo(utm, wgs84);
+        REQUIRE(toUTM.valid());
+
+        osg::Vec3d input(9.5, 45.0, 100.0), expected, actual, back;
+        REQUIRE(wgs84->transform(input, utm, expected));
+        REQUIRE(toUTM.transform(input, actual));
+        REQUIRE(vec_eq(actual, expected));
+
+        REQUIRE(toGeo.transform(actual, back));
+        REQUIRE(std::abs(back.x() - input.x()) < 1e-9);
+        REQUIRE(std::abs(back.y() - input.y()) < 1e-9);
+
+        std::vector<osg::Vec3d> points = makeGrid(5.0, 40.0, 13.0, 50.0, 4);
+        std::vector<osg::Vec3d> copy(points);
+        REQUIRE(toUTM.transform(points));
+        REQUIRE(wgs84->transform(copy, utm));
+        for (unsigned i = 0; i < points.size(); ++i)
+            REQUIRE(vec_eq(points[i], copy[i]));
+    }
+
+    SECTION("Transformer handles geocentric output") {
+        SpatialReference::Transformer toECEF(wgs84, wgs84->getGeocentricSRS());
+        osg::Vec3d ecef;
+        REQUIRE(toECEF.transform(osg::Vec3d(0, 90, 0), ecef));
+        REQUIRE(vec_eq(ecef, osg::Vec3d(0, 0, wgs84->getEllipsoid().getRadiusPolar())));
+    }
+
+    SECTION("Equivalent SRS is a no-op") {
+        SpatialReference::Transformer same(sm, SpatialReference::get("epsg:3857"));
+        osg::Vec3d p(1000, 2000, 3), out;
+        REQUIRE(same.transform(p, out));
+        REQUIRE(out == p);
+    }
+}
+
+TEST_CASE("Short transform call overhead", "[.benchmark]") {
+    const SpatialReference* wgs84 = SpatialReference::get("wgs84");
+    const SpatialReference* utm = SpatialReference::get("+proj=utm +zone=32 +datum=WGS84 +units=m +no_defs");
+    const unsigned iterations = 200000;
+
+    for (unsigned batch : { 1u, 16u })
+    {
+        auto input = makeGrid(5.0, 40.0, 13.0, 50.0, batch == 1u ? 2u : 4u);
+        input.resize(batch);
+
+        std::vector<osg::Vec3d> points;
+        auto t0 = std::chrono::steady_clock::now();
+        for (unsigned i = 0; i < iterations; ++i)
+        {
+            points = input;
+            wgs84->transform(points, utm);
+        }
+        double srsSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+        SpatialReference::Transformer xform(wgs84, utm);
+        t0 = std::chrono::steady_clock::now();
+        for (unsigned i = 0; i < iterations; ++i)
+        {
+            points = input;
+            xform.transform(points);
+        }
+        double xformSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+        std::cout << batch << "-point calls: SpatialReference::transform "
+            << srsSeconds * 1e9 / (double)iterations << " ns, Transformer "
+            << xformSeconds * 1e9 / (double)iterations << " ns" << std::endl;
+    }
+}
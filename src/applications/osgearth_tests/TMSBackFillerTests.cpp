@@ -0,0 +1,147 @@
+/* osgEarth
+* Copyright 2025 Pelican Mapping
+* MIT License
+*/
+#include <osgEarth/catch.hpp>
+#include <osgEarth/TMSBackFiller>
+#include <osg/Image>
+#include <functional>
+
+using namespace osgEarth;
+using namespace osgEarth::Contrib;
+
+namespace
+{
+    template<typename T>
+    osg::ref_ptr<osg::Image> makeTile(int s, int t, GLenum dataType, std::function<T(int, int)> value)
+    {
+        osg::ref_ptr<osg::Image> image = new osg::Image();
+        image->allocateImage(s, t, 1, GL_RED, dataType);
+        image->setInternalTextureFormat(GL_RED);
+        for (int row = 0; row < t; ++row)
+            for (int col = 0; col < s; ++col)
+                *reinterpret_cast<T*>(image->data(col, row)) = value(col, row);
+        return image;
+    }
+
+    template<typename T>
+    T at(const osg::Image* image, int col, int row)
+    {
+        return *reinterpret_cast<const T*>(image->data(col, row));
+    }
+}
+
+TEST_CASE("TMSBackFiller places each child in its quadrant")
+{
+    osg::ref_ptr<osg::Image> children[4];
+    for (unsigned i = 0; i < 4; ++i)
+        children[i] = makeTile<GLubyte>(8, 8, GL_UNSIGNED_BYTE, [i](int, int) { return (GLubyte)(10 * (i + 1)); });
+
+    for (auto filter : { TMSBackFiller::FILTER_BOX, TMSBackFiller::FILTER_BILINEAR, TMSBackFiller::FILTER_MODE })
+    {
+        osg::ref_ptr<osg::Image> parent = TMSBackFiller::downsample(children, filter);
+        REQUIRE(parent.valid());
+        REQUIRE(parent->s() == 8);
+        REQUIRE(parent->t() == 8);
+
+        // children are UL, UR, LL, LR and rows run south to north
+        REQUIRE(at<GLubyte>(parent.get(), 1, 6) == 10);
+        REQUIRE(at<GLubyte>(parent.get(), 6, 6) == 20);
+        REQUIRE(at<GLubyte>(parent.get(), 1, 1) == 30);
+        REQUIRE(at<GLubyte>(parent.get(), 6, 1) == 40);
+    }
+}
+
+TEST_CASE("TMSBackFiller box filter")
+{
+    osg::ref_ptr<osg::Image> children[4];
+    for (unsigned i = 0; i < 4; ++i)
+        children[i] = makeTile<GLubyte>(8, 8, GL_UNSIGNED_BYTE, [](int col, int) { return (GLubyte)(col * 10); });
+
+    osg::ref_ptr<osg::Image> parent = TMSBackFiller::downsample(children, TMSBackFiller::FILTER_BOX);
+    REQUIRE(parent.valid());
+
+    // each output pixel is the average of a 2x2 block: (20i + 20i + 10) / 2
+    for (int i = 0; i < 4; ++i)
+        REQUIRE(at<GLubyte>(parent.get(), i, 0) == 20 * i + 5);
+
+    SECTION("16-bit signed values round away from zero")
+    {
+        for (unsigned i = 0; i < 4; ++i)
+            children[i] = makeTile<GLshort>(2, 2, GL_SHORT, [](int col, int row) { return (GLshort)(col == 0 && row == 0 ? -1 : -2); });
+
+        parent = TMSBackFiller::downsample(children, TMSBackFiller::FILTER_BOX);
+        REQUIRE(parent.valid());
+        REQUIRE(at<GLshort>(parent.get(), 0, 0) == -2); // -7/4
+    }
+
+    SECTION("Float values are not rounded")
+    {
+        for (unsigned i = 0; i < 4; ++i)
+            children[i] = makeTile<GLfloat>(2, 2, GL_FLOAT, [](int col, int row) { return (GLfloat)(col + 2 * row); });
+
+        parent = TMSBackFiller::downsample(children, TMSBackFiller::FILTER_BOX);
+        REQUIRE(parent.valid());
+        REQUIRE(at<GLfloat>(parent.get(), 0, 0) == Approx(1.5f));
+    }
+}
+
+TEST_CASE("TMSBackFiller bilinear filter")
+{
+    osg::ref_ptr<osg::Image> children[4];
+    for (unsigned i = 0; i < 4; ++i)
+        children[i] = makeTile<GLubyte>(8, 8, GL_UNSIGNED_BYTE, [](int col, int) { return (GLubyte)(col * 10); });
+
+    osg::ref_ptr<osg::Image> parent = TMSBackFiller::downsample(children, TMSBackFiller::FILTER_BILINEAR);
+    REQUIRE(parent.valid());
+
+    // a linear ramp stays linear inside the tile: 1-3-3-1 weights centered on 2i+0.5
+    for (int i = 1; i < 3; ++i)
+        REQUIRE(at<GLubyte>(parent.get(), i, 2) == 20 * i + 5);
+
+    // edge pixels repeat the border: (0 + 3*0 + 3*10 + 20) / 8 = 6.25
+    REQUIRE(at<GLubyte>(parent.get(), 0, 2) == 6);
+}
+
+TEST_CASE("TMSBackFiller mode filter")
+{
+    // each 2x2 block holds 7, 7, 3, 9 except the first, which holds 1, 2, 3, 4
+    auto value = [](int col, int row) -> GLubyte
+    {
+        int k = (col & 1) + 2 * (row & 1);
+        if (col < 2 && row < 2)
+            return (GLubyte)(k + 1);
+        const GLubyte block[4] = { 3, 7, 9, 7 };
+        return block[k];
+    };
+
+    osg::ref_ptr<osg::Image> children[4];
+    for (unsigned i = 0; i < 4; ++i)
+        children[i] = makeTile<GLubyte>(4, 4, GL_UNSIGNED_BYTE, value);
+
+    osg::ref_ptr<osg::Image> parent = TMSBackFiller::downsample(children, TMSBackFiller::FILTER_MODE);
+    REQUIRE(parent.valid());
+
+    // the most common value wins and is never blended
+    REQUIRE(at<GLubyte>(parent.get(), 1, 0) == 7);
+    REQUIRE(at<GLubyte>(parent.get(), 1, 1) == 7);
+
+    // with no repeated value the first one is kept
+    REQUIRE(at<GLubyte>(parent.get(), 0, 0) == 1);
+}
+
+TEST_CASE("TMSBackFiller rejects mismatched children")
+{
+    osg::ref_ptr<osg::Image> children[4];
+    for (unsigned i = 0; i < 4; ++i)
+        children[i] = makeTile<GLubyte>(8, 8, GL_UNSIGNED_BYTE, [](int, int) { return (GLubyte)0; });
+
+    children[3] = makeTile<GLubyte>(4, 4, GL_UNSIGNED_BYTE, [](int, int) { return (GLubyte)0; });
+    REQUIRE(TMSBackFiller::downsample(children, TMSBackFiller::FILTER_BOX).valid() == false);
+
+    children[3] = makeTile<GLfloat>(8, 8, GL_FLOAT, [](int, int) { return 0.0f; });
+    REQUIRE(TMSBackFiller::downsample(children, TMSBackFiller::FILTER_BOX).valid() == false);
+
+    children[3] = nullptr;
+    REQUIRE(TMSBackFiller::downsample(children, TMSBackFiller::FILTER_BOX).valid() == false);
+}
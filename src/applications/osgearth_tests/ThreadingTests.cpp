@@ -5,7 +5,13 @@
 
 #include <osgEarth/catch.hpp>
 #include <osgEarth/Threading>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <string>
 #include <thread>
+#include <vector>
 
 using namespace osgEarth;
 
@@ -116,4 +122,341 @@ TEST_CASE( "ReadWriteMutex can handle multiple read locks from the same thread w
     REQUIRE(!thread2.isRunning());
     REQUIRE(elapsedTime < maxTimeSeconds);
 }
-#endif
\ No newline at end of file
+#endif
+
+namespace GateTest
+{
+    //! The previous Gate design (one mutex, linear key scan, notify_all),
+    //! kept for comparison in the contention benchmark.
+    template<typename T>
+    class SingleMutexGate
+    {
+    public:
+        void lock(const T& key)
+        {
+            std::unique_lock<std::mutex> lock(_m);
+            for (;;) {
+                bool blocked = false;
+                for (auto& k : _keys)
+                    if (k.first == key && k.second != std::this_thread::get_id())
+                        blocked = true;
+                if (!blocked) {
+                    _keys.emplace_back(key, std::this_thread::get_id());
+                    return;
+                }
+                _block.wait(lock);
+            }
+        }
+
+        void unlock(const T& key)
+        {
+            std::unique_lock<std::mutex> lock(_m);
+            for (unsigned i = 0; i < _keys.size(); ++i) {
+                if (_keys[i].first == key) {
+                    std::swap(_keys[i], _keys.back());
+                    _keys.resize(_keys.size() - 1);
+                    break;
+                }
+            }
+            _block.notify_all();
+        }
+
+    private:
+        std::mutex _m;
+        std::condition_variable _block;
+        std::vector<std::pair<T, std::thread::id>> _keys;
+    };
+
+    //! Runs "threads" threads that each lock and unlock "ops" random keys,
+    //! yielding while holding a key if "hold" is set (to stand in for the
+    //! work done under the gate); returns the number of exclusion violations.
+    template<typename GATE>
+    int hammer(GATE& gate, const std::vector<std::string>& keys, unsigned threads, unsigned ops, bool hold, double& seconds)
+    {
+        std::vector<std::atomic_int> inside(keys.size());
+        for (auto& i : inside)
+            i = 0;
+        std::atomic_int violations(0);
+
+        auto t0 = std::chrono::steady_clock::now();
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([&, t]()
+                {
+                    std::uint32_t r = 2654435761u * (t + 1u);
+                    for (unsigned i = 0; i < ops; ++i)
+                    {
+                        r = r * 1664525u + 1013904223u;
+                        unsigned k = (r >> 8) % (unsigned)keys.size();
+                        gate.lock(keys[k]);
+                        if (++inside[k] != 1)
+                            ++violations;
+                        if (hold)
+                            std::this_thread::yield();
+                        --inside[k];
+                        gate.unlock(keys[k]);
+                    }
+                });
+        }
+        for (auto& worker : workers)
+            worker.join();
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        return violations;
+    }
+
+    std::vector<std::string> makeKeys(unsigned count)
+    {
+        std::vector<std::string> keys(count);
+        for (unsigned i = 0; i < count; ++i)
+            keys[i] = "http://server/tiles/" + std::to_string(i) + ".png";
+        return keys;
+    }
+}
+
+TEST_CASE("Gate excludes threads per key")
+{
+    Threading::Gate<std::string> gate;
+    auto keys = GateTest::makeKeys(16u);
+    double seconds;
+    REQUIRE(GateTest::hammer(gate, keys, 16u, 5000u, true, seconds) == 0);
+}
+
+TEST_CASE("Gate allows recursive locking by the holding thread")
+{
+    Threading::Gate<std::string> gate;
+    gate.lock("a");
+    gate.lock("a");
+    gate.unlock("a");
+
+    // still held after one unlock
+    std::atomic_bool acquired(false);
+    std::thread other([&]()
+        {
+            Threading::ScopedGate<std::string> lock(gate, "a");
+            acquired = true;
+        });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    REQUIRE(acquired == false);
+
+    gate.unlock("a");
+    other.join();
+    REQUIRE(acquired == true);
+}
+
+TEST_CASE("Gate does not block other keys")
+{
+    Threading::Gate<int> gate;
+    gate.lock(1);
+
+    std::atomic_bool acquired(false);
+    std::thread other([&]()
+        {
+            Threading::ScopedGate<int> lock(gate, 2);
+            acquired = true;
+        });
+    other.join();
+
+    REQUIRE(acquired == true);
+    gate.unlock(1);
+}
+
+TEST_CASE("Gate contention", "[.benchmark]")
+{
+    const unsigned ops = 5000u;
+
+    for (unsigned numKeys : { 10u, 1000u, 100000u })
+    {
+        auto keys = GateTest::makeKeys(numKeys);
+
+        for (unsigned threads : { 1u, 4u, 16u, 64u })
+        {
+            double legacySeconds, stripedSeconds;
+
+            GateTest::SingleMutexGate<std::string> legacy;
+            REQUIRE(GateTest::hammer(legacy, keys, threads, ops, true, legacySeconds) == 0);
+
+            Threading::Gate<std::string> striped;
+            REQUIRE(GateTest::hammer(striped, keys, threads, ops, true, stripedSeconds) == 0);
+
+            double total = (double)threads * (double)ops;
+            std::cout << numKeys << " keys, " << threads << " threads: "
+                << "single mutex " << (unsigned)(total / legacySeconds) << " locks/s, "
+                << "striped " << (unsigned)(total / stripedSeconds) << " locks/s" << std::endl;
+        }
+    }
+}
+
+TEST_CASE("Job pool latency histograms")
+{
+    auto pool = jobs::get_pool("oe.test.latency", 2u);
+    pool->metrics()->reset_latency();
+
+    auto group = jobs::jobgroup::create();
+    for (unsigned i = 0; i < 20u; ++i)
+    {
+        jobs::context context;
+        context.pool = pool;
+        context.group = group;
+        context.name = (i % 2) ? "slow" : "fast";
+
+        if (i % 2)
+            jobs::dispatch([]() { std::this_thread::sleep_for(std::chrono::milliseconds(2)); }, context);
+        else
+            jobs::dispatch([]() {}, context);
+    }
+    group->join();
+
+    auto latency = pool->metrics()->latency_snapshot();
+    REQUIRE(latency.run_time.count == 20u);
+    REQUIRE(latency.queue_wait.count == 20u);
+    REQUIRE(latency.run_time.max_us >= 2000u);
+
+    auto byName = pool->metrics()->latency_by_name();
+    REQUIRE(byName.size() == 2u);
+    REQUIRE(byName["slow"].run_time.count == 10u);
+    REQUIRE(byName["fast"].run_time.count == 10u);
+    REQUIRE(byName["slow"].run_time.percentile_us(0.5) >= 2000.0);
+    REQUIRE(byName["slow"].run_time.mean_us() > byName["fast"].run_time.mean_us());
+
+    jobs::get_metrics()->reset_latency();
+    REQUIRE(pool->metrics()->latency_snapshot().run_time.count == 0u);
+    REQUIRE(pool->metrics()->latency_by_name()["slow"].run_time.count == 0u);
+}
+
+TEST_CASE("Job pool latency histograms skip canceled jobs")
+{
+    auto pool = jobs::get_pool("oe.test.latency.cancel", 1u);
+    pool->metrics()->reset_latency();
+
+    // hold the only thread so the next jobs are still queued when canceled
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+
+    auto group = jobs::jobgroup::create();
+    jobs::context context;
+    context.pool = pool;
+    context.group = group;
+    context.name = "blocker";
+    jobs::dispatch([released]() { released.wait(); }, context);
+
+    context.name = "abandoned";
+    for (unsigned i = 0; i < 5u; ++i)
+    {
+        // the future goes out of scope right away, which cancels the job
+        auto result = jobs::dispatch([](Cancelable&) { return 1; }, context);
+    }
+
+    release.set_value();
+    group->join();
+
+    auto latency = pool->metrics()->latency_snapshot();
+    REQUIRE(latency.queue_wait.count == 6u);
+    REQUIRE(latency.run_time.count == 1u);
+
+    auto byName = pool->metrics()->latency_by_name();
+    REQUIRE(byName["abandoned"].queue_wait.count == 5u);
+    REQUIRE(byName["abandoned"].run_time.count == 0u);
+}
+
+namespace ForkJoinTest
+{
+    //! Generates a quadtree of tiles, one job per tile; each job
+    //! dispatches its four children before returning.
+    struct Quadtree
+    {
+        jobs::jobpool* pool = nullptr;
+        std::shared_ptr<jobs::jobgroup> group = jobs::jobgroup::create();
+        unsigned maxLevel = 0u;
+        std::atomic<unsigned> tiles = { 0u };
+
+        void createTile(unsigned level, std::uint32_t seed)
+        {
+            // stand-in for generating a small heightfield
+            float heights[32 * 32];
+            std::uint32_t h = seed * 2654435761u + 1u;
+            float sum = 0.0f;
+            for (unsigned i = 0; i < 32u * 32u; ++i)
+            {
+                h ^= h << 13; h ^= h >> 17; h ^= h << 5;
+                heights[i] = (float)(h & 0xffff) * (1.0f / 65536.0f);
+                sum += heights[i];
+            }
+            if (sum >= 0.0f)
+                ++tiles;
+
+            if (level < maxLevel)
+            {
+                for (std::uint32_t q = 0; q < 4u; ++q)
+                {
+                    jobs::context context;
+                    context.name = "tile";
+                    context.pool = pool;
+                    context.group = group;
+                    jobs::dispatch([this, level, seed, q]() { createTile(level + 1, seed * 4u + q); }, context);
+                }
+            }
+        }
+
+        //! Returns tiles per second
+        double run()
+        {
+            auto t0 = std::chrono::steady_clock::now();
+            jobs::context context;
+            context.name = "tile";
+            context.pool = pool;
+            context.group = group;
+            jobs::dispatch([this]() { createTile(0u, 1u); }, context);
+            group->join();
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            return (double)tiles / seconds;
+        }
+    };
+
+    unsigned numTiles(unsigned maxLevel)
+    {
+        unsigned count = 0u;
+        for (unsigned level = 0, n = 1; level <= maxLevel; ++level, n *= 4u)
+            count += n;
+        return count;
+    }
+}
+
+TEST_CASE("Job pool local queues run fork/join work")
+{
+    auto pool = jobs::get_pool("oe.test.forkjoin", 4u);
+    pool->set_local_queues(true);
+
+    ForkJoinTest::Quadtree tree;
+    tree.pool = pool;
+    tree.maxLevel = 5u;
+    tree.run();
+
+    REQUIRE(tree.tiles == ForkJoinTest::numTiles(5u));
+    REQUIRE(pool->metrics()->pending == 0u);
+}
+
+TEST_CASE("Job pool local queues vs shared queue", "[.benchmark]")
+{
+    const unsigned maxLevel = 8u; // 87381 tiles
+
+    for (unsigned threads : { 1u, 2u, 4u, 8u, 16u })
+    {
+        double rate[2];
+        for (int local = 0; local < 2; ++local)
+        {
+            auto pool = jobs::get_pool("oe.test.forkjoin." + std::to_string(threads) + (local ? ".local" : ".shared"), threads);
+            pool->set_local_queues(local == 1);
+
+            ForkJoinTest::Quadtree tree;
+            tree.pool = pool;
+            tree.maxLevel = maxLevel;
+            rate[local] = tree.run();
+            REQUIRE(tree.tiles == ForkJoinTest::numTiles(maxLevel));
+        }
+
+        std::cout << threads << " threads: shared queue " << (unsigned)rate[0]
+            << " tiles/s, local queues " << (unsigned)rate[1] << " tiles/s" << std::endl;
+    }
+}
@@ -0,0 +1,92 @@
+/* osgEarth
+* Copyright 2025 Pelican Mapping
+* MIT License
+*/
+
+#include <osgEarth/catch.hpp>
+#include <osgEarth/TraceProfiler>
+#include <osgEarth/FileUtils>
+#include <osgEarth/JsonUtils>
+#include <osgDB/FileNameUtils>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace osgEarth;
+using namespace osgEarth::Util;
+
+TEST_CASE("TraceProfiler writes a Chrome trace")
+{
+    TraceProfiler::setEventsPerThread(1024u);
+
+    {
+        TraceProfiler::Zone zone("before start");
+        REQUIRE(zone.active() == false);
+    }
+
+    TraceProfiler::start();
+    REQUIRE(TraceProfiler::recording());
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < 4u; ++t)
+    {
+        threads.emplace_back([t]()
+            {
+                TraceProfiler::setThreadName(("trace test " + std::to_string(t)).c_str());
+                for (unsigned i = 0; i < 1000u; ++i)
+                {
+                    TraceProfiler::Zone outer("outer");
+                    TraceProfiler::Zone inner("inner");
+                    inner.text(std::to_string(i));
+                    TraceProfiler::plot("value", (double)i);
+                }
+            });
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    TraceProfiler::stop();
+    REQUIRE(TraceProfiler::recording() == false);
+
+    std::string filename = osgDB::concatPaths(getTempPath(), "osgearth_trace_test.json");
+    REQUIRE(TraceProfiler::write(filename));
+
+    std::ifstream in(filename.c_str());
+    Json::Value doc;
+    Json::Reader reader;
+    REQUIRE(reader.parse(in, doc));
+
+    const Json::Value& events = doc["traceEvents"];
+    REQUIRE(events.isArray());
+
+    // The ring buffers overflowed, so only the newest zones survive,
+    // but every surviving zone must be closed and named.
+    unsigned begins = 0u, ends = 0u, counters = 0u, withText = 0u;
+    for (unsigned i = 0; i < events.size(); ++i)
+    {
+        const Json::Value& e = events[i];
+        std::string ph = e["ph"].asString();
+        if (ph == "B")
+        {
+            ++begins;
+            REQUIRE((e["name"].asString() == "outer" || e["name"].asString() == "inner"));
+        }
+        else if (ph == "E")
+        {
+            ++ends;
+            if (e.isMember("args"))
+                ++withText;
+        }
+        else if (ph == "C")
+        {
+            ++counters;
+        }
+    }
+
+    REQUIRE(begins > 0u);
+    REQUIRE(begins <= 4u * 1024u);
+    REQUIRE(ends == begins);
+    REQUIRE(counters > 0u);
+    REQUIRE(withText > 0u);
+}
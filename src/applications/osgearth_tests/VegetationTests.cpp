@@ -0,0 +1,195 @@
+/* osgEarth
+* Copyright 2025 Pelican Mapping
+* MIT License
+*/
+
+#include <osgEarth/catch.hpp>
+#include <osgEarth/Map>
+#include <osgEarth/ImageLayer>
+#include <osgEarth/ImageUtils>
+#include <osgEarth/CoverageLayer>
+#include <osgEarthProcedural/LifeMapLayer>
+#include <osgEarthProcedural/BiomeLayer>
+#include <osgEarthProcedural/VegetationLayer>
+#include <osgEarthProcedural/VegetationFeatureGenerator>
+
+using namespace osgEarth;
+using namespace osgEarth::Procedural;
+
+namespace
+{
+    // Image layer that fills every tile with a single color.
+    class SolidImageLayer : public ImageLayer
+    {
+    public:
+        META_Layer(osgEarth, SolidImageLayer, Options, ImageLayer, vegetationtestsolid);
+
+        osg::Vec4 color;
+
+    protected:
+        Status openImplementation() override
+        {
+            Status parent = super::openImplementation();
+            if (parent.isError())
+                return parent;
+
+            setProfile(Profile::create(Profile::GLOBAL_GEODETIC));
+            return Status::OK();
+        }
+
+        GeoImage createImageImplementation(const TileKey& key, ProgressCallback* progress) const override
+        {
+            osg::ref_ptr<osg::Image> image = new osg::Image();
+            image->allocateImage(256, 256, 1, GL_RGBA, GL_UNSIGNED_BYTE);
+            ImageUtils::PixelWriter write(image.get());
+            write.assign(color);
+            return GeoImage(image.get(), key.getExtent());
+        }
+    };
+
+    // One biome with two billboard trees; the side images come from the repo data.
+    std::shared_ptr<BiomeCatalog> makeCatalog()
+    {
+        Config group("group");
+        group.set("name", "trees");
+        for (auto name : { "cypress", "pine" })
+        {
+            Config asset("asset");
+            asset.set("name", std::string(name));
+            asset.set("side_url", std::string("../data/splat/") + name + ".png");
+            asset.set("width", 6.0f);
+            asset.set("height", 12.0f);
+            group.add(asset);
+        }
+
+        Config models("models");
+        models.add(group);
+
+        Config assetcatalog("assetcatalog");
+        assetcatalog.add(models);
+
+        Config biome("biome");
+        biome.set("id", std::string("forest"));
+        Config refs("assets");
+        for (auto name : { "cypress", "pine" })
+        {
+            Config ref("asset");
+            ref.set("name", std::string(name));
+            refs.add(ref);
+        }
+        biome.add(refs);
+
+        Config biomes("biomes");
+        biomes.add(biome);
+
+        Config conf("biomecatalog");
+        conf.add(assetcatalog);
+        conf.add(biomes);
+
+        return std::make_shared<BiomeCatalog>(conf);
+    }
+}
+
+TEST_CASE("VegetationFeatureGenerator parallel output matches serial")
+{
+    osg::ref_ptr<Map> map = new Map();
+
+    osg::ref_ptr<SolidImageLayer> green = new SolidImageLayer();
+    green->color.set(0, 1, 0, 1);
+    map->addLayer(green.get());
+
+    // coverage source; a white pixel reads as value 1
+    osg::ref_ptr<SolidImageLayer> white = new SolidImageLayer();
+    white->color.set(1, 1, 1, 1);
+    map->addLayer(white.get());
+
+    osg::ref_ptr<CoverageLayer> coverage = new CoverageLayer();
+    CoverageLayer::SourceLayerOptions source;
+    source.source().setLayer(white.get());
+    Config mapping("mapping");
+    mapping.set("value", 1u);
+    mapping.set("biome_id", std::string("forest"));
+    source.mappings()->add(mapping);
+    coverage->options().layers().push_back(source);
+    map->addLayer(coverage.get());
+
+    osg::ref_ptr<LifeMapLayer> lifemap = new LifeMapLayer();
+    lifemap->setColorLayer(green.get());
+    lifemap->setColorWeight(1.0f);
+    lifemap->setNoiseWeight(0.0f);
+    lifemap->setTerrainWeight(0.0f);
+    map->addLayer(lifemap.get());
+    REQUIRE(lifemap->isOpen());
+
+    osg::ref_ptr<BiomeLayer> biomes = new BiomeLayer();
+    biomes->options().biomeBaseLayer().setLayer(coverage.get());
+    biomes->options().biomeCatalog() = makeCatalog();
+    map->addLayer(biomes.get());
+    REQUIRE(biomes->isOpen());
+    biomes->getBiomeManager().setLocked(true);
+
+    // keep the tiles small so the test stays fast
+    osg::ref_ptr<VegetationLayer> veg = new VegetationLayer();
+    veg->options().group("trees").lod() = 12u;
+    veg->options().group("trees").instancesPerSqKm() = 16;
+    veg->setLifeMapLayer(lifemap.get());
+    veg->setBiomeLayer(biomes.get());
+    map->addLayer(veg.get());
+
+    VegetationFeatureGenerator gen;
+    gen.setMap(map.get());
+    gen.setLayer(veg.get());
+    REQUIRE(gen.getStatus().isOK());
+
+    // about 4x4 tiles at LOD 12
+    GeoExtent extent(map->getSRS(), 0.0, 0.0, 0.16, 0.16);
+
+    auto generate = [&](unsigned numThreads, FeatureList& output)
+    {
+        // bypass the placement cache so each pass does the work
+        veg->options().placementCacheSize() = 0u;
+        gen.setNumThreads(numThreads);
+        return gen.getFeatures(extent, output);
+    };
+
+    FeatureList serial;
+    REQUIRE(generate(1u, serial).isOK());
+    REQUIRE(serial.size() > 0u);
+
+    for (unsigned run = 0; run < 3; ++run)
+    {
+        FeatureList parallel;
+        REQUIRE(generate(4u, parallel).isOK());
+        REQUIRE(parallel.size() == serial.size());
+
+        for (unsigned i = 0; i < serial.size(); ++i)
+        {
+            const Feature* a = serial[i].get();
+            const Feature* b = parallel[i].get();
+            REQUIRE(a->getGeometry()->size() == b->getGeometry()->size());
+            CHECK((*a->getGeometry())[0] == (*b->getGeometry())[0]);
+            REQUIRE(a->getAttrs().size() == b->getAttrs().size());
+            for (auto& attr : a->getAttrs())
+                CHECK(b->getString(attr.first) == attr.second.getString());
+        }
+    }
+
+    SECTION("Cached placements match generated ones")
+    {
+        veg->options().placementCacheSize() = 256u;
+        veg->dirty();
+
+        FeatureList first, second;
+        gen.setNumThreads(4u);
+        REQUIRE(gen.getFeatures(extent, first).isOK());
+        REQUIRE(gen.getFeatures(extent, second).isOK());
+        REQUIRE(first.size() == serial.size());
+        REQUIRE(second.size() == serial.size());
+
+        for (unsigned i = 0; i < serial.size(); ++i)
+        {
+            CHECK((*first[i]->getGeometry())[0] == (*serial[i]->getGeometry())[0]);
+            CHECK((*second[i]->getGeometry())[0] == (*serial[i]->getGeometry())[0]);
+        }
+    }
+}
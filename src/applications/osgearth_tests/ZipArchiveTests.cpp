@@ -0,0 +1,352 @@
+/* osgEarth
+* Copyright 2025 Pelican Mapping
+* MIT License
+*/
+
+#include <osgEarth/catch.hpp>
+
+#include <osgEarth/FileUtils>
+#include <osgDB/Archive>
+#include <osgDB/FileNameUtils>
+#include <osgDB/ReadFile>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace osgEarth;
+
+namespace
+{
+    std::uint32_t crc32(const std::string& data)
+    {
+        std::uint32_t crc = 0xffffffffu;
+        for (unsigned char c : data)
+        {
+            crc ^= c;
+            for (int k = 0; k < 8; ++k)
+                crc = (crc >> 1) ^ (0xedb88320u & (0u - (crc & 1u)));
+        }
+        return ~crc;
+    }
+
+    void writeLE(std::ostream& out, std::uint64_t value, unsigned bytes)
+    {
+        for (unsigned i = 0; i < bytes; ++i)
+            out.put((char)((value >> (8u * i)) & 0xff));
+    }
+
+    //! A small scene graph file whose node name pads it to about "size" bytes
+    std::string entryPayload(unsigned index, unsigned size)
+    {
+        std::ostringstream buf;
+        buf << "#Ascii Scene\n#Version 161\n#Generator osgEarth\n\n"
+            << "osg::Group {\n  UniqueID 1\n  Name \"entry" << index << "_" << std::string(size, 'x') << "\"\n}\n";
+        return buf.str();
+    }
+
+    //! Wraps data in a raw deflate stream of stored blocks, which any
+    //! inflater must accept, so the tests need no compressor
+    std::string deflateStored(const std::string& data)
+    {
+        std::ostringstream out;
+        std::size_t pos = 0u;
+        do
+        {
+            std::size_t length = std::min<std::size_t>(data.size() - pos, 0xffffu);
+            bool last = (pos + length == data.size());
+            out.put(last ? 1 : 0);              // BFINAL, BTYPE=00
+            writeLE(out, length, 2);
+            writeLE(out, ~length & 0xffffu, 2);
+            out.write(data.data() + pos, length);
+            pos += length;
+        } while (pos < data.size());
+        return out.str();
+    }
+
+    struct ZipEntrySpec
+    {
+        std::string name;
+        std::string data;
+        bool deflate = false;
+        bool badCRC = false;
+    };
+
+    //! Writes a zip of the given entries and returns its name. "zip64" writes
+    //! every size and offset in zip64 records; "trailingBytes" appends junk
+    //! after the end of central directory record.
+    std::string writeZip(const std::string& name, const std::vector<ZipEntrySpec>& entries, bool zip64 = false, unsigned trailingBytes = 0u)
+    {
+        std::string filename = osgDB::concatPaths(getTempPath(), name);
+        std::ofstream out(filename.c_str(), std::ios::binary | std::ios::trunc);
+
+        std::ostringstream directory;
+        std::uint64_t offset = 0u;
+        const std::uint64_t overflow = 0xffffffffu;
+
+        for (auto& entry : entries)
+        {
+            std::string data = entry.deflate ? deflateStored(entry.data) : entry.data;
+            std::uint32_t crc = crc32(entry.data) ^ (entry.badCRC ? 1u : 0u);
+            unsigned version = zip64 ? 45u : 20u;
+            unsigned method = entry.deflate ? 8u : 0u;
+
+            // local file header
+            writeLE(out, 0x04034b50u, 4);
+            writeLE(out, version, 2);           // version needed
+            writeLE(out, 0u, 2);                // flags
+            writeLE(out, method, 2);
+            writeLE(out, 0u, 4);                // time and date
+            writeLE(out, crc, 4);
+            writeLE(out, zip64 ? overflow : data.size(), 4);
+            writeLE(out, zip64 ? overflow : entry.data.size(), 4);
+            writeLE(out, entry.name.size(), 2);
+            writeLE(out, zip64 ? 20u : 0u, 2);
+            out << entry.name;
+            if (zip64)
+            {
+                writeLE(out, 0x0001u, 2);
+                writeLE(out, 16u, 2);
+                writeLE(out, entry.data.size(), 8);
+                writeLE(out, data.size(), 8);
+            }
+            out << data;
+
+            // central directory header
+            writeLE(directory, 0x02014b50u, 4);
+            writeLE(directory, version, 2);     // version made by
+            writeLE(directory, version, 2);     // version needed
+            writeLE(directory, 0u, 2);
+            writeLE(directory, method, 2);
+            writeLE(directory, 0u, 4);
+            writeLE(directory, crc, 4);
+            writeLE(directory, zip64 ? overflow : data.size(), 4);
+            writeLE(directory, zip64 ? overflow : entry.data.size(), 4);
+            writeLE(directory, entry.name.size(), 2);
+            writeLE(directory, zip64 ? 28u : 0u, 2); // extra
+            writeLE(directory, 0u, 2);          // comment
+            writeLE(directory, 0u, 2);          // disk
+            writeLE(directory, 0u, 2);          // internal attributes
+            writeLE(directory, 0u, 4);          // external attributes
+            writeLE(directory, zip64 ? overflow : offset, 4);
+            directory << entry.name;
+            if (zip64)
+            {
+                writeLE(directory, 0x0001u, 2);
+                writeLE(directory, 24u, 2);
+                writeLE(directory, entry.data.size(), 8);
+                writeLE(directory, data.size(), 8);
+                writeLE(directory, offset, 8);
+            }
+
+            offset += 30u + entry.name.size() + (zip64 ? 20u : 0u) + data.size();
+        }
+
+        std::string cd = directory.str();
+        out << cd;
+
+        if (zip64)
+        {
+            std::uint64_t record = offset + cd.size();
+
+            // zip64 end of central directory record
+            writeLE(out, 0x06064b50u, 4);
+            writeLE(out, 44u, 8);               // size of the rest of the record
+            writeLE(out, 45u, 2);
+            writeLE(out, 45u, 2);
+            writeLE(out, 0u, 4);
+            writeLE(out, 0u, 4);
+            writeLE(out, entries.size(), 8);
+            writeLE(out, entries.size(), 8);
+            writeLE(out, cd.size(), 8);
+            writeLE(out, offset, 8);
+
+            // zip64 end of central directory locator
+            writeLE(out, 0x07064b50u, 4);
+            writeLE(out, 0u, 4);
+            writeLE(out, record, 8);
+            writeLE(out, 1u, 4);
+        }
+
+        // end of central directory
+        writeLE(out, 0x06054b50u, 4);
+        writeLE(out, 0u, 2);
+        writeLE(out, 0u, 2);
+        writeLE(out, zip64 ? 0xffffu : entries.size(), 2);
+        writeLE(out, zip64 ? 0xffffu : entries.size(), 2);
+        writeLE(out, zip64 ? overflow : cd.size(), 4);
+        writeLE(out, zip64 ? overflow : offset, 4);
+        writeLE(out, 0u, 2);
+
+        out << std::string(trailingBytes, '\0');
+
+        return filename;
+    }
+
+    //! Writes a zip of uncompressed .osgt entries and returns its name
+    std::string createZip(const std::string& name, unsigned numEntries, unsigned payloadSize)
+    {
+        std::vector<ZipEntrySpec> entries(numEntries);
+        for (unsigned i = 0; i < numEntries; ++i)
+        {
+            entries[i].name = "tiles/" + std::to_string(i) + ".osgt";
+            entries[i].data = entryPayload(i, payloadSize);
+        }
+        return writeZip(name, entries);
+    }
+
+    //! Name of the node read from an entry, or "" if the read failed
+    std::string readNodeName(osgDB::Archive* archive, const std::string& entry)
+    {
+        osgDB::ReaderWriter::ReadResult result = archive->readNode(entry, nullptr);
+        return result.validNode() ? result.getNode()->getName() : std::string();
+    }
+
+    std::string nodeName(unsigned index, unsigned size)
+    {
+        return "entry" + std::to_string(index) + "_" + std::string(size, 'x');
+    }
+}
+
+TEST_CASE("ZipArchive reads stored and deflated entries")
+{
+    // the large entry spans several deflate blocks
+    std::vector<ZipEntrySpec> entries(3);
+    entries[0] = { "stored.osgt", entryPayload(0, 100u) };
+    entries[1] = { "deflated.osgt", entryPayload(1, 100u), true };
+    entries[2] = { "large.osgt", entryPayload(2, 150000u), true };
+
+    std::string filename = writeZip("osgearth_zip_methods.zip", entries);
+    osg::ref_ptr<osgDB::Archive> archive = osgDB::openArchive(filename, osgDB::Archive::READ);
+    if (!archive.valid())
+    {
+        WARN("No zip archive plugin; skipping");
+        return;
+    }
+
+    REQUIRE(readNodeName(archive.get(), "stored.osgt") == nodeName(0, 100u));
+    REQUIRE(readNodeName(archive.get(), "deflated.osgt") == nodeName(1, 100u));
+    REQUIRE(readNodeName(archive.get(), "large.osgt") == nodeName(2, 150000u));
+
+    // pooled buffers are reused, so read again
+    REQUIRE(readNodeName(archive.get(), "deflated.osgt") == nodeName(1, 100u));
+}
+
+TEST_CASE("ZipArchive reads zip64 archives")
+{
+    std::vector<ZipEntrySpec> entries(2);
+    entries[0] = { "tiles/0.osgt", entryPayload(0, 100u) };
+    entries[1] = { "tiles/1.osgt", entryPayload(1, 100u), true };
+
+    std::string filename = writeZip("osgearth_zip_zip64.zip", entries, true);
+    osg::ref_ptr<osgDB::Archive> archive = osgDB::openArchive(filename, osgDB::Archive::READ);
+    if (!archive.valid())
+    {
+        WARN("No zip archive plugin; skipping");
+        return;
+    }
+
+    REQUIRE(archive->fileExists("tiles/0.osgt"));
+    REQUIRE(archive->fileExists("tiles/1.osgt"));
+    REQUIRE(readNodeName(archive.get(), "tiles/0.osgt") == nodeName(0, 100u));
+    REQUIRE(readNodeName(archive.get(), "tiles/1.osgt") == nodeName(1, 100u));
+}
+
+TEST_CASE("ZipArchive rejects entries with a bad CRC")
+{
+    std::vector<ZipEntrySpec> entries(4);
+    entries[0] = { "good.osgt", entryPayload(0, 100u) };
+    entries[1] = { "bad_stored.osgt", entryPayload(1, 100u), false, true };
+    entries[2] = { "good_deflated.osgt", entryPayload(2, 100u), true };
+    entries[3] = { "bad_deflated.osgt", entryPayload(3, 100u), true, true };
+
+    std::string filename = writeZip("osgearth_zip_crc.zip", entries);
+    osg::ref_ptr<osgDB::Archive> archive = osgDB::openArchive(filename, osgDB::Archive::READ);
+    if (!archive.valid())
+    {
+        WARN("No zip archive plugin; skipping");
+        return;
+    }
+
+    REQUIRE(readNodeName(archive.get(), "good.osgt") == nodeName(0, 100u));
+    REQUIRE(readNodeName(archive.get(), "good_deflated.osgt") == nodeName(2, 100u));
+
+    // a bad deflated entry falls back on libzip, which must fail it too
+    REQUIRE(readNodeName(archive.get(), "bad_stored.osgt").empty());
+    REQUIRE(readNodeName(archive.get(), "bad_deflated.osgt").empty());
+}
+
+TEST_CASE("ZipArchive falls back on libzip for archives it cannot parse")
+{
+    // Junk after the end of central directory record is not something the
+    // built-in parser accepts, so libzip indexes and reads this archive.
+    std::vector<ZipEntrySpec> entries(2);
+    entries[0] = { "tiles/0.osgt", entryPayload(0, 100u) };
+    entries[1] = { "tiles/1.osgt", entryPayload(1, 100u), true };
+
+    std::string filename = writeZip("osgearth_zip_fallback.zip", entries, false, 16u);
+    osg::ref_ptr<osgDB::Archive> archive = osgDB::openArchive(filename, osgDB::Archive::READ);
+    if (!archive.valid())
+    {
+        WARN("No zip archive plugin; skipping");
+        return;
+    }
+
+    REQUIRE(archive->fileExists("tiles/0.osgt"));
+    REQUIRE(readNodeName(archive.get(), "tiles/0.osgt") == nodeName(0, 100u));
+    REQUIRE(readNodeName(archive.get(), "tiles/1.osgt") == nodeName(1, 100u));
+
+    // and from another thread, which opens its own libzip handle
+    std::string name;
+    std::thread([&]() { name = readNodeName(archive.get(), "tiles/1.osgt"); }).join();
+    REQUIRE(name == nodeName(1, 100u));
+}
+
+TEST_CASE("ZipArchive multi-threaded read throughput", "[.benchmark]")
+{
+    const unsigned numEntries = 512u;
+    const unsigned readsPerThread = 4096u;
+    std::string filename = createZip("osgearth_zip_benchmark.zip", numEntries, 16384u);
+
+    osg::ref_ptr<osgDB::Archive> archive = osgDB::openArchive(filename, osgDB::Archive::READ);
+    if (!archive.valid())
+    {
+        WARN("No zip archive plugin; skipping");
+        return;
+    }
+
+    REQUIRE(archive->fileExists("tiles/0.osgt"));
+
+    for (unsigned numThreads : { 1u, 2u, 4u, 8u })
+    {
+        std::atomic<unsigned> nodes(0u);
+        std::vector<std::thread> threads;
+
+        auto t0 = std::chrono::steady_clock::now();
+        for (unsigned t = 0; t < numThreads; ++t)
+        {
+            threads.emplace_back([&, t]()
+                {
+                    for (unsigned i = 0; i < readsPerThread; ++i)
+                    {
+                        std::string entry = "tiles/" + std::to_string((i * 7u + t * 131u) % numEntries) + ".osgt";
+                        osgDB::ReaderWriter::ReadResult result = archive->readNode(entry, nullptr);
+                        if (result.validNode())
+                            ++nodes;
+                    }
+                });
+        }
+        for (auto& thread : threads)
+            thread.join();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+        REQUIRE(nodes == numThreads * readsPerThread);
+        std::cout << numThreads << " threads: "
+            << (unsigned)((double)nodes / seconds) << " reads/s" << std::endl;
+    }
+}
@@ -32,6 +32,12 @@ AltitudeFilter::getOrCreateSymbol()
     return _altitude.get();
 }
 
+bool
+AltitudeFilter::isDataParallel() const
+{
+    return !_altitude.valid() || !_altitude->script().isSet();
+}
+
 FilterContext
 AltitudeFilter::push( FeatureList& features, FilterContext& cx )
 {
@@ -50,6 +56,78 @@ AltitudeFilter::push( FeatureList& features, FilterContext& cx )
     return cx;
 }
 
+FilterContext
+AltitudeFilter::pushBatch( FeatureBatch& batch, FilterContext& cx )
+{
+    bool batchable =
+        _altitude.valid()                                             &&
+        _altitude->clamping()  == AltitudeSymbol::CLAMP_TO_TERRAIN    &&
+        _altitude->technique() == AltitudeSymbol::TECHNIQUE_MAP       &&
+        _altitude->binding()   == AltitudeSymbol::BINDING_VERTEX      &&
+        !_altitude->script().isSet()                                  &&
+        !_altitude->verticalScale().isSet()                           &&
+        !_altitude->verticalOffset().isSet()                          &&
+        cx.getSession()        != nullptr                             &&
+        cx.featureProfile()    != nullptr;
+
+    if ( !batchable )
+        return FeatureFilter::pushBatch( batch, cx );
+
+    if ( batch.empty() || batch.coords().empty() )
+        return cx;
+
+    osg::ref_ptr<const Map> map = cx.getSession()->getMap();
+    if ( !map.valid() )
+        return cx;
+
+    const SpatialReference* mapSRS = map->getSRS();
+    osg::ref_ptr<const SpatialReference> featureSRS =
+        batch.getSRS() ? batch.getSRS() : cx.featureProfile()->getSRS();
+
+    std::vector<osg::Vec3d>& coords = batch.coords();
+
+    ElevationPool::Envelope envelope;
+    map->getElevationPool()->prepareEnvelope(
+        envelope,
+        GeoPoint(featureSRS.get(), coords.front().x(), coords.front().y()),
+        _maxResolution);
+
+    // transform the whole batch to the map SRS once and sample it in one call.
+    bool xform = !featureSRS->isHorizEquivalentTo(mapSRS);
+    std::vector<osg::Vec3d> transformed;
+    std::vector<osg::Vec3d>* points = &coords;
+    if ( xform )
+    {
+        transformed = coords;
+        featureSRS->transform( transformed, mapSRS );
+        points = &transformed;
+    }
+
+    envelope.sampleMapCoords( points->begin(), points->end(), nullptr );
+
+    for( auto& point : *points )
+        if ( point.z() == NO_DATA_VALUE )
+            point.z() = 0.0;
+
+    if ( xform )
+    {
+        for( std::size_t i = 0; i < coords.size(); ++i )
+            coords[i].z() = transformed[i].z();
+    }
+
+    // if necessary, transform the Z values (which are now in the map SRS) back
+    // into the feature's SRS.
+    if ( !featureSRS->isVertEquivalentTo(mapSRS) )
+    {
+        osg::ref_ptr<const SpatialReference> featureSRSwithMapVertDatum =
+            SpatialReference::create(featureSRS->getHorizInitString(), mapSRS->getVertInitString());
+
+        featureSRSwithMapVertDatum->transform( coords, featureSRS.get() );
+    }
+
+    return cx;
+}
+
 void
 AltitudeFilter::pushAndDontClamp( FeatureList& features, FilterContext& cx )
 {
@@ -0,0 +1,437 @@
+/* osgEarth
+ * Copyright 2025 Pelican Mapping
+ * MIT License
+ */
+#include <osgEarth/AnalyticTransforms>
+#include <osgEarth/SpatialReference>
+#include <osgEarth/StringUtils>
+#include <osgEarth/Notify>
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <vector>
+
+#define LC "[AnalyticTransforms] "
+
+using namespace osgEarth;
+using namespace osgEarth::Util;
+
+// All transforms below run a straight loop over the X and Y arrays
+// with no per-point branching on the SRS, so the compiler is free to
+// vectorize them. Points that fail are set to HUGE_VAL (like PROJ).
+
+namespace
+{
+    constexpr double PI = 3.14159265358979323846;
+    constexpr double TWO_PI = 2.0 * PI;
+    constexpr double DEG2RAD = PI / 180.0;
+    constexpr double RAD2DEG = 180.0 / PI;
+
+    // WGS84 ellipsoid
+    constexpr double WGS84_A = 6378137.0;
+    constexpr double WGS84_F = 1.0 / 298.257223563;
+
+    // Normalizes a longitude (radians) into [-PI, PI] only when it is
+    // out of range, same as PROJ's adjlon.
+    inline double adjlon(double lon)
+    {
+        if (std::abs(lon) <= PI + 1e-12)
+            return lon;
+        return lon - TWO_PI * std::floor((lon + PI) / TWO_PI);
+    }
+
+    // Parsed PROJ4 initialization string
+    struct Proj4
+    {
+        StringTable params;
+
+        Proj4(const std::string& init)
+        {
+            auto tokens = StringTokenizer()
+                .whitespaceDelims()
+                .standardQuotes()
+                .tokenize(init);
+
+            for (auto& token : tokens)
+            {
+                auto pos = token.find('=');
+                if (pos != std::string::npos)
+                    params[toLower(token.substr(0, pos))] = token.substr(pos + 1);
+                else
+                    params[toLower(token)] = "";
+            }
+        }
+
+        bool has(const std::string& key) const
+        {
+            return params.find(key) != params.end();
+        }
+
+        std::string get(const std::string& key) const
+        {
+            auto i = params.find(key);
+            return i != params.end() ? i->second : std::string();
+        }
+
+        double num(const std::string& key, double defaultValue) const
+        {
+            auto i = params.find(key);
+            return i != params.end() ? as<double>(i->second, defaultValue) : defaultValue;
+        }
+
+        //! True if there is no datum shift to apply (towgs84 missing or all zeros)
+        bool noDatumShift() const
+        {
+            if (has("+nadgrids") && get("+nadgrids") != "@null")
+                return false;
+            if (!has("+towgs84"))
+                return true;
+            for (auto& v : StringTokenizer().delim(",").tokenize(get("+towgs84")))
+                if (as<double>(v, 1.0) != 0.0)
+                    return false;
+            return true;
+        }
+
+        //! True if the ellipsoid is WGS84 and there is no datum shift
+        bool isWGS84() const
+        {
+            if (has("+pm") && get("+pm") != "greenwich" && get("+pm") != "0")
+                return false;
+
+            std::string datum = toLower(get("+datum"));
+            if (datum == "wgs84")
+                return true;
+            if (!datum.empty())
+                return false;
+            return toLower(get("+ellps")) == "wgs84" && noDatumShift();
+        }
+    };
+
+    //! Geographic (WGS84, degrees) SRS suitable for an analytic transform
+    bool isWGS84Geographic(const SpatialReference* srs, const Proj4& p)
+    {
+        return
+            srs->isGeographic() &&
+            !srs->isCube() &&
+            (p.get("+proj") == "longlat" || p.get("+proj") == "latlong") &&
+            p.isWGS84() &&
+            srs->getUnits().isAngle() &&
+            std::abs(srs->getUnits()._toBase - DEG2RAD) < 1e-12;
+    }
+
+    //! Spherical Mercator on a sphere of radius WGS84_A, no false origin
+    bool isWebMercator(const SpatialReference* srs, const Proj4& p)
+    {
+        if (!srs->isSphericalMercator())
+            return false;
+
+        // "webmerc" always projects onto a sphere of the semi-major axis;
+        // "merc" must be on a sphere of that radius to match.
+        std::string proj = p.get("+proj");
+        if (proj != "webmerc" && proj != "merc")
+            return false;
+
+        double a = p.has("+r") ? p.num("+r", 0.0) : p.num("+a", p.isWGS84() ? WGS84_A : 0.0);
+        double b = (proj == "webmerc" || p.has("+r")) ? a : p.num("+b", 0.0);
+
+        return
+            a == WGS84_A && b == WGS84_A &&
+            p.num("+lat_ts", 0.0) == 0.0 &&
+            p.num("+lon_0", 0.0) == 0.0 &&
+            p.num("+x_0", 0.0) == 0.0 &&
+            p.num("+y_0", 0.0) == 0.0 &&
+            p.num("+k", p.num("+k_0", 1.0)) == 1.0 &&
+            (!p.has("+units") || p.get("+units") == "m") &&
+            (p.get("+datum").empty() || p.isWGS84()) &&
+            p.noDatumShift();
+    }
+
+    //! WGS84 UTM zone; returns zone number (1..60) or 0 if not UTM
+    int getUTMZone(const SpatialReference* srs, const Proj4& p, bool& south)
+    {
+        if (!srs->isProjected() || p.get("+proj") != "utm" || !p.isWGS84())
+            return 0;
+        if (p.has("+units") && p.get("+units") != "m")
+            return 0;
+        int zone = as<int>(p.get("+zone"), 0);
+        if (zone < 1 || zone > 60)
+            return 0;
+        south = p.has("+south");
+        return zone;
+    }
+
+    //! WGS84 geographic <-> Spherical Mercator
+    class WebMercatorTransform : public AnalyticTransform
+    {
+    public:
+        WebMercatorTransform(bool forward, bool over) :
+            _forward(forward), _over(over) { }
+
+        const char* name() const override
+        {
+            return _forward ? "WGS84 to Spherical Mercator" : "Spherical Mercator to WGS84";
+        }
+
+        bool transform(double* x, double* y, unsigned count) const override
+        {
+            const double R = WGS84_A;
+            const double maxLat = 0.5 * PI - 1e-10;
+            bool ok = true;
+
+            if (_forward)
+            {
+                for (unsigned i = 0; i < count; ++i)
+                {
+                    double lon = x[i] * DEG2RAD;
+                    double lat = y[i] * DEG2RAD;
+                    bool valid = std::isfinite(lon) && std::abs(lat) <= maxLat;
+                    if (!_over) lon = adjlon(lon);
+                    x[i] = valid ? R * lon : HUGE_VAL;
+                    y[i] = valid ? R * std::log(std::tan(0.25 * PI + 0.5 * lat)) : HUGE_VAL;
+                    ok = ok && valid;
+                }
+            }
+            else
+            {
+                for (unsigned i = 0; i < count; ++i)
+                {
+                    bool valid = std::isfinite(x[i]) && std::isfinite(y[i]);
+                    double lon = x[i] / R;
+                    if (!_over) lon = adjlon(lon);
+                    x[i] = valid ? lon * RAD2DEG : HUGE_VAL;
+                    y[i] = valid ? std::atan(std::sinh(y[i] / R)) * RAD2DEG : HUGE_VAL;
+                    ok = ok && valid;
+                }
+            }
+            return ok;
+        }
+
+    private:
+        bool _forward;
+        bool _over;
+    };
+
+    //! WGS84 geographic <-> UTM, using the 6th-order Krueger series
+    //! (Karney 2011) that PROJ also uses for its "utm" projection.
+    class UTMTransform : public AnalyticTransform
+    {
+    public:
+        UTMTransform(bool forward, int zone, bool south) :
+            _forward(forward),
+            _lon0((zone * 6.0 - 183.0) * DEG2RAD),
+            _y0(south ? 10000000.0 : 0.0)
+        {
+            const double f = WGS84_F;
+            const double n = f / (2.0 - f);
+            const double n2 = n * n, n3 = n2 * n, n4 = n3 * n, n5 = n4 * n, n6 = n5 * n;
+
+            _e = std::sqrt(f * (2.0 - f));
+            _k0A = K0 * WGS84_A / (1.0 + n) * (1.0 + n2 / 4.0 + n4 / 64.0 + n6 / 256.0);
+
+            _alpha[0] = n / 2.0 - 2.0 * n2 / 3.0 + 5.0 * n3 / 16.0 + 41.0 * n4 / 180.0 - 127.0 * n5 / 288.0 + 7891.0 * n6 / 37800.0;
+            _alpha[1] = 13.0 * n2 / 48.0 - 3.0 * n3 / 5.0 + 557.0 * n4 / 1440.0 + 281.0 * n5 / 630.0 - 1983433.0 * n6 / 1935360.0;
+            _alpha[2] = 61.0 * n3 / 240.0 - 103.0 * n4 / 140.0 + 15061.0 * n5 / 26880.0 + 167603.0 * n6 / 181440.0;
+            _alpha[3] = 49561.0 * n4 / 161280.0 - 179.0 * n5 / 168.0 + 6601661.0 * n6 / 7257600.0;
+            _alpha[4] = 34729.0 * n5 / 80640.0 - 3418889.0 * n6 / 1995840.0;
+            _alpha[5] = 212378941.0 * n6 / 319334400.0;
+
+            _beta[0] = n / 2.0 - 2.0 * n2 / 3.0 + 37.0 * n3 / 96.0 - n4 / 360.0 - 81.0 * n5 / 512.0 + 96199.0 * n6 / 604800.0;
+            _beta[1] = n2 / 48.0 + n3 / 15.0 - 437.0 * n4 / 1440.0 + 46.0 * n5 / 105.0 - 1118711.0 * n6 / 3870720.0;
+            _beta[2] = 17.0 * n3 / 480.0 - 37.0 * n4 / 840.0 - 209.0 * n5 / 4480.0 + 5569.0 * n6 / 90720.0;
+            _beta[3] = 4397.0 * n4 / 161280.0 - 11.0 * n5 / 504.0 - 830251.0 * n6 / 7257600.0;
+            _beta[4] = 4583.0 * n5 / 161280.0 - 108847.0 * n6 / 3991680.0;
+            _beta[5] = 20648693.0 * n6 / 638668800.0;
+        }
+
+        const char* name() const override
+        {
+            return _forward ? "WGS84 to UTM" : "UTM to WGS84";
+        }
+
+        bool transform(double* x, double* y, unsigned count) const override
+        {
+            return _forward ? forward(x, y, count) : inverse(x, y, count);
+        }
+
+    private:
+        static constexpr double K0 = 0.9996;
+        static constexpr double X0 = 500000.0;
+        static constexpr double MAX_ETA = 2.623395162778; // same limit as PROJ
+
+        bool _forward;
+        double _lon0, _y0;
+        double _e, _k0A;
+        double _alpha[6], _beta[6];
+
+        // conformal latitude tangent from geodetic latitude tangent
+        inline double conformal(double tau) const
+        {
+            double s = std::sqrt(1.0 + tau * tau);
+            double sigma = std::sinh(_e * std::atanh(_e * tau / s));
+            return tau * std::sqrt(1.0 + sigma * sigma) - sigma * s;
+        }
+
+        bool forward(double* x, double* y, unsigned count) const
+        {
+            bool ok = true;
+            for (unsigned i = 0; i < count; ++i)
+            {
+                double lon = adjlon(x[i] * DEG2RAD - _lon0);
+                double lat = y[i] * DEG2RAD;
+
+                double tau_p = conformal(std::tan(lat));
+                double cos_lon = std::cos(lon);
+                double xi_p = std::atan2(tau_p, cos_lon);
+                double eta_p = std::asinh(std::sin(lon) / std::sqrt(tau_p * tau_p + cos_lon * cos_lon));
+
+                double xi = xi_p, eta = eta_p;
+                for (int j = 0; j < 6; ++j)
+                {
+                    double k = 2.0 * (j + 1);
+                    xi += _alpha[j] * std::sin(k * xi_p) * std::cosh(k * eta_p);
+                    eta += _alpha[j] * std::cos(k * xi_p) * std::sinh(k * eta_p);
+                }
+
+                bool valid = std::isfinite(lon) && std::abs(lat) <= 0.5 * PI && std::abs(eta_p) <= MAX_ETA;
+                x[i] = valid ? _k0A * eta + X0 : HUGE_VAL;
+                y[i] = valid ? _k0A * xi + _y0 : HUGE_VAL;
+                ok = ok && valid;
+            }
+            return ok;
+        }
+
+        bool inverse(double* x, double* y, unsigned count) const
+        {
+            const double one_e2 = 1.0 - _e * _e;
+            bool ok = true;
+            for (unsigned i = 0; i < count; ++i)
+            {
+                double eta = (x[i] - X0) / _k0A;
+                double xi = (y[i] - _y0) / _k0A;
+
+                double xi_p = xi, eta_p = eta;
+                for (int j = 0; j < 6; ++j)
+                {
+                    double k = 2.0 * (j + 1);
+                    xi_p -= _beta[j] * std::sin(k * xi) * std::cosh(k * eta);
+                    eta_p -= _beta[j] * std::cos(k * xi) * std::sinh(k * eta);
+                }
+
+                double sinh_eta_p = std::sinh(eta_p);
+                double sin_xi_p = std::sin(xi_p);
+                double cos_xi_p = std::cos(xi_p);
+                double tau_p = sin_xi_p / std::sqrt(sinh_eta_p * sinh_eta_p + cos_xi_p * cos_xi_p);
+
+                // Newton-Raphson for the geodetic latitude tangent; a fixed
+                // iteration count keeps the loop branch-free.
+                double tau = tau_p;
+                for (int n = 0; n < 5; ++n)
+                {
+                    double tau_i_p = conformal(tau);
+                    double s = std::sqrt(1.0 + tau * tau);
+                    tau += (tau_p - tau_i_p) / std::sqrt(1.0 + tau_i_p * tau_i_p) *
+                        (1.0 + one_e2 * tau * tau) / (one_e2 * s);
+                }
+
+                bool valid = std::isfinite(tau) && std::abs(eta_p) <= MAX_ETA;
+                x[i] = valid ? adjlon(std::atan2(sinh_eta_p, cos_xi_p) + _lon0) * RAD2DEG : HUGE_VAL;
+                y[i] = valid ? std::atan(tau) * RAD2DEG : HUGE_VAL;
+                ok = ok && valid;
+            }
+            return ok;
+        }
+    };
+
+    std::shared_ptr<AnalyticTransform> createBuiltIn(const SpatialReference* from, const SpatialReference* to)
+    {
+        Proj4 src(from->getHorizInitString());
+        Proj4 dst(to->getHorizInitString());
+
+        bool fromGeo = isWGS84Geographic(from, src);
+        bool toGeo = isWGS84Geographic(to, dst);
+        if (fromGeo == toGeo)
+            return nullptr;
+
+        const Proj4& proj = fromGeo ? dst : src;
+        const SpatialReference* projSRS = fromGeo ? to : from;
+
+        if (isWebMercator(projSRS, proj))
+        {
+            return std::make_shared<WebMercatorTransform>(fromGeo, proj.has("+over"));
+        }
+
+        bool south = false;
+        int zone = getUTMZone(projSRS, proj, south);
+        if (zone > 0)
+        {
+            return std::make_shared<UTMTransform>(fromGeo, zone, south);
+        }
+
+        return nullptr;
+    }
+
+    struct TransformRegistry
+    {
+        std::mutex mutex;
+        std::vector<AnalyticTransforms::Factory> factories;
+        std::atomic_bool enabled = { ::getenv("OSGEARTH_DISABLE_ANALYTIC_TRANSFORMS") == nullptr };
+
+        TransformRegistry()
+        {
+            factories.emplace_back(createBuiltIn);
+        }
+    };
+
+    TransformRegistry& registry()
+    {
+        static TransformRegistry instance;
+        return instance;
+    }
+}
+
+void
+AnalyticTransforms::add(const Factory& factory)
+{
+    OE_SOFT_ASSERT_AND_RETURN(factory != nullptr, void());
+    auto& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.factories.emplace_back(factory);
+}
+
+std::shared_ptr<AnalyticTransform>
+AnalyticTransforms::get(const SpatialReference* from, const SpatialReference* to)
+{
+    if (!from || !to || !from->valid() || !to->valid())
+        return nullptr;
+
+    auto& r = registry();
+    std::vector<Factory> factories;
+    {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        factories = r.factories;
+    }
+
+    for (auto i = factories.rbegin(); i != factories.rend(); ++i)
+    {
+        auto xform = (*i)(from, to);
+        if (xform)
+        {
+            OE_DEBUG << LC << "Using " << xform->name() << " for "
+                << from->getName() << " -> " << to->getName() << std::endl;
+            return xform;
+        }
+    }
+    return nullptr;
+}
+
+void
+AnalyticTransforms::setEnabled(bool value)
+{
+    registry().enabled = value;
+}
+
+bool
+AnalyticTransforms::getEnabled()
+{
+    return registry().enabled;
+}
@@ -12,6 +12,9 @@
 #include <osgDB/FileNameUtils>
 #include <osgEarth/ImageToHeightFieldConverter>
 #include <osgEarth/Notify>
+#include <cstdio>
+#include <iterator>
+#include <streambuf>
 
 using namespace osgEarth;
 using namespace osgEarth::ArcGIS;
@@ -26,16 +29,6 @@ using namespace osgEarth::ArcGIS;
 
 namespace osgEarth { namespace ArcGIS
 {
-    unsigned int computeOffset(const std::vector<char>& buffer)
-    {
-        unsigned int sum = 0;
-        for (unsigned int i = 0; i < buffer.size(); i++) {
-            char v = buffer[i];
-            sum += ((unsigned int)v & 0xff) * pow(2.0, 8.0 * i);
-        }
-        return sum;
-    }
-
     unsigned int hexFromString(const std::string& input)
     {
         unsigned int result;
@@ -44,57 +37,90 @@ namespace osgEarth { namespace ArcGIS
         ss >> result;
         return result;
     }
+} }
 
-    std::string toHex(unsigned int value)
-    {
-        std::stringstream ss;
-        ss << std::hex << value;
-        return ss.str();
-    }
+//........................................................................
 
-    std::string padLeft(std::string value, unsigned int length)
+namespace
+{
+    //! Read-only stream buffer over a slice of memory, so decoders can
+    //! read a tile straight out of the mapped bundle without a copy.
+    class MemoryStreamBuf : public std::streambuf
     {
-        std::stringstream ss;
-        if (value.size() < length)
+    public:
+        MemoryStreamBuf(const char* data, std::size_t size)
         {
-            for (unsigned int i = 0; i < (length - value.size()); i++)
-            {
-                ss << "0";
-            }
-            ss << value;
-            return ss.str();
+            char* p = const_cast<char*>(data);
+            setg(p, p, p + size);
         }
-        else
+
+    protected:
+        pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override
         {
-            return value;
+            if (which & std::ios_base::out)
+                return pos_type(off_type(-1));
+
+            off_type base =
+                dir == std::ios_base::beg ? 0 :
+                dir == std::ios_base::cur ? gptr() - eback() :
+                egptr() - eback();
+
+            off_type pos = base + off;
+            if (pos < 0 || pos > egptr() - eback())
+                return pos_type(off_type(-1));
+
+            setg(eback(), eback() + pos, egptr());
+            return pos_type(pos);
         }
-    }
 
-} }
+        pos_type seekpos(pos_type pos, std::ios_base::openmode which) override
+        {
+            return seekoff(off_type(pos), std::ios_base::beg, which);
+        }
+    };
+
+    class MemoryStream : public std::istream
+    {
+    public:
+        MemoryStream(const char* data, std::size_t size) :
+            std::istream(nullptr),
+            _buf(data, size)
+        {
+            rdbuf(&_buf);
+        }
+
+    private:
+        MemoryStreamBuf _buf;
+    };
+
+    //! Reads a little-endian unsigned integer of "bytes" bytes
+    inline unsigned long long readLE(const char* data, unsigned bytes)
+    {
+        unsigned long long value = 0ull;
+        for (unsigned i = 0; i < bytes; ++i)
+            value |= ((unsigned long long)(unsigned char)data[i]) << (8u * i);
+        return value;
+    }
+}
 
 //........................................................................
 
-BundleReader::BundleReader(const std::string& bundleFile, unsigned int bundleSize) :
+Bundle::Bundle(const std::string& bundleFile, unsigned int bundleSize) :
     _bundleFile(bundleFile),
+    _bundleSize(bundleSize),
     _lod(0),
-    _colOffset(0),
     _rowOffset(0),
-    _bundleSize(bundleSize)
+    _colOffset(0)
 {
-    init();
+    //nop
 }
 
-void BundleReader::init()
+void Bundle::init()
 {
-    std::string base = osgDB::getNameLessExtension(_bundleFile);
-    _indexFile = base + ".bundlx";
-
-    // Open the bundle
-    _in.open(_bundleFile.c_str(), std::ofstream::binary);
-
-    // Read the index
-    readIndex(_indexFile, _index);
+    // Map the bundle
+    _file = std::make_unique<MappedFile>(_bundleFile);
 
+    std::string base = osgDB::getNameLessExtension(_bundleFile);
     std::string baseName = osgDB::getSimpleFileName(base);
 
     _rowOffset = hexFromString(baseName.substr(1, 4));
@@ -106,81 +132,43 @@ void BundleReader::init()
     _lod = as<unsigned int>(levelDir.substr(1, 2), 0);
 }
 
-/**
-* Reads the index of a bundle file.
-*/
-void BundleReader::readIndex(const std::string& filename, std::vector<int>& index)
+bool Bundle::getTileData(const TileKey& key, const char*& data, std::size_t& size) const
 {
-    std::ifstream input(filename.c_str(), std::ifstream::binary);
-    char header[INDEX_HEADER_SIZE];
-    input.read(header, INDEX_HEADER_SIZE);
-    while (input.good()) {
-        std::vector<char> buffer;
-        buffer.resize(5);
-        if (input.read(&buffer[0], INDEX_SIZE))
-        {
-            int offset = computeOffset(buffer);
-            index.push_back(offset);
-        }
-    }
+    return getTileData(getTileIndex(key), data, size);
 }
 
-osg::Image* BundleReader::readImage(const TileKey& key, const osgDB::ReaderWriter* rw)
+osg::Image* Bundle::readImage(const TileKey& key, const osgDB::ReaderWriter* rw) const
 {
-    // Figure out the index for the tilekey
-    unsigned int row = key.getTileX() - _colOffset;
-    unsigned int i = key.getTileY() - _rowOffset + (row * _bundleSize);
-    return readImage(i, rw);
+    return readImage(getTileIndex(key), rw);
 }
 
-osg::Image* BundleReader::readImage(unsigned int index, const osgDB::ReaderWriter* rw)
+osg::Image* Bundle::readImage(unsigned int index, const osgDB::ReaderWriter* rw) const
 {
-    if (index < 0 || index >= _index.size()) return 0;
+    const char* data;
+    std::size_t size;
+    if (!getTileData(index, data, size))
+        return nullptr;
 
-    _in.seekg(_index[index], std::ios::beg);
-    std::vector<char> sizeBuffer;
-    sizeBuffer.resize(4);
-    _in.read(&sizeBuffer[0], 4);
-    int size = computeOffset(sizeBuffer);
-    if (size > 0)
-    {
-        std::string image;
-        image.resize(size);
-        _in.read(&image[0], size);
-        std::stringstream ss(image);
+    MemoryStream in(data, size);
 
-        osg::Image* result = ImageUtils::readStream(ss, 0);
-        if (!result && rw)
-        {
-            result = rw->readImage(ss, 0).takeImage();
-        }
-        return result;
+    osg::Image* result = ImageUtils::readStream(in, 0);
+    if (!result && rw)
+    {
+        in.clear();
+        in.seekg(0, std::ios::beg);
+        result = rw->readImage(in, 0).takeImage();
     }
-
-    return 0;
+    return result;
 }
 
-void BundleReader::readFeatures(const TileKey& key, FeatureList& features)
+void Bundle::readFeatures(const TileKey& key, FeatureList& features) const
 {
 #ifdef OSGEARTH_HAVE_MVT
-    // Figure out the index for the tilekey
-    unsigned int row = key.getTileX() - _colOffset;
-    unsigned int index = key.getTileY() - _rowOffset + (row * _bundleSize);
-
-    if (index < 0 || index >= _index.size()) return;
-
-    _in.seekg(_index[index], std::ios::beg);
-    std::vector<char> sizeBuffer;
-    sizeBuffer.resize(4);
-    _in.read(&sizeBuffer[0], 4);
-    int size = computeOffset(sizeBuffer);
-    if (size > 0)
+    const char* data;
+    std::size_t size;
+    if (getTileData(key, data, size))
     {
-        std::string image;
-        image.resize(size);
-        _in.read(&image[0], size);
-
-        osgEarth::MVT::readTile(image, key, features);
+        osgEarth::MVT::readTile(std::string(data, size), key, features);
     }
 #else
     OE_WARN << LC << "osgEarth is not built with MVT/PBF support" << std::endl;
@@ -188,37 +176,72 @@ void BundleReader::readFeatures(const TileKey& key, FeatureList& features)
 }
 
 //........................................................................
-const unsigned long long M = pow(2, 40);
 
-BundleReader2::BundleReader2(const std::string& bundleFile, unsigned int bundleSize) :
-    _bundleFile(bundleFile),
-    _lod(0),
-    _colOffset(0),
-    _rowOffset(0),
-    _bundleSize(bundleSize)
+BundleReader::BundleReader(const std::string& bundleFile, unsigned int bundleSize) :
+    Bundle(bundleFile, bundleSize)
 {
     init();
+
+    _indexFile = osgDB::getNameLessExtension(_bundleFile) + ".bundlx";
+
+    // Read the index
+    if (valid())
+        readIndex(_indexFile, _index);
 }
 
-void BundleReader2::init()
+/**
+* Reads the index of a bundle file.
+*/
+void BundleReader::readIndex(const std::string& filename, std::vector<unsigned long long>& index)
 {
-    std::string base = osgDB::getNameLessExtension(_bundleFile);
+    std::ifstream input(filename.c_str(), std::ifstream::binary);
+    std::string buffer((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    if (buffer.size() < INDEX_HEADER_SIZE)
+        return;
 
-    // Open the bundle
-    _in.open(_bundleFile.c_str(), std::ofstream::binary);
+    std::size_t count = (buffer.size() - INDEX_HEADER_SIZE) / INDEX_SIZE;
+    index.resize(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        index[i] = readLE(&buffer[INDEX_HEADER_SIZE + i * INDEX_SIZE], INDEX_SIZE);
+    }
+}
 
-    // Read the index
-    readIndex(_index);
+unsigned int BundleReader::getTileIndex(const TileKey& key) const
+{
+    unsigned int row = key.getTileX() - _colOffset;
+    return key.getTileY() - _rowOffset + (row * _bundleSize);
+}
 
-    std::string baseName = osgDB::getSimpleFileName(base);
+bool BundleReader::getTileData(unsigned int index, const char*& data, std::size_t& size) const
+{
+    if (index >= _index.size() || !valid())
+        return false;
 
-    _rowOffset = hexFromString(baseName.substr(1, 4));
-    _colOffset = hexFromString(baseName.substr(6, 4));
+    // each record is a 4-byte size followed by the tile bytes
+    unsigned long long offset = _index[index];
+    if (offset + 4u > _file->size())
+        return false;
 
-    std::string path = osgDB::getFilePath(_bundleFile);
+    size = (std::size_t)readLE(_file->data() + offset, 4);
+    if (size == 0u || offset + 4u + size > _file->size())
+        return false;
 
-    std::string levelDir = osgDB::getSimpleFileName(path);
-    _lod = as<unsigned int>(levelDir.substr(1, 2), 0);
+    data = _file->data() + offset + 4u;
+    return true;
+}
+
+//........................................................................
+const unsigned long long M = pow(2, 40);
+
+BundleReader2::BundleReader2(const std::string& bundleFile, unsigned int bundleSize) :
+    Bundle(bundleFile, bundleSize)
+{
+    init();
+
+    // Read the index
+    if (valid())
+        readIndex(_index);
 }
 
 /**
@@ -226,86 +249,118 @@ void BundleReader2::init()
 */
 void BundleReader2::readIndex(std::vector<unsigned long long>& index)
 {
-    // Go past the bundle header
-    _in.seekg(64);
-
+    // The index follows the 64-byte bundle header
+    const unsigned int headerSize = 64;
     const unsigned int numEntries = 128 * 128;
-    index = std::vector<unsigned long long>(numEntries, 0);
+    if (_file->size() < headerSize + numEntries * 8u)
+        return;
 
-    //unsigned long long indexBuffer[numEntries];
-    _in.read((char*)&index[0], numEntries * sizeof(unsigned long long));
-    unsigned int numGoodEntries = 0;
-    for (unsigned int i = 0; i < numEntries; i++)
+    index.resize(numEntries);
+    const char* ptr = _file->data() + headerSize;
+    for (unsigned int i = 0; i < numEntries; ++i, ptr += 8)
     {
-        unsigned long long tile_index = index[i];
-        unsigned long long tileOffset = tile_index % (unsigned long long)M;
-        unsigned long long tileSize = floor((unsigned long long)tile_index / M);
-        if (tileSize > 0)
-        {
-            numGoodEntries++;
-        }
+        index[i] = readLE(ptr, 8);
     }
 }
 
-osg::Image* BundleReader2::readImage(const TileKey& key, const osgDB::ReaderWriter* rw)
+unsigned int BundleReader2::getTileIndex(const TileKey& key) const
 {
     unsigned int col = key.getTileX() - _colOffset;
     unsigned int row = key.getTileY() - _rowOffset;
-    unsigned int i = _bundleSize * row + col;
-    return readImage(i, rw);
+    return _bundleSize * row + col;
 }
 
-osg::Image* BundleReader2::readImage(unsigned int index, const osgDB::ReaderWriter* rw)
+bool BundleReader2::getTileData(unsigned int index, const char*& data, std::size_t& size) const
 {
-    if (index < 0 || index >= _index.size()) return 0;
+    if (index >= _index.size() || !valid())
+        return false;
 
+    // each entry packs a 40-bit offset and a 24-bit size
     unsigned long long tile_index = _index[index];
-    unsigned long long tileOffset = tile_index % (unsigned long long)M;
-    unsigned long long tileSize = floor((unsigned long long)tile_index / M);
+    unsigned long long tileOffset = tile_index % M;
+    unsigned long long tileSize = tile_index / M;
 
-    _in.seekg(tileOffset, std::ios::beg);
-    if (tileSize > 0)
-    {
-        std::string imageData;
-        imageData.resize(tileSize);
-        _in.read(&imageData[0], tileSize);
-        std::stringstream ss(imageData);
+    if (tileSize == 0u || tileOffset + tileSize > _file->size())
+        return false;
 
-        osg::Image* result = ImageUtils::readStream(ss, 0);
-        if (!result && rw)
-        {
-            result = rw->readImage(ss, 0).takeImage();
-        }
-        return result;
-    }
+    data = _file->data() + tileOffset;
+    size = (std::size_t)tileSize;
+    return true;
+}
+
+//........................................................................
 
-    return 0;
+BundleCache::BundleCache(const std::string& rootDir, StorageFormat format, unsigned int bundleSize, unsigned capacity) :
+    _rootDir(rootDir),
+    _format(format),
+    _bundleSize(std::max(1u, bundleSize)),
+    _capacity(std::max(1u, capacity)),
+    _bundles(_capacity)
+{
+    //nop
 }
 
-void BundleReader2::readFeatures(const TileKey& key, FeatureList& features)
+std::string
+BundleCache::getBundleFileName(unsigned lod, unsigned x, unsigned y) const
 {
-#ifdef OSGEARTH_HAVE_MVT
-    unsigned int col = key.getTileX() - _colOffset;
-    unsigned int row = key.getTileY() - _rowOffset;
-    unsigned int index = _bundleSize * row + col;
+    unsigned colOffset = (x / _bundleSize) * _bundleSize;
+    unsigned rowOffset = (y / _bundleSize) * _bundleSize;
 
-    if (index < 0 || index >= _index.size()) return;
+    char name[32];
+    snprintf(name, sizeof(name), "L%02u/R%04xC%04x.bundle", lod, rowOffset, colOffset);
+    return _rootDir + name;
+}
 
-    unsigned long long tile_index = _index[index];
-    unsigned long long tileOffset = tile_index % (unsigned long long)M;
-    unsigned long long tileSize = floor((unsigned long long)tile_index / M);
+std::shared_ptr<const Bundle>
+BundleCache::getBundle(unsigned lod, unsigned x, unsigned y) const
+{
+    ++_lookups;
+
+    BundleKey key(lod, x / _bundleSize, y / _bundleSize);
+
+    auto cached = _bundles.get(key);
+    if (cached.has_value())
+        return cached.value();
+
+    // Only one thread opens bundles at a time, so concurrent requests
+    // for the same new bundle share one mapping.
+    std::lock_guard<std::mutex> lock(_openMutex);
 
-    _in.seekg(tileOffset, std::ios::beg);
-    if (tileSize > 0)
+    cached = _bundles.get(key);
+    if (cached.has_value())
+        return cached.value();
+
+    std::shared_ptr<const Bundle> bundle;
+
+    std::string bundleFile = getBundleFileName(lod, x, y);
+    if (osgDB::fileExists(bundleFile))
     {
-        std::string imageData;
-        imageData.resize(tileSize);
-        _in.read(&imageData[0], tileSize);
-        osgEarth::MVT::readTile(imageData, key, features);
+        ++_opens;
+
+        std::shared_ptr<Bundle> reader;
+        if (_format == STORAGE_FORMAT_COMPACTV2)
+            reader = std::make_shared<BundleReader2>(bundleFile, _bundleSize);
+        else
+            reader = std::make_shared<BundleReader>(bundleFile, _bundleSize);
+
+        if (reader->valid())
+            bundle = reader;
+        else
+            OE_WARN << LC << "Failed to open bundle " << bundleFile << std::endl;
     }
-#else
-    OE_WARN << LC << "osgEarth is not built with MVT/PBF support" << std::endl;
-#endif
+
+    _bundles.insert(key, bundle);
+    return bundle;
+}
+
+BundleCache::Stats
+BundleCache::getStats() const
+{
+    Stats stats;
+    stats.capacity = _capacity;
+    stats.lookups = _lookups;
+    stats.opens = _opens;
+    return stats;
 }
 
 //........................................................................
@@ -315,6 +370,7 @@ ArcGISTilePackageImageLayer::Options::getConfig() const
 {
     Config conf = ImageLayer::Options::getConfig();
     conf.set("url", _url);
+    conf.set("max_open_bundles", _maxOpenBundles);
     return conf;
 }
 
@@ -322,11 +378,13 @@ void
 ArcGISTilePackageImageLayer::Options::fromConfig(const Config& conf)
 {
     conf.get("url", _url);
+    conf.get("max_open_bundles", _maxOpenBundles);
 }
 //........................................................................
 
 REGISTER_OSGEARTH_LAYER(arcgistilepackageimage, ArcGISTilePackageImageLayer);
 OE_LAYER_PROPERTY_IMPL(ArcGISTilePackageImageLayer, URI, URL, url);
+OE_LAYER_PROPERTY_IMPL(ArcGISTilePackageImageLayer, unsigned, MaxOpenBundles, maxOpenBundles);
 
 
 void
@@ -368,36 +426,32 @@ ArcGISTilePackageImageLayer::openImplementation()
         setProfile(profile);
     }
 
+    _bundles = std::make_unique<BundleCache>(
+        osgEarth::getFullPath(options().url()->full(), "_alllayers/"),
+        _storageFormat,
+        _bundleSize,
+        options().maxOpenBundles().get());
+
     return Status::NoError;
 }
 
+Status
+ArcGISTilePackageImageLayer::closeImplementation()
+{
+    _bundles = nullptr;
+    return ImageLayer::closeImplementation();
+}
+
 GeoImage
 ArcGISTilePackageImageLayer::createImageImplementation(const TileKey& key, ProgressCallback* progress) const
 {
-    std::stringstream buf;    
-    buf << osgEarth::getFullPath(options().url()->full(), "_alllayers/");
-    buf << "L" << padLeft(std::to_string(key.getLevelOfDetail()), 2) << "/";
-
-    unsigned int colOffset = static_cast<unsigned int>(floor(static_cast<double>(key.getTileX() / _bundleSize) * _bundleSize));
-    unsigned int rowOffset = static_cast<unsigned int>(floor(static_cast<double>(key.getTileY() / _bundleSize) * _bundleSize));
-
-    buf << "R" << padLeft(toHex(rowOffset), 4) << "C" << padLeft(toHex(colOffset), 4);
-    buf << ".bundle";
+    if (!_bundles)
+        return GeoImage::INVALID;
 
-    std::string bundleFile = buf.str();
-    if (osgDB::fileExists(bundleFile))
+    auto bundle = _bundles->getBundle(key.getLevelOfDetail(), key.getTileX(), key.getTileY());
+    if (bundle)
     {
-        osg::Image* result = NULL;
-        if (_storageFormat == STORAGE_FORMAT_COMPACT)
-        {
-            BundleReader reader(bundleFile, _bundleSize);
-            result = reader.readImage(key, _rw.get());
-        }
-        if (_storageFormat == STORAGE_FORMAT_COMPACTV2)
-        {
-            BundleReader2 reader(bundleFile, _bundleSize);
-            result = reader.readImage(key, _rw.get());
-        }
+        osg::Image* result = bundle->readImage(key, _rw.get());
         if (result)
         {
             return GeoImage(result, key.getExtent());
@@ -463,6 +517,7 @@ ArcGISTilePackageElevationLayer::Options::getConfig() const
 {
     Config conf = ElevationLayer::Options::getConfig();
     conf.set("url", _url);
+    conf.set("max_open_bundles", _maxOpenBundles);
     return conf;
 }
 
@@ -470,10 +525,12 @@ void
 ArcGISTilePackageElevationLayer::Options::fromConfig(const Config& conf)
 {
     conf.get("url", _url);
+    conf.get("max_open_bundles", _maxOpenBundles);
 }
 
 REGISTER_OSGEARTH_LAYER(arcgistilepackageelevation, ArcGISTilePackageElevationLayer);
 OE_LAYER_PROPERTY_IMPL(ArcGISTilePackageElevationLayer, URI, URL, url);
+OE_LAYER_PROPERTY_IMPL(ArcGISTilePackageElevationLayer, unsigned, MaxOpenBundles, maxOpenBundles);
 
 void
 ArcGISTilePackageElevationLayer::init()
@@ -514,40 +571,36 @@ ArcGISTilePackageElevationLayer::openImplementation()
         setProfile(profile);
     }
 
+    _bundles = std::make_unique<BundleCache>(
+        osgEarth::getFullPath(options().url()->full(), "_alllayers/"),
+        _storageFormat,
+        _bundleSize,
+        options().maxOpenBundles().get());
+
     return Status::NoError;
 }
 
+Status
+ArcGISTilePackageElevationLayer::closeImplementation()
+{
+    _bundles = nullptr;
+    return ElevationLayer::closeImplementation();
+}
+
 GeoHeightField
 ArcGISTilePackageElevationLayer::createHeightFieldImplementation(const TileKey& key, ProgressCallback* progress) const
 {
-    std::stringstream buf;
-    buf << osgEarth::getFullPath(options().url()->full(), "_alllayers/");
-    buf << "L" << padLeft(std::to_string(key.getLevelOfDetail()), 2) << "/";
-
-    unsigned int colOffset = static_cast<unsigned int>(floor(static_cast<double>(key.getTileX() / _bundleSize) * _bundleSize));
-    unsigned int rowOffset = static_cast<unsigned int>(floor(static_cast<double>(key.getTileY() / _bundleSize) * _bundleSize));
-
-    buf << "R" << padLeft(toHex(rowOffset), 4) << "C" << padLeft(toHex(colOffset), 4);
-    buf << ".bundle";
+    if (!_bundles)
+        return GeoHeightField::INVALID;
 
-    std::string bundleFile = buf.str();
-    if (osgDB::fileExists(bundleFile))
+    auto bundle = _bundles->getBundle(key.getLevelOfDetail(), key.getTileX(), key.getTileY());
+    if (bundle)
     {
-        osg::Image* result = NULL;
-        if (_storageFormat == STORAGE_FORMAT_COMPACT)
-        {
-            BundleReader reader(bundleFile, _bundleSize);
-            result = reader.readImage(key, _rw.get());
-        }
-        if (_storageFormat == STORAGE_FORMAT_COMPACTV2)
-        {
-            BundleReader2 reader(bundleFile, _bundleSize);
-            result = reader.readImage(key, _rw.get());
-        }
-        if (result)
+        osg::ref_ptr<osg::Image> result = bundle->readImage(key, _rw.get());
+        if (result.valid())
         {
             ImageToHeightFieldConverter conv;
-            osg::HeightField* hf = conv.convert(result);
+            osg::HeightField* hf = conv.convert(result.get());
             return GeoHeightField(hf, key.getExtent());
         }
     }
@@ -609,6 +662,7 @@ ArcGISTilePackageElevationLayer::readConf()
 REGISTER_OSGEARTH_LAYER(vtpkfeatures, VTPKFeatureSource);
 
 OE_LAYER_PROPERTY_IMPL(VTPKFeatureSource, URI, URL, url);
+OE_LAYER_PROPERTY_IMPL(VTPKFeatureSource, unsigned, MaxOpenBundles, maxOpenBundles);
 
 Status
 VTPKFeatureSource::openImplementation()
@@ -666,10 +720,22 @@ VTPKFeatureSource::openImplementation()
     featureProfile->geoInterp() = osgEarth::GEOINTERP_GREAT_CIRCLE;
     setFeatureProfile(featureProfile);
 
+    _bundles = std::make_unique<BundleCache>(
+        options().url()->full() + "/p12/tile/",
+        _storageFormat,
+        _bundleSize,
+        options().maxOpenBundles().get());
 
     return Status::NoError;
 }
 
+Status
+VTPKFeatureSource::closeImplementation()
+{
+    _bundles = nullptr;
+    return FeatureSource::closeImplementation();
+}
+
 void
 VTPKFeatureSource::init()
 {
@@ -721,29 +787,13 @@ VTPKFeatureSource::createFeatureCursorImplementation(const Query& query, Progres
         z += 1;
     }
 
-    std::stringstream buf;
-    buf << options().url()->full() << "/p12/tile/";
-    buf << "L" << padLeft(std::to_string(z), 2) << "/";
-
-    unsigned int colOffset = static_cast<unsigned int>(floor(static_cast<double>(x / _bundleSize) * _bundleSize));
-    unsigned int rowOffset = static_cast<unsigned int>(floor(static_cast<double>(y / _bundleSize) * _bundleSize));
-
-    buf << "R" << padLeft(toHex(rowOffset), 4) << "C" << padLeft(toHex(colOffset), 4);
-    buf << ".bundle";
-
     FeatureList features;
-    std::string bundleFile = buf.str();
-    if (osgDB::fileExists(bundleFile))
+    if (_bundles)
     {
-        if (_storageFormat == STORAGE_FORMAT_COMPACT)
-        {
-            BundleReader reader(bundleFile, _bundleSize);
-            reader.readFeatures(key, features);
-        }
-        if (_storageFormat == STORAGE_FORMAT_COMPACTV2)
+        auto bundle = _bundles->getBundle(z, x, y);
+        if (bundle)
         {
-            BundleReader2 reader(bundleFile, _bundleSize);
-            reader.readFeatures(key, features);
+            bundle->readFeatures(key, features);
         }
     }
 
@@ -759,6 +809,7 @@ VTPKFeatureSource::Options::getConfig() const
 {
     Config conf = FeatureSource::Options::getConfig();
     conf.set("url", url());
+    conf.set("max_open_bundles", maxOpenBundles());
     return conf;
 }
 
@@ -766,4 +817,5 @@ void
 VTPKFeatureSource::Options::fromConfig(const Config& conf)
 {
     conf.get("url", url());
+    conf.get("max_open_bundles", maxOpenBundles());
 }
@@ -4,6 +4,7 @@
  */
 #include <osgEarth/Cache>
 #include <osgEarth/Registry>
+#include <osgEarth/TieredCache>
 #include <osgEarth/Utils>
 #include "sha1.hpp"
 #include <osgEarth/Notify>
@@ -193,6 +194,10 @@ CacheFactory::create( const CacheOptions& options )
     {
         OE_WARN << LC << "Sorry, but TMS caching is no longer supported; try \"filesystem\" instead" << std::endl;
     }
+    else if ( options.getDriver() == "tiered" )
+    {
+        result = new TieredCache( TieredCacheOptions(options) );
+    }
     else // try to load from a plugin
     {
         osg::ref_ptr<osgDB::Options> rwopt = Registry::cloneOrCreateOptions();
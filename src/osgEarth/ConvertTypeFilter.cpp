@@ -65,3 +65,14 @@ ConvertTypeFilter::push( FeatureList& input, FilterContext& context )
 
     return context;
 }
+
+FilterContext
+ConvertTypeFilter::pushBatch( FeatureBatch& input, FilterContext& context )
+{
+    if (_toType != Geometry::TYPE_UNKNOWN)
+    {
+        input.convertType(_toType.value());
+    }
+
+    return context;
+}
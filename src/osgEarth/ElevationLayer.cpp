@@ -417,6 +417,11 @@ ElevationLayer::createHeightFieldInKeyProfile(const TileKey& key, ProgressCallba
                 key.getExtent());
 
             fromMemCache = true;
+            ++_memCacheHits;
+        }
+        else
+        {
+            ++_memCacheMisses;
         }
     }
 
@@ -452,6 +457,11 @@ ElevationLayer::createHeightFieldInKeyProfile(const TileKey& key, ProgressCallba
                     }
                 }
             }
+
+            if (fromCache)
+                ++_cacheHits;
+            else
+                ++_cacheMisses;
         }
 
         // if we're cache-only, but didn't get data from the cache, fail silently.
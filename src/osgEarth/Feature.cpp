@@ -93,7 +93,7 @@ Feature::Feature(Geometry* geom, const SpatialReference* srs, const Style& style
 
 Feature::Feature(const Feature& rhs) :
     _fid(rhs._fid),
-    _attrs(rhs._attrs),
+    _attrs(rhs.attrs()),
     _style(rhs._style),
     _geoInterp(rhs._geoInterp),
     _srs(rhs._srs.get())
@@ -104,6 +104,39 @@ Feature::Feature(const Feature& rhs) :
         _geom = rhs._geom->clone();
 }
 
+Feature*
+Feature::copyOnWrite() const
+{
+    Feature* f = new Feature(_fid);
+    f->_geom = _geom;
+    f->_geomShared = _geom.valid();
+    f->_srs = _srs;
+    f->_attrsOwner = _attrsOwner.valid() ? _attrsOwner.get() : this;
+    f->_style = _style;
+    f->_geoInterp = _geoInterp;
+    return f;
+}
+
+void
+Feature::detachGeometry()
+{
+    // another feature still references this geometry; take a private copy.
+    if (_geom.valid() && _geom->referenceCount() > 1)
+        _geom = _geom->clone();
+    _geomShared = false;
+}
+
+AttributeTable&
+Feature::writableAttrs()
+{
+    if (_attrsOwner.valid())
+    {
+        _attrs = _attrsOwner->_attrs;
+        _attrsOwner = nullptr;
+    }
+    return _attrs;
+}
+
 void
 Feature::setFID(FeatureID fid)
 {
@@ -131,6 +164,7 @@ Feature::setGeometry( Geometry* geom )
 {
     OE_HARD_ASSERT(geom != nullptr);
     _geom = geom;
+    _geomShared = false;
 }
 
 void
@@ -155,96 +189,96 @@ Feature::getOrCreateStyle()
 void
 Feature::set(const std::string& name, const std::string& value)
 {
-    _attrs[toLower(name)].emplace<std::string>(value);
+    writableAttrs()[toLower(name)].emplace<std::string>(value);
 }
 
 void
 Feature::set(const std::string& name, const char* value)
 {
-    _attrs[toLower(name)].emplace<std::string>(std::string(value));
+    writableAttrs()[toLower(name)].emplace<std::string>(std::string(value));
 }
 
 void
 Feature::set(const std::string& name, double value)
 {
-    _attrs[toLower(name)].emplace<double>(value);
+    writableAttrs()[toLower(name)].emplace<double>(value);
 }
 
 void
 Feature::set(const std::string& name, long long value)
 {
-    _attrs[toLower(name)].emplace<long long>(value);
+    writableAttrs()[toLower(name)].emplace<long long>(value);
 }
 
 void
 Feature::set(const std::string& name, int value)
 {
-    _attrs[toLower(name)].emplace<long long>(static_cast<long long>(value));
+    writableAttrs()[toLower(name)].emplace<long long>(static_cast<long long>(value));
 }
 
 void
 Feature::set(const std::string& name, bool value)
 {
-    _attrs[toLower(name)].emplace<bool>(value);
+    writableAttrs()[toLower(name)].emplace<bool>(value);
 }
 
 void
 Feature::set(const std::string& name, const AttributeValue& value)
 {
-    _attrs[toLower(name)] = value;
+    writableAttrs()[toLower(name)] = value;
 }
 
 void
 Feature::setNull(const std::string& name)
 {
-    _attrs[toLower(name)].emplace<std::monostate>();
+    writableAttrs()[toLower(name)].emplace<std::monostate>();
 }
 
 void
 Feature::removeAttribute(const std::string& name)
 {
-    _attrs.erase(toLower(name));
+    writableAttrs().erase(toLower(name));
 }
 
 bool
 Feature::hasAttr( const std::string& name ) const
 {
-    return _attrs.find(toLower(name)) != _attrs.end();
+    return attrs().find(toLower(name)) != attrs().end();
 }
 
 std::string
 Feature::getString( const std::string& name ) const
 {
-    auto i = _attrs.find(toLower(name));
-    return i != _attrs.end()? i->second.getString() : EMPTY_STRING;
+    auto i = attrs().find(toLower(name));
+    return i != attrs().end()? i->second.getString() : EMPTY_STRING;
 }
 
 double
 Feature::getDouble( const std::string& name, double defaultValue ) const
 {
-    auto i = _attrs.find(toLower(name));
-    return i != _attrs.end()? i->second.getDouble(defaultValue) : defaultValue;
+    auto i = attrs().find(toLower(name));
+    return i != attrs().end()? i->second.getDouble(defaultValue) : defaultValue;
 }
 
 long long
 Feature::getInt( const std::string& name, long long defaultValue ) const
 {
-    auto i = _attrs.find(toLower(name));
-    return i != _attrs.end()? i->second.getInt(defaultValue) : defaultValue;
+    auto i = attrs().find(toLower(name));
+    return i != attrs().end()? i->second.getInt(defaultValue) : defaultValue;
 }
 
 bool
 Feature::getBool( const std::string& name, bool defaultValue ) const
 {
-    auto i = _attrs.find(toLower(name));
-    return i != _attrs.end()? i->second.getBool(defaultValue) : defaultValue;
+    auto i = attrs().find(toLower(name));
+    return i != attrs().end()? i->second.getBool(defaultValue) : defaultValue;
 }
 
 bool
 Feature::isSet(const std::string& name) const
 {
-    auto i = _attrs.find(toLower(name));
-    return i != _attrs.end() ? i->second.getType() != ATTRTYPE_UNSPECIFIED : false;
+    auto i = attrs().find(toLower(name));
+    return i != attrs().end() ? i->second.getType() != ATTRTYPE_UNSPECIFIED : false;
 }
 
 #if 0
@@ -586,7 +620,8 @@ std::string Feature::featuresToGeoJSON(const FeatureList& features, bool include
 
 void Feature::transform( const SpatialReference* srs )
 {
-    if (!getGeometry())
+    // test the member directly so a no-op doesn't detach a shared geometry
+    if (!_geom.valid())
         return;
 
     if (!getSRS() || !srs)
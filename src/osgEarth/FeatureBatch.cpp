@@ -0,0 +1,338 @@
+/* osgEarth
+ * Copyright 2025 Pelican Mapping
+ * MIT License
+ */
+#include "FeatureBatch"
+#include <algorithm>
+
+#define LC "[FeatureBatch] "
+
+using namespace osgEarth;
+using namespace osgEarth::Util;
+
+namespace
+{
+    Geometry* createPart(Geometry::Type type, std::size_t capacity)
+    {
+        switch (type)
+        {
+        case Geometry::TYPE_POINT: return new Point(capacity);
+        case Geometry::TYPE_POINTSET: return new PointSet(capacity);
+        case Geometry::TYPE_LINESTRING: return new LineString(capacity);
+        case Geometry::TYPE_RING: return new Ring(capacity);
+        case Geometry::TYPE_POLYGON: return new Polygon(capacity);
+        default: return new PointSet(capacity);
+        }
+    }
+
+    void resize(FeatureBatch::Column& column, std::size_t rows)
+    {
+        switch (column.type)
+        {
+        case ATTRTYPE_DOUBLE: column.doubles.resize(rows, 0.0); break;
+        case ATTRTYPE_INT:
+        case ATTRTYPE_BOOL: column.ints.resize(rows, 0LL); break;
+        default: column.strings.resize(rows); break;
+        }
+        column.isSet.resize(rows, 0u);
+    }
+}
+
+FeatureBatch::FeatureBatch(const FeatureList& features, const FeatureSchema& schema)
+{
+    if (!schema.empty())
+    {
+        for (auto& entry : schema)
+        {
+            getOrCreateColumn(toLower(entry.first), entry.second);
+        }
+        _discoverSchema = false;
+    }
+
+    append(features);
+}
+
+void
+FeatureBatch::clear()
+{
+    _srs = nullptr;
+    _fids.clear();
+    _multi.clear();
+    _styles.clear();
+    _featureOffsets.assign(1, 0u);
+    _partOffsets.assign(1, 0u);
+    _partTypes.clear();
+    _partHoles.clear();
+    _coords.clear();
+    _schema.clear();
+    _columns.clear();
+    _discoverSchema = true;
+}
+
+int
+FeatureBatch::indexOf(const std::string& name) const
+{
+    return _schema.indexOf(name);
+}
+
+int
+FeatureBatch::getOrCreateColumn(const std::string& name, AttributeType type)
+{
+    int index = _schema.indexOf(name);
+    if (index < 0)
+    {
+        _schema[name] = type;
+        _columns.emplace_back();
+        _columns.back().type = type;
+        resize(_columns.back(), size());
+        index = (int)_columns.size() - 1;
+    }
+    return index;
+}
+
+void
+FeatureBatch::addPart(const Geometry* part, bool hole)
+{
+    Geometry::Type type = part->getType();
+    if (type == Geometry::TYPE_TRIMESH || type == Geometry::TYPE_UNKNOWN)
+        type = Geometry::TYPE_POINTSET;
+
+    _coords.insert(_coords.end(), part->begin(), part->end());
+    _partOffsets.push_back((std::uint32_t)_coords.size());
+    _partTypes.push_back(hole ? Geometry::TYPE_RING : type);
+    _partHoles.push_back(hole ? 1u : 0u);
+
+    if (type == Geometry::TYPE_POLYGON && !hole)
+    {
+        for (auto& h : static_cast<const Polygon*>(part)->getHoles())
+        {
+            if (h.valid())
+                addPart(h.get(), true);
+        }
+    }
+}
+
+void
+FeatureBatch::addGeometry(const Geometry* geom)
+{
+    ConstGeometryIterator iter(geom, false);
+    while (iter.hasMore())
+    {
+        addPart(iter.next(), false);
+    }
+}
+
+void
+FeatureBatch::append(const FeatureList& features)
+{
+    _fids.reserve(_fids.size() + features.size());
+    _multi.reserve(_fids.size() + features.size());
+    _styles.reserve(_fids.size() + features.size());
+
+    for (auto& feature_ref : features)
+    {
+        const Feature* feature = feature_ref.get();
+        if (!feature)
+            continue;
+
+        if (!_srs.valid())
+            _srs = feature->getSRS();
+
+        const std::size_t row = _fids.size();
+        _fids.push_back(feature->getFID());
+        _styles.push_back(feature->_style);
+
+        const Geometry* geom = feature->getGeometry();
+        _multi.push_back(geom && geom->getType() == Geometry::TYPE_MULTI ? 1u : 0u);
+
+        if (geom)
+        {
+            std::size_t firstCoord = _coords.size();
+            addGeometry(geom);
+
+            // bring the new vertices into the batch SRS if necessary:
+            if (feature->getSRS() && _srs.valid() && !feature->getSRS()->isEquivalentTo(_srs.get()))
+            {
+                std::vector<osg::Vec3d> temp(_coords.begin() + firstCoord, _coords.end());
+                feature->getSRS()->transform(temp, _srs.get());
+                std::copy(temp.begin(), temp.end(), _coords.begin() + firstCoord);
+            }
+        }
+
+        _featureOffsets.push_back((std::uint32_t)_partTypes.size());
+
+        // new row in every column, then fill in the attributes we have:
+        for (auto& column : _columns)
+            resize(column, row + 1);
+
+        for (auto& attr : feature->getAttrs())
+        {
+            const AttributeValue& value = attr.second;
+            if (value.getType() == ATTRTYPE_UNSPECIFIED)
+                continue;
+
+            int index = _discoverSchema ?
+                getOrCreateColumn(attr.first, value.getType()) :
+                _schema.indexOf(attr.first);
+
+            if (index < 0)
+                continue;
+
+            Column& column = _columns[index];
+            switch (column.type)
+            {
+            case ATTRTYPE_DOUBLE: column.doubles[row] = value.getDouble(); break;
+            case ATTRTYPE_INT: column.ints[row] = value.getInt(); break;
+            case ATTRTYPE_BOOL: column.ints[row] = value.getBool() ? 1LL : 0LL; break;
+            default: column.strings[row] = value.getString(); break;
+            }
+            column.isSet[row] = 1u;
+        }
+    }
+}
+
+void
+FeatureBatch::setCoords(std::vector<osg::Vec3d>&& coords, const std::vector<std::uint32_t>& partSizes)
+{
+    OE_SOFT_ASSERT_AND_RETURN(partSizes.size() == _partTypes.size(), void());
+
+    _coords = std::move(coords);
+    std::uint32_t offset = 0u;
+    for (std::size_t p = 0; p < partSizes.size(); ++p)
+    {
+        offset += partSizes[p];
+        _partOffsets[p + 1] = offset;
+    }
+    OE_SOFT_ASSERT(offset == _coords.size());
+}
+
+void
+FeatureBatch::convertType(Geometry::Type toType)
+{
+    OE_SOFT_ASSERT_AND_RETURN(toType != Geometry::TYPE_UNKNOWN && toType != Geometry::TYPE_MULTI, void());
+
+    std::vector<osg::Vec3d> coords;
+    coords.reserve(_coords.size());
+    std::vector<std::uint32_t> featureOffsets = { 0u };
+    std::vector<std::uint32_t> partOffsets = { 0u };
+    std::vector<Geometry::Type> partTypes;
+    std::vector<std::uint8_t> partHoles;
+    partTypes.reserve(_partTypes.size());
+    partHoles.reserve(_partHoles.size());
+
+    auto emit = [&](std::uint32_t p, Geometry::Type type, bool hole, bool closeLine, bool reverse)
+    {
+        auto begin = _coords.begin() + _partOffsets[p];
+        auto end = _coords.begin() + _partOffsets[p + 1];
+        std::size_t start = coords.size();
+        coords.insert(coords.end(), begin, end);
+        if (closeLine && end - begin > 1 && *begin != *(end - 1))
+            coords.push_back(*begin);
+        if (reverse)
+            std::reverse(coords.begin() + start, coords.end());
+        partOffsets.push_back((std::uint32_t)coords.size());
+        partTypes.push_back(type);
+        partHoles.push_back(hole ? 1u : 0u);
+    };
+
+    for (std::size_t i = 0; i < size(); ++i)
+    {
+        for (std::uint32_t p = firstPart(i); p < firstPart(i + 1); ++p)
+        {
+            Geometry::Type type = _partTypes[p];
+            bool isRing = type == Geometry::TYPE_RING || type == Geometry::TYPE_POLYGON;
+
+            if (_partHoles[p])
+            {
+                // holes survive polygon->polygon, and become reversed lines
+                // in a polygon->line conversion; otherwise they are dropped.
+                if (toType == Geometry::TYPE_POLYGON)
+                    emit(p, Geometry::TYPE_RING, true, false, false);
+                else if (toType == Geometry::TYPE_LINESTRING)
+                {
+                    emit(p, Geometry::TYPE_LINESTRING, false, true, true);
+                    _multi[i] = 1u;
+                }
+            }
+            else
+            {
+                emit(p, toType, false, isRing && toType == Geometry::TYPE_LINESTRING, false);
+            }
+        }
+        featureOffsets.push_back((std::uint32_t)partTypes.size());
+    }
+
+    _coords.swap(coords);
+    _featureOffsets.swap(featureOffsets);
+    _partOffsets.swap(partOffsets);
+    _partTypes.swap(partTypes);
+    _partHoles.swap(partHoles);
+}
+
+void
+FeatureBatch::toFeatures(FeatureList& output) const
+{
+    output.reserve(output.size() + size());
+
+    for (std::size_t i = 0; i < size(); ++i)
+    {
+        osg::ref_ptr<MultiGeometry> multi = _multi[i] ? new MultiGeometry() : nullptr;
+        osg::ref_ptr<Geometry> single;
+        Polygon* lastPolygon = nullptr;
+
+        for (std::uint32_t p = firstPart(i); p < firstPart(i + 1); ++p)
+        {
+            auto begin = _coords.begin() + _partOffsets[p];
+            auto end = _coords.begin() + _partOffsets[p + 1];
+
+            Geometry* part = createPart(_partTypes[p], end - begin);
+            part->insert(part->end(), begin, end);
+
+            if (_partHoles[p] && lastPolygon)
+            {
+                lastPolygon->getHoles().push_back(static_cast<Ring*>(part));
+                continue;
+            }
+
+            lastPolygon = _partTypes[p] == Geometry::TYPE_POLYGON ? static_cast<Polygon*>(part) : nullptr;
+
+            if (multi.valid())
+                multi->add(part);
+            else if (!single.valid())
+                single = part;
+            else
+            {
+                // more than one top-level part in a non-multi feature
+                multi = new MultiGeometry();
+                multi->add(single.get());
+                multi->add(part);
+                single = nullptr;
+            }
+        }
+
+        Geometry* geom = multi.valid() ? multi.get() : single.get();
+        if (!geom)
+            geom = new PointSet();
+
+        osg::ref_ptr<Feature> feature = new Feature(geom, _srs.get(), Style(), _fids[i]);
+        feature->_style = _styles[i];
+
+        for (int c = 0; c < (int)_columns.size(); ++c)
+        {
+            const Column& column = _columns[c];
+            if (!column.isSet[i])
+                continue;
+
+            AttributeValue& value = feature->_attrs[_schema._container[c].first];
+            switch (column.type)
+            {
+            case ATTRTYPE_DOUBLE: value.emplace<double>(column.doubles[i]); break;
+            case ATTRTYPE_INT: value.emplace<long long>(column.ints[i]); break;
+            case ATTRTYPE_BOOL: value.emplace<bool>(column.ints[i] != 0LL); break;
+            default: value.emplace<std::string>(column.strings[i]); break;
+            }
+        }
+
+        output.emplace_back(feature);
+    }
+}
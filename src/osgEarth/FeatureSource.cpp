@@ -26,6 +26,7 @@ FeatureSource::Options::getConfig() const
     conf.set("vdatum", vdatum());
     conf.set("buffer_width", bufferWidth(), bufferWidthAsPercentage());
     conf.set("auto_fid", autoFID());
+    conf.set("parallel_filters", parallelFilters());
 
     if (!filters().empty())
     {
@@ -50,6 +51,7 @@ FeatureSource::Options::fromConfig(const Config& conf)
     conf.get("vdatum", vdatum());
     conf.get("buffer_width", bufferWidth(), bufferWidthAsPercentage());
     conf.get("auto_fid", autoFID());
+    conf.get("parallel_filters", parallelFilters());
 
     for(auto& filterConf : conf.child("filters").children())
         filters().push_back(filterConf);
@@ -112,6 +114,7 @@ FeatureSource::openImplementation()
 
     // Create and initialize the filters.
     _filters = FeatureFilterChain::create(options().filters(), getReadOptions());
+    _filters.setParallel(options().parallelFilters().value());
     return _filters.getStatus();
 }
 
@@ -343,9 +346,11 @@ FeatureSource::createFeatureCursor(const Query& in_query, const FeatureFilterCha
 
                 if (cached_entry.has_value())
                 {
+                    // hand out copy-on-write handles; only features that are
+                    // later modified will pay for a deep copy.
                     FeatureList copy(cached_entry.value().size());
                     std::transform(cached_entry.value().begin(), cached_entry.value().end(), copy.begin(),
-                        [&](auto& feature) { return new Feature(*feature); });
+                        [&](auto& feature) { return feature->copyOnWrite(); });
                     result = new FeatureListCursor(std::move(copy));
                     fromCache = true;
                 }
@@ -466,12 +471,14 @@ FeatureSource::createFeatureCursor(const Query& in_query, const FeatureFilterCha
                 // TODO: If we have a persistent cache, write to that as well here
                 if (_featuresCache)
                 {
-                    // clone the list for caching:
-                    FeatureList clone(features.size());
-                    std::transform(features.begin(), features.end(), clone.begin(),
-                        [&](auto& feature) { return new Feature(*feature); });
-
-                    _featuresCache->insert(cache_key, clone);
+                    // The cache takes ownership of the originals (which are never
+                    // modified again) and the caller gets copy-on-write handles.
+                    FeatureList handles(features.size());
+                    std::transform(features.begin(), features.end(), handles.begin(),
+                        [&](auto& feature) { return feature->copyOnWrite(); });
+
+                    _featuresCache->insert(cache_key, features);
+                    features.swap(handles);
                 }
 
                 result = new FeatureListCursor(std::move(features));
@@ -25,6 +25,8 @@
 #  include <sys/utime.h>
 #else
 #  include <utime.h>
+#  include <fcntl.h>
+#  include <sys/mman.h>
 #endif
 
 
@@ -580,6 +582,82 @@ void DirectoryVisitor::traverse(const std::string& path )
 	}
 }
 
+/**************************************************/
+MappedFile::MappedFile(const std::string& filename)
+{
+#ifdef _WIN32
+    HANDLE file = ::CreateFileW(
+        osgDB::convertUTF8toUTF16(filename).c_str(),
+        GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return;
+
+    LARGE_INTEGER size;
+    if (!::GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    {
+        ::CloseHandle(file);
+        return;
+    }
+
+    HANDLE mapping = ::CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping == NULL)
+    {
+        ::CloseHandle(file);
+        return;
+    }
+
+    void* data = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (data == NULL)
+    {
+        ::CloseHandle(mapping);
+        ::CloseHandle(file);
+        return;
+    }
+
+    _file = file;
+    _mapping = mapping;
+    _data = static_cast<const char*>(data);
+    _size = (std::size_t)size.QuadPart;
+#else
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        return;
+
+    struct stat buf;
+    if (::fstat(fd, &buf) != 0 || buf.st_size <= 0)
+    {
+        ::close(fd);
+        return;
+    }
+
+    void* data = ::mmap(nullptr, (std::size_t)buf.st_size, PROT_READ, MAP_SHARED, fd, 0);
+
+    // the mapping holds its own reference to the file
+    ::close(fd);
+
+    if (data == MAP_FAILED)
+        return;
+
+    _data = static_cast<const char*>(data);
+    _size = (std::size_t)buf.st_size;
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+#ifdef _WIN32
+    if (_data)
+        ::UnmapViewOfFile(_data);
+    if (_mapping)
+        ::CloseHandle(_mapping);
+    if (_file)
+        ::CloseHandle(_file);
+#else
+    if (_data)
+        ::munmap(const_cast<char*>(_data), _size);
+#endif
+}
+
 /**************************************************/
 CollectFilesVisitor::CollectFilesVisitor()
 {
@@ -8,9 +8,12 @@
 #include <osgEarth/ECEF>
 #include <osgEarth/Registry>
 #include <osgEarth/GLUtils>
+#include <osgEarth/Threading>
 #include <osg/MatrixTransform>
 #include <osgDB/ReadFile>
 #include <mutex>
+#include <chrono>
+#include <iterator>
 
 using namespace osgEarth;
 using namespace osgEarth::Util;
@@ -29,11 +32,26 @@ void FeatureFilter::addedToMap(const class Map*)
 {
 }
 
+FilterContext
+FeatureFilter::pushBatch(FeatureBatch& input, FilterContext& context)
+{
+    FeatureList features;
+    input.toFeatures(features);
+    FilterContext output = push(features, context);
+    FeatureBatch result(features);
+    if (!result.getSRS())
+        result.setSRS(input.getSRS());
+    input = std::move(result);
+    return output;
+}
+
 /********************************************************************************/
 
 #undef LC
 #define LC "[FeatureFilterChain] "
 
+#define FILTER_POOL_NAME "oe.featurefilters"
+
 FeatureFilterChain
 FeatureFilterChain::create(const std::vector<ConfigOptions>& filters, const osgDB::Options* readOptions)
 {
@@ -60,6 +78,97 @@ FeatureFilterChain::create(const std::vector<ConfigOptions>& filters, const osgD
     return std::move(chain);
 }
 
+FilterContext
+FeatureFilterChain::push(FeatureList& input, FilterContext& context) const
+{
+    FilterContext temp = context;
+    for (auto& filter : *this)
+    {
+        temp = push(filter.get(), input, temp, _parallel, _minChunkSize);
+    }
+    return temp;
+}
+
+FilterContext
+FeatureFilterChain::push(FeatureFilter* filter, FeatureList& input, FilterContext& context, bool parallel, unsigned minChunkSize)
+{
+    OE_SOFT_ASSERT_AND_RETURN(filter != nullptr, context);
+
+    auto t0 = std::chrono::steady_clock::now();
+    std::size_t numFeatures = input.size();
+    unsigned numChunks = 1u;
+    FilterContext output;
+
+    if (parallel && filter->isDataParallel() && minChunkSize > 0u)
+    {
+        auto* pool = jobs::get_pool(FILTER_POOL_NAME, std::max(std::thread::hardware_concurrency(), 1u));
+        // the caller blocks on the chunks, so a worker must not steal
+        // a job that then waits on this pool
+        pool->set_can_steal_work(false);
+
+        // the calling thread processes one chunk itself. Fewer features
+        // than minChunkSize still make one chunk.
+        numChunks = std::max(1u, std::min(
+            (unsigned)(numFeatures / minChunkSize),
+            pool->concurrency() + 1u));
+    }
+
+    if (numChunks > 1u)
+    {
+        // split the input into contiguous chunks so the output order is deterministic.
+        std::vector<FeatureList> chunks(numChunks);
+        std::vector<FilterContext> contexts(numChunks, context);
+        std::size_t chunkSize = (numFeatures + numChunks - 1) / numChunks;
+
+        for (unsigned c = 0; c < numChunks; ++c)
+        {
+            auto begin = input.begin() + std::min(numFeatures, c * chunkSize);
+            auto end = input.begin() + std::min(numFeatures, (c + 1) * chunkSize);
+            chunks[c].reserve(end - begin);
+            std::move(begin, end, std::back_inserter(chunks[c]));
+        }
+
+        jobs::context job;
+        job.name = filter->name();
+        job.pool = jobs::get_pool(FILTER_POOL_NAME);
+        job.group = jobs::jobgroup::create();
+
+        for (unsigned c = 1; c < numChunks; ++c)
+        {
+            jobs::dispatch([filter, &chunks, &contexts, c]()
+                {
+                    contexts[c] = filter->push(chunks[c], contexts[c]);
+                }, job);
+        }
+
+        contexts[0] = filter->push(chunks[0], contexts[0]);
+
+        job.group->join();
+
+        input.clear();
+        for (auto& chunk : chunks)
+            std::move(chunk.begin(), chunk.end(), std::back_inserter(input));
+
+        output = contexts[0];
+    }
+    else
+    {
+        output = filter->push(input, context);
+    }
+
+    if (context.timings())
+    {
+        FilterTiming timing;
+        timing.filter = filter->name();
+        timing.features = numFeatures;
+        timing.chunks = numChunks;
+        timing.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        context.timings()->push_back(timing);
+    }
+
+    return output;
+}
+
 /********************************************************************************/
         
 #undef  LC
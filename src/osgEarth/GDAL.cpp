@@ -18,6 +18,8 @@
 
 #include <sstream>
 #include <thread>
+#include <chrono>
+#include <algorithm>
 
 #include <gdal.h>
 #include <gdalwarper.h>
@@ -1666,6 +1668,7 @@ GDAL_detail::Options::readFrom(const Config& conf)
     conf.get("interpolation", "cubicspline", _interpolation, osgEarth::INTERP_CUBICSPLINE);
     conf.get("coverage_uses_palette_index", coverageUsesPaletteIndex());
     conf.get("single_threaded", singleThreaded());
+    conf.get("max_open_datasets", maxOpenDatasets());
     conf.get("use_vrt", useVRT());
     conf.get("fallback_profile", fallbackProfile());
 
@@ -1692,18 +1695,166 @@ GDAL_detail::Options::writeTo(Config& conf) const
     conf.set("interpolation", "cubicspline", _interpolation, osgEarth::INTERP_CUBICSPLINE);
     conf.set("coverage_uses_palette_index", coverageUsesPaletteIndex());
     conf.set("single_threaded", singleThreaded());
+    conf.set("max_open_datasets", maxOpenDatasets());
     conf.set("fallback_profile", fallbackProfile());
 }
 
 //......................................................................
 
+GDAL_detail::DriverPool::Lease&
+GDAL_detail::DriverPool::Lease::operator=(Lease&& rhs)
+{
+    if (this != &rhs)
+    {
+        release();
+        _pool = rhs._pool;
+        _driver = std::move(rhs._driver);
+        rhs._pool = nullptr;
+        rhs._driver = nullptr;
+    }
+    return *this;
+}
+
+void
+GDAL_detail::DriverPool::Lease::release()
+{
+    if (_pool && _driver)
+    {
+        _pool->giveBack(std::move(_driver));
+    }
+    _pool = nullptr;
+    _driver = nullptr;
+}
+
+void
+GDAL_detail::DriverPool::setCapacity(unsigned value)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stats.capacity = std::max(value, 1u);
+    _returned.notify_all();
+}
+
+unsigned
+GDAL_detail::DriverPool::getCapacity() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stats.capacity;
+}
+
+void
+GDAL_detail::DriverPool::add(Driver::Ptr driver)
+{
+    if (driver)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _idle.emplace_back(std::move(driver));
+        ++_stats.open;
+        ++_stats.opens;
+        _returned.notify_one();
+    }
+}
+
+void
+GDAL_detail::DriverPool::giveBack(Driver::Ptr driver)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    --_stats.leased;
+
+    // if the capacity shrank while this driver was out, close it.
+    if (_stats.open > _stats.capacity)
+        --_stats.open;
+    else
+        _idle.emplace_back(std::move(driver));
+
+    _returned.notify_one();
+}
+
+GDAL_detail::DriverPool::Lease
+GDAL_detail::DriverPool::lease(const Factory& factory)
+{
+    Lease result;
+    result._pool = this;
+
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    if (_idle.empty() && _stats.open >= _stats.capacity)
+    {
+        auto t0 = std::chrono::steady_clock::now();
+        _returned.wait(lock, [this]() { return !_idle.empty() || _stats.open < _stats.capacity; });
+        ++_stats.waits;
+        _stats.waitSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    }
+
+    if (!_idle.empty())
+    {
+        result._driver = std::move(_idle.back());
+        _idle.pop_back();
+    }
+    else
+    {
+        // reserve a slot, then open the new driver outside the lock:
+        ++_stats.open;
+        lock.unlock();
+        Driver::Ptr driver = factory();
+        lock.lock();
+
+        if (!driver)
+        {
+            --_stats.open;
+            _returned.notify_one();
+            result._pool = nullptr;
+            return result;
+        }
+
+        ++_stats.opens;
+        result._driver = std::move(driver);
+    }
+
+    ++_stats.leased;
+    ++_stats.leases;
+    return result;
+}
+
+void
+GDAL_detail::DriverPool::clear()
+{
+    std::vector<Driver::Ptr> closing;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        closing.swap(_idle);
+        _stats.open -= std::min(_stats.open, (unsigned)closing.size());
+    }
+    // drivers close their datasets here, outside the lock
+}
+
+GDAL_detail::DriverPool::Stats
+GDAL_detail::DriverPool::getStats() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stats;
+}
+
+//......................................................................
+
 #undef LC
 #define LC "[GDAL] \"" << getName() << "\" "
 
 namespace
 {
+    // pool capacity for a layer
+    template<typename T>
+    unsigned getDriverPoolCapacity(const T* layer)
+    {
+        if (layer->options().singleThreaded() == true)
+            return 1u;
+        else if (layer->options().maxOpenDatasets().value() > 0u)
+            return layer->options().maxOpenDatasets().value();
+        else
+            return std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
     template<typename T>
-    Status openOnThisThread(
+    Status openDriver(
         const T* layer,
         GDAL_detail::Driver::Ptr& driver,
         osg::ref_ptr<const Profile>* in_out_profile,
@@ -1770,6 +1921,7 @@ OE_LAYER_PROPERTY_IMPL(GDALImageLayer, RasterInterpolation, Interpolation, inter
 
 void GDALImageLayer::setSingleThreaded(bool value) { options().singleThreaded() = value; }
 bool GDALImageLayer::getSingleThreaded() const { return options().singleThreaded().get(); }
+OE_LAYER_PROPERTY_IMPL(GDALImageLayer, unsigned, MaxOpenDatasets, maxOpenDatasets);
 
 
 void
@@ -1801,17 +1953,14 @@ GDALImageLayer::openImplementation()
         }
     }
 
-    // GDAL thread-safety requirement: each thread requires a separate GDALDataSet.
-    // So we just encapsulate the entire setup once per thread.
+    // GDAL thread-safety requirement: a GDALDataset may only be used by one thread
+    // at a time. So each read leases a driver (with its own dataset) from a bounded pool.
     // https://trac.osgeo.org/gdal/wiki/FAQMiscellaneous#IstheGDALlibrarythread-safe
-
-    // Note: no need to mutex the _driverSingleThreaded instance since we are in open
-    // and open is single-threaded by definition.
-    GDAL_detail::Driver::Ptr& driver = getSingleThreaded() ? _driverSingleThreaded : _driverPerThread.get();
+    GDAL_detail::Driver::Ptr driver;
 
     DataExtentList dataExtents;
 
-    Status s = openOnThisThread(
+    Status s = openDriver(
         this,
         driver,
         &profile,
@@ -1821,6 +1970,9 @@ GDALImageLayer::openImplementation()
     if (s.isError())
         return s;
 
+    _driverPool.setCapacity(getDriverPoolCapacity(this));
+    _driverPool.add(driver);
+
     // if the driver generated a valid profile, set it.
     if (profile.valid())
     {
@@ -1835,10 +1987,9 @@ GDALImageLayer::openImplementation()
 Status
 GDALImageLayer::closeImplementation()
 {
-    // safely shut down all per-thread handles.
+    // safely shut down all pooled handles.
     Util::ScopedWriteLock unique_lock(_createCloseMutex);
-    _driverPerThread.clear();
-    _driverSingleThreaded = nullptr;
+    _driverPool.clear();
 
     return ImageLayer::closeImplementation();
 }
@@ -1855,23 +2006,19 @@ GDALImageLayer::createImageImplementation(const TileKey& key, ProgressCallback*
     if (!isOpen())
         return GeoImage::INVALID;
 
-    GDAL_detail::Driver::Ptr& driver = getSingleThreaded() ? _driverSingleThreaded : _driverPerThread.get();
-
-    if (driver == nullptr)
-    {
-        // calling openImpl with NULL params limits the setup
-        // since we already called this during openImplementation
-        osg::ref_ptr<const Profile> profile = getProfile();
-        openOnThisThread(this, driver, &profile, nullptr, false);
-    }
+    auto driver = _driverPool.lease([this]()
+        {
+            // calling openDriver with NULL params limits the setup
+            // since we already called this during openImplementation
+            GDAL_detail::Driver::Ptr driver;
+            osg::ref_ptr<const Profile> profile = getProfile();
+            return openDriver(this, driver, &profile, nullptr, false).isOK() ? driver : nullptr;
+        });
 
-    if (driver != nullptr)
+    if (driver)
     {
         OE_PROFILING_ZONE;
 
-        // serialize acccess if we're in single-threaded mode
-        Util::scoped_lock_if lock(_singleThreadingMutex, getSingleThreaded());
-
         osg::ref_ptr<osg::Image> image = driver->createImage(
             key,
             options().tileSize().get(),
@@ -1912,6 +2059,7 @@ OE_LAYER_PROPERTY_IMPL(GDALElevationLayer, bool, UseVRT, useVRT);
 
 void GDALElevationLayer::setSingleThreaded(bool value) { options().singleThreaded() = value; }
 bool GDALElevationLayer::getSingleThreaded() const { return options().singleThreaded().get(); }
+OE_LAYER_PROPERTY_IMPL(GDALElevationLayer, unsigned, MaxOpenDatasets, maxOpenDatasets);
 
 void
 GDALElevationLayer::setExternalDataset(GDAL_detail::ExternalDataset* value)
@@ -1935,16 +2083,14 @@ GDALElevationLayer::openImplementation()
 
     osg::ref_ptr<const Profile> profile;
 
-    // GDAL thread-safety requirement: each thread requires a separate GDALDataSet.
-    // So we just encapsulate the entire setup once per thread.
+    // GDAL thread-safety requirement: a GDALDataset may only be used by one thread
+    // at a time. So each read leases a driver (with its own dataset) from a bounded pool.
     // https://trac.osgeo.org/gdal/wiki/FAQMiscellaneous#IstheGDALlibrarythread-safe
-
-    // Open the dataset temporarily to query the profile and extents.
-    GDAL_detail::Driver::Ptr& driver = getSingleThreaded() ? _driverSingleThreaded :  _driverPerThread.get();
+    GDAL_detail::Driver::Ptr driver;
 
     DataExtentList dataExtents;
 
-    Status s = openOnThisThread(
+    Status s = openDriver(
         this,
         driver,
         &profile,
@@ -1954,6 +2100,9 @@ GDALElevationLayer::openImplementation()
     if (s.isError())
         return s;
 
+    _driverPool.setCapacity(getDriverPoolCapacity(this));
+    _driverPool.add(driver);
+
     if (profile.valid())
         setProfile(profile.get());
 
@@ -1966,12 +2115,11 @@ GDALElevationLayer::openImplementation()
 Status
 GDALElevationLayer::closeImplementation()
 {
-    // safely shut down all per-thread handles. The mutex prevents closing
+    // safely shut down all pooled handles. The mutex prevents closing
     // while the layer is working on a create call.
     {
         Util::ScopedWriteLock unique_lock(_createCloseMutex);
-        _driverPerThread.clear();
-        _driverSingleThreaded = nullptr;
+        _driverPool.clear();
     }
 
     return ElevationLayer::closeImplementation();
@@ -1989,22 +2137,19 @@ GDALElevationLayer::createHeightFieldImplementation(const TileKey& key, Progress
     if (!isOpen())
         return GeoHeightField::INVALID;
 
-    GDAL_detail::Driver::Ptr& driver = getSingleThreaded() ? _driverSingleThreaded : _driverPerThread.get();
-
-    if (driver == nullptr)
-    {
-        // calling openImpl with NULL params limits the setup
-        // since we already called this during openImplementation
-        osg::ref_ptr<const Profile> profile = getProfile();
-        openOnThisThread(this, driver, &profile, nullptr, false);
-    }
+    auto driver = _driverPool.lease([this]()
+        {
+            // calling openDriver with NULL params limits the setup
+            // since we already called this during openImplementation
+            GDAL_detail::Driver::Ptr driver;
+            osg::ref_ptr<const Profile> profile = getProfile();
+            return openDriver(this, driver, &profile, nullptr, false).isOK() ? driver : nullptr;
+        });
 
-    if (driver != nullptr)
+    if (driver)
     {
         OE_PROFILING_ZONE;
 
-        Util::scoped_lock_if lock(_singleThreadingMutex, getSingleThreaded());
-
         osg::ref_ptr<osg::HeightField> heightfield;
 
         if (*_options->useVRT())
@@ -5,6 +5,7 @@
 #include "Geoid"
 #include "HeightFieldUtils"
 #include "Notify"
+#include <algorithm>
 
 #define LC "[Geoid] "
 
@@ -69,7 +70,12 @@ Geoid::getHeight(double lat_deg, double lon_deg, const RasterInterpolation& inte
 {
     float result = 0.0f;
 
-    if ( _valid && contains(_bounds, lon_deg, lat_deg))
+    if (interp == INTERP_BILINEAR)
+    {
+        getHeights(&lat_deg, &lon_deg, 1u, &result);
+    }
+
+    else if ( _valid && contains(_bounds, lon_deg, lat_deg))
     {
         double width = _bounds.xMax() - _bounds.xMin();
         double height = _bounds.yMax() - _bounds.yMin();
@@ -81,6 +87,44 @@ Geoid::getHeight(double lat_deg, double lon_deg, const RasterInterpolation& inte
     return result;
 }
 
+void
+Geoid::getHeights(const double* lat_deg, const double* lon_deg, unsigned count, float* out_heights) const
+{
+    if (!_valid)
+    {
+        std::fill(out_heights, out_heights + count, 0.0f);
+        return;
+    }
+
+    // The height list is one contiguous row-major grid, so sample it
+    // directly instead of going through HeightFieldUtils per point.
+    // Loop body is branch-free so the compiler can vectorize it.
+    const float* grid = _hf->getHeightList().data();
+    const int cols = (int)_hf->getNumColumns();
+    const int rows = (int)_hf->getNumRows();
+    const double xmin = _bounds.xMin(), xmax = _bounds.xMax();
+    const double ymin = _bounds.yMin(), ymax = _bounds.yMax();
+    const double sx = (double)(cols - 1) / (xmax - xmin);
+    const double sy = (double)(rows - 1) / (ymax - ymin);
+
+    for (unsigned i = 0; i < count; ++i)
+    {
+        const double lon = lon_deg[i], lat = lat_deg[i];
+        const bool inside = lon >= xmin && lon <= xmax && lat >= ymin && lat <= ymax;
+
+        const double px = inside ? (lon - xmin) * sx : 0.0;
+        const double py = inside ? (lat - ymin) * sy : 0.0;
+        const int c0 = std::min((int)px, cols - 1), c1 = std::min(c0 + 1, cols - 1);
+        const int r0 = std::min((int)py, rows - 1), r1 = std::min(r0 + 1, rows - 1);
+        const double fx = px - (double)c0, fy = py - (double)r0;
+
+        const double h0 = (1.0 - fx) * grid[r0 * cols + c0] + fx * grid[r0 * cols + c1];
+        const double h1 = (1.0 - fx) * grid[r1 * cols + c0] + fx * grid[r1 * cols + c1];
+
+        out_heights[i] = inside ? (float)((1.0 - fy) * h0 + fy * h1) : 0.0f;
+    }
+}
+
 bool
 Geoid::isEquivalentTo( const Geoid& rhs ) const
 {
@@ -56,7 +56,8 @@ _optimizeVertexOrdering( true ),
 _validate              ( false ),
 _maxPolyTilingAngle    ( 45.0f ),
 _useOSGTessellator     ( false ),
-_buildKDTrees          ( true )
+_buildKDTrees          ( true ),
+_parallelFilters       ( false )
 {
     //nop
 }
@@ -77,7 +78,8 @@ _optimizeVertexOrdering( s_defaults.optimizeVertexOrdering().value() ),
 _validate              ( s_defaults.validate().value() ),
 _maxPolyTilingAngle    ( s_defaults.maxPolygonTilingAngle().value() ),
 _useOSGTessellator     (s_defaults.useOSGTessellator().value()),
-_buildKDTrees          ( s_defaults.buildKDTrees().value() )
+_buildKDTrees          ( s_defaults.buildKDTrees().value() ),
+_parallelFilters       ( s_defaults.parallelFilters().value() )
 {
     fromConfig(conf.getConfig());
 }
@@ -100,6 +102,7 @@ GeometryCompilerOptions::fromConfig( const Config& conf )
     conf.get( "max_polygon_tiling_angle", _maxPolyTilingAngle );
     conf.get( "use_osg_tessellator", _useOSGTessellator);
     conf.get( "build_kdtrees", _buildKDTrees );
+    conf.get( "parallel_filters", _parallelFilters );
 
     conf.get( "shader_policy", "disable",  _shaderPolicy, SHADERPOLICY_DISABLE );
     conf.get( "shader_policy", "inherit",  _shaderPolicy, SHADERPOLICY_INHERIT );
@@ -125,6 +128,7 @@ GeometryCompilerOptions::getConfig() const
     conf.set( "max_polygon_tiling_angle", _maxPolyTilingAngle );
     conf.set( "use_osg_tessellator", _useOSGTessellator);
     conf.set( "build_kdtrees", _buildKDTrees );
+    conf.set( "parallel_filters", _parallelFilters );
 
     conf.set( "shader_policy", "disable",  _shaderPolicy, SHADERPOLICY_DISABLE );
     conf.set( "shader_policy", "inherit",  _shaderPolicy, SHADERPOLICY_INHERIT );
@@ -307,7 +311,7 @@ GeometryCompiler::compile(FeatureList&          workingSet,
         {
             resample.maxLength() = *_options.resampleMaxLength();
         }
-        sharedCX = resample.push( workingSet, sharedCX );
+        sharedCX = FeatureFilterChain::push( &resample, workingSet, sharedCX, _options.parallelFilters().value() );
         if ( trackHistory ) history.push_back( "resample" );
     }
 
@@ -343,7 +347,7 @@ GeometryCompiler::compile(FeatureList&          workingSet,
         else if ( instance->placement() == InstanceSymbol::PLACEMENT_CENTROID )
         {
             CentroidFilter centroid;
-            localCX = centroid.push( workingSet, localCX );
+            localCX = FeatureFilterChain::push( &centroid, workingSet, localCX, _options.parallelFilters().value() );
             if ( trackHistory ) history.push_back( "centroid" );
         }
 
@@ -351,7 +355,7 @@ GeometryCompiler::compile(FeatureList&          workingSet,
         {
             AltitudeFilter clamp;
             clamp.setPropertiesFromStyle( style );
-            localCX = clamp.push( workingSet, localCX );
+            localCX = FeatureFilterChain::push( &clamp, workingSet, localCX, _options.parallelFilters().value() );
             if ( trackHistory ) history.push_back( "altitude" );
         }
 
@@ -384,7 +388,7 @@ GeometryCompiler::compile(FeatureList&          workingSet,
         {
             AltitudeFilter clamp;
             clamp.setPropertiesFromStyle( style );
-            sharedCX = clamp.push( workingSet, sharedCX );
+            sharedCX = FeatureFilterChain::push( &clamp, workingSet, sharedCX, _options.parallelFilters().value() );
             if ( trackHistory ) history.push_back( "altitude" );
             altRequired = false;
         }
@@ -414,7 +418,7 @@ GeometryCompiler::compile(FeatureList&          workingSet,
         {
             AltitudeFilter clamp;
             clamp.setPropertiesFromStyle( style );
-            sharedCX = clamp.push( workingSet, sharedCX );
+            sharedCX = FeatureFilterChain::push( &clamp, workingSet, sharedCX, _options.parallelFilters().value() );
             if ( trackHistory ) history.push_back( "altitude" );
             altRequired = false;
         }
@@ -461,7 +465,7 @@ GeometryCompiler::compile(FeatureList&          workingSet,
         {
             AltitudeFilter clamp;
             clamp.setPropertiesFromStyle( style );
-            sharedCX = clamp.push( workingSet, sharedCX );
+            sharedCX = FeatureFilterChain::push( &clamp, workingSet, sharedCX, _options.parallelFilters().value() );
             if ( trackHistory ) history.push_back( "altitude" );
             altRequired = false;
         }
@@ -401,6 +401,43 @@ ImageLayer::createImage(const TileKey& key, ProgressCallback* progress)
     return result;
 }
 
+ReadResult
+ImageLayer::readEncodedImage(const TileKey& key, ProgressCallback* progress)
+{
+    if (!isOpen() || !isKeyInLegalRange(key))
+    {
+        return ReadResult(ReadResult::RESULT_NOT_FOUND);
+    }
+
+    // The source bytes are only usable if nothing would alter the decoded image:
+    if (!key.getProfile()->isHorizEquivalentTo(getProfile()) ||
+        getUpsample() == true ||
+        _nodataImage.valid() ||
+        onCreate ||
+        !_postLayers.empty())
+    {
+        return ReadResult(ReadResult::RESULT_NOT_IMPLEMENTED);
+    }
+
+    // ...and only if createImage() would go straight to the source. With a cache
+    // in play, or a key outside the data extents, let createImage() apply the
+    // cache policy and the extents.
+    CacheSettings* cacheSettings = getCacheSettings();
+    bool cacheActive = cacheSettings && (
+        cacheSettings->cachePolicy()->isCacheOnly() ||
+        (!cacheSettings->cachePolicy()->isCacheDisabled() && cacheSettings->getCacheBin() != nullptr));
+
+    if (cacheActive || _memCache.valid() || !mayHaveData(key))
+    {
+        return ReadResult(ReadResult::RESULT_NOT_IMPLEMENTED);
+    }
+
+    NetworkMonitor::ScopedRequestLayer layerRequest(getName());
+
+    Threading::ScopedReadLock lock(inUseMutex());
+    return readEncodedImageImplementation(key, progress);
+}
+
 GeoImage
 ImageLayer::applyPostLayer(const GeoImage& canvas, const TileKey& key, Layer* post, ProgressCallback* progress) const
 {
@@ -465,8 +502,10 @@ ImageLayer::createImageInKeyProfile(const TileKey& key, ProgressCallback* progre
         ReadResult result = bin->readObject(memCacheKey, nullptr);
         if (result.succeeded())
         {
+            ++_memCacheHits;
             return GeoImage(static_cast<osg::Image*>(result.releaseObject()), key.getExtent());
         }
+        ++_memCacheMisses;
     }
 
     // locate the cache bin for the target profile for this layer:
@@ -493,9 +532,11 @@ ImageLayer::createImageInKeyProfile(const TileKey& key, ProgressCallback* progre
             bool expired = policy.isExpired(r.lastModifiedTime());
             if (!expired)
             {
+                ++_cacheHits;
                 return GeoImage(cachedImage.get(), key.getExtent());
             }
         }
+        ++_cacheMisses;
     }
 
     // The data was not in the cache. If we are cache-only, fail sliently
@@ -854,7 +895,7 @@ FutureTexture2D::dispatch() const
         };
 
     jobs::context context{
-        Stringify() << key.str() << " " << _layer->getName(),
+        _layer->getName(),
         jobs::get_pool(ARENA_ASYNC_LAYER), // pool
         [key]() { return key.getLOD(); }
     };
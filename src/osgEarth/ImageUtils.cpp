@@ -13,6 +13,8 @@
 #include <osgDB/Registry>
 
 #include <osg/ValueObject>
+#include <cstdint>
+#include <vector>
 
 #define LC "[ImageUtils] "
 
@@ -435,6 +437,116 @@ ImageUtils::bicubicUpsample(const osg::Image* source,
     return true;
 }
 
+namespace
+{
+    // One output row of a 2x2 box filter on 8-bit data with C channels.
+    // "sums" is scratch space for s*C values.
+    // gluScaleImage widens 8-bit values to 16 bits (x257), averages with
+    // rounding and narrows back (>>8): ((257*S + 2) >> 10) for a 2x2 sum S.
+    // (S + ((S + 2) >> 8)) >> 2 is the same value for every S in [0, 1020]
+    // and stays within 16 bits, so the output matches it exactly.
+    template<int C>
+    void halveRow(const std::uint8_t* r0, const std::uint8_t* r1, std::uint16_t* sums, std::uint8_t* out, int s)
+    {
+        const int n = s * C;
+        for (int i = 0; i < n; ++i)
+            sums[i] = (std::uint16_t)(r0[i] + r1[i]);
+
+        const int outWidth = s / 2;
+        for (int j = 0; j < outWidth; ++j)
+        {
+            for (int k = 0; k < C; ++k)
+            {
+                unsigned sum = (unsigned)sums[2 * j * C + k] + (unsigned)sums[2 * j * C + C + k];
+                out[j * C + k] = (std::uint8_t)((sum + ((sum + 2u) >> 8)) >> 2);
+            }
+        }
+    }
+
+    // One output row of a 2x2 box filter on float data with C channels.
+    // Averages in full precision; gluScaleImage quantizes to 16 bits and
+    // clamps to [0..1] on the way.
+    template<int C>
+    void halveRow(const float* r0, const float* r1, float* sums, float* out, int s)
+    {
+        const int n = s * C;
+        for (int i = 0; i < n; ++i)
+            sums[i] = r0[i] + r1[i];
+
+        const int outWidth = s / 2;
+        for (int j = 0; j < outWidth; ++j)
+        {
+            for (int k = 0; k < C; ++k)
+            {
+                out[j * C + k] = (sums[2 * j * C + k] + sums[2 * j * C + C + k]) * 0.25f;
+            }
+        }
+    }
+
+    template<typename T, typename SUM>
+    void halveLevel(const T* src, T* dst, int s, int t, int components)
+    {
+        std::vector<SUM> sums(s * components);
+        const int rowSize = s * components;
+        const int outRowSize = (s / 2) * components;
+
+        for (int j = 0; j < t / 2; ++j)
+        {
+            const T* r0 = src + (2 * j) * rowSize;
+            const T* r1 = r0 + rowSize;
+            T* out = dst + j * outRowSize;
+
+            switch (components)
+            {
+            case 1: halveRow<1>(r0, r1, sums.data(), out, s); break;
+            case 2: halveRow<2>(r0, r1, sums.data(), out, s); break;
+            case 3: halveRow<3>(r0, r1, sums.data(), out, s); break;
+            default: halveRow<4>(r0, r1, sums.data(), out, s); break;
+            }
+        }
+    }
+
+    // Builds the next mipmap level (s/2 x t/2) from level data of size s x t
+    // with a 2x2 box filter, in loops written for the compiler to vectorize.
+    // Handles 8-bit and float images whose rows carry no padding; returns
+    // false for anything else so the caller can fall back on gluScaleImage.
+    bool halveImage(const osg::Image* image, const unsigned char* src, int s, int t, unsigned char* dst)
+    {
+        if (s < 2 || t < 2 || (s & 1) || (t & 1))
+            return false;
+
+        if (image->getRowLength() != 0 && image->getRowLength() != image->s())
+            return false;
+
+        GLenum type = image->getDataType();
+        if (type != GL_UNSIGNED_BYTE && type != GL_FLOAT)
+            return false;
+
+        int components = osg::Image::computeNumComponents(image->getPixelFormat());
+        if (components < 1 || components > 4)
+            return false;
+
+        int bytesPerComponent = (type == GL_FLOAT ? 4 : 1);
+        int packing = std::max((int)image->getPacking(), 1);
+        if ((s * components * bytesPerComponent) % packing != 0 ||
+            ((s / 2) * components * bytesPerComponent) % packing != 0)
+            return false;
+
+        if (type == GL_UNSIGNED_BYTE)
+        {
+            halveLevel<std::uint8_t, std::uint16_t>(src, dst, s, t, components);
+        }
+        else
+        {
+            halveLevel<float, float>(
+                reinterpret_cast<const float*>(src),
+                reinterpret_cast<float*>(dst),
+                s, t, components);
+        }
+        return true;
+    }
+}
+
 // helper function for calculating memory requirements and mipmap offsets of an
 // image without mipmaps.
 //
@@ -550,6 +662,16 @@ ImageUtils::mipmapImage(const osg::Image* input, int minLevelSize)
 
     for(int level=1; level<numLevels; ++level)
     {
+        if (halveImage(
+            output,
+            output->getMipmapData(level - 1),
+            output->s() >> (level - 1),
+            output->t() >> (level - 1),
+            output->getMipmapData(level)))
+        {
+            continue;
+        }
+
 #if 0
         // Build mipmaps based on the full resolution image
         // OSG-custom gluScaleImage that does not require a graphics context
@@ -650,16 +772,23 @@ ImageUtils::mipmapImageInPlace(osg::Image* input)
     psm.pack_row_length = input->getRowLength();
     psm.unpack_alignment = input->getPacking();
 
+    // Build each level from the previous one, like mipmapImage does
     for(int level=1; level<numLevels; ++level)
     {
+        int prev_s = std::max(input->s() >> (level - 1), 1);
+        int prev_t = std::max(input->t() >> (level - 1), 1);
+
+        if (halveImage(input, input->getMipmapData(level - 1), prev_s, prev_t, input->getMipmapData(level)))
+            continue;
+
         // OSG-custom gluScaleImage that does not require a graphics context
         GLint status = gluScaleImage(
             &psm,
             input->getPixelFormat(),
-            input->s(),
-            input->t(),
+            prev_s,
+            prev_t,
             input->getDataType(),
-            input->data(),
+            input->getMipmapData(level - 1),
             std::max(input->s() >> level, 1),
             std::max(input->t() >> level, 1),
             input->getDataType(),
@@ -11,6 +11,7 @@
 
 #include <gdal.h>
 #include <queue>
+#include <algorithm>
 
 #ifdef OSGEARTH_HAVE_SUPERLUMINALAPI
 #include <Superluminal/PerformanceAPI.h>
@@ -34,6 +35,18 @@ namespace osgEarth { namespace OGR
         return h;
     }
 
+    // lower-cased names of the fields in a layer or result set, by field index
+    void getFieldNames(OGRLayerH layer, std::vector<std::string>& output)
+    {
+        OGRFeatureDefnH def = OGR_L_GetLayerDefn(layer);
+        int count = OGR_FD_GetFieldCount(def);
+        output.reserve(count);
+        for (int i = 0; i < count; ++i)
+        {
+            output.push_back(osgEarth::toLower(std::string(OGR_Fld_GetNameRef(OGR_FD_GetFieldDefn(def, i)))));
+        }
+    }
+
     /**
      * Determine whether a point is valid or not.  Some shapefiles can have points that are ridiculously big, which are really invalid data
      * but shapefiles have no way of marking the data as invalid.  So instead we check for really large values that are indiciative of something being wrong.
@@ -80,6 +93,7 @@ OGR::OGRFeatureCursor::OGRFeatureCursor(
     const FeatureFilterChain& filters,
     bool rewindPolygons,
     unsigned chunkSize,
+    bool useArrowStream,
     ProgressCallback* progress) :
 
     FeatureCursor(progress),
@@ -190,9 +204,35 @@ OGR::OGRFeatureCursor::OGRFeatureCursor(
     _factory->srs = _profile->getSRS();
     _factory->interp = _profile->geoInterp();
     _factory->rewindPolygons = _rewindPolygons;
-    _factory->fieldNames.reserve(_source->getSchema().size());
-    for(auto& f : _source->getSchema())
-        _factory->fieldNames.push_back(f.first);
+    OGR::getFieldNames(static_cast<OGRLayerH>(_resultSetHandle), _factory->fieldNames);
+
+#ifdef OSGEARTH_HAVE_OGR_ARROW_STREAM
+    if (useArrowStream)
+    {
+        _arrowReader = new OGRArrowFeatureReader();
+        _arrowReader->srs = _factory->srs;
+        _arrowReader->interp = _factory->interp;
+        _arrowReader->rewindPolygons = _rewindPolygons;
+
+        if (!_arrowReader->open(static_cast<OGRLayerH>(_resultSetHandle), std::min(_chunkSize, 65536u)))
+        {
+            OE_DEBUG << LC << "No fast Arrow stream; reading one feature at a time" << std::endl;
+            delete _arrowReader;
+            _arrowReader = nullptr;
+            OGR_L_ResetReading(static_cast<OGRLayerH>(_resultSetHandle));
+        }
+    }
+#endif
+
+    // record which read path this cursor uses
+    auto ogrSource = dynamic_cast<const OGRFeatureSource*>(source);
+    if (ogrSource)
+    {
+        if (_arrowReader)
+            ogrSource->_arrowStreamCursors++;
+        else
+            ogrSource->_getNextFeatureCursors++;
+    }
 
     readChunk();
 }
@@ -217,6 +257,12 @@ OGR::OGRFeatureCursor::OGRFeatureCursor(void* resultSetHandle, const FeatureProf
 
 OGR::OGRFeatureCursor::~OGRFeatureCursor()
 {
+#ifdef OSGEARTH_HAVE_OGR_ARROW_STREAM
+    // the stream must be released before its layer
+    if (_arrowReader)
+        delete _arrowReader;
+#endif
+
     if ( _nextHandleToQueue )
         OGR_F_Destroy( static_cast<OGRFeatureH>(_nextHandleToQueue) );
 
@@ -270,8 +316,31 @@ OGR::OGRFeatureCursor::readChunk()
     while( _queue.size() < _chunkSize && !_resultSetEndReached )
     {
         FeatureList filterList;
-        OGRFeatureFactory factory;
-        while( filterList.size() < _chunkSize && !_resultSetEndReached )
+
+#ifdef OSGEARTH_HAVE_OGR_ARROW_STREAM
+        if (_arrowReader)
+        {
+            // one record batch at a time:
+            FeatureList batch;
+            if (_arrowReader->read(batch))
+            {
+                for (auto& feature : batch)
+                {
+                    if ((_source == NULL || !_source->isBlacklisted(feature->getFID())) &&
+                        validateGeometry(feature->getGeometry()))
+                    {
+                        filterList.push_back(feature);
+                    }
+                }
+            }
+            else
+            {
+                _resultSetEndReached = true;
+            }
+        }
+#endif
+
+        while( !_arrowReader && filterList.size() < _chunkSize && !_resultSetEndReached )
         {
             OGRFeatureH handle = OGR_L_GetNextFeature( static_cast<OGRLayerH>(_resultSetHandle) );
             if ( handle )
@@ -335,6 +404,8 @@ OGRFeatureSource::Options::getConfig() const
     conf.set("geometry_url", _geometryUrl);
     conf.set("layer", _layer);
     conf.set("query", _query);
+    conf.set("use_arrow_stream", _useArrowStream);
+    conf.set("attributes", _attributes);
     return conf;
 }
 
@@ -350,6 +421,8 @@ OGRFeatureSource::Options::fromConfig(const Config& conf)
     conf.get("geometry_url", _geometryUrl);
     conf.get("layer", _layer);
     conf.get("query", _query);
+    conf.get("use_arrow_stream", _useArrowStream);
+    conf.get("attributes", _attributes);
 }
 
 //........................................................................
@@ -363,6 +436,8 @@ OE_LAYER_PROPERTY_IMPL(OGRFeatureSource, std::string, OGRDriver, ogrDriver);
 OE_LAYER_PROPERTY_IMPL(OGRFeatureSource, URI, GeometryURL, geometryUrl);
 OE_LAYER_PROPERTY_IMPL(OGRFeatureSource, std::string, Layer, layer);
 OE_LAYER_PROPERTY_IMPL(OGRFeatureSource, Query, Query, query);
+OE_LAYER_PROPERTY_IMPL(OGRFeatureSource, bool, UseArrowStream, useArrowStream);
+OE_LAYER_PROPERTY_IMPL(OGRFeatureSource, std::string, Attributes, attributes);
 
 void
 OGRFeatureSource::init()
@@ -375,6 +450,7 @@ OGRFeatureSource::init()
     _needsSync = false;
     _writable = false;
     _geometryType = Geometry::TYPE_UNKNOWN;
+    _ignoredFields.clear();
 }
 
 Status
@@ -604,6 +680,7 @@ OGRFeatureSource::openImplementation()
 
         // establish the feature schema:
         initSchema();
+        applyIgnoredFields(_layerHandle);
 
         // establish the geometry type for this feature layer:
         OGRwkbGeometryType wkbType = OGR_FD_GetGeomType(OGR_L_GetLayerDefn(static_cast<OGRLayerH>(_layerHandle)));
@@ -777,7 +854,9 @@ OGRFeatureSource::create(const FeatureProfile* profile,
 
     OGRSpatialReferenceH ogrSRS = static_cast<OGRSpatialReferenceH>(profile->getSRS()->getHandle());
 
-    _layerHandle = GDALDatasetCreateLayer(static_cast<GDALDatasetH>(_dsHandle), "", ogrSRS, ogrGeomType, NULL);
+    // name the new layer after the layer option; drivers like GPKG need a
+    // name, and an unset option still passes an empty one
+    _layerHandle = GDALDatasetCreateLayer(static_cast<GDALDatasetH>(_dsHandle), options().layer().value().c_str(), ogrSRS, ogrGeomType, NULL);
 
     if (!_layerHandle)
     {
@@ -858,6 +937,7 @@ OGRFeatureSource::createFeatureCursorImplementation(const Query& query, Progress
         if (dsHandle)
         {
             layerHandle = OGR::openLayer(dsHandle, options().layer().get());
+            applyIgnoredFields(layerHandle);
         }
 
         if (dsHandle && layerHandle)
@@ -878,6 +958,7 @@ OGRFeatureSource::createFeatureCursorImplementation(const Query& query, Progress
                 getFilters(),
                 _options->rewindPolygons().get(),
                 0, // default chunksize
+                options().useArrowStream().value(),
                 progress
                 );
         }
@@ -933,9 +1014,7 @@ OGRFeatureSource::getFeature(FeatureID fid)
             factory.srs = getFeatureProfile()->getSRS();
             factory.interp = getFeatureProfile()->geoInterp();
             factory.rewindPolygons = _options->rewindPolygons().value();
-            factory.fieldNames.reserve(getSchema().size());
-            for (auto& f : getSchema())
-                factory.fieldNames.push_back(f.first);
+            OGR::getFieldNames(static_cast<OGRLayerH>(_layerHandle), factory.fieldNames);
 
             result = factory.createFeature(handle);
 
@@ -1051,13 +1130,45 @@ OGRFeatureSource::parseGeometryUrl(const URI& geomUrl, const osgDB::Options* dbO
 void
 OGRFeatureSource::initSchema()
 {
+    std::vector<std::string> subset;
+    if (options().attributes().isSet())
+    {
+        for (auto& name : StringTokenizer().delim(",").tokenize(options().attributes().value()))
+            subset.push_back(osgEarth::toLower(name));
+    }
+
     OGRFeatureDefnH layerDef = OGR_L_GetLayerDefn(static_cast<OGRLayerH>(_layerHandle));
     for (int i = 0; i < OGR_FD_GetFieldCount(layerDef); i++)
     {
         OGRFieldDefnH fieldDef = OGR_FD_GetFieldDefn(layerDef, i);
         std::string name;
         name = osgEarth::toLower(std::string(OGR_Fld_GetNameRef(fieldDef)));
+
+        // fields outside the requested subset are never read:
+        if (!subset.empty() && std::find(subset.begin(), subset.end(), name) == subset.end())
+        {
+            _ignoredFields.push_back(OGR_Fld_GetNameRef(fieldDef));
+            continue;
+        }
+
         OGRFieldType ogrType = OGR_Fld_GetType(fieldDef);
         _schema[name] = OgrUtils::getAttributeType(ogrType);
     }
 }
+
+void
+OGRFeatureSource::applyIgnoredFields(void* layerHandle) const
+{
+    if (layerHandle && !_ignoredFields.empty())
+    {
+        std::vector<const char*> names;
+        for (auto& name : _ignoredFields)
+            names.push_back(name.c_str());
+        names.push_back(nullptr);
+
+        if (OGR_L_SetIgnoredFields(static_cast<OGRLayerH>(layerHandle), names.data()) != OGRERR_NONE)
+        {
+            OE_DEBUG << LC << "Driver cannot ignore fields; reading all attributes" << std::endl;
+        }
+    }
+}
@@ -4,6 +4,9 @@
 */
 #include "OgrUtils"
 #include "Feature"
+#include "Endian"
+#include <cstring>
+#include <algorithm>
 
 #define LC "[FeatureSource] "
 
@@ -219,6 +222,252 @@ OgrUtils::createGeometry( OGRGeometryH geomHandle, bool rewindPolygons)
     return output;
 }
 
+namespace
+{
+    // Decodes OGC, ISO, or extended (PostGIS/OGR 2.5D) WKB into osgEarth
+    // geometry, producing the same results as OgrUtils::createGeometry.
+    struct WKBDecoder
+    {
+        const unsigned char* ptr;
+        const unsigned char* end;
+        bool rewindPolygons;
+        bool swap = false;
+        bool unsupported = false;
+
+        struct Header
+        {
+            std::uint32_t type = 0u;
+            unsigned dims = 2u;
+            bool hasZ = false;
+        };
+
+        template<typename T>
+        bool read(T& value)
+        {
+            if ((std::size_t)(end - ptr) < sizeof(T))
+                return false;
+            std::memcpy(&value, ptr, sizeof(T));
+            ptr += sizeof(T);
+            if (swap)
+            {
+                unsigned char* b = reinterpret_cast<unsigned char*>(&value);
+                std::reverse(b, b + sizeof(T));
+            }
+            return true;
+        }
+
+        bool readHeader(Header& h)
+        {
+            std::uint8_t order;
+            if (!read(order))
+                return false;
+
+#ifdef OE_IS_LITTLE_ENDIAN
+            swap = (order == 0u);
+#else
+            swap = (order == 1u);
+#endif
+
+            std::uint32_t code;
+            if (!read(code))
+                return false;
+
+            bool hasM = false;
+            if (code & 0x80000000u) h.hasZ = true;
+            if (code & 0x40000000u) hasM = true;
+            if (code & 0x20000000u)
+            {
+                std::uint32_t srid;
+                if (!read(srid))
+                    return false;
+            }
+            code &= 0x0fffffffu;
+
+            switch (code / 1000u)
+            {
+            case 1u: h.hasZ = true; break;
+            case 2u: hasM = true; break;
+            case 3u: h.hasZ = true, hasM = true; break;
+            default: break;
+            }
+
+            h.type = code % 1000u;
+            h.dims = 2u + (h.hasZ ? 1u : 0u) + (hasM ? 1u : 0u);
+            return true;
+        }
+
+        // same as OgrUtils::populate, including the removal of duplicates
+        bool readPoints(Geometry* target, std::uint32_t count, const Header& h)
+        {
+            if ((std::size_t)(end - ptr) / (h.dims * sizeof(double)) < count)
+                return false;
+
+            target->reserve(target->size() + count);
+            for (std::uint32_t i = 0; i < count; ++i)
+            {
+                double c[4] = { 0.0, 0.0, 0.0, 0.0 };
+                for (unsigned d = 0; d < h.dims; ++d)
+                    read(c[d]);
+
+                osg::Vec3d p(c[0], c[1], h.hasZ ? c[2] : 0.0);
+                if (target->size() == 0 || p != target->back())
+                    target->push_back(p);
+            }
+            return true;
+        }
+
+        bool readPoint(Geometry* target, const Header& h)
+        {
+            if ((std::size_t)(end - ptr) < h.dims * sizeof(double))
+                return false;
+
+            double c[4] = { 0.0, 0.0, 0.0, 0.0 };
+            for (unsigned d = 0; d < h.dims; ++d)
+                read(c[d]);
+
+            // an empty point is encoded as NaN coordinates
+            if (osg::isNaN(c[0]) && osg::isNaN(c[1]))
+                return true;
+
+            osg::Vec3d p(c[0], c[1], h.hasZ ? c[2] : 0.0);
+            if (target->size() == 0 || p != target->back())
+                target->push_back(p);
+            return true;
+        }
+
+        Geometry* readPolygon(const Header& h)
+        {
+            std::uint32_t numRings;
+            if (!read(numRings))
+                return nullptr;
+
+            osg::ref_ptr<osgEarth::Polygon> output = new osgEarth::Polygon();
+
+            for (std::uint32_t r = 0; r < numRings; ++r)
+            {
+                std::uint32_t numPoints;
+                if (!read(numPoints))
+                    return nullptr;
+
+                if (r == 0)
+                {
+                    if (!readPoints(output.get(), numPoints, h))
+                        return nullptr;
+                    if (rewindPolygons)
+                    {
+                        output->open();
+                        output->rewind(Ring::ORIENTATION_CCW);
+                    }
+                }
+                else
+                {
+                    osg::ref_ptr<Ring> hole = new Ring(numPoints);
+                    if (!readPoints(hole.get(), numPoints, h))
+                        return nullptr;
+                    if (rewindPolygons)
+                    {
+                        hole->open();
+                        hole->rewind(Ring::ORIENTATION_CW);
+                    }
+                    output->getHoles().push_back(hole.get());
+                }
+            }
+
+            return output.release();
+        }
+
+        Geometry* readGeometry()
+        {
+            Header h;
+            if (!readHeader(h))
+                return nullptr;
+
+            osg::ref_ptr<Geometry> output;
+            std::uint32_t count;
+
+            switch (h.type)
+            {
+            case 1u: // point
+                output = new Point();
+                if (!readPoint(output.get(), h))
+                    return nullptr;
+                break;
+
+            case 2u: // linestring
+                if (!read(count))
+                    return nullptr;
+                output = new LineString(count);
+                if (!readPoints(output.get(), count, h))
+                    return nullptr;
+                break;
+
+            case 3u: // polygon
+                output = readPolygon(h);
+                break;
+
+            case 4u: // multipoint
+                if (!read(count))
+                    return nullptr;
+                output = new PointSet(count);
+                for (std::uint32_t i = 0; i < count; ++i)
+                {
+                    Header sub;
+                    if (!readHeader(sub) || sub.type != 1u || !readPoint(output.get(), sub))
+                        return nullptr;
+                }
+                break;
+
+            case 5u: // multilinestring
+            case 6u: // multipolygon
+            case 7u: // geometrycollection
+            {
+                if (!read(count))
+                    return nullptr;
+                osg::ref_ptr<MultiGeometry> multi = new MultiGeometry();
+                for (std::uint32_t i = 0; i < count; ++i)
+                {
+                    osg::ref_ptr<Geometry> part = readGeometry();
+                    if (!part.valid())
+                        return nullptr;
+                    multi->getComponents().push_back(part.get());
+                }
+                output = multi.get();
+                break;
+            }
+
+            default:
+                // curves, surfaces, and TINs go through OGR instead
+                unsupported = true;
+                return nullptr;
+            }
+
+            return output.release();
+        }
+    };
+}
+
+Geometry*
+OgrUtils::createGeometryFromWKB(const unsigned char* wkb, std::size_t size, bool rewindPolygons)
+{
+    if (!wkb || size == 0)
+        return nullptr;
+
+    WKBDecoder decoder{ wkb, wkb + size, rewindPolygons };
+    Geometry* output = decoder.readGeometry();
+
+    if (decoder.unsupported)
+    {
+        OGRGeometryH handle = nullptr;
+        if (OGR_G_CreateFromWkb(const_cast<unsigned char*>(wkb), nullptr, &handle, (int)size) == OGRERR_NONE && handle)
+        {
+            output = createGeometry(handle, rewindPolygons);
+            OGR_G_DestroyGeometry(handle);
+        }
+    }
+
+    return output;
+}
+
 OGRwkbGeometryType
 OgrUtils::getOGRGeometryType(const osgEarth::Geometry::Type& geomType)
 {
@@ -447,6 +696,10 @@ OGRFeatureFactory::createFeature(OGRFeatureH handle) const
     {
         OGRFieldDefnH field_handle_ref = OGR_F_GetFieldDefnRef( handle, i );
 
+        // skip fields excluded with OGR_L_SetIgnoredFields
+        if (OGR_Fld_IsIgnored(field_handle_ref))
+            continue;
+
         // get the field name and convert to lower case:
         std::string name;
         if (i < fieldNames.size())
@@ -534,3 +787,289 @@ OgrUtils::getAttributeType(OGRFieldType type)
 }
 
 
+
+#ifdef OSGEARTH_HAVE_OGR_ARROW_STREAM
+
+namespace
+{
+    // Looks up a key in Arrow C data interface metadata
+    // (int32 count, then int32-length-prefixed key/value pairs)
+    std::string getArrowMetadata(const char* metadata, const std::string& key)
+    {
+        if (!metadata)
+            return {};
+
+        const char* p = metadata;
+        std::int32_t count, len;
+        std::memcpy(&count, p, 4); p += 4;
+        for (std::int32_t i = 0; i < count; ++i)
+        {
+            std::memcpy(&len, p, 4); p += 4;
+            std::string k(p, len); p += len;
+            std::memcpy(&len, p, 4); p += 4;
+            if (k == key)
+                return std::string(p, len);
+            p += len;
+        }
+        return {};
+    }
+
+    inline bool isBitSet(const void* buffer, std::int64_t i)
+    {
+        return (static_cast<const std::uint8_t*>(buffer)[i >> 3] >> (i & 7)) & 1;
+    }
+
+    inline bool isValid(const ArrowArray* array, std::int64_t i)
+    {
+        return array->null_count == 0 || array->buffers[0] == nullptr || isBitSet(array->buffers[0], i);
+    }
+
+    template<typename T>
+    inline T valueAt(const ArrowArray* array, std::int64_t i)
+    {
+        return static_cast<const T*>(array->buffers[1])[i];
+    }
+
+    inline long long integerAt(const ArrowArray* array, char format, std::int64_t i)
+    {
+        switch (format)
+        {
+        case 'c': return valueAt<std::int8_t>(array, i);
+        case 'C': return valueAt<std::uint8_t>(array, i);
+        case 's': return valueAt<std::int16_t>(array, i);
+        case 'S': return valueAt<std::uint16_t>(array, i);
+        case 'i': return valueAt<std::int32_t>(array, i);
+        case 'I': return valueAt<std::uint32_t>(array, i);
+        case 'l': return valueAt<std::int64_t>(array, i);
+        case 'L': return (long long)valueAt<std::uint64_t>(array, i);
+        default: return 0LL;
+        }
+    }
+
+    // variable-length (utf8 or binary) value: 32-bit offsets for lower-case
+    // formats, 64-bit offsets for upper-case formats
+    inline const char* bytesAt(const ArrowArray* array, bool large, std::int64_t i, std::size_t& size)
+    {
+        const char* data = static_cast<const char*>(array->buffers[2]);
+        std::int64_t begin, end;
+        if (large)
+        {
+            auto* offsets = static_cast<const std::int64_t*>(array->buffers[1]);
+            begin = offsets[i], end = offsets[i + 1];
+        }
+        else
+        {
+            auto* offsets = static_cast<const std::int32_t*>(array->buffers[1]);
+            begin = offsets[i], end = offsets[i + 1];
+        }
+        size = (std::size_t)(end - begin);
+        return data + begin;
+    }
+}
+
+OGRArrowFeatureReader::~OGRArrowFeatureReader()
+{
+    close();
+}
+
+void
+OGRArrowFeatureReader::close()
+{
+    if (_schema.release)
+        _schema.release(&_schema);
+
+    if (_stream.release)
+        _stream.release(&_stream);
+
+    _schema = {};
+    _stream = {};
+    _open = false;
+    _fidChild = -1;
+    _geomChild = -1;
+    _columns.clear();
+}
+
+bool
+OGRArrowFeatureReader::open(OGRLayerH layer, unsigned batchSize)
+{
+    close();
+
+    if (!layer || !OGR_L_TestCapability(layer, OLCFastGetArrowStream))
+        return false;
+
+    const char* fidColumn = OGR_L_GetFIDColumn(layer);
+    std::string fidName = (fidColumn && fidColumn[0]) ? fidColumn : "OGC_FID";
+
+    std::string maxFeatures = "MAX_FEATURES_IN_BATCH=" + std::to_string(std::max(batchSize, 1u));
+    const char* streamOptions[] = {
+        "INCLUDE_FID=YES",
+        "GEOMETRY_ENCODING=WKB",
+        maxFeatures.c_str(),
+        nullptr
+    };
+
+    if (!OGR_L_GetArrowStream(layer, &_stream, const_cast<char**>(streamOptions)))
+    {
+        _stream = {};
+        return false;
+    }
+
+    _open = true;
+
+    if (_stream.get_schema(&_stream, &_schema) != 0 || !_schema.format || std::strcmp(_schema.format, "+s") != 0)
+    {
+        close();
+        return false;
+    }
+
+    for (int c = 0; c < (int)_schema.n_children; ++c)
+    {
+        const ArrowSchema* child = _schema.children[c];
+        std::string name = child->name ? child->name : "";
+        std::string format = child->format ? child->format : "";
+
+        std::string extension = getArrowMetadata(child->metadata, "ARROW:extension:name");
+        if (extension == "ogc.wkb" || extension == "geoarrow.wkb")
+        {
+            // like OGR_F_GetGeometryRef, only read the first geometry field
+            if (_geomChild < 0)
+                _geomChild = c;
+            continue;
+        }
+
+        if (_fidChild < 0 && name == fidName && format == "l")
+        {
+            _fidChild = c;
+            continue;
+        }
+
+        Column column;
+        column.child = c;
+        column.name = osgEarth::toLower(name);
+        column.format = format.size() == 1u ? format[0] : 0;
+
+        switch (child->dictionary ? 0 : column.format)
+        {
+        case 'c': case 'C': case 's': case 'S':
+        case 'i': case 'I': case 'l': case 'L':
+            column.kind = 'i'; break;
+        case 'f': case 'g':
+            column.kind = 'd'; break;
+        case 'b':
+            column.kind = 'b'; break;
+        case 'u': case 'U':
+            column.kind = 's'; break;
+        default:
+            // dates, lists, binaries, dictionaries: let OGR format them
+            OE_DEBUG << LC << "Arrow format \"" << format << "\" of field \"" << name
+                << "\" not supported; reading features one at a time" << std::endl;
+            close();
+            return false;
+        }
+
+        _columns.push_back(column);
+    }
+
+    return true;
+}
+
+bool
+OGRArrowFeatureReader::read(FeatureList& output)
+{
+    if (!_open)
+        return false;
+
+    ArrowArray batch = {};
+    if (_stream.get_next(&_stream, &batch) != 0)
+    {
+        const char* error = _stream.get_last_error(&_stream);
+        OE_WARN << LC << "Arrow stream error: " << (error ? error : "unknown") << std::endl;
+        close();
+        return false;
+    }
+
+    // a released array marks the end of the stream
+    if (batch.release == nullptr)
+    {
+        close();
+        return false;
+    }
+
+    const std::int64_t count = batch.length;
+    const std::size_t first = output.size();
+    output.reserve(first + (std::size_t)count);
+
+    // geometry and FID first:
+    const ArrowArray* fids = _fidChild >= 0 ? batch.children[_fidChild] : nullptr;
+    const ArrowArray* geoms = _geomChild >= 0 ? batch.children[_geomChild] : nullptr;
+    const bool largeGeoms = _geomChild >= 0 && _schema.children[_geomChild]->format[0] == 'Z';
+
+    for (std::int64_t row = 0; row < count; ++row)
+    {
+        std::int64_t r = batch.offset + row;
+
+        FeatureID fid = OGRNullFID;
+        if (fids && isValid(fids, fids->offset + r))
+            fid = valueAt<std::int64_t>(fids, fids->offset + r);
+
+        Geometry* geom = nullptr;
+        if (geoms && isValid(geoms, geoms->offset + r))
+        {
+            std::size_t size;
+            const char* wkb = bytesAt(geoms, largeGeoms, geoms->offset + r, size);
+            geom = OgrUtils::createGeometryFromWKB(reinterpret_cast<const unsigned char*>(wkb), size, rewindPolygons);
+        }
+
+        Feature* feature = new Feature(geom, srs, Style(), fid);
+
+        if (srs && interp.isSet())
+            feature->geoInterp() = interp.value();
+
+        output.emplace_back(feature);
+    }
+
+    // then the attributes, one column at a time:
+    for (auto& column : _columns)
+    {
+        const ArrowArray* array = batch.children[column.child];
+
+        for (std::int64_t row = 0; row < count; ++row)
+        {
+            Feature* feature = output[first + row].get();
+            std::int64_t i = array->offset + batch.offset + row;
+
+            if (!isValid(array, i))
+            {
+                if (keepNullValues)
+                    feature->setNull(column.name);
+                continue;
+            }
+
+            switch (column.kind)
+            {
+            case 'i':
+                feature->set(column.name, integerAt(array, column.format, i));
+                break;
+            case 'd':
+                feature->set(column.name, column.format == 'f' ?
+                    (double)valueAt<float>(array, i) :
+                    valueAt<double>(array, i));
+                break;
+            case 'b':
+                feature->set(column.name, isBitSet(array->buffers[1], i) ? 1LL : 0LL);
+                break;
+            default:
+            {
+                std::size_t size;
+                const char* value = bytesAt(array, column.format == 'U', i, size);
+                feature->set(column.name, std::string(value, size));
+            }
+            }
+        }
+    }
+
+    batch.release(&batch);
+    return true;
+}
+
+#endif // OSGEARTH_HAVE_OGR_ARROW_STREAM
@@ -11,6 +11,7 @@
 #include "GLUtils"
 #include "Chonk"
 #include "MemoryUtils"
+#include "TraceProfiler"
 
 #include <osg/ArgumentParser>
 #include <osgText/Font>
@@ -40,6 +41,11 @@ void osgEarth::initialize()
     jobs::set_thread_name_function([](const char* value) {
         osgEarth::setThreadName(value);
     });
+
+#ifdef OSGEARTH_HAVE_TRACE_PROFILER
+    // Record a trace if OSGEARTH_TRACE is set
+    Util::TraceProfiler::startFromEnvironment();
+#endif
 }
 
 void osgEarth::initialize(osg::ArgumentParser& args)
@@ -5,8 +5,7 @@
 #include <osgEarth/ResampleFilter>
 #include <osgEarth/FilterContext>
 #include <osgEarth/GeoMath>
-#include <list>
-#include <cstdlib>
+#include <osgEarth/Random>
 
 using namespace osgEarth;
 
@@ -38,126 +37,129 @@ ResampleFilterOptions( conf )
 }
 
 
-bool
-ResampleFilter::push( Feature* input, FilterContext& context )
+void
+ResampleFilter::resample( const osg::Vec3d* part, std::size_t count, std::vector<osg::Vec3d>& output, Util::Random& prng ) const
 {
-    if ( !input || !input->getGeometry() )
-        return true;
-
-    bool success = true;
-
-    GeometryIterator i( input->getGeometry() );
-    while( i.hasMore() )
-    {        
-        Geometry* part = i.next();
-
-        if ( part->size() < 2 ) continue;
-
-        unsigned int origSize = part->size();
-
-        // whether to resample the virtual segment that closes an open ring:
-        bool loop =
-            part->getComponentType() == Geometry::TYPE_RING &&
-            static_cast<Ring*>(part)->isOpen();
-
-        // copy the original part to a linked list. use a std::list since insert/erase
-        // will not invalidate iterators.
-        std::list<osg::Vec3d> plist;
-        plist.insert( plist.begin(), part->begin(), part->end() );
+    // Walk the segments in a single pass, streaming the output. "p0" is always the
+    // last emitted point and "input[i]" the next candidate; points that are too close
+    // are skipped and new points are inserted until the remaining segment is short enough.
+    std::size_t size = count;
+    output.push_back( part[0] );
+
+    std::size_t i = 1;
+    while( i < count )
+    {
+        osg::Vec3d p0 = output.back();
+        const osg::Vec3d& p1 = part[i];
+        bool lastSeg = (i == count-1);
+        osg::Vec3d seg = p1 - p0;
 
-        std::list<osg::Vec3d>::iterator v1 = plist.begin(); ++v1;
-        std::list<osg::Vec3d>::iterator v0 = plist.begin();
-        std::list<osg::Vec3d>::iterator last = plist.end(); --last;
+        osg::Vec3d p0Rad, p1Rad;
 
-        while( v0 != last )
+        if (resampleMode().value() == RESAMPLE_GREATCIRCLE || resampleMode().value() == RESAMPLE_RHUMB)
         {
-            bool increment = true;
-
-            osg::Vec3d& p0 = *v0;
-            osg::Vec3d& p1 = *v1;
-            bool lastSeg = v1 == last;
-            osg::Vec3d seg = p1 - p0;
+            p0Rad = osg::Vec3d(osg::DegreesToRadians(p0.x()), osg::DegreesToRadians(p0.y()), p0.z());
+            p1Rad = osg::Vec3d(osg::DegreesToRadians(p1.x()), osg::DegreesToRadians(p1.y()), p1.z());
+        }
 
-            osg::Vec3d p0Rad, p1Rad;
+        //Compute the length of the segment
+        double segLen = 0.0;
+        switch (resampleMode().value())
+        {
+        case RESAMPLE_LINEAR:
+            segLen = seg.length();
+            break;
+        case RESAMPLE_GREATCIRCLE:
+            segLen = GeoMath::distance(p0Rad.y(), p0Rad.x(), p1Rad.y(), p1Rad.x());
+            break;
+        case RESAMPLE_RHUMB:
+            segLen = GeoMath::rhumbDistance(p0Rad.y(), p0Rad.x(), p1Rad.y(), p1Rad.x());
+            break;
+        }
 
-            if (resampleMode().value() == RESAMPLE_GREATCIRCLE || resampleMode().value() == RESAMPLE_RHUMB)
-            {
-                p0Rad = osg::Vec3d(osg::DegreesToRadians(p0.x()), osg::DegreesToRadians(p0.y()), p0.z());
-                p1Rad = osg::Vec3d(osg::DegreesToRadians(p1.x()), osg::DegreesToRadians(p1.y()), p1.z());
-            }
-                       
-            //Compute the length of the segment
-            double segLen = 0.0;
+        if ( segLen < _minLen.value() && !lastSeg && size > 2 )
+        {
+            // drop the candidate point
+            ++i;
+            --size;
+        }
+        else if ( segLen > _maxLen.value() )
+        {
+            //Compute the number of divisions to make
+            int numDivs = (1 + (int)(segLen/_maxLen.value()));
+            double newSegLen = segLen/(double)numDivs;
+            seg.normalize();
+            osg::Vec3d newPt;
+            double newHeight;
             switch (resampleMode().value())
             {
             case RESAMPLE_LINEAR:
-                segLen = seg.length();
+                {
+                    newPt = p0 + seg * newSegLen;
+                }
                 break;
             case RESAMPLE_GREATCIRCLE:
-                segLen = GeoMath::distance(p0Rad.y(), p0Rad.x(), p1Rad.y(), p1Rad.x());
+                {
+                    double bearing = GeoMath::bearing(p0Rad.y(), p0Rad.x(), p1Rad.y(), p1Rad.x());
+                    double lat,lon;
+                    GeoMath::destination(p0Rad.y(), p0Rad.x(), bearing, newSegLen, lat, lon);
+                    newHeight = p0Rad.z() + ( p1Rad.z() - p0Rad.z() ) / (double)numDivs;
+                    newPt = osg::Vec3d(osg::RadiansToDegrees(lon), osg::RadiansToDegrees(lat), newHeight);
+                }
                 break;
             case RESAMPLE_RHUMB:
-                segLen = GeoMath::rhumbDistance(p0Rad.y(), p0Rad.x(), p1Rad.y(), p1Rad.x());
+                {
+                    double bearing = GeoMath::rhumbBearing(p0Rad.y(), p0Rad.x(), p1Rad.y(), p1Rad.x());
+                    double lat,lon;
+                    GeoMath::rhumbDestination(p0Rad.y(), p0Rad.x(), bearing, newSegLen, lat, lon);
+                    newHeight = p0Rad.z() + ( p1Rad.z() - p0Rad.z() ) / (double)numDivs;
+                    newPt = osg::Vec3d(osg::RadiansToDegrees(lon), osg::RadiansToDegrees(lat), newHeight);
+                }
                 break;
             }
 
-            if ( segLen < _minLen.value() && !lastSeg && plist.size() > 2 )
+            if ( _perturbThresh.value() > 0.0 && _perturbThresh.value() < newSegLen )
             {
-                v1 = plist.erase( v1 );
-                increment = false;
-            }
-            else if ( segLen > _maxLen.value() )
-            {
-                //Compute the number of divisions to make
-                int numDivs = (1 + (int)(segLen/_maxLen.value()));
-                double newSegLen = segLen/(double)numDivs;
-                seg.normalize();
-                osg::Vec3d newPt;
-                double newHeight;
-                switch (resampleMode().value())
-                {
-                case RESAMPLE_LINEAR:
-                    {
-                        newPt = p0 + seg * newSegLen;
-                    }
-                    break;
-                case RESAMPLE_GREATCIRCLE:
-                    {
-                        double bearing = GeoMath::bearing(p0Rad.y(), p0Rad.x(), p1Rad.y(), p1Rad.x());
-                        double lat,lon;
-                        GeoMath::destination(p0Rad.y(), p0Rad.x(), bearing, newSegLen, lat, lon);
-                        newHeight = p0Rad.z() + ( p1Rad.z() - p0Rad.z() ) / (double)numDivs;
-                        newPt = osg::Vec3d(osg::RadiansToDegrees(lon), osg::RadiansToDegrees(lat), newHeight);
-                    }
-                    break;
-                case RESAMPLE_RHUMB:
-                    {
-                        double bearing = GeoMath::rhumbBearing(p0Rad.y(), p0Rad.x(), p1Rad.y(), p1Rad.x());
-                        double lat,lon;
-                        GeoMath::rhumbDestination(p0Rad.y(), p0Rad.x(), bearing, newSegLen, lat, lon);
-                        newHeight = p0Rad.z() + ( p1Rad.z() - p0Rad.z() ) / (double)numDivs;
-                        newPt = osg::Vec3d(osg::RadiansToDegrees(lon), osg::RadiansToDegrees(lat), newHeight);
-                    }
-                    break;
-                }
-                
-                if ( _perturbThresh.value() > 0.0 && _perturbThresh.value() < newSegLen )
-                {
-                    float r = 0.5 - (float)::rand()/(float)RAND_MAX;
-                    newPt.x() += r;
-                    newPt.y() += r;
-                }
-                v1 = plist.insert( v1, newPt );
+                float r = 0.5f - (float)prng.next();
+                newPt.x() += r;
+                newPt.y() += r;
             }
 
-            if ( increment ) { ++v0; ++v1; }
+            // emit the new point; the candidate is tested again against it.
+            output.push_back( newPt );
+            ++size;
+        }
+        else
+        {
+            output.push_back( p1 );
+            ++i;
         }
+    }
+}
 
-        part->clear();
-        part->reserve( plist.size() );
-        part->insert( part->begin(), plist.begin(), plist.end() );
+bool
+ResampleFilter::push( Feature* input, FilterContext& context )
+{
+    if ( !input || !input->getGeometry() )
+        return true;
+
+    std::vector<osg::Vec3d> resampled;
+
+    // seed from the FID so the perturbation does not depend on threading
+    Util::Random prng( (unsigned)input->getFID() );
+
+    GeometryIterator i( input->getGeometry() );
+    while( i.hasMore() )
+    {
+        Geometry* part = i.next();
+
+        if ( part->size() < 2 ) continue;
+
+        resampled.clear();
+        resample( &part->front(), part->size(), resampled, prng );
+        part->asVector().swap( resampled );
     }
-    return success;
+    return true;
 }
 
 
@@ -177,3 +179,44 @@ ResampleFilter::push( FeatureList& input, FilterContext& context )
 
     return context;
 }
+
+FilterContext
+ResampleFilter::pushBatch( FeatureBatch& input, FilterContext& context )
+{
+    if ( !isSupported() )
+    {
+        OE_WARN << "ResampleFilter support not enabled" << std::endl;
+        return context;
+    }
+
+    const std::vector<osg::Vec3d>& coords = input.coords();
+
+    std::vector<osg::Vec3d> output;
+    output.reserve( coords.size() );
+
+    std::vector<std::uint32_t> partSizes( input.getNumParts() );
+
+    for( std::size_t f = 0; f < input.size(); ++f )
+    {
+        // same seed as the per-feature path
+        Util::Random prng( (unsigned)input.fids()[f] );
+
+        for( std::size_t p = input.firstPart(f); p < input.firstPart(f+1); ++p )
+        {
+            std::size_t begin = input.firstCoord(p);
+            std::size_t count = input.firstCoord(p+1) - begin;
+            std::size_t start = output.size();
+
+            if ( count < 2 )
+                output.insert( output.end(), coords.begin() + begin, coords.begin() + begin + count );
+            else
+                resample( &coords[begin], count, output, prng );
+
+            partSizes[p] = (std::uint32_t)(output.size() - start);
+        }
+    }
+
+    input.setCoords( std::move(output), partSizes );
+
+    return context;
+}
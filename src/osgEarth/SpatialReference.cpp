@@ -64,8 +64,6 @@ namespace
 
 SpatialReference::ThreadLocal::ThreadLocal() :
     _handle(nullptr),
-    _workspace(nullptr),
-    _workspaceSize(0u),
     _threadId(std::this_thread::get_id())
 {
     //nop
@@ -73,24 +71,53 @@ SpatialReference::ThreadLocal::ThreadLocal() :
 
 SpatialReference::ThreadLocal::~ThreadLocal()
 {
-    if (_workspace)
-        delete [] _workspace;
+    if (_handle)
+    {
+        OSRDestroySpatialReference(static_cast<OGRSpatialReferenceH>(_handle));
+    }
+}
 
+SpatialReference::TransformInfo::~TransformInfo()
+{
     // Causing a crash under GDAL3/PROJ6 - comment out until further notice
-    // This only happens on program exist anyway
+    // This only happens on program exit for the per-thread cache; a
+    // Transformer destroys its own handle in ~Transformer.
 #if GDAL_VERSION_MAJOR < 3
-    for(auto& xformEntry : _xformCache)
-    {
-        optional<TransformInfo>& ti = xformEntry.second;
-        if (ti.isSet() && ti->_handle != nullptr)
-            OCTDestroyCoordinateTransformation(ti->_handle);
-    }
+    if (_handle != nullptr)
+        OCTDestroyCoordinateTransformation(_handle);
 #endif
+}
 
-    if (_handle)
-    {
-        OSRDestroySpatialReference(static_cast<OGRSpatialReferenceH>(_handle));
-    }
+SpatialReference::TransformCache&
+SpatialReference::getTransformCache()
+{
+    static thread_local TransformCache cache;
+    return cache;
+}
+
+std::uint32_t
+SpatialReference::getInternedID() const
+{
+    std::uint32_t id = _internedID.load(std::memory_order_relaxed);
+    if (id == 0u)
+    {
+        // SRS instances with the same definition share an ID, so the
+        // transform cache entries outlive any one instance.
+        static std::mutex s_mutex;
+        static std::unordered_map<std::string, std::uint32_t> s_ids;
+
+        std::string def = Stringify()
+            << (_is_cube ? "cube|" : "") << (_is_ltp ? "ltp|" : "")
+            << _key.horizLower << '|' << _wkt;
+
+        std::lock_guard<std::mutex> lock(s_mutex);
+        auto& entry = s_ids[def];
+        if (entry == 0u)
+            entry = (std::uint32_t)s_ids.size();
+        id = entry;
+        _internedID.store(id, std::memory_order_relaxed);
+    }
+    return id;
 }
 
 SpatialReference*
@@ -877,29 +904,45 @@ SpatialReference::transform(std::vector<osg::Vec3d>& points,
         return success;
     }
 
+    TransformCache& cache = getTransformCache();
+    std::uint64_t key = ((std::uint64_t)inputSRS->getInternedID() << 32) | outputSRS->getInternedID();
+    if (key != cache._lastKey)
+    {
+        cache._last = &cache._entries[key];
+        cache._lastKey = key;
+    }
+
+    return inputSRS->transformDirect(points, outputSRS, *cache._last, cache._workspace);
+}
+
+
+bool
+SpatialReference::transformDirect(
+    std::vector<osg::Vec3d>& points,
+    const SpatialReference* outputSRS,
+    TransformInfo& xform,
+    std::vector<double>& workspace) const
+{
+    bool success = false;
+
     // if the points are starting as geographic, do the Z's first to avoid an unneccesary
     // transformation in the case of differing vdatums.
     bool z_done = false;
-    if ( inputSRS->isGeographic() )
+    if ( isGeographic() )
     {
-        z_done = inputSRS->transformZ( points, outputSRS, true );
+        z_done = transformZ( points, outputSRS, true );
     }
 
-    ThreadLocal& local = getLocal();
-
     // move the xy data into straight arrays that OGR can use
     unsigned count = points.size();
 
-    if (count*2 > local._workspaceSize)
+    if (count*2 > workspace.size())
     {
-        if (local._workspace)
-            delete [] local._workspace;
-        local._workspace = new double[count*2];
-        local._workspaceSize = count*2;
+        workspace.resize(count*2);
     }
 
-    double* x = local._workspace;
-    double* y = local._workspace + count;
+    double* x = workspace.data();
+    double* y = workspace.data() + count;
 
     for( unsigned i=0; i<count; i++ )
     {
@@ -907,11 +950,11 @@ SpatialReference::transform(std::vector<osg::Vec3d>& points,
         y[i] = points[i].y();
     }
 
-    success = inputSRS->transformXYPointArrays( local, x, y, count, outputSRS );
+    success = transformXYPointArrays( xform, x, y, count, outputSRS );
 
     if ( success )
     {
-        if ( inputSRS->isProjected() && outputSRS->isGeographic() )
+        if ( isProjected() && outputSRS->isGeographic() )
         {
             // special case: when going from projected to geographic, clamp the 
             // points to the maximum geographic extent. Sometimes the conversion from
@@ -938,7 +981,7 @@ SpatialReference::transform(std::vector<osg::Vec3d>& points,
         // calculate the Zs if we haven't already done so
         if ( !z_done )
         {
-            z_done = inputSRS->transformZ( points, outputSRS, outputSRS->isGeographic() );
+            z_done = transformZ( points, outputSRS, outputSRS->isGeographic() );
         }   
 
         // run the user post-transform code
@@ -949,6 +992,64 @@ SpatialReference::transform(std::vector<osg::Vec3d>& points,
 }
 
 
+SpatialReference::Transformer::Transformer(const SpatialReference* from, const SpatialReference* to) :
+    _from(from),
+    _to(to)
+{
+    if (valid())
+    {
+        _equivalent = from->isEquivalentTo(to);
+
+        // pairs that need a pre-transform or a geocentric step take the
+        // general path; everything else goes straight to the XY transform.
+        _direct =
+            !from->isGeocentric() && !to->isGeocentric() &&
+            !from->isCube() && !from->isLTP();
+
+        _info.reset(new TransformInfo());
+    }
+}
+
+SpatialReference::Transformer::~Transformer()
+{
+    // Unlike the per-thread cache entries, which live until thread exit,
+    // a Transformer goes away at runtime and must release its transform.
+    if (_info && _info->_handle != nullptr)
+    {
+        OCTDestroyCoordinateTransformation(static_cast<OGRCoordinateTransformationH>(_info->_handle));
+        _info->_handle = nullptr;
+    }
+}
+
+bool
+SpatialReference::Transformer::transform(std::vector<osg::Vec3d>& points) const
+{
+    if (!valid() || !_from->valid())
+        return false;
+
+    if (_equivalent)
+        return true;
+
+    if (!_direct)
+        return _from->transform(points, _to.get());
+
+    return _from->transformDirect(points, _to.get(), *_info, _workspace);
+}
+
+bool
+SpatialReference::Transformer::transform(const osg::Vec3d& input, osg::Vec3d& output) const
+{
+    _single.resize(1);
+    _single[0] = input;
+    if (transform(_single))
+    {
+        output = _single[0];
+        return true;
+    }
+    return false;
+}
+
+
 bool 
 SpatialReference::transform2D(double x, double y,
                               const SpatialReference* outputSRS,
@@ -971,7 +1072,7 @@ SpatialReference::transform2D(double x, double y,
 
 bool
 SpatialReference::transformXYPointArrays(
-    ThreadLocal& local,
+    TransformInfo& xform,
     double*  x,
     double*  y,
     unsigned count,
@@ -982,13 +1083,23 @@ SpatialReference::transformXYPointArrays(
     if (!valid())
         return false;
 
-    // Transform the X and Y values inside an exclusive GDAL/OGR lock
-    optional<TransformInfo>& xform = local._xformCache[out_srs->getWKT()];
-    if (!xform.isSet())
+    if (!xform._resolved)
     {
-        xform.mutable_value()._handle = OCTNewCoordinateTransformation(static_cast<OGRSpatialReferenceH>(local._handle), static_cast<OGRSpatialReferenceH>(out_srs->getHandle()));
+        // closed-form transform that bypasses OGR for common SRS pairs:
+        xform._analytic = Util::AnalyticTransforms::get(this, out_srs);
+        xform._resolved = true;
+    }
 
-        if ( xform.mutable_value()._handle == nullptr )
+    if (xform._analytic && Util::AnalyticTransforms::getEnabled())
+    {
+        return xform._analytic->transform(x, y, count);
+    }
+
+    if (xform._handle == nullptr && !xform._failed)
+    {
+        xform._handle = OCTNewCoordinateTransformation(static_cast<OGRSpatialReferenceH>(getHandle()), static_cast<OGRSpatialReferenceH>(out_srs->getHandle()));
+
+        if ( xform._handle == nullptr )
         {
             OE_WARN << LC
                 << "SRS xform not possible:" << std::endl
@@ -1001,19 +1112,19 @@ SpatialReference::transformXYPointArrays(
             const char* errmsg = CPLGetLastErrorMsg();
             OE_WARN << LC << "ERROR: " << (errmsg? errmsg : "do not know") << std::endl;
 
-            xform.mutable_value()._handle = nullptr;
-            xform.mutable_value()._failed = true;
+            xform._handle = nullptr;
+            xform._failed = true;
 
             return false;
         }
     }
 
-    if (xform->_failed)
+    if (xform._failed)
     {
         return false;
     }
 
-    return OCTTransform(static_cast<OGRCoordinateTransformationH>(xform->_handle), count, x, y, 0L) > 0;
+    return OCTTransform(static_cast<OGRCoordinateTransformationH>(xform._handle), count, x, y, 0L) > 0;
 }
 
 
@@ -1036,51 +1147,61 @@ SpatialReference::transformZ(std::vector<osg::Vec3d>& points,
     UnitsType inUnits = _vdatum.valid() ? _vdatum->getUnits() : Units::METERS;
     UnitsType outUnits = outVDatum ? outVDatum->getUnits() : inUnits;
 
-    if ( isGeographic() || pointsAreLatLong )
-    {
-        for( unsigned i=0; i<points.size(); ++i )
-        {
-            if ( _vdatum.valid() )
-            {
-                // to HAE:
-                points[i].z() = _vdatum->msl2hae( points[i].y(), points[i].x(), points[i].z() );
-            }
+    const bool inGeoid = _vdatum.valid() && _vdatum->getGeoid();
+    const bool outGeoid = outVDatum && outVDatum->getGeoid();
+    const unsigned count = points.size();
 
-            // do the units conversion:
-            points[i].z() = inUnits.convertTo(outUnits, points[i].z());
+    // nothing to do when neither datum has a geoid and the units match:
+    if ( !inGeoid && !outGeoid && inUnits == outUnits )
+        return true;
 
-            if ( outVDatum )
-            {
-                // to MSL:
-                points[i].z() = outVDatum->hae2msl( points[i].y(), points[i].x(), points[i].z() );
-            }
-        }
-    }
+    // Z values as a contiguous array for the batch datum conversions:
+    std::vector<double> z(count);
+    for (unsigned i = 0; i < count; ++i)
+        z[i] = points[i].z();
 
-    else // need to xform input points
+    if (inGeoid || outGeoid)
     {
-        // copy the points and convert them to geographic coordinates (lat/long with the same Z):
-        std::vector<osg::Vec3d> geopoints(points);
-        transform( geopoints, getGeographicSRS() );
+        // the geoid lookups need lat/long arrays; only reproject the input
+        // when a geoid is actually involved.
+        std::vector<double> lat(count), lon(count);
 
-        for( unsigned i=0; i<geopoints.size(); ++i )
+        if ( isGeographic() || pointsAreLatLong )
         {
-            if ( _vdatum.valid() )
-            {
-                // to HAE:
-                points[i].z() = _vdatum->msl2hae( geopoints[i].y(), geopoints[i].x(), points[i].z() );
-            }
+            for (unsigned i = 0; i < count; ++i)
+                lon[i] = points[i].x(), lat[i] = points[i].y();
+        }
+        else // need to xform input points
+        {
+            // copy the points and convert them to geographic coordinates (lat/long with the same Z):
+            std::vector<osg::Vec3d> geopoints(points);
+            transform( geopoints, getGeographicSRS() );
+            for (unsigned i = 0; i < count; ++i)
+                lon[i] = geopoints[i].x(), lat[i] = geopoints[i].y();
+        }
 
-            // do the units conversion:
-            points[i].z() = inUnits.convertTo(outUnits, points[i].z());
+        // to HAE:
+        if ( inGeoid )
+            _vdatum->msl2hae( lat.data(), lon.data(), z.data(), count );
 
-            if ( outVDatum )
-            {
-                // to MSL:
-                points[i].z() = outVDatum->hae2msl( geopoints[i].y(), geopoints[i].x(), points[i].z() );
-            }
-        }
+        // do the units conversion:
+        if ( inUnits != outUnits )
+            for (unsigned i = 0; i < count; ++i)
+                z[i] = inUnits.convertTo(outUnits, z[i]);
+
+        // to MSL:
+        if ( outGeoid )
+            outVDatum->hae2msl( lat.data(), lon.data(), z.data(), count );
     }
+    else if ( inUnits != outUnits )
+    {
+        // units conversion only:
+        for (unsigned i = 0; i < count; ++i)
+            z[i] = inUnits.convertTo(outUnits, z[i]);
+    }
+
+    for (unsigned i = 0; i < count; ++i)
+        points[i].z() = z[i];
 
     return true;
 }
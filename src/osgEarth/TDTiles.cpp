@@ -540,7 +540,7 @@ namespace
         };
 
         return jobs::dispatch(job,
-            jobs::context{ uri.full(), jobs::get_pool("oe.3dtiles") });
+            jobs::context{ "oe.3dtiles.tileset", jobs::get_pool("oe.3dtiles") });
     }
 
     osg::ref_ptr<osg::Node> readTileContentSync(
@@ -562,7 +562,7 @@ namespace
         osg::ref_ptr<const osgDB::Options> options)
     {
         jobs::context context;
-        context.name = uri.full();
+        context.name = "oe.3dtiles.read";
         context.pool = jobs::get_pool("oe.3dtiles");
 
         return jobs::dispatch([uri, options](Cancelable& progress)
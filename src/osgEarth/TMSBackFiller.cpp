@@ -5,127 +5,486 @@
 #include <osgEarth/TMSBackFiller>
 #include <osgEarth/FileUtils>
 #include <osgEarth/ImageMosaic>
+#include <osgEarth/Threading>
 
 #include <osgDB/FileUtils>
 #include <osgDB/FileNameUtils>
 #include <osgDB/ReadFile>
 #include <osgDB/WriteFile>
 
+#include <chrono>
+#include <cstring>
+#include <type_traits>
+
 #define LC "[TMSBackFiller] "
 
+#define BUILD_POOL_NAME "oe.tmsbackfill"
+#define WRITE_POOL_NAME "oe.tmsbackfill.write"
+
 using namespace osgEarth;
 using namespace osgEarth::Contrib;
 
+namespace
+{
+    // Accumulator type for filtering a channel type
+    template<typename T>
+    using Accum = typename std::conditional<std::is_floating_point<T>::value, T, std::int32_t>::type;
+
+    template<typename T, typename A>
+    inline T divide(A sum, A divisor)
+    {
+        if (std::is_floating_point<T>::value)
+            return (T)(sum / divisor);
+        else
+            return (T)((sum >= 0 ? sum + divisor / 2 : sum - divisor / 2) / divisor);
+    }
+
+    /**
+     * Reduces a child tile by half into one quadrant of its parent.
+     * The filters are separable: a vertical pass over whole rows into "vert",
+     * then a horizontal pass. Both are simple loops over contiguous memory
+     * that the compiler can vectorize.
+     */
+    template<typename T>
+    void reduce(
+        const osg::Image* child,
+        osg::Image* parent,
+        unsigned col0, unsigned row0,
+        unsigned comps,
+        TMSBackFiller::Filter filter)
+    {
+        using A = Accum<T>;
+        const int cs = child->s(), ct = child->t();
+        const unsigned w = cs / 2, h = ct / 2;
+        const unsigned rowLen = cs * comps;
+        std::vector<A> vert(rowLen);
+
+        auto row = [&](int r) {
+            return reinterpret_cast<const T*>(child->data(0, osg::clampBetween(r, 0, ct - 1)));
+        };
+
+        for (unsigned j = 0; j < h; ++j)
+        {
+            T* out = reinterpret_cast<T*>(parent->data(col0, row0 + j));
+
+            if (filter == TMSBackFiller::FILTER_MODE)
+            {
+                // most common of the four pixels; ties go to the first one found
+                const unsigned char* r0 = reinterpret_cast<const unsigned char*>(row(2 * j));
+                const unsigned char* r1 = reinterpret_cast<const unsigned char*>(row(2 * j + 1));
+                const unsigned px = comps * sizeof(T);
+
+                for (unsigned i = 0; i < w; ++i)
+                {
+                    const unsigned char* p[4] = {
+                        r0 + (2 * i) * px, r0 + (2 * i + 1) * px,
+                        r1 + (2 * i) * px, r1 + (2 * i + 1) * px };
+
+                    unsigned best = 0, bestCount = 0;
+                    for (unsigned a = 0; a < 4 && bestCount < 2; ++a)
+                    {
+                        unsigned count = 1;
+                        for (unsigned b = a + 1; b < 4; ++b)
+                            if (::memcmp(p[a], p[b], px) == 0)
+                                ++count;
+                        if (count > bestCount)
+                            best = a, bestCount = count;
+                    }
+                    ::memcpy(out + i * comps, p[best], px);
+                }
+            }
+
+            else if (filter == TMSBackFiller::FILTER_BILINEAR)
+            {
+                // 4x4 tent filter, weights 1-3-3-1 on each axis
+                const T* r0 = row(2 * j - 1);
+                const T* r1 = row(2 * j);
+                const T* r2 = row(2 * j + 1);
+                const T* r3 = row(2 * j + 2);
+
+                for (unsigned x = 0; x < rowLen; ++x)
+                    vert[x] = (A)r0[x] + (A)3 * ((A)r1[x] + (A)r2[x]) + (A)r3[x];
+
+                for (unsigned i = 0; i < w; ++i)
+                {
+                    int xm1 = std::max((int)(2 * i) - 1, 0) * comps;
+                    int x0 = (2 * i) * comps;
+                    int x1 = (2 * i + 1) * comps;
+                    int x2 = std::min(2 * i + 2, (unsigned)cs - 1) * comps;
+
+                    for (unsigned c = 0; c < comps; ++c)
+                    {
+                        A sum = vert[xm1 + c] + (A)3 * (vert[x0 + c] + vert[x1 + c]) + vert[x2 + c];
+                        out[i * comps + c] = divide<T, A>(sum, (A)64);
+                    }
+                }
+            }
+
+            else // FILTER_BOX
+            {
+                const T* r0 = row(2 * j);
+                const T* r1 = row(2 * j + 1);
+
+                for (unsigned x = 0; x < rowLen; ++x)
+                    vert[x] = (A)r0[x] + (A)r1[x];
+
+                for (unsigned i = 0; i < w; ++i)
+                {
+                    const A* v = &vert[2 * i * comps];
+                    for (unsigned c = 0; c < comps; ++c)
+                        out[i * comps + c] = divide<T, A>(v[c] + v[comps + c], (A)4);
+                }
+            }
+        }
+    }
+
+    // Whether four child tiles can go through the fast downsampler
+    bool canDownsample(const osg::ref_ptr<osg::Image> children[4])
+    {
+        const osg::Image* first = children[0].get();
+        GLenum type = first->getDataType();
+
+        if (first->isCompressed() || first->r() != 1 ||
+            (first->s() & 1) != 0 || (first->t() & 1) != 0 ||
+            (type != GL_UNSIGNED_BYTE && type != GL_UNSIGNED_SHORT && type != GL_SHORT && type != GL_FLOAT))
+        {
+            return false;
+        }
+
+        for (unsigned i = 1; i < 4; ++i)
+        {
+            const osg::Image* c = children[i].get();
+            if (c->s() != first->s() || c->t() != first->t() || c->r() != 1 ||
+                c->getPixelFormat() != first->getPixelFormat() ||
+                c->getDataType() != type ||
+                c->getPacking() != first->getPacking())
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
 TMSBackFiller::TMSBackFiller() :
 _minLevel(0u),
 _maxLevel(0u),
-_verbose(false)
+_verbose(false),
+_filter(FILTER_BOX),
+_numThreads(std::max(std::thread::hardware_concurrency(), 1u)),
+_maxPendingWrites(64u),
+_pendingWrites(0u),
+_tilesWritten(0u)
 {
     //nop
 }
 
 
 void TMSBackFiller::process( const std::string& tms, osgDB::Options* options )
-{               
-    std::string fullPath = getFullPath( "", tms );        
+{
+    std::string fullPath = getFullPath( "", tms );
     _options = options;
 
     //Read the tilemap
     _tileMap = TMS::TileMapReaderWriter::read( fullPath, 0 );
-    if (_tileMap)
-    {                        
-        //The max level is where we are going to read data from, so we need to start one level up.
-        osg::ref_ptr< const Profile> profile = _tileMap->createProfile();           
-
-        //If the bounds aren't valid just use the full extent of the profile.
-        if (!_bounds.valid())
-        {                
-            _bounds = profile->getExtent().bounds();
-        }
+    if (!_tileMap)
+    {
+        OE_NOTICE << "Failed to load TileMap from " << fullPath << std::endl;
+        return;
+    }
 
+    //The max level is where we are going to read data from, so we need to start one level up.
+    _profile = _tileMap->createProfile();
 
-        int firstLevel = _maxLevel-1;            
+    //Don't look for source tiles deeper than the tile map goes.
+    if (_tileMap->getMaxLevel() > 0u && _maxLevel > _tileMap->getMaxLevel())
+    {
+        _maxLevel = _tileMap->getMaxLevel();
+    }
 
-        GeoExtent extent( profile->getSRS(), _bounds );           
+    if (_maxLevel <= _minLevel)
+    {
+        OE_WARN << LC << "Nothing to do; max level (" << _maxLevel << ") must be greater than min level (" << _minLevel << ")" << std::endl;
+        return;
+    }
 
-        //Process each level in it's entirety
-        for (int level = firstLevel; level >= static_cast<int>(_minLevel); level--)
+    //If the bounds aren't valid just use the full extent of the profile.
+    if (!_bounds.valid())
+    {
+        _bounds = _profile->getExtent().bounds();
+    }
+
+    GeoExtent extent( _profile->getSRS(), _bounds );
+
+    //Tile ranges to rebuild at each level, and the level at which to split the work
+    //into independent subtrees (the first one with a few tiles for each thread):
+    unsigned firstLevel = _maxLevel - 1;
+    unsigned splitLevel = firstLevel;
+
+    _ranges.assign(_maxLevel, TileRange());
+    for (unsigned level = _minLevel; level <= firstLevel; ++level)
+    {
+        TileKey ll = _profile->createTileKey(extent.xMin(), extent.yMin(), level);
+        TileKey ur = _profile->createTileKey(extent.xMax(), extent.yMax(), level);
+        TileRange& r = _ranges[level];
+        r.xmin = ll.getTileX(), r.xmax = ur.getTileX();
+        r.ymin = ur.getTileY(), r.ymax = ll.getTileY();
+
+        std::size_t count = (std::size_t)(r.xmax - r.xmin + 1) * (std::size_t)(r.ymax - r.ymin + 1);
+        if (splitLevel == firstLevel && count >= 4u * _numThreads)
+            splitLevel = level;
+    }
+
+    jobs::get_pool(BUILD_POOL_NAME)->set_concurrency(std::max(_numThreads, 1u));
+    jobs::get_pool(WRITE_POOL_NAME)->set_concurrency(std::max(_numThreads / 2u, 1u));
+
+    _tilesWritten = 0u;
+    auto start = std::chrono::steady_clock::now();
+
+    //Build whole subtrees from the split level down in parallel, then the
+    //levels above it one at a time from the in-memory results:
+    ImageMap below, current;
+    for (int level = splitLevel; level >= static_cast<int>(_minLevel); level--)
+    {
+        auto t0 = std::chrono::steady_clock::now();
+
+        current.clear();
+        buildLevel(level, level == (int)splitLevel ? nullptr : &below, level > (int)_minLevel ? &current : nullptr);
+        below.swap(current);
+
+        if (_verbose)
         {
-            if (_verbose) OE_NOTICE << "Processing level " << level << std::endl;                
+            double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            std::string levels = std::to_string(level);
+            if (level == (int)splitLevel && splitLevel < firstLevel)
+                levels += "-" + std::to_string(firstLevel);
+
+            OE_NOTICE << LC << "Level " << levels << " done in " << s << "s; "
+                << _tilesWritten << " tiles written" << std::endl;
+        }
+    }
 
-            TileKey ll = profile->createTileKey(extent.xMin(), extent.yMin(), level);
-            TileKey ur = profile->createTileKey(extent.xMax(), extent.yMax(), level);
+    waitForWrites();
 
-            for (unsigned int x = ll.getTileX(); x <= ur.getTileX(); x++)
+    if (_verbose)
+    {
+        double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        OE_NOTICE << LC << "Wrote " << _tilesWritten << " tiles in " << s << "s ("
+            << (s > 0.0 ? (double)_tilesWritten / s : 0.0) << " tiles/s)" << std::endl;
+    }
+}
+
+bool TMSBackFiller::inRange( const TileKey& key ) const
+{
+    unsigned level = key.getLevelOfDetail();
+    if (level < _minLevel || level >= _ranges.size())
+        return false;
+
+    const TileRange& r = _ranges[level];
+    return
+        key.getTileX() >= r.xmin && key.getTileX() <= r.xmax &&
+        key.getTileY() >= r.ymin && key.getTileY() <= r.ymax;
+}
+
+void TMSBackFiller::buildLevel( unsigned level, const ImageMap* below, ImageMap* output )
+{
+    const TileRange& r = _ranges[level];
+
+    std::vector<TileKey> keys;
+    keys.reserve((r.xmax - r.xmin + 1) * (r.ymax - r.ymin + 1));
+    for (unsigned int x = r.xmin; x <= r.xmax; x++)
+        for (unsigned int y = r.ymin; y <= r.ymax; y++)
+            keys.emplace_back(level, x, y, _profile.get());
+
+    // keep the built tiles only if the next level needs them; otherwise each
+    // image is released as soon as buildTile has queued it for writing.
+    std::vector<osg::ref_ptr<osg::Image>> results(output ? keys.size() : 0u);
+
+    jobs::context job;
+    job.name = "TMSBackFiller";
+    job.pool = jobs::get_pool(BUILD_POOL_NAME);
+    job.group = jobs::jobgroup::create();
+
+    for (std::size_t k = 0; k < keys.size(); ++k)
+    {
+        jobs::dispatch([this, &keys, &results, below, output, k]()
             {
-                for (unsigned int y = ur.getTileY(); y <= ll.getTileY(); y++)
-                {
-                    TileKey key = TileKey(level, x, y, profile.get());
-                    processKey( key );
-                }
-            }                
+                osg::ref_ptr<osg::Image> image = buildTile(keys[k], below);
+                if (output)
+                    results[k] = image;
+            }, job);
+    }
+
+    job.group->join();
 
-        }            
+    if (output)
+    {
+        for (std::size_t k = 0; k < keys.size(); ++k)
+            (*output)[keys[k]] = results[k];
+    }
+}
+
+osg::ref_ptr<osg::Image> TMSBackFiller::buildTile( const TileKey& key, const ImageMap* below )
+{
+    //Source tiles, and tiles outside the bounds, come from disk.
+    if (key.getLevelOfDetail() >= _maxLevel || !inRange(key))
+    {
+        return readTile(key);
+    }
+
+    if (_verbose) OE_DEBUG << LC << "Processing key " << key.str() << std::endl;
+
+    //Get all of the child tiles for this key; they are either already built
+    //or we build them now, and they stay in memory until this tile is done.
+    osg::ref_ptr< osg::Image > children[4];
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        TileKey childKey = key.createChildKey(i);
+        ImageMap::const_iterator itr;
+        if (below && (itr = below->find(childKey)) != below->end())
+            children[i] = itr->second;
+        else
+            children[i] = buildTile(childKey, nullptr);
+    }
+
+    osg::ref_ptr< osg::Image > image = createParent(key, children);
+    if (image.valid())
+    {
+        writeTileAsync(key, image.get());
+        return image;
     }
     else
     {
-        OE_NOTICE << "Failed to load TileMap from " << _tmsPath << std::endl;
+        //Keep whatever is already on disk
+        return readTile(key);
     }
 }
 
-void TMSBackFiller::processKey( const TileKey& key )
+osg::ref_ptr<osg::Image> TMSBackFiller::downsample( const osg::ref_ptr<osg::Image> children[4], Filter filter )
 {
-    if (_verbose) OE_NOTICE << "Processing key " << key.str() << std::endl;
-
-    //Get all of the child tiles for this key, load them and mosaic them into a new tile
-    TileKey ulKey = key.createChildKey( 0 );
-    TileKey urKey = key.createChildKey( 1 );
-    TileKey llKey = key.createChildKey( 2 );
-    TileKey lrKey = key.createChildKey( 3 );
-
-    osg::ref_ptr< osg::Image > ul = readTile( ulKey );
-    osg::ref_ptr< osg::Image > ur = readTile( urKey );
-    osg::ref_ptr< osg::Image > ll = readTile( llKey );
-    osg::ref_ptr< osg::Image > lr = readTile( lrKey );
-
-    if (ul.valid() && ur.valid() && ll.valid() && lr.valid())
-    {            
-        //Merge them together
-        ImageMosaic mosaic;
-        mosaic.getImages().push_back( TileImage( ul.get(), ulKey ) );
-        mosaic.getImages().push_back( TileImage( ur.get(), urKey ) );
-        mosaic.getImages().push_back( TileImage( ll.get(), llKey ) );
-        mosaic.getImages().push_back( TileImage( lr.get(), lrKey ) );            
-
-        osg::ref_ptr< osg::Image> merged = mosaic.createImage();
-        if (merged.valid())
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        if (!children[i].valid())
+            return nullptr;
+    }
+
+    if (!canDownsample(children))
+        return nullptr;
+
+    const osg::Image* ul = children[0].get();
+
+    osg::ref_ptr<osg::Image> parent = new osg::Image();
+    parent->allocateImage(ul->s(), ul->t(), 1, ul->getPixelFormat(), ul->getDataType(), ul->getPacking());
+    parent->setInternalTextureFormat(ul->getInternalTextureFormat());
+
+    unsigned comps = osg::Image::computeNumComponents(ul->getPixelFormat());
+
+    //Child order is UL, UR, LL, LR; image rows run south to north.
+    const unsigned qx[4] = { 0u, 1u, 0u, 1u };
+    const unsigned qy[4] = { 1u, 1u, 0u, 0u };
+
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        unsigned col0 = qx[i] * ul->s() / 2, row0 = qy[i] * ul->t() / 2;
+        switch (ul->getDataType())
         {
-            //Resize the image so it's the same size as one of the input files
-            osg::ref_ptr<osg::Image> resized;
-            ImageUtils::resizeImage( merged.get(), ul->s(), ul->t(), resized );
-            std::string outputFilename = getFilename( key );                
-            writeTile( key, resized.get() );
+        case GL_UNSIGNED_BYTE:
+            reduce<GLubyte>(children[i].get(), parent.get(), col0, row0, comps, filter); break;
+        case GL_UNSIGNED_SHORT:
+            reduce<GLushort>(children[i].get(), parent.get(), col0, row0, comps, filter); break;
+        case GL_SHORT:
+            reduce<GLshort>(children[i].get(), parent.get(), col0, row0, comps, filter); break;
+        default:
+            reduce<GLfloat>(children[i].get(), parent.get(), col0, row0, comps, filter); break;
         }
-    }                
-}    
+    }
+
+    return parent;
+}
+
+osg::ref_ptr<osg::Image> TMSBackFiller::createParent( const TileKey& key, const osg::ref_ptr<osg::Image> children[4] ) const
+{
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        if (!children[i].valid())
+            return nullptr;
+    }
+
+    osg::ref_ptr<osg::Image> parent = downsample(children, _filter);
+    if (parent.valid())
+        return parent;
+
+    const osg::Image* ul = children[0].get();
+
+    //Mixed or unusual formats: merge them together and resize
+    ImageMosaic mosaic;
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        mosaic.getImages().push_back( TileImage( children[i].get(), key.createChildKey(i) ) );
+    }
+
+    osg::ref_ptr< osg::Image> merged = mosaic.createImage();
+    if (merged.valid())
+    {
+        //Resize the image so it's the same size as one of the input files
+        osg::ref_ptr<osg::Image> resized;
+        ImageUtils::resizeImage( merged.get(), ul->s(), ul->t(), resized );
+        return resized;
+    }
+
+    return nullptr;
+}
 
 std::string TMSBackFiller::getFilename( const TileKey& key )
 {
-    return _tileMap->getURL( key, false );        
+    return _tileMap->getURL( key, false );
 }
 
-osg::Image* TMSBackFiller::readTile( const TileKey& key )
+osg::ref_ptr<osg::Image> TMSBackFiller::readTile( const TileKey& key )
 {
     std::string filename = getFilename( key );
-    osg::ref_ptr< osg::Image> image = osgDB::readRefImageFile( filename );
-    return image.release();
+    return osgDB::readRefImageFile( filename );
 }
 
 void TMSBackFiller::writeTile( const TileKey& key, osg::Image* image )
 {
     std::string filename = getFilename( key );
-    if ( !osgDB::fileExists( osgDB::getFilePath(filename) ) )
-        osgEarth::makeDirectoryForFile( filename );
-    osgDB::writeImageFile( *image, filename, _options.get() );        
+    {
+        std::lock_guard<std::mutex> lock(_mkdirMutex);
+        if ( !osgDB::fileExists( osgDB::getFilePath(filename) ) )
+            osgEarth::makeDirectoryForFile( filename );
+    }
+    osgDB::writeImageFile( *image, filename, _options.get() );
+}
+
+void TMSBackFiller::writeTileAsync( const TileKey& key, osg::Image* image )
+{
+    //Block the builder while too many tiles are waiting to be written
+    {
+        std::unique_lock<std::mutex> lock(_writeMutex);
+        _writeCV.wait(lock, [this]() { return _pendingWrites < std::max(_maxPendingWrites, 1u); });
+        ++_pendingWrites;
+    }
+
+    osg::ref_ptr<osg::Image> ref = image;
+
+    jobs::context job;
+    job.name = "TMSBackFiller write";
+    job.pool = jobs::get_pool(WRITE_POOL_NAME);
+
+    jobs::dispatch([this, key, ref]()
+        {
+            writeTile(key, ref.get());
+            _tilesWritten++;
+
+            std::lock_guard<std::mutex> lock(_writeMutex);
+            --_pendingWrites;
+            _writeCV.notify_all();
+        }, job);
+}
+
+void TMSBackFiller::waitForWrites()
+{
+    std::unique_lock<std::mutex> lock(_writeMutex);
+    _writeCV.wait(lock, [this]() { return _pendingWrites == 0u; });
 }
-     
@@ -35,6 +35,7 @@ TerrainOptions::getConfig() const
     conf.set( "min_expiry_time", _minExpiryTime);
     conf.set( "min_expiry_frames", _minExpiryFrames);
     conf.set( "min_resident_tiles", minResidentTiles());
+    conf.set( "tile_memory_budget", tileMemoryBudget());
     conf.set( "max_tiles_to_unload_per_frame", _maxTilesToUnloadPerFrame);
     conf.set( "cast_shadows", _castShadows);
     conf.set( "tile_pixel_size", _tilePixelSize);
@@ -51,6 +52,10 @@ TerrainOptions::getConfig() const
     conf.set( "morph_elevation", morphTerrain() );
     conf.set( "morph_imagery", morphImagery() );
     conf.set( "merges_per_frame", mergesPerFrame() );
+    conf.set( "merge_time_budget", mergeTimeBudget() );
+    conf.set( "prefetch", prefetch() );
+    conf.set( "prefetch_horizon", prefetchHorizon() );
+    conf.set( "max_prefetch_tiles", maxPrefetchTiles() );
     conf.set( "priority_scale", priorityScale() );
     conf.set( "texture_compression", textureCompression());
     conf.set( "concurrency", concurrency());
@@ -94,6 +99,7 @@ TerrainOptions::fromConfig(const Config& conf)
     conf.get( "min_expiry_time", _minExpiryTime);
     conf.get( "min_expiry_frames", _minExpiryFrames);
     conf.get( "min_resident_tiles", minResidentTiles());
+    conf.get( "tile_memory_budget", tileMemoryBudget());
     conf.get( "max_tiles_to_unload_per_frame", _maxTilesToUnloadPerFrame);
     conf.get( "cast_shadows", _castShadows);
     conf.get( "tile_pixel_size", _tilePixelSize);
@@ -110,6 +116,10 @@ TerrainOptions::fromConfig(const Config& conf)
     conf.get( "morph_terrain", morphTerrain() );
     conf.get( "morph_imagery", morphImagery() );
     conf.get( "merges_per_frame", mergesPerFrame() );
+    conf.get( "merge_time_budget", mergeTimeBudget() );
+    conf.get( "prefetch", prefetch() );
+    conf.get( "prefetch_horizon", prefetchHorizon() );
+    conf.get( "max_prefetch_tiles", maxPrefetchTiles() );
     conf.get( "priority_scale", priorityScale());
     conf.get( "texture_compression", textureCompression());
     conf.get( "concurrency", concurrency());
@@ -194,6 +204,7 @@ OE_OPTION_IMPL(TerrainOptionsAPI, double, MinExpiryTime, minExpiryTime);
 OE_OPTION_IMPL(TerrainOptionsAPI, float, MinExpiryRange, minExpiryRange);
 OE_OPTION_IMPL(TerrainOptionsAPI, unsigned, MaxTilesToUnloadPerFrame, maxTilesToUnloadPerFrame);
 OE_OPTION_IMPL(TerrainOptionsAPI, unsigned, MinResidentTiles, minResidentTiles);
+OE_OPTION_IMPL(TerrainOptionsAPI, unsigned, TileMemoryBudget, tileMemoryBudget);
 OE_OPTION_IMPL(TerrainOptionsAPI, float, HeightFieldSkirtRatio, heightFieldSkirtRatio);
 OE_OPTION_IMPL(TerrainOptionsAPI, Color, Color, color);
 OE_OPTION_IMPL(TerrainOptionsAPI, bool, Progressive, progressive);
@@ -203,6 +214,10 @@ OE_OPTION_IMPL(TerrainOptionsAPI, bool, NormalizeEdges, normalizeEdges);
 OE_OPTION_IMPL(TerrainOptionsAPI, bool, MorphTerrain, morphTerrain);
 OE_OPTION_IMPL(TerrainOptionsAPI, bool, MorphImagery, morphImagery);
 OE_OPTION_IMPL(TerrainOptionsAPI, unsigned, MergesPerFrame, mergesPerFrame);
+OE_OPTION_IMPL(TerrainOptionsAPI, float, MergeTimeBudget, mergeTimeBudget);
+OE_OPTION_IMPL(TerrainOptionsAPI, bool, Prefetch, prefetch);
+OE_OPTION_IMPL(TerrainOptionsAPI, float, PrefetchHorizon, prefetchHorizon);
+OE_OPTION_IMPL(TerrainOptionsAPI, unsigned, MaxPrefetchTiles, maxPrefetchTiles);
 OE_OPTION_IMPL(TerrainOptionsAPI, std::string, TextureCompressionMethod, textureCompression);
 OE_OPTION_IMPL(TerrainOptionsAPI, unsigned, Concurrency, concurrency);
 OE_OPTION_IMPL(TerrainOptionsAPI, float, ScreenSpaceError, screenSpaceError);
@@ -3,6 +3,7 @@
  * MIT License
  */
 #include "Threading"
+#include "TraceProfiler"
 #include <cstdlib>
 #include <climits>
 #include <cstring>
@@ -22,6 +23,10 @@ using namespace osgEarth;
 
 void osgEarth::setThreadName(const std::string& name)
 {
+#ifdef OSGEARTH_HAVE_TRACE_PROFILER
+    Util::TraceProfiler::setThreadName(name.c_str());
+#endif
+
 #if (defined _WIN32 && defined _WIN32_WINNT_WIN10 && defined _WIN32_WINNT && _WIN32_WINNT >= _WIN32_WINNT_WIN10) || (defined __CYGWIN__)
     wchar_t buf[256];
     mbstowcs(buf, name.c_str(), 256);
@@ -0,0 +1,455 @@
+/* osgEarth
+ * Copyright 2025 Pelican Mapping
+ * MIT License
+ */
+#include <osgEarth/TieredCache>
+#include <osgEarth/MemCache>
+#include <osgEarth/DateTime>
+
+#define LC "[TieredCache] "
+
+using namespace osgEarth;
+
+//------------------------------------------------------------------------
+
+TieredCacheOptions::Tier::Tier(const ConfigOptions& co) :
+    ConfigOptions(co)
+{
+    fromConfig(_conf);
+}
+
+Config
+TieredCacheOptions::Tier::getConfig() const
+{
+    Config conf = cache()->getConfig();
+    conf.key() = "tier";
+    conf.set("readable", readable());
+    conf.set("writable", writable());
+    conf.set("promote", promote());
+    conf.set("max_age", maxAge());
+    conf.set("max_size", maxSize());
+    return conf;
+}
+
+void
+TieredCacheOptions::Tier::fromConfig(const Config& conf)
+{
+    cache() = CacheOptions(ConfigOptions(conf));
+    conf.get("readable", readable());
+    conf.get("writable", writable());
+    conf.get("promote", promote());
+    conf.get("max_age", maxAge());
+    conf.get("max_size", maxSize());
+}
+
+Config
+TieredCacheOptions::getConfig() const
+{
+    Config conf = CacheOptions::getConfig();
+    conf.remove("tier");
+    for (auto& tier : _tiers)
+        conf.add(tier.getConfig());
+    return conf;
+}
+
+void
+TieredCacheOptions::fromConfig(const Config& conf)
+{
+    for (auto& child : conf.children("tier"))
+        _tiers.emplace_back(ConfigOptions(child));
+}
+
+//------------------------------------------------------------------------
+
+namespace
+{
+    // Metadata key that carries a record's original timestamp into the
+    // tiers it is promoted to, so a promotion does not refresh its age
+    const std::string ORIGINAL_TIME_KEY = "tiered_cache_time";
+
+    using Tier = TieredCache::Tier;
+    using Tiers = std::vector<std::shared_ptr<Tier>>;
+
+    /**
+     * Bin that holds one child bin per tier, fastest first.
+     */
+    class TieredCacheBin : public CacheBin
+    {
+    public:
+        TieredCacheBin(const std::string& binID, const Tiers& tiers, bool isDefault) :
+            CacheBin(binID),
+            _tiers(tiers)
+        {
+            _bins.reserve(_tiers.size());
+            for (auto& tier : _tiers)
+            {
+                CacheBin* bin = isDefault ?
+                    tier->cache->getOrCreateDefaultBin() :
+                    tier->cache->addBin(binID);
+                _bins.emplace_back(bin);
+            }
+        }
+
+        ReadResult readObject(const std::string& key, const osgDB::Options* dbo) override
+        {
+            return read(key, dbo, &CacheBin::readObject);
+        }
+
+        ReadResult readImage(const std::string& key, const osgDB::Options* dbo) override
+        {
+            return read(key, dbo, &CacheBin::readImage);
+        }
+
+        ReadResult readString(const std::string& key, const osgDB::Options* dbo) override
+        {
+            return read(key, dbo, &CacheBin::readString);
+        }
+
+        bool write(const std::string& key, const osg::Object* object, const Config& meta, const osgDB::Options* dbo) override
+        {
+            bool ok = false;
+            for (unsigned i = 0; i < _tiers.size(); ++i)
+            {
+                if (_bins[i].valid() && _tiers[i]->policy.writable() == true)
+                {
+                    if (_bins[i]->write(key, object, meta, dbo))
+                    {
+                        _tiers[i]->writes++;
+                        ok = true;
+                    }
+                }
+            }
+            return ok;
+        }
+
+        RecordStatus getRecordStatus(const std::string& key) override
+        {
+            RecordStatus result = STATUS_NOT_FOUND;
+            for (unsigned i = 0; i < _tiers.size(); ++i)
+            {
+                if (_bins[i].valid() && _tiers[i]->policy.readable() == true)
+                {
+                    RecordStatus status = _bins[i]->getRecordStatus(key);
+                    if (status == STATUS_OK)
+                        return status;
+                    else if (status == STATUS_EXPIRED)
+                        result = status;
+                }
+            }
+            return result;
+        }
+
+        bool remove(const std::string& key) override
+        {
+            return forEachWritable([&](CacheBin* bin) { return bin->remove(key); });
+        }
+
+        bool touch(const std::string& key) override
+        {
+            return forEachWritable([&](CacheBin* bin) { return bin->touch(key); });
+        }
+
+        bool clear() override
+        {
+            return forEachWritable([&](CacheBin* bin) { return bin->clear(); });
+        }
+
+        bool compact() override
+        {
+            return forEachWritable([&](CacheBin* bin) { return bin->compact(); });
+        }
+
+        unsigned getStorageSize() override
+        {
+            unsigned total = 0u;
+            for (auto& bin : _bins)
+                if (bin.valid())
+                    total += bin->getStorageSize();
+            return total;
+        }
+
+    private:
+        using ReadFunc = ReadResult(CacheBin::*)(const std::string&, const osgDB::Options*);
+
+        ReadResult read(const std::string& key, const osgDB::Options* dbo, ReadFunc func)
+        {
+            // An expired record is only returned if no slower tier has a fresh one,
+            // and it is never promoted since that would refresh its timestamp.
+            ReadResult stale;
+            TimeStamp now = 0;
+
+            for (unsigned i = 0; i < _tiers.size(); ++i)
+            {
+                Tier& tier = *_tiers[i];
+                if (!_bins[i].valid() || tier.policy.readable() == false)
+                    continue;
+
+                tier.reads++;
+                ReadResult r = (_bins[i].get()->*func)(key, dbo);
+                if (r.succeeded())
+                {
+                    restoreOriginalTime(r);
+
+                    if (tier.policy.maxAge() > 0.0 && r.lastModifiedTime() > 0)
+                    {
+                        if (now == 0)
+                            now = DateTime().asTimeStamp();
+
+                        if ((double)(now - r.lastModifiedTime()) > tier.policy.maxAge().value())
+                        {
+                            tier.expired++;
+                            if (stale.failed())
+                                stale = r;
+                            continue;
+                        }
+                    }
+
+                    tier.hits++;
+                    promote(i, key, r, dbo);
+                    return r;
+                }
+                else
+                {
+                    tier.misses++;
+                }
+            }
+
+            return stale;
+        }
+
+        //! Writes a record found in tier "found" into the faster tiers above it.
+        //! The record keeps its original timestamp so that a promoted copy
+        //! expires (in the tiers and under the layer's CachePolicy) when the
+        //! original would have. Tiers in which it has already expired are
+        //! skipped; the copy would only miss and be promoted again.
+        void promote(unsigned found, const std::string& key, const ReadResult& r, const osgDB::Options* dbo)
+        {
+            Config meta = r.metadata();
+            if (r.lastModifiedTime() > 0)
+                meta.set(ORIGINAL_TIME_KEY, std::to_string((long long)r.lastModifiedTime()));
+
+            TimeStamp now = 0;
+
+            for (unsigned i = 0; i < found; ++i)
+            {
+                Tier& tier = *_tiers[i];
+                if (_bins[i].valid() && tier.policy.writable() == true && tier.policy.promote() == true)
+                {
+                    if (tier.policy.maxAge() > 0.0 && r.lastModifiedTime() > 0)
+                    {
+                        if (now == 0)
+                            now = DateTime().asTimeStamp();
+
+                        if ((double)(now - r.lastModifiedTime()) > tier.policy.maxAge().value())
+                            continue;
+                    }
+
+                    if (_bins[i]->write(key, r.getObject(), meta, dbo))
+                        tier.promotions++;
+                }
+            }
+        }
+
+        //! Replaces the timestamp of a promoted record with the one it
+        //! had in the tier it was promoted from.
+        static void restoreOriginalTime(ReadResult& r)
+        {
+            if (r.metadata().hasChild(ORIGINAL_TIME_KEY))
+            {
+                Config meta = r.metadata();
+                long long t = meta.value<long long>(ORIGINAL_TIME_KEY, 0LL);
+                meta.remove(ORIGINAL_TIME_KEY);
+                r.setMetadata(meta);
+                if (t > 0)
+                    r.setLastModifiedTime((TimeStamp)t);
+            }
+        }
+
+        template<typename FUNC>
+        bool forEachWritable(FUNC&& func)
+        {
+            bool ok = false;
+            for (unsigned i = 0; i < _tiers.size(); ++i)
+            {
+                if (_bins[i].valid() && _tiers[i]->policy.writable() == true)
+                    ok = func(_bins[i].get()) || ok;
+            }
+            return ok;
+        }
+
+        Tiers _tiers;
+        std::vector<osg::ref_ptr<CacheBin>> _bins;
+    };
+
+    std::mutex s_defaultBinMutex;
+}
+
+//------------------------------------------------------------------------
+
+TieredCache::TieredCache(const TieredCacheOptions& options) :
+    Cache(options)
+{
+    for (auto& tierOptions : options.tiers())
+    {
+        const CacheOptions& cacheOptions = tierOptions.cache().value();
+
+        osg::ref_ptr<Cache> cache;
+        if (cacheOptions.getDriver() == "memory")
+            cache = new MemCache(tierOptions.maxSize().value());
+        else if (cacheOptions.getDriver() == "tiered")
+            OE_WARN << LC << "A tiered cache cannot be a tier of itself" << std::endl;
+        else
+            cache = Util::CacheFactory::create(cacheOptions);
+
+        if (cache.valid() && cache->getStatus().isOK())
+        {
+            addTier(cache.get(), tierOptions);
+        }
+        else
+        {
+            OE_WARN << LC << "Skipping tier " << _tiers.size() << " (driver \"" << cacheOptions.getDriver() << "\")"
+                << (cache.valid() ? ": " + cache->getStatus().message() : std::string()) << std::endl;
+        }
+    }
+
+    if (_tiers.empty())
+    {
+        _status = Status::Error(Status::ConfigurationError, "No usable cache tiers");
+    }
+}
+
+TieredCache::TieredCache(const TieredCache& rhs, const osg::CopyOp& op) :
+    Cache(rhs, op),
+    _tiers(rhs._tiers),
+    _binsOpened(rhs._binsOpened.load())
+{
+    //nop
+}
+
+void
+TieredCache::addTier(Cache* cache, const TieredCacheOptions::Tier& policy)
+{
+    OE_SOFT_ASSERT_AND_RETURN(cache != nullptr, void());
+    OE_SOFT_ASSERT(!_binsOpened && !_defaultBin.valid(), "Add tiers before opening bins");
+
+    auto tier = std::make_shared<Tier>();
+    tier->cache = cache;
+    tier->policy = policy;
+    _tiers.emplace_back(tier);
+
+    // a tier added programmatically rescues an empty configuration
+    _status = Status();
+}
+
+Cache*
+TieredCache::getTier(unsigned i) const
+{
+    return i < _tiers.size() ? _tiers[i]->cache.get() : nullptr;
+}
+
+std::vector<TieredCache::TierStats>
+TieredCache::getTierStats() const
+{
+    std::vector<TierStats> output;
+    output.reserve(_tiers.size());
+    for (auto& tier : _tiers)
+    {
+        output.emplace_back();
+        TierStats& stats = output.back();
+        stats.driver = tier->cache->getCacheOptions().getDriver();
+        if (stats.driver.empty())
+            stats.driver = tier->cache->className();
+        stats.reads = tier->reads;
+        stats.hits = tier->hits;
+        stats.misses = tier->misses;
+        stats.expired = tier->expired;
+        stats.writes = tier->writes;
+        stats.promotions = tier->promotions;
+    }
+    return output;
+}
+
+void
+TieredCache::resetTierStats()
+{
+    for (auto& tier : _tiers)
+    {
+        tier->reads = 0u;
+        tier->hits = 0u;
+        tier->misses = 0u;
+        tier->expired = 0u;
+        tier->writes = 0u;
+        tier->promotions = 0u;
+    }
+}
+
+CacheBin*
+TieredCache::addBin(const std::string& binID)
+{
+    _binsOpened = true;
+    return _bins.getOrCreate(binID, new TieredCacheBin(binID, _tiers, false));
+}
+
+CacheBin*
+TieredCache::getOrCreateDefaultBin()
+{
+    _binsOpened = true;
+    if (!_defaultBin.valid())
+    {
+        std::lock_guard<std::mutex> lock(s_defaultBinMutex);
+        // double check
+        if (!_defaultBin.valid())
+        {
+            _defaultBin = new TieredCacheBin(DEFAULT_BIN_ID, _tiers, true);
+        }
+    }
+    return _defaultBin.get();
+}
+
+void
+TieredCache::removeBin(CacheBin* bin)
+{
+    for (auto& tier : _tiers)
+    {
+        CacheBin* child = tier->cache->getBin(bin->getID());
+        if (child)
+            tier->cache->removeBin(child);
+    }
+    Cache::removeBin(bin);
+}
+
+off_t
+TieredCache::getApproximateSize() const
+{
+    off_t total = 0;
+    for (auto& tier : _tiers)
+        total += tier->cache->getApproximateSize();
+    return total;
+}
+
+bool
+TieredCache::compact()
+{
+    bool ok = false;
+    for (auto& tier : _tiers)
+        if (tier->policy.writable() == true)
+            ok = tier->cache->compact() || ok;
+    return ok;
+}
+
+bool
+TieredCache::clear()
+{
+    bool ok = false;
+    for (auto& tier : _tiers)
+        if (tier->policy.writable() == true)
+            ok = tier->cache->clear() || ok;
+    return ok;
+}
+
+void
+TieredCache::setNumThreads(unsigned num)
+{
+    for (auto& tier : _tiers)
+        tier->cache->setNumThreads(num);
+}
@@ -761,6 +761,17 @@ TileLayer::dirtyDataExtents()
     }
 }
 
+TileLayer::CacheStats
+TileLayer::getCacheStats() const
+{
+    CacheStats stats;
+    stats.memCacheHits = _memCacheHits;
+    stats.memCacheMisses = _memCacheMisses;
+    stats.cacheHits = _cacheHits;
+    stats.cacheMisses = _cacheMisses;
+    return stats;
+}
+
 const DataExtent&
 TileLayer::getDataExtentsUnion() const
 {
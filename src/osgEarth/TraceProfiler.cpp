@@ -0,0 +1,510 @@
+/* osgEarth
+* Copyright 2025 Pelican Mapping
+* MIT License
+*/
+#include <osgEarth/TraceProfiler>
+#include <osgEarth/Threading>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace osgEarth;
+using namespace osgEarth::Util;
+
+std::atomic<bool> TraceProfiler::s_recording(false);
+
+namespace
+{
+    enum class EventType : std::uint8_t
+    {
+        ZoneBegin,
+        ZoneEnd,
+        ZoneText,
+        Counter,
+        Frame
+    };
+
+    constexpr unsigned TEXT_SIZE = 40u;
+
+    struct Event
+    {
+        std::int64_t time;      // steady clock, ns
+        const char* name;
+        union {
+            double value;
+            char text[TEXT_SIZE];
+        };
+        EventType type;
+    };
+
+    //! Events recorded by one thread. Only the owning thread writes to it.
+    //! Readers copy it under the registry mutex while the owner keeps
+    //! writing, so the copy races with the owner by design; afterwards they
+    //! drop every event the owner may have overwritten or been writing.
+    struct ThreadBuffer
+    {
+        unsigned threadId = 0u;
+        std::string name;                       // guarded by the registry mutex
+        std::unique_ptr<Event[]> events;
+        unsigned capacity = 0u;
+        unsigned generation = 0u;               // recording this buffer belongs to
+        std::atomic<std::uint64_t> head = { 0u }; // events written in this recording
+        std::atomic<bool> retired = { false };  // owning thread has exited
+    };
+
+    struct Registry
+    {
+        std::mutex mutex;
+        std::mutex controlMutex;                // serializes start() and stop()
+        std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+        std::set<std::string> counterNames;     // stable storage for sampled counter names
+        unsigned nextThreadId = 1u;
+        unsigned eventsPerThread = 16384u;
+        std::atomic<unsigned> generation = { 1u };
+        std::int64_t origin = 0;
+
+        // job pool sampler, guarded by controlMutex
+        std::thread sampler;
+        std::condition_variable samplerCond;
+        bool samplerDone = false;
+        std::chrono::milliseconds sampleInterval = std::chrono::milliseconds(10);
+        std::string autoFile;                   // OSGEARTH_TRACE
+        double autoSeconds = 0.0;               // OSGEARTH_TRACE_SECONDS
+        bool autoPending = false;               // autoFile not written yet
+    };
+
+    // Never destroyed, since threads may record after static destruction begins;
+    // for the same reason nothing here logs through Notify.
+    Registry& registry()
+    {
+        static Registry* r = new Registry();
+        return *r;
+    }
+
+    inline std::int64_t now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    //! Marks the thread's buffer retired when the thread exits. The buffer
+    //! is created by the thread's first event; until then only the name is kept.
+    struct ThreadOwner
+    {
+        ThreadBuffer* buffer = nullptr;
+        std::string name;
+        ~ThreadOwner() {
+            if (buffer)
+                buffer->retired = true;
+        }
+    };
+
+    thread_local ThreadOwner t_owner;
+
+    ThreadBuffer* threadBuffer()
+    {
+        if (!t_owner.buffer)
+        {
+            Registry& r = registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            r.buffers.emplace_back(new ThreadBuffer());
+            t_owner.buffer = r.buffers.back().get();
+            t_owner.buffer->threadId = r.nextThreadId++;
+            t_owner.buffer->name = t_owner.name;
+        }
+        return t_owner.buffer;
+    }
+
+    //! Next free event slot for the calling thread, or nullptr.
+    //! The caller fills it in and then calls commit().
+    inline Event* reserve(ThreadBuffer*& out_buffer)
+    {
+        ThreadBuffer* buffer = threadBuffer();
+        Registry& r = registry();
+
+        unsigned generation = r.generation.load(std::memory_order_acquire);
+        if (buffer->generation != generation)
+        {
+            // first event of this recording on this thread
+            std::lock_guard<std::mutex> lock(r.mutex);
+            if (buffer->capacity != r.eventsPerThread)
+            {
+                buffer->events.reset(new Event[r.eventsPerThread]);
+                buffer->capacity = r.eventsPerThread;
+            }
+            buffer->head.store(0u, std::memory_order_relaxed);
+            buffer->generation = generation;
+        }
+
+        if (buffer->capacity == 0u)
+            return nullptr;
+
+        out_buffer = buffer;
+        std::uint64_t head = buffer->head.load(std::memory_order_relaxed);
+        return &buffer->events[head % buffer->capacity];
+    }
+
+    inline void commit(ThreadBuffer* buffer)
+    {
+        buffer->head.store(buffer->head.load(std::memory_order_relaxed) + 1u, std::memory_order_release);
+    }
+
+    inline void record(EventType type, const char* name, double value = 0.0)
+    {
+        ThreadBuffer* buffer = nullptr;
+        Event* e = reserve(buffer);
+        if (e)
+        {
+            e->time = now();
+            e->name = name;
+            e->value = value;
+            e->type = type;
+            commit(buffer);
+        }
+    }
+
+    void writeString(std::ostream& out, const char* value)
+    {
+        out << '"';
+        for (const char* c = value; c && *c; ++c)
+        {
+            unsigned char ch = (unsigned char)*c;
+            if (ch == '"' || ch == '\\')
+                out << '\\' << *c;
+            else if (ch < 0x20)
+            {
+                char buf[8];
+                std::snprintf(buf, sizeof(buf), "\\u%04x", ch);
+                out << buf;
+            }
+            else
+                out << *c;
+        }
+        out << '"';
+    }
+
+    void sampleJobPools(Registry& r)
+    {
+        if (!jobs::alive())
+            return;
+
+        for (auto* pool : jobs::get_metrics()->all())
+        {
+            if (!pool)
+                continue;
+
+            const char* pending;
+            const char* running;
+            {
+                std::lock_guard<std::mutex> lock(r.mutex);
+                pending = r.counterNames.insert(pool->name + " pending").first->c_str();
+                running = r.counterNames.insert(pool->name + " running").first->c_str();
+            }
+            record(EventType::Counter, pending, (double)pool->pending);
+            record(EventType::Counter, running, (double)pool->running);
+        }
+    }
+
+    void runSampler()
+    {
+        Registry& r = registry();
+        TraceProfiler::setThreadName("oe.trace");
+
+        std::int64_t deadline = r.autoPending && r.autoSeconds > 0.0 ?
+            r.origin + (std::int64_t)(r.autoSeconds * 1e9) : 0;
+
+        std::unique_lock<std::mutex> lock(r.mutex);
+        while (!r.samplerDone)
+        {
+            lock.unlock();
+            sampleJobPools(r);
+
+            if (deadline > 0 && now() >= deadline)
+            {
+                // stop() joins this thread, so just stop recording
+                TraceProfiler::s_recording = false;
+                r.autoPending = false;
+                TraceProfiler::write(r.autoFile);
+                break;
+            }
+
+            lock.lock();
+            r.samplerCond.wait_for(lock, r.sampleInterval, [&r]() { return r.samplerDone; });
+        }
+    }
+
+    //! Joins the sampler thread; the caller holds the control mutex
+    void stopSampler()
+    {
+        Registry& r = registry();
+        if (r.sampler.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> lock(r.mutex);
+                r.samplerDone = true;
+            }
+            r.samplerCond.notify_all();
+            r.sampler.join();
+        }
+    }
+
+    //! Writes the recording started by startFromEnvironment() at exit
+    void writeAtExit()
+    {
+        Registry& r = registry();
+        TraceProfiler::stop();
+        if (r.autoPending)
+        {
+            r.autoPending = false;
+            TraceProfiler::write(r.autoFile);
+        }
+    }
+}
+
+void
+TraceProfiler::start()
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> control(r.controlMutex);
+
+    stopSampler();
+    {
+        std::lock_guard<std::mutex> lock(r.mutex);
+
+        // free the buffers of threads that have exited
+        r.buffers.erase(
+            std::remove_if(r.buffers.begin(), r.buffers.end(),
+                [](const std::unique_ptr<ThreadBuffer>& b) { return b->retired.load(); }),
+            r.buffers.end());
+
+        r.origin = now();
+        r.generation.fetch_add(1u, std::memory_order_release);
+        r.samplerDone = false;
+    }
+
+    s_recording = true;
+    r.sampler = std::thread(runSampler);
+}
+
+void
+TraceProfiler::stop()
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> control(r.controlMutex);
+
+    s_recording = false;
+    stopSampler();
+}
+
+void
+TraceProfiler::startFromEnvironment()
+{
+    Registry& r = registry();
+    if (r.autoPending || recording())
+        return;
+
+    const char* events = ::getenv("OSGEARTH_TRACE_EVENTS");
+    if (events)
+        setEventsPerThread((unsigned)std::max(0, ::atoi(events)));
+
+    const char* interval = ::getenv("OSGEARTH_TRACE_SAMPLE_MS");
+    if (interval)
+        r.sampleInterval = std::chrono::milliseconds(std::max(1, ::atoi(interval)));
+
+    const char* file = ::getenv("OSGEARTH_TRACE");
+    if (file && *file)
+    {
+        r.autoFile = file;
+        const char* seconds = ::getenv("OSGEARTH_TRACE_SECONDS");
+        r.autoSeconds = seconds ? ::atof(seconds) : 0.0;
+        r.autoPending = true;
+        start();
+        std::atexit(writeAtExit);
+    }
+}
+
+void
+TraceProfiler::setEventsPerThread(unsigned value)
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.eventsPerThread = value;
+}
+
+void
+TraceProfiler::setThreadName(const char* name)
+{
+    // a thread that never records never registers a buffer
+    t_owner.name = name ? name : "";
+    if (t_owner.buffer)
+    {
+        std::lock_guard<std::mutex> lock(registry().mutex);
+        t_owner.buffer->name = t_owner.name;
+    }
+}
+
+void
+TraceProfiler::plot(const char* name, double value)
+{
+    if (recording())
+        record(EventType::Counter, name, value);
+}
+
+void
+TraceProfiler::frameMark()
+{
+    if (recording())
+        record(EventType::Frame, "Frame");
+}
+
+void
+TraceProfiler::begin(const char* name)
+{
+    record(EventType::ZoneBegin, name);
+}
+
+void
+TraceProfiler::end()
+{
+    record(EventType::ZoneEnd, nullptr);
+}
+
+void
+TraceProfiler::text(const char* value, std::size_t length)
+{
+    ThreadBuffer* buffer = nullptr;
+    Event* e = reserve(buffer);
+    if (e)
+    {
+        length = std::min(length, (std::size_t)TEXT_SIZE - 1u);
+        e->time = now();
+        e->name = nullptr;
+        std::memcpy(e->text, value, length);
+        e->text[length] = '\0';
+        e->type = EventType::ZoneText;
+        commit(buffer);
+    }
+}
+
+bool
+TraceProfiler::write(const std::string& filename)
+{
+    std::ofstream out(filename.c_str(), std::ios::out | std::ios::trunc);
+    if (!out.is_open())
+        return false;
+
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+
+    unsigned generation = r.generation.load(std::memory_order_acquire);
+    std::vector<Event> events;
+    std::vector<std::string> texts;
+    bool first = true;
+
+    auto comma = [&]() { if (!first) out << ",\n"; first = false; };
+    auto timestamp = [&](const Event& e) { return (double)(e.time - r.origin) * 1e-3; };
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    out.precision(3);
+    out << std::fixed;
+
+    comma();
+    out << "{\"ph\":\"M\",\"pid\":1,\"name\":\"process_name\",\"args\":{\"name\":\"osgEarth\"}}";
+
+    for (auto& buffer : r.buffers)
+    {
+        if (buffer->generation != generation || buffer->capacity == 0u)
+            continue;
+
+        // copy the newest events, then drop any the owner overwrote meanwhile
+        std::uint64_t head = buffer->head.load(std::memory_order_acquire);
+        std::uint64_t tail = head > buffer->capacity ? head - buffer->capacity : 0u;
+        events.clear();
+        for (std::uint64_t i = tail; i < head; ++i)
+            events.push_back(buffer->events[i % buffer->capacity]);
+
+        // The owner may be in the middle of writing slot newHead % capacity,
+        // which held event newHead - capacity; drop up to and including it.
+        std::uint64_t newHead = buffer->head.load(std::memory_order_acquire);
+        std::uint64_t firstIntact = newHead >= buffer->capacity ? newHead - buffer->capacity + 1u : 0u;
+        std::size_t skip = (std::size_t)std::min<std::uint64_t>(
+            firstIntact > tail ? firstIntact - tail : 0u, events.size());
+
+        if (!buffer->name.empty())
+        {
+            comma();
+            out << "{\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadId << ",\"name\":\"thread_name\",\"args\":{\"name\":";
+            writeString(out, buffer->name.c_str());
+            out << "}}";
+        }
+
+        // Zones whose beginning was overwritten are dropped; the text of
+        // each zone goes into the arguments of its end event.
+        texts.clear();
+        for (std::size_t i = skip; i < events.size(); ++i)
+        {
+            const Event& e = events[i];
+            switch (e.type)
+            {
+            case EventType::ZoneBegin:
+                comma();
+                out << "{\"ph\":\"B\",\"pid\":1,\"tid\":" << buffer->threadId << ",\"ts\":" << timestamp(e) << ",\"name\":";
+                writeString(out, e.name);
+                out << "}";
+                texts.emplace_back();
+                break;
+
+            case EventType::ZoneText:
+                if (!texts.empty())
+                {
+                    std::string& t = texts.back();
+                    if (!t.empty())
+                        t += "; ";
+                    t.append(e.text, ::strnlen(e.text, TEXT_SIZE));
+                }
+                break;
+
+            case EventType::ZoneEnd:
+                if (!texts.empty())
+                {
+                    comma();
+                    out << "{\"ph\":\"E\",\"pid\":1,\"tid\":" << buffer->threadId << ",\"ts\":" << timestamp(e);
+                    if (!texts.back().empty())
+                    {
+                        out << ",\"args\":{\"text\":";
+                        writeString(out, texts.back().c_str());
+                        out << "}";
+                    }
+                    out << "}";
+                    texts.pop_back();
+                }
+                break;
+
+            case EventType::Counter:
+                comma();
+                out << "{\"ph\":\"C\",\"pid\":1,\"ts\":" << timestamp(e) << ",\"name\":";
+                writeString(out, e.name);
+                out << ",\"args\":{\"value\":" << e.value << "}}";
+                break;
+
+            case EventType::Frame:
+                comma();
+                out << "{\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":" << buffer->threadId << ",\"ts\":" << timestamp(e) << ",\"name\":\"Frame\"}";
+                break;
+            }
+        }
+    }
+
+    out << "\n]}\n";
+    out.close();
+    return !out.fail();
+}
@@ -150,3 +150,54 @@ TransformFilter::push( FeatureList& input, FilterContext& incx )
 
     return outcx;
 }
+
+FilterContext
+TransformFilter::pushBatch( FeatureBatch& batch, FilterContext& incx )
+{
+    _bbox = osg::BoundingBoxd();
+
+    const SpatialReference* inputSRS =
+        batch.getSRS() ? batch.getSRS() :
+        incx.featureProfile() ? incx.featureProfile()->getSRS() :
+        nullptr;
+
+    std::vector<osg::Vec3d>& coords = batch.coords();
+
+    if ( inputSRS && !coords.empty() )
+    {
+        if ( !_mat.isIdentity() )
+        {
+            for( auto& p : coords )
+                p = p * _mat;
+        }
+
+        // one transformation call for the entire batch:
+        if ( _outputSRS.valid() && !inputSRS->isEquivalentTo(_outputSRS.get()) )
+        {
+            inputSRS->transform( coords, _outputSRS.get() );
+            batch.setSRS( _outputSRS.get() );
+        }
+
+        if ( _localize )
+        {
+            for( auto& p : coords )
+                _bbox.expandBy( p );
+
+            osg::Vec3d center = _bbox.center();
+            for( auto& p : coords )
+                p -= center;
+        }
+    }
+
+    FilterContext outcx( incx );
+
+    if ( _outputSRS.valid() )
+    {
+        if ( incx.workingExtent()->isValid() )
+            outcx.setFeatureProfile( new FeatureProfile( incx.workingExtent()->transform( _outputSRS.get()) ) );
+        else
+            outcx.setFeatureProfile( new FeatureProfile( incx.featureProfile()->getExtent().transform( _outputSRS.get()) ) );
+    }
+
+    return outcx;
+}
@@ -8,6 +8,8 @@
 #include <osgEarth/GeoData>
 
 #include <osgDB/ReadFile>
+#include <algorithm>
+#include <vector>
 
 using namespace osgEarth;
 
@@ -169,6 +171,39 @@ VerticalDatum::transform(const VerticalDatum* from,
     return ok;
 }
 
+bool
+VerticalDatum::transform(const VerticalDatum* from,
+                         const VerticalDatum* to,
+                         const double*        lat_deg,
+                         const double*        lon_deg,
+                         double*              in_out_z,
+                         unsigned             count)
+{
+    if ( from == to )
+        return true;
+
+    if ( from )
+    {
+        from->msl2hae( lat_deg, lon_deg, in_out_z, count );
+    }
+
+    auto fromUnits = from ? from->getUnits() : Units::METERS;
+    auto toUnits = to ? to->getUnits() : Units::METERS;
+
+    if ( fromUnits != toUnits )
+    {
+        for (unsigned i = 0; i < count; ++i)
+            in_out_z[i] = fromUnits.convertTo(toUnits, in_out_z[i]);
+    }
+
+    if ( to )
+    {
+        to->hae2msl( lat_deg, lon_deg, in_out_z, count );
+    }
+
+    return true;
+}
+
 bool
 VerticalDatum::transform(const VerticalDatum* from,
                          const VerticalDatum* to,
@@ -198,28 +233,37 @@ VerticalDatum::transform(const VerticalDatum* from,
 
     auto fromUnits = from ? from->getUnits() : Units::METERS;
     auto toUnits = to ? to->getUnits() : Units::METERS;
+    const double scale = fromUnits.convertTo(toUnits, 1.0);
 
-    for( unsigned c=0; c<cols; ++c)
-    {
-        double lon = sw.x() + xstep*double(c);
-        for( unsigned r=0; r<rows; ++r)
-        {
-            double lat = sw.y() + ystep*double(r);
-            float h = hf->getHeight(c, r);
-            if (h != NO_DATA_VALUE)
-            {
-                //VerticalDatum::transform( from, to, lat, lon, h );
+    // Precompute the offset grid for the whole tile (one row of the
+    // geoid lookup at a time) so the datum offsets come from a single
+    // batched geoid pass instead of two interpolations per sample.
+    const Geoid* fromGeoid = from ? from->getGeoid() : nullptr;
+    const Geoid* toGeoid = to ? to->getGeoid() : nullptr;
 
-                if (from)
-                    h = from->msl2hae(lat, lon, h);
+    std::vector<double> lons(cols), lats(cols);
+    std::vector<float> fromOffsets(cols, 0.0f), toOffsets(cols, 0.0f);
+    for (unsigned c = 0; c < cols; ++c)
+        lons[c] = sw.x() + xstep*double(c);
 
-                if (fromUnits != toUnits)
-                    h = fromUnits.convertTo(toUnits, h);
+    osg::HeightField::HeightList& heights = hf->getHeightList();
 
-                if (to)
-                    h = to->hae2msl(lat, lon, h);
+    for( unsigned r=0; r<rows; ++r)
+    {
+        std::fill(lats.begin(), lats.end(), sw.y() + ystep*double(r));
 
-                hf->setHeight(c, r, h);
+        if (fromGeoid)
+            fromGeoid->getHeights(lats.data(), lons.data(), cols, fromOffsets.data());
+
+        if (toGeoid)
+            toGeoid->getHeights(lats.data(), lons.data(), cols, toOffsets.data());
+
+        float* row = &heights[r*cols];
+        for( unsigned c=0; c<cols; ++c)
+        {
+            if (row[c] != NO_DATA_VALUE)
+            {
+                row[c] = (float)((((double)row[c] + fromOffsets[c]) * scale) - toOffsets[c]);
             }
         }
     }
@@ -227,6 +271,38 @@ VerticalDatum::transform(const VerticalDatum* from,
     return true;
 }
 
+void
+VerticalDatum::msl2hae(const double* lat_deg, const double* lon_deg, double* in_out_z, unsigned count) const
+{
+    if (!_geoid.valid())
+        return;
+
+    float offsets[256];
+    for (unsigned i = 0; i < count; i += 256)
+    {
+        unsigned n = std::min(count - i, 256u);
+        _geoid->getHeights(lat_deg + i, lon_deg + i, n, offsets);
+        for (unsigned j = 0; j < n; ++j)
+            in_out_z[i + j] += offsets[j];
+    }
+}
+
+void
+VerticalDatum::hae2msl(const double* lat_deg, const double* lon_deg, double* in_out_z, unsigned count) const
+{
+    if (!_geoid.valid())
+        return;
+
+    float offsets[256];
+    for (unsigned i = 0; i < count; i += 256)
+    {
+        unsigned n = std::min(count - i, 256u);
+        _geoid->getHeights(lat_deg + i, lon_deg + i, n, offsets);
+        for (unsigned j = 0; j < n; ++j)
+            in_out_z[i + j] -= offsets[j];
+    }
+}
+
 bool 
 VerticalDatum::isEquivalentTo( const VerticalDatum* rhs ) const
 {
@@ -43,12 +43,10 @@ XYZ::Driver::open(const URI& uri,
     return STATUS_OK;
 }
 
-osgEarth::ReadResult
-XYZ::Driver::read(const URI& uri,
-                  const TileKey& key, 
-                  bool invertY,
-                  ProgressCallback* progress,
-                  const osgDB::Options* readOptions) const
+osgEarth::URI
+XYZ::Driver::createURI(const URI& uri,
+                       const TileKey& key,
+                       bool invertY) const
 {
     unsigned x, y;
     key.getTileXY(x, y);
@@ -92,7 +90,27 @@ XYZ::Driver::read(const URI& uri,
         myUri.setCacheKey(Cache::makeCacheKey(location, "uri"));
     }
 
-    return myUri.getImage(readOptions, progress);
+    return myUri;
+}
+
+ReadResult
+XYZ::Driver::read(const URI& uri,
+                  const TileKey& key, 
+                  bool invertY,
+                  ProgressCallback* progress,
+                  const osgDB::Options* readOptions) const
+{
+    return createURI(uri, key, invertY).readImage(readOptions, progress);
+}
+
+ReadResult
+XYZ::Driver::readEncoded(const URI& uri,
+                         const TileKey& key,
+                         bool invertY,
+                         ProgressCallback* progress,
+                         const osgDB::Options* readOptions) const
+{
+    return createURI(uri, key, invertY).readString(readOptions, progress);
 }
 
 //........................................................................
@@ -223,6 +241,17 @@ XYZImageLayer::createImageImplementation(const TileKey& key, ProgressCallback* p
         return GeoImage(Status(r.errorDetail()));
 }
 
+ReadResult
+XYZImageLayer::readEncodedImageImplementation(const TileKey& key, ProgressCallback* progress) const
+{
+    return _driver.readEncoded(
+        options().url().get(),
+        key,
+        options().invertY() == true,
+        progress,
+        getReadOptions());
+}
+
 //........................................................................
 
 REGISTER_OSGEARTH_LAYER(xyzelevation, XYZElevationLayer);
@@ -9,11 +9,15 @@
 #include <cfloat>
 #include <chrono>
 #include <condition_variable>
+#include <cstdint>
 #include <cstdlib>
 #include <functional>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <thread>
 #include <type_traits>
+#include <unordered_map>
 #include <vector>
 #include <string>
 #include <algorithm>
@@ -484,12 +488,112 @@ namespace WEEJOBS_NAMESPACE
     //! but here's an alias for clarity.
     template<class T> using promise = future<T>;
 
+    /**
+    * Snapshot of a latency histogram. Bucket 0 counts samples under 1us,
+    * bucket i counts samples in [2^(i-1), 2^i) us, and the last bucket
+    * also takes everything longer.
+    */
+    struct histogram_t
+    {
+        static constexpr unsigned num_buckets = 32u;
+
+        std::uint64_t buckets[num_buckets] = {};
+        std::uint64_t count = 0u;
+        std::uint64_t total_us = 0u;
+        std::uint64_t max_us = 0u;
+
+        //! Exclusive upper bound of bucket i in microseconds
+        static std::uint64_t bucket_upper_us(unsigned i) {
+            return std::uint64_t(1u) << i;
+        }
+
+        //! Mean sample in microseconds
+        double mean_us() const {
+            return count > 0u ? (double)total_us / (double)count : 0.0;
+        }
+
+        //! Upper bound of the bucket holding the p-th percentile (0..1), in microseconds
+        double percentile_us(double p) const {
+            if (count == 0u) return 0.0;
+            std::uint64_t target = (std::uint64_t)std::max(1.0, p * (double)count), cumulative = 0u;
+            for (unsigned i = 0; i < num_buckets; ++i) {
+                cumulative += buckets[i];
+                if (cumulative >= target)
+                    return (double)std::min(bucket_upper_us(i), max_us);
+            }
+            return (double)max_us;
+        }
+    };
+
+    //! How long jobs waited in the queue and how long they ran
+    struct latency_t
+    {
+        histogram_t queue_wait;
+        histogram_t run_time;
+    };
+
     namespace detail
     {
+        //! Histogram that worker threads update without locking
+        struct atomic_histogram
+        {
+            std::atomic<std::uint64_t> buckets[histogram_t::num_buckets] = {};
+            std::atomic<std::uint64_t> count = { 0u };
+            std::atomic<std::uint64_t> total_us = { 0u };
+            std::atomic<std::uint64_t> max_us = { 0u };
+
+            inline void record(std::chrono::steady_clock::duration d) {
+                auto us = (std::uint64_t)std::max((std::int64_t)0,
+                    (std::int64_t)std::chrono::duration_cast<std::chrono::microseconds>(d).count());
+                unsigned b = 0u;
+                while (b < histogram_t::num_buckets - 1u && (us >> b) != 0u)
+                    ++b;
+                buckets[b].fetch_add(1u, std::memory_order_relaxed);
+                count.fetch_add(1u, std::memory_order_relaxed);
+                total_us.fetch_add(us, std::memory_order_relaxed);
+                auto prev = max_us.load(std::memory_order_relaxed);
+                while (us > prev && !max_us.compare_exchange_weak(prev, us, std::memory_order_relaxed));
+            }
+
+            inline void snapshot(histogram_t& out) const {
+                for (unsigned i = 0; i < histogram_t::num_buckets; ++i)
+                    out.buckets[i] = buckets[i].load(std::memory_order_relaxed);
+                out.count = count.load(std::memory_order_relaxed);
+                out.total_us = total_us.load(std::memory_order_relaxed);
+                out.max_us = max_us.load(std::memory_order_relaxed);
+            }
+
+            inline void reset() {
+                for (auto& b : buckets)
+                    b.store(0u, std::memory_order_relaxed);
+                count = 0u;
+                total_us = 0u;
+                max_us = 0u;
+            }
+        };
+
+        struct atomic_latency
+        {
+            atomic_histogram queue_wait;
+            atomic_histogram run_time;
+
+            inline void snapshot(latency_t& out) const {
+                queue_wait.snapshot(out.queue_wait);
+                run_time.snapshot(out.run_time);
+            }
+
+            inline void reset() {
+                queue_wait.reset();
+                run_time.reset();
+            }
+        };
+
         struct job
         {
             context ctx;
             std::function<bool()> _delegate;
+            std::chrono::steady_clock::time_point _queued = {};
+            atomic_latency* _named_latency = nullptr; // per-name stats in the dispatching pool
 
             bool operator < (const job& rhs) const
             {
@@ -499,6 +603,132 @@ namespace WEEJOBS_NAMESPACE
             }
         };
 
+        /**
+        * Chase-Lev work-stealing deque of heap-allocated jobs. The owning
+        * thread pushes and pops at the bottom without locking; any thread
+        * may steal from the top.
+        */
+        class ws_deque
+        {
+        public:
+            ws_deque()
+            {
+                _rings.emplace_back(new ring(64));
+                _array.store(_rings.back().get(), std::memory_order_relaxed);
+            }
+
+            ~ws_deque()
+            {
+                while (!empty())
+                    delete steal();
+            }
+
+            //! Whether a worker thread owns this deque
+            std::atomic<bool> owned = { false };
+
+            //! Owner only: push a job onto the bottom
+            void push(job* j)
+            {
+                auto b = _bottom.load(std::memory_order_relaxed);
+                auto t = _top.load(std::memory_order_acquire);
+                ring* a = _array.load(std::memory_order_relaxed);
+                if (b - t > a->size - 1)
+                {
+                    // grow; old rings stay alive for concurrent stealers
+                    ring* bigger = new ring(a->size * 2);
+                    for (auto i = t; i < b; ++i)
+                        bigger->put(i, a->get(i));
+                    _rings.emplace_back(bigger);
+                    _array.store(bigger, std::memory_order_release);
+                    a = bigger;
+                }
+                a->put(b, j);
+                _bottom.store(b + 1, std::memory_order_release);
+            }
+
+            //! Owner only: pop the most recently pushed job, or nullptr
+            job* pop()
+            {
+                auto b = _bottom.load(std::memory_order_relaxed) - 1;
+                ring* a = _array.load(std::memory_order_relaxed);
+                _bottom.store(b, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                auto t = _top.load(std::memory_order_relaxed);
+
+                job* j = nullptr;
+                if (t <= b)
+                {
+                    j = a->get(b);
+                    if (t == b)
+                    {
+                        // last one; race the stealers for it
+                        if (!_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                            j = nullptr;
+                        _bottom.store(b + 1, std::memory_order_relaxed);
+                    }
+                }
+                else
+                {
+                    _bottom.store(b + 1, std::memory_order_relaxed);
+                }
+                return j;
+            }
+
+            //! Any thread: take the oldest job, or nullptr if the deque is
+            //! empty or another thread won the race for it
+            job* steal()
+            {
+                auto t = _top.load(std::memory_order_acquire);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                auto b = _bottom.load(std::memory_order_acquire);
+                if (t < b)
+                {
+                    ring* a = _array.load(std::memory_order_acquire);
+                    job* j = a->get(t);
+                    if (_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                        return j;
+                }
+                return nullptr;
+            }
+
+            bool empty() const
+            {
+                return _bottom.load(std::memory_order_seq_cst) <= _top.load(std::memory_order_seq_cst);
+            }
+
+        private:
+            struct ring
+            {
+                ring(std::int64_t n) : size(n), slots(new std::atomic<job*>[n]) { }
+                std::int64_t size;
+                std::unique_ptr<std::atomic<job*>[]> slots;
+                job* get(std::int64_t i) const { return slots[i & (size - 1)].load(std::memory_order_relaxed); }
+                void put(std::int64_t i, job* j) { slots[i & (size - 1)].store(j, std::memory_order_relaxed); }
+            };
+
+            std::atomic<std::int64_t> _top = { 0 };
+            std::atomic<std::int64_t> _bottom = { 0 };
+            std::atomic<ring*> _array = { nullptr };
+            std::vector<std::unique_ptr<ring>> _rings; // owner only
+        };
+
+        //! Identity of a job pool worker thread, plus per-thread dispatch caches
+        struct worker_slot
+        {
+            class jobpool* pool = nullptr;
+            ws_deque* deque = nullptr;
+            unsigned next_victim = 0u;
+            std::string last_name; // per-name latency lookup cache
+            atomic_latency* last_latency = nullptr;
+            class jobpool* last_latency_pool = nullptr;
+        };
+
+        inline worker_slot& this_worker()
+        {
+            static thread_local worker_slot slot;
+            return slot;
+        }
+
         inline bool steal_job(class jobpool* thief, detail::job& stolen);
     }
 
@@ -524,6 +754,58 @@ namespace WEEJOBS_NAMESPACE
 
             //! Whether this pool's counts appear in the total metrics counts
             bool visible = true;
+
+            //! Queue wait and run time of every job this pool ran
+            detail::atomic_latency latency;
+
+            //! Most distinct job names tracked per pool; later names are
+            //! counted under other_job_name.
+            static constexpr unsigned max_job_names = 64u;
+            static constexpr const char* other_job_name = "(other)";
+
+            //! Snapshot of the latency histograms for the whole pool
+            latency_t latency_snapshot() const
+            {
+                latency_t out;
+                latency.snapshot(out);
+                return out;
+            }
+
+            //! Snapshot of the latency histograms for each job name (context::name)
+            std::map<std::string, latency_t> latency_by_name() const
+            {
+                std::map<std::string, latency_t> out;
+                std::lock_guard<std::mutex> lock(_by_name_mutex);
+                for (auto& entry : _by_name)
+                    entry.second->snapshot(out[entry.first]);
+                return out;
+            }
+
+            //! Zero the latency histograms
+            void reset_latency()
+            {
+                latency.reset();
+                std::lock_guard<std::mutex> lock(_by_name_mutex);
+                for (auto& entry : _by_name)
+                    entry.second->reset();
+            }
+
+            //! Per-name stats for a job name (internal). Entries are never
+            //! removed so workers can keep the pointer.
+            detail::atomic_latency* _latency_for(const std::string& job_name)
+            {
+                std::lock_guard<std::mutex> lock(_by_name_mutex);
+                auto iter = _by_name.find(job_name);
+                if (iter != _by_name.end())
+                    return iter->second.get();
+                auto& entry = _by_name[_by_name.size() < max_job_names ? job_name : other_job_name];
+                if (!entry)
+                    entry.reset(new detail::atomic_latency());
+                return entry.get();
+            }
+
+            mutable std::mutex _by_name_mutex;
+            std::unordered_map<std::string, std::unique_ptr<detail::atomic_latency>> _by_name;
         };
 
     public:
@@ -568,13 +850,31 @@ namespace WEEJOBS_NAMESPACE
             _can_steal_work = value;
         }
 
+        //! Whether jobs dispatched from this pool's own workers go to a
+        //! per-worker deque instead of the shared queue. The worker runs
+        //! them newest first, and idle workers steal the oldest. Suits
+        //! fork/join work (jobs that spawn child jobs); priorities of
+        //! those jobs are ignored. Default = false.
+        void set_local_queues(bool value)
+        {
+            _local_queues = value;
+        }
+
+        bool local_queues() const
+        {
+            return _local_queues;
+        }
+
         //! Discard all queued jobs
         void cancel_all()
         {
-            std::lock_guard<std::mutex> lock(_queue_mutex);
-            _queue.clear();
-            _metrics.canceled += _metrics.pending;
-            _metrics.pending = 0;
+            {
+                std::lock_guard<std::mutex> lock(_queue_mutex);
+                _queue.clear();
+                _metrics.canceled += _metrics.pending;
+                _metrics.pending = 0;
+            }
+            _drain_local_queues(true);
         }
 
         //! Schedule an asynchronous task on this scheduler
@@ -591,11 +891,31 @@ namespace WEEJOBS_NAMESPACE
                     context.group->acquire();
                 }
 
-                if (_target_concurrency > 0)
+                auto& worker = detail::this_worker();
+                if (_local_queues && worker.pool == this && worker.deque)
                 {
+                    // spawned by one of our workers: push to its own deque
+                    auto named_latency = _named_latency(worker, context.name);
+
+                    _metrics.pending++;
+                    _metrics.total++;
+                    worker.deque->push(new detail::job{ context, delegate, std::chrono::steady_clock::now(), named_latency });
+
+                    // wake a sleeper to steal it (see the wait in run())
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+                    if (_sleepers.load(std::memory_order_relaxed) > 0)
+                    {
+                        std::lock_guard<std::mutex> lock(_queue_mutex);
+                        _block.notify_one();
+                    }
+                }
+                else if (_target_concurrency > 0)
+                {
+                    auto named_latency = _named_latency(worker, context.name);
+
                     std::lock_guard<std::mutex> lock(_queue_mutex);
 
-                    _queue.emplace_back(detail::job{ context, delegate });
+                    _queue.emplace_back(detail::job{ context, delegate, std::chrono::steady_clock::now(), named_latency });
 
                     _metrics.pending++;
                     _metrics.total++;
@@ -614,6 +934,20 @@ namespace WEEJOBS_NAMESPACE
             }
         }
 
+        //! Per-name stats for a dispatch from this thread. The last lookup is
+        //! kept in the thread's slot, so a loop dispatching under one name
+        //! takes _by_name_mutex once instead of once per job.
+        inline detail::atomic_latency* _named_latency(detail::worker_slot& slot, const std::string& job_name)
+        {
+            if (slot.last_latency == nullptr || slot.last_latency_pool != this || slot.last_name != job_name)
+            {
+                slot.last_latency = _metrics._latency_for(job_name);
+                slot.last_latency_pool = this;
+                slot.last_name = job_name;
+            }
+            return slot.last_latency;
+        }
+
         //! removes the highest priority job from the queue and places it
         //! in output. Returns true if a job was taken, false if the queue
         //! was empty.
@@ -655,6 +989,109 @@ namespace WEEJOBS_NAMESPACE
             return false;
         }
 
+        //! Takes the calling worker's newest local job, then the
+        //! highest-priority shared job, then steals from another worker.
+        inline bool _take_job_local(detail::job& output)
+        {
+            auto& worker = detail::this_worker();
+
+            if (!worker.deque && _local_queues)
+                _attach_local_queue(worker);
+
+            if (worker.deque)
+            {
+                if (auto* j = worker.deque->pop())
+                {
+                    output = std::move(*j);
+                    delete j;
+                    _metrics.pending--;
+                    return true;
+                }
+            }
+
+            if (_take_job(output, true))
+                return true;
+
+            return _steal_local(output, worker.deque, worker.next_victim);
+        }
+
+        //! Steals the oldest job from any worker deque except "exclude"
+        inline bool _steal_local(detail::job& output, detail::ws_deque* exclude, unsigned& next_victim)
+        {
+            unsigned n = _num_deques.load(std::memory_order_acquire);
+            for (unsigned k = 0; k < n; ++k)
+            {
+                auto* deque = _deques[(next_victim + k) % n].get();
+                if (deque == exclude)
+                    continue;
+
+                if (auto* j = deque->steal())
+                {
+                    next_victim = (next_victim + k) % n;
+                    output = std::move(*j);
+                    delete j;
+                    _metrics.pending--;
+                    return true;
+                }
+            }
+            next_victim++;
+            return false;
+        }
+
+        //! Whether any worker deque holds a job
+        inline bool _has_local_work() const
+        {
+            unsigned n = _num_deques.load(std::memory_order_acquire);
+            for (unsigned i = 0; i < n; ++i)
+                if (!_deques[i]->empty())
+                    return true;
+            return false;
+        }
+
+        //! Gives the calling worker a deque, reusing one left by an exited worker
+        inline void _attach_local_queue(detail::worker_slot& worker)
+        {
+            std::lock_guard<std::mutex> lock(_queue_mutex);
+            unsigned n = _num_deques.load(std::memory_order_relaxed);
+            for (unsigned i = 0; i < n; ++i)
+            {
+                bool expected = false;
+                if (_deques[i]->owned.compare_exchange_strong(expected, true, std::memory_order_acquire))
+                {
+                    worker.deque = _deques[i].get();
+                    return;
+                }
+            }
+            if (n < max_local_queues)
+            {
+                _deques[n].reset(new detail::ws_deque());
+                _deques[n]->owned = true;
+                worker.deque = _deques[n].get();
+                _num_deques.store(n + 1, std::memory_order_release);
+            }
+        }
+
+        //! Empties every worker deque, releasing the jobs' groups
+        inline void _drain_local_queues(bool count_as_canceled)
+        {
+            unsigned n = _num_deques.load(std::memory_order_acquire);
+            for (unsigned i = 0; i < n; ++i)
+            {
+                while (!_deques[i]->empty())
+                {
+                    if (auto* j = _deques[i]->steal())
+                    {
+                        if (j->ctx.group)
+                            j->ctx.group->release();
+                        delete j;
+                        _metrics.pending--;
+                        if (count_as_canceled)
+                            _metrics.canceled++;
+                    }
+                }
+            }
+        }
+
         //! Construct a new job pool.
         //! Do not call this directly - call getPool(name) instead.
         jobpool(const std::string& name, unsigned concurrency) :
@@ -679,6 +1116,11 @@ namespace WEEJOBS_NAMESPACE
         inline void join_threads();
 
         bool _can_steal_work = true;
+        std::atomic<bool> _local_queues = { false }; // per-worker deques for jobs spawned by workers
+        static constexpr unsigned max_local_queues = 128u;
+        std::unique_ptr<detail::ws_deque> _deques[max_local_queues]; // never freed while the pool lives
+        std::atomic<unsigned> _num_deques = { 0u };
+        std::atomic<int> _sleepers = { 0 }; // workers waiting on _block
         std::vector<detail::job> _queue;
         mutable std::mutex _queue_mutex; // protect access to the queue
         mutable std::mutex _quit_mutex; // protects access to _done
@@ -713,6 +1155,9 @@ namespace WEEJOBS_NAMESPACE
             return _pools;
         }
 
+        //! Zero the latency histograms of all job pools
+        void reset_latency();
+
         std::vector<struct jobpool::metrics_t*> _pools;
     };
 
@@ -909,10 +1354,38 @@ namespace WEEJOBS_NAMESPACE
 
     inline void jobpool::run()
     {
+        auto& worker = detail::this_worker();
+        worker.pool = this;
+
         while (!_done)
         {
             detail::job next;
             bool have_next = false;
+
+            if (_local_queues || _num_deques.load(std::memory_order_acquire) > 0)
+            {
+                have_next = _take_job_local(next);
+
+                if (!have_next && _can_steal_work && instance()._stealing_allowed)
+                {
+                    have_next = detail::steal_job(this, next);
+                }
+
+                if (!have_next)
+                {
+                    std::unique_lock<std::mutex> lock(_queue_mutex);
+
+                    // Register as a sleeper before checking the deques. A worker
+                    // that pushes to its deque checks for sleepers afterwards,
+                    // so one of the two always sees the other.
+                    _sleepers.fetch_add(1);
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+                    _block.wait(lock, [this]() { return !_queue.empty() || _done || _has_local_work(); });
+                    _sleepers.fetch_sub(1);
+                    continue;
+                }
+            }
+            else
             {
                 if (_can_steal_work && instance()._stealing_allowed)
                 {
@@ -952,12 +1425,24 @@ namespace WEEJOBS_NAMESPACE
                 _metrics.running++;
 
                 auto t0 = std::chrono::steady_clock::now();
+                auto wait = t0 - next._queued;
 
                 bool job_executed = next._delegate();
 
                 auto duration = std::chrono::steady_clock::now() - t0;
 
-                if (job_executed == false)
+                // canceled jobs waited but did not run, so they only count toward queue_wait
+                _metrics.latency.queue_wait.record(wait);
+                if (next._named_latency)
+                    next._named_latency->queue_wait.record(wait);
+
+                if (job_executed)
+                {
+                    _metrics.latency.run_time.record(duration);
+                    if (next._named_latency)
+                        next._named_latency->run_time.record(duration);
+                }
+                else
                 {
                     _metrics.canceled++;
                 }
@@ -981,6 +1466,13 @@ namespace WEEJOBS_NAMESPACE
                 break;
             }
         }
+
+        // leave our deque to the other workers; a new worker may adopt it
+        if (worker.deque)
+        {
+            worker.deque->owned.store(false, std::memory_order_release);
+        }
+        worker = {};
     }
 
     inline void jobpool::start_threads()
@@ -1022,6 +1514,8 @@ namespace WEEJOBS_NAMESPACE
         }
         _queue.clear();
 
+        _drain_local_queues(false);
+
         // wake up all threads so they can exit
         _block.notify_all();
     }
@@ -1060,14 +1554,22 @@ namespace WEEJOBS_NAMESPACE
                     }
                 }
             }
-        }
 
-        if (pool_with_most_jobs)
-        {
-            return pool_with_most_jobs->_take_job(stolen, true);
+            // no shared jobs anywhere; try the worker deques of other pools.
+            // stealing from a deque is lock-free, so do it under the lock we hold.
+            if (!pool_with_most_jobs)
+            {
+                for (auto pool : instance()._pools)
+                {
+                    unsigned victim = 0u;
+                    if (pool != thief && pool->_steal_local(stolen, nullptr, victim))
+                        return true;
+                }
+                return false;
+            }
         }
 
-        return false;
+        return pool_with_most_jobs->_take_job(stolen, true);
     }
 
     template<typename T>
@@ -1263,6 +1765,14 @@ namespace WEEJOBS_NAMESPACE
         return count;
     }
 
+    //! Zero the latency histograms of all job pools
+    inline void metrics::reset_latency()
+    {
+        std::lock_guard<std::mutex> lock(instance()._pools_mutex);
+        for (auto pool : _pools)
+            pool->reset_latency();
+    }
+
     // Use this macro ONCE in your application in a .cpp file to 
     // instaniate the weejobs runtime singleton.
 #define WEEJOBS_INSTANCE \
@@ -660,7 +660,7 @@ namespace
             _writeCacheRWM.unlock();
 
             // asynchronous write
-            jobs::dispatch(write_op, jobs::context{ fileURI.full(), _pool });
+            jobs::dispatch(write_op, jobs::context{ "oe.fscache.write", _pool });
         }
 
         else
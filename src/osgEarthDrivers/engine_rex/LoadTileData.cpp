@@ -6,6 +6,7 @@
 #include "SurfaceNode"
 #include "TileNode"
 #include "EngineContext"
+#include "Prefetcher"
 
 #include <osgEarth/TerrainEngineNode>
 #include <osgEarth/Terrain>
@@ -28,6 +29,7 @@ LoadTileDataOperation::LoadTileDataOperation(
 {
     _engine = context->getEngine();
     _name = tilenode->getKey().str();
+    _prefetcher = context->getPrefetcher();
 }
 
 LoadTileDataOperation::LoadTileDataOperation(
@@ -43,6 +45,7 @@ LoadTileDataOperation::LoadTileDataOperation(
 {
     _engine = context->getEngine();
     _name = tilenode->getKey().str();
+    _prefetcher = context->getPrefetcher();
 }
 
 LoadTileDataOperation::~LoadTileDataOperation()
@@ -99,6 +102,14 @@ LoadTileDataOperation::dispatch(bool async)
     };
 
 
+    // A full (all-layers) load may already be in flight if the prefetcher
+    // predicted this tile; if so adopt that job instead of starting another.
+    if (async && _manifest.empty() && _prefetcher &&
+        _prefetcher->take(key, priority_func, _result))
+    {
+        return true;
+    }
+
     if (async)
     {
         jobs::context context;
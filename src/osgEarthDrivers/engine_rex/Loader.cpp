@@ -13,6 +13,9 @@
 #include <osgUtil/IncrementalCompileOperation>
 #include <osgViewer/View>
 
+#include <osg/Timer>
+
+#include <algorithm>
 #include <string>
 
 using namespace osgEarth;
@@ -21,14 +24,30 @@ using namespace osgEarth::REX;
 #undef LC
 #define LC "[Merger] "
 
+// weight of the newest sample in the running merge cost estimates
+#define COST_SMOOTHING 0.2
+
+// priority boost for tiles that were culled last frame, so they merge
+// ahead of tiles that are loading but not currently in view
+#define VISIBLE_PRIORITY_BOOST 1000.0f
+
 Merger::Merger() :
-    _mergesPerFrame(~0)
+    _mergesPerFrame(~0),
+    _mergeTimeBudget(0.0f),
+    _tileClock(nullptr),
+    _averageCost(0.0),
+    _mergesLastFrame(0u),
+    _mergeTimeLastFrame(0.0),
+    _peakMergeTime(0.0),
+    _totalMerges(0u)
 {
     setCullingActive(false);
     setNumChildrenRequiringUpdateTraversal(+1);
 
     auto pool = jobs::get_pool(ARENA_LOAD_TILE);
     _metrics = pool->metrics();
+
+    std::fill(std::begin(_costEstimate), std::end(_costEstimate), 0.0);
 }
 
 Merger::~Merger()
@@ -42,6 +61,111 @@ Merger::setMergesPerFrame(unsigned value)
     _mergesPerFrame = value;
 }
 
+void
+Merger::setMergeTimeBudget(float milliseconds)
+{
+    _mergeTimeBudget = std::max(milliseconds, 0.0f);
+}
+
+void
+Merger::setTileClock(const FrameClock* clock)
+{
+    _tileClock = clock;
+}
+
+TerrainEngine::MergeStats
+Merger::getStats() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    TerrainEngine::MergeStats stats;
+    stats.mergeQueueDepth = (unsigned)_mergeQueue.size();
+    stats.compileQueueDepth = (unsigned)_compileQueue.size();
+    stats.mergesLastFrame = _mergesLastFrame;
+    stats.mergeTimeLastFrame = _mergeTimeLastFrame;
+    stats.peakMergeTime = _peakMergeTime;
+    stats.totalMerges = _totalMerges;
+    stats.timeBudget = _mergeTimeBudget;
+    return stats;
+}
+
+void
+Merger::resetStats()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _peakMergeTime = 0.0;
+}
+
+unsigned
+Merger::getCostClass(const LoadTileDataOperation& data)
+{
+    if (!data._result.available() || !data._result.value().valid())
+        return 0u;
+
+    const TerrainTileModel& model = *data._result.value();
+
+    unsigned layers = (unsigned)model.colorLayers.size();
+    if (model.elevation.texture) ++layers;
+    if (model.normalMap.texture) ++layers;
+    if (model.landCover.texture) ++layers;
+    if (model.mesh.verts.valid()) ++layers;
+
+    return std::min(layers, NUM_COST_CLASSES - 1u);
+}
+
+double
+Merger::predictCost(unsigned costClass) const
+{
+    // fall back on the overall average until this class has history
+    return _costEstimate[costClass] > 0.0 ? _costEstimate[costClass] : _averageCost;
+}
+
+void
+Merger::recordCost(unsigned costClass, double milliseconds)
+{
+    double& estimate = _costEstimate[costClass];
+    estimate = estimate > 0.0 ?
+        estimate + COST_SMOOTHING * (milliseconds - estimate) :
+        milliseconds;
+
+    _averageCost = _averageCost > 0.0 ?
+        _averageCost + COST_SMOOTHING * (milliseconds - _averageCost) :
+        milliseconds;
+}
+
+void
+Merger::prioritize()
+{
+    // Tiles that disappeared go first since they are discarded at no cost.
+    // The stable sort keeps successive loads for the same tile in order.
+    const int frame = _tileClock ? (int)_tileClock->getFrame() : -1;
+
+    std::vector<std::pair<float, LoadTileDataOperationPtr>> ranked;
+    ranked.reserve(_mergeQueue.size());
+
+    for (auto& data : _mergeQueue)
+    {
+        float priority = FLT_MAX;
+
+        osg::ref_ptr<TileNode> tilenode;
+        if (data && data->_tilenode.lock(tilenode))
+        {
+            priority = tilenode->getLoadPriority();
+            if (frame >= 0 && tilenode->getLastTraversalFrame() + 1 >= frame)
+                priority += VISIBLE_PRIORITY_BOOST;
+        }
+
+        ranked.emplace_back(priority, std::move(data));
+    }
+
+    std::stable_sort(ranked.begin(), ranked.end(),
+        [](const auto& lhs, const auto& rhs) { return lhs.first > rhs.first; });
+
+    _mergeQueue.clear();
+    for (auto& entry : ranked)
+        _mergeQueue.emplace_back(std::move(entry.second));
+}
+
 void
 Merger::clear()
 {
@@ -100,13 +224,13 @@ Merger::merge(LoadTileDataOperationPtr data, osg::NodeVisitor& nv)
         }
         else
         {
-            _mergeQueue.push(data);
+            _mergeQueue.push_back(data);
         }
     }
     else
     {
         std::lock_guard<std::mutex> lock(_mutex);
-        _mergeQueue.push(data);
+        _mergeQueue.push_back(data);
     }
 
     if (_metrics)
@@ -136,7 +260,7 @@ Merger::traverse(osg::NodeVisitor& nv)
             if (next._compiled.available())
             {
                 // compile finished, put it on the merge queue
-                _mergeQueue.emplace(std::move(next._data));
+                _mergeQueue.emplace_back(std::move(next._data));
 
                 // note: no change the metrics since we are just moving from
                 // one queue to another
@@ -164,6 +288,16 @@ Merger::traverse(osg::NodeVisitor& nv)
         if (max_count == 0)
             max_count = INT_MAX;
 
+        const bool budgeted = _mergeTimeBudget > 0.0f;
+        if (budgeted && _mergeQueue.size() > 1)
+        {
+            prioritize();
+        }
+
+        const osg::Timer* timer = osg::Timer::instance();
+        const osg::Timer_t frameStart = timer->tick();
+        double elapsed = 0.0;
+
         while (!_mergeQueue.empty() && count < max_count)
         {
             LoadTileDataOperationPtr next = _mergeQueue.front();
@@ -172,9 +306,26 @@ Merger::traverse(osg::NodeVisitor& nv)
             {
                 if (next->_result.available())
                 {
+                    unsigned costClass = getCostClass(*next);
+
+                    // Stop if the next merge is likely to overrun the budget,
+                    // but always merge at least one tile so the queue drains.
+                    if (budgeted && count > 0 &&
+                        elapsed + predictCost(costClass) > _mergeTimeBudget)
+                    {
+                        break;
+                    }
+
+                    osg::Timer_t start = timer->tick();
+
                     // only tiles that succesfully merge count toward the max count
                     if (next->merge())
+                    {
                         ++count;
+                        recordCost(costClass, timer->delta_m(start, timer->tick()));
+                    }
+
+                    elapsed = timer->delta_m(frameStart, timer->tick());
                 }
                 else
                 {
@@ -182,7 +333,7 @@ Merger::traverse(osg::NodeVisitor& nv)
                 }
             }
 
-            _mergeQueue.pop();
+            _mergeQueue.pop_front();
 
             if (_metrics)
             {
@@ -190,6 +341,14 @@ Merger::traverse(osg::NodeVisitor& nv)
             }
         }
 
+        _mergesLastFrame = count;
+        _mergeTimeLastFrame = elapsed;
+        _peakMergeTime = std::max(_peakMergeTime, elapsed);
+        _totalMerges += count;
+
+        OE_PROFILING_PLOT("Merge queue", (float)_mergeQueue.size());
+        OE_PROFILING_PLOT("Merge time (ms)", (float)elapsed);
+
         //if (count > 0)
         //{
         //    OE_INFO << LC << "Merged " << count << std::endl;
@@ -0,0 +1,431 @@
+/* osgEarth
+* Copyright 2025 Pelican Mapping
+* MIT License
+*/
+#include "Prefetcher"
+#include "EngineContext"
+#include "SelectionInfo"
+#include "TileNodeRegistry"
+
+#include <osgEarth/Map>
+#include <osgEarth/GeoData>
+#include <osg/Quat>
+#include <algorithm>
+#include <cmath>
+#include <unordered_set>
+
+using namespace osgEarth::REX;
+using namespace osgEarth;
+
+#define LC "[Prefetcher] "
+
+namespace
+{
+    // seconds of camera history used to estimate velocity and acceleration
+    constexpr double HISTORY = 0.5;
+
+    // number of points along the predicted path at which to sample tiles
+    constexpr unsigned STEPS = 4u;
+
+    // seconds a loaded prefetch may sit outside the prediction before
+    // it is discarded; covers a camera that wobbles back onto its path
+    constexpr double GRACE = 1.0;
+}
+
+float
+Prefetcher::Priority::get()
+{
+    std::function<float()> func;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!follow)
+            return value;
+        func = follow;
+    }
+    return func();
+}
+
+Prefetcher::Prefetcher(EngineContext* context) :
+    _context(context),
+    _lastFrame(~0u)
+{
+    //nop
+}
+
+void
+Prefetcher::update(
+    const osg::Vec3d& eye,
+    const osg::Vec3d& look,
+    double time,
+    unsigned frame,
+    float lodScale)
+{
+    std::vector<Target> predicted;
+    std::vector<TileKey> keys;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        if (frame == _lastFrame)
+            return;
+        _lastFrame = frame;
+
+        // a clock that jumps backwards invalidates the history
+        if (!_samples.empty() && time <= _samples.back().time)
+            _samples.clear();
+
+        _samples.push_back(Sample{ time, eye, look });
+        while (_samples.size() > 3u && time - _samples.front().time > HISTORY)
+            _samples.pop_front();
+
+        predict(lodScale, predicted);
+
+        for (auto& request : _requests)
+            keys.push_back(request.first);
+    }
+
+    // Most urgent first, without duplicates:
+    std::unordered_map<TileKey, float> wanted;
+    std::vector<Target> targets;
+    targets.reserve(predicted.size());
+    for (auto& target : predicted)
+    {
+        auto i = wanted.find(target.key);
+        if (i == wanted.end())
+        {
+            wanted[target.key] = target.priority;
+            targets.push_back(target);
+            keys.push_back(target.key);
+        }
+        else if (target.priority > i->second)
+        {
+            i->second = target.priority;
+        }
+    }
+    for (auto& target : targets)
+        target.priority = wanted[target.key];
+
+    std::stable_sort(targets.begin(), targets.end(),
+        [](const Target& lhs, const Target& rhs) { return lhs.priority > rhs.priority; });
+
+    // Check which tiles exist before relocking, since the registry
+    // lock is taken before tile load locks elsewhere.
+    std::unordered_set<TileKey> resident;
+    auto tiles = _context->tiles();
+    for (auto& key : keys)
+    {
+        if (tiles->contains(key))
+            resident.insert(key);
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // Drop prefetches the camera is no longer heading for. A tile that now
+    // exists keeps its prefetch since its load operation is about to adopt it.
+    for (auto i = _requests.begin(); i != _requests.end(); )
+    {
+        Request& request = i->second;
+        auto w = wanted.find(i->first);
+        if (w != wanted.end())
+        {
+            request.lastWanted = time;
+            std::lock_guard<std::mutex> plock(request.priority->mutex);
+            request.priority->value = w->second;
+        }
+
+        if (request.result.empty())
+        {
+            // canceled by the job system
+            ++_stats.canceled;
+            i = _requests.erase(i);
+        }
+        else if (request.lastWanted == time || resident.count(i->first) > 0)
+        {
+            ++i;
+        }
+        else if (request.result.available() == false)
+        {
+            // dropping the last reference to the future cancels the job
+            ++_stats.canceled;
+            i = _requests.erase(i);
+        }
+        else if (time - request.lastWanted > GRACE)
+        {
+            ++_stats.expired;
+            i = _requests.erase(i);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+
+    // Dispatch new prefetches for tiles that don't exist yet:
+    unsigned maxTiles = _context->options().getMaxPrefetchTiles();
+    for (auto& target : targets)
+    {
+        if (_requests.size() >= maxTiles)
+            break;
+
+        if (_requests.count(target.key) > 0 || resident.count(target.key) > 0)
+            continue;
+
+        Request& request = _requests[target.key];
+        request.priority = std::make_shared<Priority>();
+        request.priority->value = target.priority;
+        request.lastWanted = time;
+        dispatch(target.key, request);
+
+        if (request.result.empty())
+            _requests.erase(target.key);
+        else
+            ++_stats.issued;
+    }
+}
+
+void
+Prefetcher::predict(float lodScale, std::vector<Target>& output) const
+{
+    float horizon = _context->options().getPrefetchHorizon();
+    if (_samples.size() < 3u || horizon <= 0.0f)
+        return;
+
+    osg::ref_ptr<const Map> map = _context->getMap();
+    if (!map.valid())
+        return;
+
+    // Finite differences over the two halves of the history window:
+    const Sample& first = _samples.front();
+    const Sample& middle = _samples[_samples.size() / 2];
+    const Sample& last = _samples.back();
+
+    double dt1 = middle.time - first.time;
+    double dt2 = last.time - middle.time;
+    if (dt1 <= 0.0 || dt2 <= 0.0)
+        return;
+
+    osg::Vec3d v1 = (middle.eye - first.eye) / dt1;
+    osg::Vec3d velocity = (last.eye - middle.eye) / dt2;
+    osg::Vec3d accel = (velocity - v1) / (0.5 * (dt1 + dt2));
+
+    // A noisy acceleration estimate grows with the square of the horizon;
+    // never let it move the prediction further than the velocity does.
+    double maxAccel = 2.0 * velocity.length() / horizon;
+    double accelLength = accel.length();
+    if (accelLength > maxAccel)
+        accel *= maxAccel / accelLength;
+
+    const SpatialReference* srs = map->getSRS();
+    bool geocentric = srs->isGeographic();
+    const Ellipsoid& ellipsoid = srs->getEllipsoid();
+
+    osg::Vec3d up = geocentric ? ellipsoid.geocentricToUpVector(last.eye) : osg::Vec3d(0, 0, 1);
+
+    // Heading rate: how fast the look vector turns about the local up vector
+    auto flatten = [&up](const osg::Vec3d& look)
+        {
+            osg::Vec3d heading = look - up * (look * up);
+            return heading.normalize() > 0.0 ? heading : osg::Vec3d();
+        };
+
+    double yawRate = 0.0;
+    osg::Vec3d h1 = flatten(middle.look), h2 = flatten(last.look);
+    if (h1.length2() > 0.0 && h2.length2() > 0.0)
+    {
+        yawRate = atan2((h1 ^ h2) * up, h1 * h2) / dt2;
+    }
+
+    // A camera at rest needs nothing the culler isn't already loading
+    if (velocity.length() * horizon < 1.0 && fabs(yawRate) * horizon < 0.01)
+        return;
+
+    for (unsigned step = 1; step <= STEPS; ++step)
+    {
+        double t = horizon * (double)step / (double)STEPS;
+        osg::Vec3d eye = last.eye + velocity * t + accel * (0.5 * t * t);
+        osg::Vec3d look = osg::Quat(yawRate * t, up) * last.look;
+        float priority = -(float)step;
+
+        // ground point directly below the predicted eye:
+        GeoPoint nadir;
+        if (nadir.fromWorld(srs, eye) && nadir.z() > 0.0)
+        {
+            double height = nadir.z();
+            nadir.z() = 0.0;
+            nadir.altitudeMode() = ALTMODE_ABSOLUTE;
+            osg::Vec3d ground;
+            if (nadir.toWorld(ground))
+                addTargets(ground, height, lodScale, priority, output);
+        }
+
+        // ground point in the predicted view direction:
+        osg::Vec3d hit;
+        bool hitGround = false;
+        if (geocentric)
+        {
+            hitGround =
+                ellipsoid.intersectGeocentricLine(eye, eye + look, hit) &&
+                (hit - eye) * look > 0.0;
+        }
+        else if (look.z() < 0.0 && eye.z() > 0.0)
+        {
+            hit = eye + look * (-eye.z() / look.z());
+            hitGround = true;
+        }
+
+        if (hitGround)
+        {
+            addTargets(hit, (hit - eye).length(), lodScale, priority - 0.5f, output);
+        }
+    }
+}
+
+void
+Prefetcher::addTargets(
+    const osg::Vec3d& world,
+    double distance,
+    float lodScale,
+    float priority,
+    std::vector<Target>& output) const
+{
+    const SelectionInfo& si = _context->getSelectionInfo();
+    unsigned firstLOD = _context->options().getFirstLOD();
+    unsigned maxLOD = std::min(si.getNumLODs(), _context->options().getMaxLOD() + 1u);
+
+    // The culler draws the deepest LOD whose visibility range covers the
+    // distance (ranges shrink as the LOD increases).
+    float range = (float)distance * lodScale;
+    int lod = -1;
+    for (unsigned i = firstLOD; i < maxLOD && si.getLOD(i)._visibilityRange > range; ++i)
+        lod = (int)i;
+
+    if (lod <= (int)firstLOD)
+        return;
+
+    osg::ref_ptr<const Map> map = _context->getMap();
+    GeoPoint point;
+    if (!map.valid() || !point.fromWorld(map->getSRS(), world))
+        return;
+
+    TileKey key = map->getProfile()->createTileKey(point, lod);
+    if (!key.valid())
+        return;
+
+    // The parent must exist before the tile can, so it goes first;
+    // then the tile itself and the ring of tiles around it.
+    output.push_back(Target{ key.createParentKey(), priority + 0.25f });
+    output.push_back(Target{ key, priority });
+
+    for (int dy = -1; dy <= 1; ++dy)
+    {
+        for (int dx = -1; dx <= 1; ++dx)
+        {
+            if (dx == 0 && dy == 0)
+                continue;
+
+            TileKey neighbor = key.createNeighborKey(dx, dy);
+            if (neighbor.valid())
+                output.push_back(Target{ neighbor, priority - 0.25f });
+        }
+    }
+}
+
+void
+Prefetcher::dispatch(const TileKey& key, Request& request)
+{
+    osg::ref_ptr<TerrainEngineNode> engine = _context->getEngine();
+    osg::ref_ptr<const Map> map = _context->getMap();
+    if (!engine.valid() || !map.valid())
+        return;
+
+    // an empty manifest loads all layers, just like a new tile's first load
+    CreateTileManifest manifest;
+
+    auto load = [engine, map, key, manifest](Cancelable& progress)
+    {
+        osg::ref_ptr<ProgressCallback> wrapper = new ProgressCallback(&progress);
+
+        osg::ref_ptr<TerrainTileModel> result = engine->createTileModel(
+            map.get(),
+            key,
+            manifest,
+            wrapper.get());
+
+        return result;
+    };
+
+    auto priority = request.priority;
+
+    jobs::context context;
+    context.name = "oe.rex.prefetch";
+    context.pool = jobs::get_pool(ARENA_LOAD_TILE);
+    context.priority = [priority]() { return priority->get(); };
+    request.result = jobs::dispatch(load, context);
+}
+
+bool
+Prefetcher::take(
+    const TileKey& key,
+    const std::function<float()>& priority,
+    Future<LoadResult>& output)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto i = _requests.find(key);
+    if (i == _requests.end())
+        return false;
+
+    Request& request = i->second;
+    bool taken = !request.result.empty();
+    if (taken)
+    {
+        {
+            std::lock_guard<std::mutex> plock(request.priority->mutex);
+            request.priority->follow = priority;
+        }
+        output = request.result;
+        ++_stats.used;
+    }
+    else
+    {
+        ++_stats.canceled;
+    }
+
+    _requests.erase(i);
+    return taken;
+}
+
+void
+Prefetcher::clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    for (auto& request : _requests)
+    {
+        if (request.second.result.available())
+            ++_stats.expired;
+        else
+            ++_stats.canceled;
+    }
+
+    _requests.clear();
+    _samples.clear();
+    _lastFrame = ~0u;
+}
+
+Prefetcher::Stats
+Prefetcher::getStats() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    Stats stats = _stats;
+    stats.loading = 0u;
+    stats.ready = 0u;
+    for (auto& request : _requests)
+    {
+        if (request.second.result.available())
+            ++stats.ready;
+        else
+            ++stats.loading;
+    }
+    return stats;
+}
@@ -19,6 +19,7 @@
 #include <osgEarth/Elevation>
 #include <osgEarth/LandCover>
 #include <osgEarth/ShaderFactory>
+#include <osgEarth/CameraUtils>
 
 #include <osg/BlendFunc>
 #include <osg/Depth>
@@ -102,6 +103,20 @@ namespace
             tileNode.refreshSharedSamplers(_bindings);
         }
     };
+
+    // Whether a cull traversal comes from a camera that selects terrain tiles
+    // for display, as opposed to shadow, picking, RTT or spy cameras.
+    bool isViewCamera(const TerrainCuller& culler)
+    {
+        const osg::Camera* cam = culler._camera;
+        return
+            cam != nullptr &&
+            culler._isSpy == false &&
+            cam->getReferenceFrame() != osg::Camera::ABSOLUTE_RF_INHERIT_VIEWPOINT &&
+            cam->isRenderToTextureCamera() == false &&
+            CameraUtils::isShadowCamera(cam) == false &&
+            CameraUtils::isPickCamera(cam) == false;
+    }
 }
 
 //------------------------------------------------------------------------
@@ -150,6 +165,7 @@ RexTerrainEngineNode::RexTerrainEngineNode() :
     _cachedLayerExtentsComputeRequired = true;
 
     _updatedThisFrame = false;
+    _tilesAwaitingData = 0u;
 }
 
 RexTerrainEngineNode::~RexTerrainEngineNode()
@@ -222,6 +238,47 @@ RexTerrainEngineNode::getNumResidentTiles() const
     return _tiles ? _tiles->size() : 0u;
 }
 
+TerrainEngine::ResidencyStats
+RexTerrainEngineNode::getResidencyStats() const
+{
+    ResidencyStats stats;
+    if (_tiles)
+    {
+        stats.tiles = _tiles->size();
+        stats.cpuBytes = _tiles->getCPUBytes();
+        stats.gpuBytes = _tiles->getGPUBytes();
+        stats.evictions = _tiles->getNumBudgetEvictions();
+    }
+    stats.budgetBytes = (std::uint64_t)_optionsConcrete.tileMemoryBudget().get() * 1048576u;
+    return stats;
+}
+
+TerrainEngine::MergeStats
+RexTerrainEngineNode::getMergeStats() const
+{
+    return _merger.valid() ? _merger->getStats() : MergeStats();
+}
+
+void
+RexTerrainEngineNode::resetMergeStats()
+{
+    if (_merger.valid())
+        _merger->resetStats();
+}
+
+TerrainEngine::PrefetchStats
+RexTerrainEngineNode::getPrefetchStats() const
+{
+    auto prefetcher = _engineContext.valid() ? _engineContext->getPrefetcher() : nullptr;
+    return prefetcher ? prefetcher->getStats() : PrefetchStats();
+}
+
+unsigned
+RexTerrainEngineNode::getNumTilesAwaitingData() const
+{
+    return _tilesAwaitingData;
+}
+
 void
 RexTerrainEngineNode::onSetMap()
 {
@@ -280,6 +337,8 @@ RexTerrainEngineNode::onSetMap()
     // Geometry compiler/merger
     _merger = new Merger();
     _merger->setMergesPerFrame(options.getMergesPerFrame());
+    _merger->setMergeTimeBudget(options.getMergeTimeBudget());
+    _merger->setTileClock(&_clock);
     this->addChild(_merger.get());
 
     // Loader concurrency (size of the thread pool)
@@ -321,6 +380,11 @@ RexTerrainEngineNode::onSetMap()
         _selectionInfo,
         &_clock);
 
+    if (options.getPrefetch() == true)
+    {
+        _engineContext->_prefetcher = std::make_shared<Prefetcher>(_engineContext.get());
+    }
+
     // Calculate the LOD morphing parameters:
     unsigned maxLOD = options.getMaxLOD();
 
@@ -452,6 +516,12 @@ RexTerrainEngineNode::invalidateRegion(
         }
 
         _tiles->setDirty(extentLocal, minLevel, maxLevel, manifest);
+
+        // prefetched data predates the invalidation
+        if (_engineContext.valid() && _engineContext->getPrefetcher())
+        {
+            _engineContext->getPrefetcher()->clear();
+        }
     }
 }
 
@@ -488,6 +558,12 @@ RexTerrainEngineNode::invalidateRegion(
         }
 
         _tiles->setDirty(extentLocal, minLevel, maxLevel, manifest);
+
+        // prefetched data predates the invalidation
+        if (_engineContext.valid() && _engineContext->getPrefetcher())
+        {
+            _engineContext->getPrefetcher()->clear();
+        }
     }
 }
 
@@ -511,6 +587,12 @@ RexTerrainEngineNode::refresh(bool forceDirty)
         // clear the loader:
         _merger->clear();
 
+        // cancel any predictive loads:
+        if (_engineContext.valid() && _engineContext->getPrefetcher())
+        {
+            _engineContext->getPrefetcher()->clear();
+        }
+
         // clear out the tile registry:
         if (_tiles)
         {
@@ -704,6 +786,7 @@ RexTerrainEngineNode::dirtyTerrainOptions()
     _tiles->setNotifyNeighbors(options.getNormalizeEdges() == true);
 
     _merger->setMergesPerFrame(options.getMergesPerFrame());
+    _merger->setMergeTimeBudget(options.getMergeTimeBudget());
 
     jobs::get_pool(ARENA_LOAD_TILE)->set_concurrency(options.getConcurrency());
 
@@ -751,6 +834,30 @@ RexTerrainEngineNode::cull_traverse(osg::NodeVisitor& nv)
     // Assemble the terrain drawables:
     _terrain->accept(culler);
 
+    // Record how much of the view still needs data, and feed the camera's
+    // motion to the prefetcher so it can load the tiles it will need next.
+    if (isViewCamera(culler))
+    {
+        _tilesAwaitingData = culler._tilesAwaitingData;
+
+        auto prefetcher = getEngineContext()->getPrefetcher();
+        if (prefetcher)
+        {
+            osg::Matrixd inverseMV;
+            inverseMV.invert(*cv->getModelViewMatrix());
+            osg::Vec3d eye = osg::Vec3d(0, 0, 0) * inverseMV;
+            osg::Vec3d look = osg::Vec3d(0, 0, -1) * inverseMV - eye;
+            look.normalize();
+
+            prefetcher->update(
+                eye,
+                look,
+                nv.getFrameStamp()->getReferenceTime(),
+                _clock.getFrame(),
+                cv->getLODScale());
+        }
+    }
+
     // If we're using geometry pooling, optimize the drawable forf shared state
     // by sorting the draw commands.
     // Skip if using GL4/indirect rendering. Actually seems to hurt?
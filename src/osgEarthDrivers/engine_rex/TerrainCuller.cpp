@@ -45,6 +45,7 @@ TerrainCuller::reset(
     _currentTileNode = nullptr;
     _firstDrawCommandForTile = nullptr;
     _orphanedPassesDetected = 0u;
+    _tilesAwaitingData = 0u;
     _layerExtents = &layerExtents;
     bool temp;
     _isSpy = _cv->getUserValue("osgEarth.Spy", temp);
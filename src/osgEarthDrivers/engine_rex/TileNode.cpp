@@ -503,6 +503,12 @@ TileNode::cull(TerrainCuller* culler)
         _surface->accept( *culler );
     }
 
+    // Count tiles that are still short of their final resolution
+    if (dirty() || (childrenInRange && !_childrenReady))
+    {
+        ++culler->_tilesAwaitingData;
+    }
+
     // If this tile is marked dirty, try loading data.
     if ( dirty() && canLoadData )
     {
@@ -690,7 +696,7 @@ TileNode::createChildren()
                     return result;
                 };
 
-            jobs::context c{ _key.str() };
+            jobs::context c{ "oe.rex.createChildren" };
             c.pool = jobs::get_pool(ARENA_CREATE_CHILD);
             c.pool->set_can_steal_work(false);
             _createChildrenFutureResult = jobs::dispatch(createChildrenOperation, c);
@@ -747,7 +753,7 @@ TileNode::createChildren()
                     };
 
                 jobs::context c;
-                c.name = childkey.str();
+                c.name = "oe.rex.createChild";
                 c.pool = jobs::get_pool(ARENA_CREATE_CHILD);
                 c.pool->set_can_steal_work(false);
 
@@ -1092,6 +1098,50 @@ TileNode::merge(const TerrainTileModel* model, const CreateTileManifest& manifes
 
     // Bump the data revision for the tile.
     ++_revision;
+
+    // Report the new memory footprint for the unloader's budget.
+    std::size_t cpuBytes = 0u, gpuBytes = 0u;
+    getMemoryUsage(cpuBytes, gpuBytes);
+    _context->tiles()->setMemoryUsage(this, cpuBytes, gpuBytes);
+}
+
+void
+TileNode::getMemoryUsage(std::size_t& cpuBytes, std::size_t& gpuBytes) const
+{
+    cpuBytes = 0u;
+    gpuBytes = 0u;
+
+    auto accumulate = [&](const Sampler& sampler)
+        {
+            if (!sampler.ownsTexture())
+                return;
+
+            const osg::Texture* tex = sampler._texture->osgTexture().get();
+            const osg::Image* image = tex && tex->getNumImages() > 0 ? tex->getImage(0) : nullptr;
+            if (image && image->data())
+            {
+                std::size_t bytes = image->getTotalSizeInBytesIncludingMipmaps();
+                cpuBytes += bytes;
+
+                // the GPU builds the mipmap chain if the image doesn't carry one
+                gpuBytes += sampler._texture->mipmap() && !image->isMipmap() ? bytes * 4u / 3u : bytes;
+            }
+            else if (tex)
+            {
+                // image released after upload; estimate from the texture size at 4 bytes per texel
+                gpuBytes +=
+                    (std::size_t)std::max(tex->getTextureWidth(), 1) *
+                    (std::size_t)std::max(tex->getTextureHeight(), 1) *
+                    (std::size_t)std::max(tex->getTextureDepth(), 1) * 4u;
+            }
+        };
+
+    for (auto& sampler : _renderModel._sharedSamplers)
+        accumulate(sampler);
+
+    for (auto& pass : _renderModel._passes)
+        for (auto& sampler : pass.samplers())
+            accumulate(sampler);
 }
 
 void TileNode::inheritSharedSampler(int binding)
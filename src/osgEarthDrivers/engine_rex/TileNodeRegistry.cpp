@@ -16,6 +16,7 @@ using namespace osgEarth;
 #define SENTRY_VALUE nullptr
 
 #define PROFILING_REX_TILES "Live Terrain Tiles"
+#define PROFILING_REX_TILE_MB "Live Terrain Tile MB"
 
 //----------------------------------------------------------------------------
 
@@ -58,6 +59,39 @@ TileNodeRegistry::setDirty(
     }
 }
 
+bool
+TileNodeRegistry::contains(const TileKey& key) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _tiles.find(key) != _tiles.end();
+}
+
+void
+TileNodeRegistry::setMemoryUsage(const TileNode* tile, std::size_t cpuBytes, std::size_t gpuBytes)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto i = _tiles.find(tile->getKey());
+    if (i == _tiles.end() || i->second._tile.get() != tile)
+        return;
+
+    TableEntry& entry = i->second;
+    _cpuBytes += cpuBytes;
+    _cpuBytes -= entry._cpuBytes;
+    _gpuBytes += gpuBytes;
+    _gpuBytes -= entry._gpuBytes;
+    entry._cpuBytes = cpuBytes;
+    entry._gpuBytes = gpuBytes;
+}
+
+void
+TileNodeRegistry::remove(TileTable::iterator entry)
+{
+    _cpuBytes -= entry->second._cpuBytes;
+    _gpuBytes -= entry->second._gpuBytes;
+    _tiles.erase(entry);
+}
+
 void
 TileNodeRegistry::add(TileNode* tile)
 {
@@ -65,6 +99,12 @@ TileNodeRegistry::add(TileNode* tile)
 
     auto& entry = _tiles[tile->getKey()];
     entry._tile = tile;
+
+    // a recycled entry still carries the memory of the tile it held
+    _cpuBytes -= entry._cpuBytes;
+    _gpuBytes -= entry._gpuBytes;
+    entry._cpuBytes = 0u;
+    entry._gpuBytes = 0u;
     bool recyclingOrphan = entry._trackerToken != nullptr;
     entry._trackerToken = _tracker.use(tile, nullptr);
 
@@ -163,6 +203,8 @@ TileNodeRegistry::releaseAll(osg::State* state)
         tile.second._tile->releaseGLObjects(state);
     }
     _tiles.clear();
+    _cpuBytes = 0u;
+    _gpuBytes = 0u;
 
     _tracker.reset();
 
@@ -254,7 +296,9 @@ TileNodeRegistry::collectDormantTiles(
 
             output.push_back(tile);
 
-            _tiles.erase(key);
+            auto i = _tiles.find(key);
+            if (i != _tiles.end())
+                remove(i);
 
             return true; // dispose it
         }
@@ -269,4 +313,59 @@ TileNodeRegistry::collectDormantTiles(
     _tracker.flush(maxTiles, disposeTile);
 
     OE_PROFILING_PLOT(PROFILING_REX_TILES, (float)(_tiles.size()));
+    OE_PROFILING_PLOT(PROFILING_REX_TILE_MB, (float)((_cpuBytes + _gpuBytes) / 1048576u));
+}
+
+void
+TileNodeRegistry::collectTilesOverBudget(
+    std::uint64_t maxBytes,
+    unsigned oldestAllowableFrame,
+    unsigned maxTiles,
+    std::vector<osg::observer_ptr<TileNode>>& output)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    std::uint64_t total = _cpuBytes + _gpuBytes;
+    if (total <= maxBytes)
+        return;
+
+    const auto disposeTile = [&](osg::ref_ptr<TileNode>& tile) -> bool
+    {
+        if (total <= maxBytes)
+            return false; // within budget; keep the rest
+
+        OE_SOFT_ASSERT_AND_RETURN(tile, true);
+
+        const TileKey& key = tile->getKey();
+
+        if (tile->getDoNotExpire() == false &&
+            tile->getLastTraversalFrame() < (int)oldestAllowableFrame &&
+            tile->areSiblingsDormant())
+        {
+            if (_notifyNeighbors)
+            {
+                stopListeningFor(key.createNeighborKey(1, 0), key);
+                stopListeningFor(key.createNeighborKey(0, 1), key);
+            }
+
+            output.push_back(tile);
+
+            auto i = _tiles.find(key);
+            if (i != _tiles.end())
+            {
+                total -= i->second._cpuBytes + i->second._gpuBytes;
+                remove(i);
+            }
+
+            ++_budgetEvictions;
+            return true; // dispose it
+        }
+
+        return false; // keep it
+    };
+
+    _tracker.flushOldest(maxTiles, disposeTile);
+
+    OE_PROFILING_PLOT(PROFILING_REX_TILES, (float)(_tiles.size()));
+    OE_PROFILING_PLOT(PROFILING_REX_TILE_MB, (float)((_cpuBytes + _gpuBytes) / 1048576u));
 }
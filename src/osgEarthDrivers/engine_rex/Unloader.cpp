@@ -35,7 +35,9 @@ UnloaderGroup::traverse(osg::NodeVisitor& nv)
         unsigned frame = _clock->getFrame();
         bool runUpdate = (_frameLastUpdated < frame);
 
-        if (runUpdate && _tiles->size() > _options.getMinResidentTiles())
+        std::uint64_t budget = (std::uint64_t)_options.getTileMemoryBudget() * 1048576u;
+
+        if (runUpdate && (_tiles->size() > _options.getMinResidentTiles() || budget > 0u))
         {
             _frameLastUpdated = frame;
 
@@ -51,13 +53,30 @@ UnloaderGroup::traverse(osg::NodeVisitor& nv)
             unsigned oldestAllowableFrame = osg::maximum(frame, 3u) - 3u;
 
             // Remove them from the registry:
-            _tiles->collectDormantTiles(
-                nv,
-                oldestAllowableTime,
-                oldestAllowableFrame,
-                _options.getMinExpiryRange(),
-                _options.getMaxTilesToUnloadPerFrame(),
-                _deadpool);
+            if (_tiles->size() > _options.getMinResidentTiles())
+            {
+                _tiles->collectDormantTiles(
+                    nv,
+                    oldestAllowableTime,
+                    oldestAllowableFrame,
+                    _options.getMinExpiryRange(),
+                    _options.getMaxTilesToUnloadPerFrame(),
+                    _deadpool);
+            }
+
+            // If the remaining tiles still hold more memory than the budget allows,
+            // evict dormant tiles early, least recently used first. The budget
+            // overrides the minimum resident tile count, but not the per-frame
+            // limit, which the pass above may have used up already.
+            unsigned maxToUnload = _options.getMaxTilesToUnloadPerFrame();
+            if (budget > 0u && _deadpool.size() < maxToUnload)
+            {
+                _tiles->collectTilesOverBudget(
+                    budget,
+                    oldestAllowableFrame,
+                    maxToUnload - (unsigned)_deadpool.size(),
+                    _deadpool);
+            }
 
             // Remove them from the scene graph:
             for(auto& tile_weakptr : _deadpool)
@@ -8,14 +8,93 @@
 #include <osgEarth/Notify>
 #include <osg/GLU>
 #include <osgEarth/ImageUtils>
+#include <osgEarth/Threading>
+#include <osg/Timer>
 #include <stdlib.h>
 #include "libdxt.h"
 #include <string.h>
+#include <algorithm>
+#include <thread>
 
+#define LC "[FastDXT] "
 
 using namespace osgEarth;
 using namespace osgEarth::Util;
 
+namespace
+{
+    // Levels with fewer pixels than this compress on the calling thread
+    constexpr int PARALLEL_MIN_PIXELS = 512 * 512;
+
+    // Fewest pixel rows handed to one job
+    constexpr int MIN_ROWS_PER_BAND = 64;
+
+    // Set OSGEARTH_FASTDXT_THREADS to cap the threads per image (1 = serial).
+    // Read on every image so it can change at runtime.
+    unsigned getNumThreads()
+    {
+        const char* env = ::getenv("OSGEARTH_FASTDXT_THREADS");
+        if (env && ::atoi(env) > 0)
+            return (unsigned)::atoi(env);
+        return std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    // Compresses one level. Each 4x4 block depends only on its own pixels and
+    // the blocks are written in row order, so the level is split into bands of
+    // block rows that compress on the "oe.fastdxt" pool straight into their
+    // place in the output. The result is identical to a serial CompressDXT.
+    int compressLevel(const unsigned char* in, unsigned char* out, int width, int height, int format)
+    {
+        unsigned numThreads = getNumThreads();
+
+        if (numThreads <= 1u || width * height < PARALLEL_MIN_PIXELS || height < 2 * MIN_ROWS_PER_BAND)
+        {
+            return CompressDXT(in, out, width, height, format);
+        }
+
+        int bytesPerPixel = (format == FORMAT_BC5) ? 2 : 4;
+        int bytesPerBlock = (format == FORMAT_DXT1) ? 8 : 16;
+
+        int rowsPerBand = std::max(MIN_ROWS_PER_BAND, (height + (int)numThreads - 1) / (int)numThreads);
+        rowsPerBand = (rowsPerBand + 3) & ~3;
+
+        jobs::context job;
+        job.name = "FastDXT rows";
+        job.pool = jobs::get_pool("oe.fastdxt", std::max(std::thread::hardware_concurrency(), 1u));
+        // callers (tile loaders) block on these bands, so a worker must
+        // not steal a loader job and then wait on its own queue
+        job.pool->set_can_steal_work(false);
+        job.group = jobs::jobgroup::create();
+
+        std::vector<int> outputBytes((height + rowsPerBand - 1) / rowsPerBand, 0);
+
+        // the calling thread takes the first band itself
+        for (int band = 1; band < (int)outputBytes.size(); ++band)
+        {
+            int t0 = band * rowsPerBand;
+            int rows = std::min(rowsPerBand, height - t0);
+            const unsigned char* bandIn = in + t0 * width * bytesPerPixel;
+            unsigned char* bandOut = out + (t0 / 4) * (width / 4) * bytesPerBlock;
+            int* bandBytes = &outputBytes[band];
+
+            jobs::dispatch([bandIn, bandOut, width, rows, format, bandBytes]()
+                {
+                    *bandBytes = CompressDXT(bandIn, bandOut, width, rows, format);
+                },
+                job);
+        }
+
+        outputBytes[0] = CompressDXT(in, out, width, std::min(rowsPerBand, height), format);
+
+        job.group->join();
+
+        int total = 0;
+        for (int bytes : outputBytes)
+            total += bytes;
+        return total;
+    }
+}
+
 // Helper function to convert RGB/RGBA to RG8 for BC5 compression
 osg::Image* convertToRG8(const osg::Image* image)
 {
@@ -219,6 +298,8 @@ public:
 
         OE_SOFT_ASSERT_AND_RETURN(sourceImage != nullptr, void());
 
+        osg::Timer_t start = osg::Timer::instance()->tick();
+
         if (generateMipMap)
         {
             // size in bytes of the top-level image set (sum of [0..r-1])
@@ -269,7 +350,7 @@ public:
                     mipOffsets.push_back(totalCompressedBytes);
                 }
 
-                int outputBytes = CompressDXT(
+                int outputBytes = compressLevel(
                     in,
                     compressedLevelDataPtr,
                     level_s,
@@ -309,6 +390,8 @@ public:
                 osg::Image::USE_NEW_DELETE);
 
             input.setMipmapLevels(mipOffsets);
+
+            logTiming(start, input, numLevels);
         }
 
         else // no mipmaps, just one level
@@ -323,7 +406,7 @@ public:
             unsigned char* out = (unsigned char*)memalign(16, input.s() * input.t() * 4);
             memset(out, 0, input.s() * input.t() * 4);
 
-            int outputBytes = CompressDXT(in, out, sourceImage->s(), sourceImage->t(), format);
+            int outputBytes = compressLevel(in, out, sourceImage->s(), sourceImage->t(), format);
 
             //Allocate and copy over the output data to the correct size array.
             unsigned char* data = (unsigned char*)malloc(outputBytes);
@@ -331,9 +414,22 @@ public:
             memfree(out);
             memfree(in);
             input.setImage(input.s(), input.t(), input.r(), compressedPixelFormat, compressedPixelFormat, GL_UNSIGNED_BYTE, data, osg::Image::USE_MALLOC_FREE);
+
+            logTiming(start, input, 1u);
         }
     }
 
+    void logTiming(osg::Timer_t start, const osg::Image& image, unsigned numLevels) const
+    {
+        double ms = osg::Timer::instance()->delta_m(start, osg::Timer::instance()->tick());
+        double megapixels = (double)image.s() * (double)image.t() * 1e-6;
+
+        OE_DEBUG << LC << "Compressed " << image.s() << "x" << image.t()
+            << " (" << numLevels << " levels) in " << ms << " ms, "
+            << (megapixels > 0.0 ? ms / megapixels : 0.0) << " ms/MP ("
+            << getNumThreads() << " threads)" << std::endl;
+    }
+
     virtual void generateMipMap(osg::Image& image, bool resizeToPowerOfTwo, CompressionMethod method)
     {
         OSG_WARN << "FastDXT: generateMipMap not implemented" << std::endl;
@@ -80,6 +80,8 @@ public: // FeatureFilter
         }     
     }
 
+    const char* name() const override { return "IntersectFeatureFilter"; }
+
     FilterContext push(FeatureList& input, FilterContext& context)
     {       
         if (_featureSource.valid())
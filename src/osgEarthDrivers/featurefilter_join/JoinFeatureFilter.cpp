@@ -123,6 +123,8 @@ public: // FeatureFilter
     }
 
 
+    const char* name() const override { return "JoinFeatureFilter"; }
+
     FilterContext push(FeatureList& input, FilterContext& context)
     {
         OE_PROFILING_ZONE;
@@ -12,12 +12,88 @@
 
 #include <Lerc_c_api.h>
 #include <Lerc_types.h>
+#include <cstdint>
+#include <cstring>
+#include <vector>
 
 #define LC "[lerc] "
 
 typedef unsigned char Byte;    // convenience
 typedef unsigned int uint32;
 
+namespace
+{
+    // Copies LERC's band-sequential, top-down layout into an interleaved,
+    // bottom-up (OSG) image in a single pass, so no separate flip is needed.
+    template<typename T>
+    void interleaveFlipped(const Byte* lerc, Byte* image, unsigned width, unsigned height, unsigned numBands, unsigned numDims)
+    {
+        const std::size_t bandValues = (std::size_t)width * height * numDims;
+        const std::size_t rowValues = (std::size_t)width * numDims;
+        const unsigned pixelValues = numBands * numDims;
+
+        for (unsigned r = 0; r < height; ++r)
+        {
+            T* dst = reinterpret_cast<T*>(image) + (std::size_t)(height - 1 - r) * width * pixelValues;
+
+            if (numBands == 1)
+            {
+                memcpy(dst, lerc + r * rowValues * sizeof(T), rowValues * sizeof(T));
+                continue;
+            }
+
+            for (unsigned b = 0; b < numBands; ++b)
+            {
+                const T* src = reinterpret_cast<const T*>(lerc) + b * bandValues + r * rowValues;
+                T* out = dst + b * numDims;
+                for (unsigned c = 0; c < width; ++c)
+                    for (unsigned d = 0; d < numDims; ++d)
+                        out[c * pixelValues + d] = src[c * numDims + d];
+            }
+        }
+    }
+
+    // Inverse of interleaveFlipped: reads an interleaved, bottom-up image
+    // straight into LERC's band-sequential, top-down layout.
+    template<typename T>
+    void deinterleaveFlipped(const osg::Image& image, Byte* lerc, unsigned numBands)
+    {
+        const unsigned width = image.s(), height = image.t();
+        const std::size_t bandValues = (std::size_t)width * height;
+
+        for (unsigned r = 0; r < height; ++r)
+        {
+            const T* src = reinterpret_cast<const T*>(image.data(0, height - 1 - r));
+
+            if (numBands == 1)
+            {
+                memcpy(lerc + r * width * sizeof(T), src, width * sizeof(T));
+                continue;
+            }
+
+            for (unsigned b = 0; b < numBands; ++b)
+            {
+                T* dst = reinterpret_cast<T*>(lerc) + b * bandValues + (std::size_t)r * width;
+                for (unsigned c = 0; c < width; ++c)
+                    dst[c] = src[c * numBands + b];
+            }
+        }
+    }
+
+    template<typename FUNC>
+    bool dispatchBySampleSize(unsigned sampleSize, FUNC&& func)
+    {
+        switch (sampleSize)
+        {
+        case 1: func(std::uint8_t()); return true;
+        case 2: func(std::uint16_t()); return true;
+        case 4: func(std::uint32_t()); return true;
+        case 8: func(std::uint64_t()); return true;
+        default: return false;
+        }
+    }
+}
+
 class ReaderWriterLERC : public osgDB::ReaderWriter
 {
 public:
@@ -46,8 +122,12 @@ public:
         fin.seekg(0, fin.end);
         int length = fin.tellg();
         fin.seekg(0, fin.beg);
-        char* data = new char[length];
-        fin.read(data, length);
+        if (length <= 0)
+            return ReadResult::ERROR_IN_READING_FILE;
+
+        std::vector<char> buffer(length);
+        fin.read(buffer.data(), length);
+        const char* data = buffer.data();
 
         uint32 infoArr[8];
 
@@ -151,54 +231,27 @@ public:
             numBands == 3 ? GL_RGB :
             GL_RGBA;
 
-        // Allocate enough memory to hold the output image.
-        unsigned int totalOutputSize = width * height * sampleSize * numDims * numBands;
-        Byte* output = new Byte[totalOutputSize];
-        memset(output, 0, totalOutputSize);
+        // Decode the image into LERC's native layout (band-sequential, top row first):
+        std::size_t totalOutputSize = (std::size_t)width * height * sampleSize * numDims * numBands;
+        std::vector<Byte> decoded(totalOutputSize);
 
-        // Decode the image
-        unsigned int bandOffset = 0;
-        hr = lerc_decode((const unsigned char*)(data), length, 0, numDims, width, height, numBands, dataType, (void*)output);
+        hr = lerc_decode((const unsigned char*)(data), length, 0, numDims, width, height, numBands, dataType, (void*)decoded.data());
         if (hr)
         {
-            delete[]output;
             OE_WARN << LC << "Failed to decode lerc blob error=" << hr << std::endl;
             return ReadResult::ERROR_IN_READING_FILE;
         }
 
-        // Allocate the final output image
-        osg::ref_ptr< osg::Image > image = new osg::Image;
-
-        if (numBands > 1 && numDims == 1)
-        {
-            // Interleave the bands properly if we have more than one.
-            image->allocateImage(width, height, 1, pixelFormat, glDataType);
-            memset(image->data(), 0, image->getImageSizeInBytes());
-
-            unsigned int bandSize = width * height * sampleSize * numDims;
-            unsigned int rowSize = sampleSize * width;
-
-            for (unsigned int r = 0; r < height; ++r)
+        // Interleave the bands and flip the rows into the final image in one pass.
+        Byte* output = new Byte[totalOutputSize];
+        dispatchBySampleSize(sampleSize, [&](auto type)
             {
-                for (unsigned int c = 0; c < width; ++c)
-                {
-                    for (unsigned int band = 0; band < numBands; ++band)
-                    {
-                        Byte* bandPtr = output + (band * bandSize);
-                        memcpy(image->data(c, r) + band * sampleSize, (const void*)&bandPtr[r * rowSize + c * sampleSize], sampleSize);
-                    }
-                }
-            }
-            // Delete the original output array, no longer needed.
-            delete[]output;
-        }
-        else
-        {
-            // Just set the output array as the image, image takes ownership of the array.
-            image->setImage(width, height, 1, internalFormat, pixelFormat, glDataType, (unsigned char*)output, osg::Image::USE_NEW_DELETE);
-        }
+                interleaveFlipped<decltype(type)>(decoded.data(), output, width, height, numBands, numDims);
+            });
 
-        image->flipVertical();
+        // Image takes ownership of the array.
+        osg::ref_ptr< osg::Image > image = new osg::Image;
+        image->setImage(width, height, 1, internalFormat, pixelFormat, glDataType, output, osg::Image::USE_NEW_DELETE);
         image->setInternalTextureFormat(internalFormat);
 
         return image;
@@ -245,13 +298,10 @@ public:
         unsigned int width = img.s();
         unsigned int height = img.t();
 
-        osg::ref_ptr< osg::Image > flipped = new osg::Image(img);
-        flipped->flipVertical();
-
         unsigned int numDims = 1;
         unsigned int numBands = 1;
-        uint32 dataType;
-        unsigned int sampleSize;
+        uint32 dataType = 0;
+        unsigned int sampleSize = 0;
 
         switch (img.getDataType())
         {
@@ -280,7 +330,8 @@ public:
             sampleSize = sizeof(double);
             break;
         default:
-            break;
+            OE_WARN << LC << "Unsupported data type" << std::endl;
+            return WriteResult::ERROR_IN_WRITING_FILE;
         }
 
         switch (img.getPixelFormat())
@@ -302,33 +353,16 @@ public:
             break;
         }
 
-        unsigned int totalOutputSize = width * height * sampleSize * numDims * numBands;
-        unsigned char* imageData = new unsigned char[totalOutputSize];
-        if (numBands > 1)
-        {
-            unsigned int bandSize = width * height * sampleSize * numDims;
-            unsigned int rowSize = sampleSize * width;
+        // Write each band into the array separately, top row first, straight
+        // from the source image (no flipped copy).
+        std::size_t totalOutputSize = (std::size_t)width * height * sampleSize * numDims * numBands;
+        std::vector<unsigned char> buffer(totalOutputSize);
+        unsigned char* imageData = buffer.data();
 
-            // Write each band into the array separately.
-            for (unsigned int band = 0; band < numBands; ++band)
+        dispatchBySampleSize(sampleSize, [&](auto type)
             {
-                Byte* bandPtr = imageData + (band * bandSize);
-                for (unsigned int r = 0; r < height; ++r)
-                {
-                    for (unsigned int c = 0; c < width; ++c)
-                    {
-                        unsigned int destPix = r * rowSize + c * sampleSize;
-                        memcpy((void*)(bandPtr + destPix), flipped->data(c, r) + band * sampleSize, sampleSize);
-                    }
-                }
-            }
-        }
-        else
-        {
-            memcpy(imageData, flipped->data(), totalOutputSize);
-        }
-
-
+                deinterleaveFlipped<decltype(type)>(img, imageData, numBands);
+            });
 
         hr = lerc_computeCompressedSize((void*)imageData,    // raw image data, row by row, band by band
             dataType, numDims, width, height, numBands,
@@ -359,7 +393,6 @@ public:
         }
         fout.write((const char*)pLercBlob, numBytesWritten);
         delete[]pLercBlob;
-        delete[]imageData;
 
         return WriteResult::FILE_SAVED;
     }
@@ -78,76 +78,69 @@ public:
 
   virtual ReadResult readImage(std::istream &fin, const Options *options) const
   {
-    Image *image = NULL;
-    unsigned long size_of_vp8_image_data = 0;
-    char *vp8_buffer = NULL;
-
     fin.seekg(0, std::ios::end);
     size_t stream_size = fin.tellg();
     fin.seekg(0, std::ios::beg);
 
-    if (stream_size > 0)
+    if (stream_size == 0)
     {
+      OSG_NOTICE << "read webp image: stream size is zero" << std::endl;
+      return ReadResult::ERROR_IN_READING_FILE;
+    }
 
-      size_of_vp8_image_data = stream_size;
-      vp8_buffer = new char[stream_size];
-
-      int version = WebPGetEncoderVersion();
-      size_of_vp8_image_data = fin.read(vp8_buffer, size_of_vp8_image_data).gcount();
-
-      WebPDecoderConfig config;
-      WebPInitDecoderConfig(&config);
-      int status = WebPGetFeatures((const uint8_t *)vp8_buffer, (uint32_t)size_of_vp8_image_data, &config.input);
-      if (status == VP8_STATUS_OK)
+    // Decode opaque images to RGB instead of RGBA with the "rgb" option.
+    // (RGBA remains the default because of an old AMD driver bug:
+    // http://devgurus.amd.com/message/1302663)
+    bool opaqueRGB = false;
+    if (options)
+    {
+      std::istringstream iss(options->getOptionString());
+      std::string opt;
+      while (iss >> opt)
       {
+        if (opt == "rgb")
+          opaqueRGB = true;
+      }
+    }
 
-        unsigned int pixelFormat;
-        unsigned int dataType = GL_UNSIGNED_BYTE;
+    std::vector<uint8_t> vp8_buffer(stream_size);
+    size_t size_of_vp8_image_data = fin.read((char*)vp8_buffer.data(), stream_size).gcount();
 
-        if (config.input.has_alpha)
-        {
-          pixelFormat = GL_RGBA;
-          config.output.colorspace = MODE_RGBA;
-        }
-        else
-        {
-          /*
-            BUG of AMD driver: http://devgurus.amd.com/message/1302663
-            pixelFormat = GL_RGB;
-            config.output.colorspace = MODE_RGB;
-            */
-          pixelFormat = GL_RGBA;
-          config.output.colorspace = MODE_RGBA;
-        }
-        int internalFormat = pixelFormat;
-        int r = 1;
+    WebPDecoderConfig config;
+    WebPInitDecoderConfig(&config);
+    if (WebPGetFeatures(vp8_buffer.data(), size_of_vp8_image_data, &config.input) != VP8_STATUS_OK)
+    {
+      return ReadResult::ERROR_IN_READING_FILE;
+    }
 
-        image = new Image();
-        image->allocateImage(config.input.width, config.input.height, 1, pixelFormat, dataType);
+    unsigned int pixelFormat = GL_RGBA;
+    config.output.colorspace = MODE_RGBA;
 
-        config.output.u.RGBA.rgba = (uint8_t *)image->data();
-        config.output.u.RGBA.stride = image->getRowSizeInBytes();
-        config.output.u.RGBA.size = image->getImageSizeInBytes();
+    if (!config.input.has_alpha && opaqueRGB)
+    {
+      pixelFormat = GL_RGB;
+      config.output.colorspace = MODE_RGB;
+    }
 
-        config.options.no_fancy_upsampling = 1;
+    osg::ref_ptr<Image> image = new Image();
+    image->allocateImage(config.input.width, config.input.height, 1, pixelFormat, GL_UNSIGNED_BYTE);
 
-        config.output.is_external_memory = 1;
+    // Decode straight into the image; libwebp writes the rows bottom-up
+    // for us so there is no separate flip pass.
+    config.output.u.RGBA.rgba = (uint8_t *)image->data();
+    config.output.u.RGBA.stride = image->getRowStepInBytes();
+    config.output.u.RGBA.size = image->getImageSizeInBytes();
+    config.output.is_external_memory = 1;
 
-        status = WebPDecode((const uint8_t *)vp8_buffer, (uint32_t)size_of_vp8_image_data, &config);
-      }
-      delete[] vp8_buffer;
-    }
-    else
-    {
-      OSG_NOTICE << "read webp image: stream size is zero" << std::endl;
-    }
+    config.options.no_fancy_upsampling = 1;
+    config.options.flip = 1;
 
-    if (image)
+    if (WebPDecode(vp8_buffer.data(), size_of_vp8_image_data, &config) != VP8_STATUS_OK)
     {
-        image->flipVertical();
+      return ReadResult::ERROR_IN_READING_FILE;
     }
 
-    return image;
+    return image.release();
   }
 
   virtual WriteResult writeObject(const osg::Object &object, const std::string &file, const osgDB::ReaderWriter::Options *options) const
@@ -193,10 +186,10 @@ public:
 
   WriteResult writeImage(const osg::Image &img, std::ostream &fout, const Options *options) const
   {
-    int internalFormat = osg::Image::computeNumComponents(img.getPixelFormat());
-
-    osg::ref_ptr< osg::Image > flippedImage = new osg::Image(img);
-    flippedImage->flipVertical();
+    // Import the rows bottom-up (last row first, negative stride) so the
+    // source image is neither copied nor flipped.
+    const int stride = -(int)img.getRowStepInBytes();
+    const uint8_t* topRow = img.t() > 0 ? (const uint8_t*)img.data(0, img.t() - 1) : img.data();
 
     WebPConfig config;
     config.quality = 75;
@@ -265,13 +258,13 @@ public:
     switch (img.getPixelFormat())
     {
     case (GL_RGB):
-      WebPPictureImportRGB(&picture, flippedImage->data(), img.getRowSizeInBytes());
+      WebPPictureImportRGB(&picture, topRow, stride);
       break;
     case (GL_RGBA):
-      WebPPictureImportRGBA(&picture, flippedImage->data(), img.getRowSizeInBytes());
+      WebPPictureImportRGBA(&picture, topRow, stride);
       break;
     case (GL_LUMINANCE):
-      WebPPictureImportRGBX(&picture, flippedImage->data(), img.getRowSizeInBytes());
+      WebPPictureImportRGBX(&picture, topRow, stride);
       break;
     default:
       return WriteResult::ERROR_IN_WRITING_FILE;
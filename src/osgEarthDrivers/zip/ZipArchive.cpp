@@ -29,6 +29,269 @@
 
 #include <sstream>
 #include <cstdio>
+#include <cstring>
+#include <climits>
+#include <streambuf>
+
+#ifdef OSGEARTH_ZIP_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace
+{
+    // Buffers bigger than this are freed instead of going back to the pool
+    constexpr std::size_t MAX_POOLED_BUFFER_BYTES = 16u * 1024u * 1024u;
+
+    // Most buffers kept in the pool
+    constexpr std::size_t MAX_POOLED_BUFFERS = 16u;
+
+    inline std::uint16_t read16(const char* p)
+    {
+        const unsigned char* b = reinterpret_cast<const unsigned char*>(p);
+        return (std::uint16_t)(b[0] | (b[1] << 8));
+    }
+
+    inline std::uint32_t read32(const char* p)
+    {
+        const unsigned char* b = reinterpret_cast<const unsigned char*>(p);
+        return (std::uint32_t)b[0] | ((std::uint32_t)b[1] << 8) | ((std::uint32_t)b[2] << 16) | ((std::uint32_t)b[3] << 24);
+    }
+
+    inline std::uint64_t read64(const char* p)
+    {
+        return (std::uint64_t)read32(p) | ((std::uint64_t)read32(p + 4) << 32);
+    }
+
+    //! One file header from the central directory
+    struct CentralDirectoryRecord
+    {
+        std::string name;
+        std::uint16_t flags;
+        std::uint16_t method;
+        std::uint32_t crc;
+        std::uint64_t compressedSize;
+        std::uint64_t size;
+        std::uint64_t localHeaderOffset;
+    };
+
+    //! Parses the central directory of a zip (or zip64) archive held in
+    //! memory, calling "output" for each file header in order. Returns false
+    //! if the archive is not one this parser understands (e.g. split across
+    //! disks), in which case libzip should build the index instead.
+    template<typename OUTPUT>
+    bool parseCentralDirectory(const char* data, std::size_t size, OUTPUT&& output)
+    {
+        const std::size_t EOCD_SIZE = 22u;
+        if (!data || size < EOCD_SIZE)
+            return false;
+
+        // The end of central directory record sits at the very end,
+        // followed only by an archive comment of up to 64K.
+        std::size_t eocd = std::string::npos;
+        std::size_t earliest = size > EOCD_SIZE + 0xffffu ? size - EOCD_SIZE - 0xffffu : 0u;
+        for (std::size_t p = size - EOCD_SIZE + 1u; p-- > earliest; )
+        {
+            if (read32(data + p) == 0x06054b50u && p + EOCD_SIZE + read16(data + p + 20) == size)
+            {
+                eocd = p;
+                break;
+            }
+        }
+        if (eocd == std::string::npos)
+            return false;
+
+        std::uint16_t disk = read16(data + eocd + 4);
+        std::uint16_t cdDisk = read16(data + eocd + 6);
+        std::uint64_t numEntries = read16(data + eocd + 10);
+        std::uint64_t cdSize = read32(data + eocd + 12);
+        std::uint64_t cdOffset = read32(data + eocd + 16);
+
+        if (numEntries == 0xffffu || cdSize == 0xffffffffu || cdOffset == 0xffffffffu)
+        {
+            // zip64: the locator just before the record points at the zip64 record
+            if (eocd < 20u || read32(data + eocd - 20u) != 0x07064b50u)
+                return false;
+
+            std::uint64_t zip64 = read64(data + eocd - 20u + 8u);
+            if (size < 56u || zip64 > size - 56u || read32(data + zip64) != 0x06064b50u)
+                return false;
+
+            disk = (std::uint16_t)read32(data + zip64 + 16u);
+            cdDisk = (std::uint16_t)read32(data + zip64 + 20u);
+            numEntries = read64(data + zip64 + 32u);
+            cdSize = read64(data + zip64 + 40u);
+            cdOffset = read64(data + zip64 + 48u);
+        }
+
+        if (disk != 0u || cdDisk != 0u || cdOffset > size || cdSize > size - cdOffset)
+            return false;
+
+        const char* p = data + cdOffset;
+        const char* end = p + cdSize;
+
+        for (std::uint64_t i = 0; i < numEntries; ++i)
+        {
+            if (end - p < 46 || read32(p) != 0x02014b50u)
+                return false;
+
+            CentralDirectoryRecord record;
+            record.flags = read16(p + 8);
+            record.method = read16(p + 10);
+            record.crc = read32(p + 16);
+            record.compressedSize = read32(p + 20);
+            record.size = read32(p + 24);
+            std::uint16_t nameLength = read16(p + 28);
+            std::uint16_t extraLength = read16(p + 30);
+            std::uint16_t commentLength = read16(p + 32);
+            record.localHeaderOffset = read32(p + 42);
+
+            if (end - p < 46 + nameLength + extraLength + commentLength)
+                return false;
+
+            record.name.assign(p + 46, nameLength);
+
+            // 64-bit sizes and offsets live in the zip64 extra field,
+            // in this order, for each value that overflowed.
+            const char* extra = p + 46 + nameLength;
+            const char* extraEnd = extra + extraLength;
+            while (extraEnd - extra >= 4)
+            {
+                std::uint16_t id = read16(extra);
+                std::uint16_t length = read16(extra + 2);
+                const char* field = extra + 4;
+                const char* fieldEnd = field + length;
+                if (fieldEnd > extraEnd)
+                    break;
+
+                if (id == 0x0001u)
+                {
+                    if (record.size == 0xffffffffu && fieldEnd - field >= 8)
+                        record.size = read64(field), field += 8;
+                    if (record.compressedSize == 0xffffffffu && fieldEnd - field >= 8)
+                        record.compressedSize = read64(field), field += 8;
+                    if (record.localHeaderOffset == 0xffffffffu && fieldEnd - field >= 8)
+                        record.localHeaderOffset = read64(field), field += 8;
+                }
+                extra = fieldEnd;
+            }
+
+            output(record);
+
+            p += 46 + nameLength + extraLength + commentLength;
+        }
+
+        return true;
+    }
+
+    //! Locates an entry's data from its local file header.
+    //! Returns false if the header is damaged or the data runs past the end.
+    bool findEntryData(const char* data, std::size_t size, std::uint64_t localHeaderOffset, std::uint64_t compressedSize, const char*& output)
+    {
+        const std::size_t LOCAL_HEADER_SIZE = 30u;
+        if (localHeaderOffset > size || size - localHeaderOffset < LOCAL_HEADER_SIZE)
+            return false;
+
+        const char* header = data + localHeaderOffset;
+        if (read32(header) != 0x04034b50u)
+            return false;
+
+        std::uint64_t start = localHeaderOffset + LOCAL_HEADER_SIZE + read16(header + 26) + read16(header + 28);
+        if (start > size || size - start < compressedSize)
+            return false;
+
+        output = data + start;
+        return true;
+    }
+
+#ifdef OSGEARTH_ZIP_HAVE_ZLIB
+    //! Inflates a raw deflate stream of known output size
+    bool inflateEntry(const char* input, std::uint64_t inputSize, char* output, std::uint64_t outputSize)
+    {
+        if (inputSize > UINT_MAX || outputSize > UINT_MAX)
+            return false;
+
+        z_stream stream;
+        ::memset(&stream, 0, sizeof(stream));
+        if (inflateInit2(&stream, -MAX_WBITS) != Z_OK)
+            return false;
+
+        stream.next_in = (Bytef*)input;
+        stream.avail_in = (uInt)inputSize;
+        // zlib won't finish a stream without room to write, even an empty one
+        Bytef empty = 0;
+        stream.next_out = outputSize > 0u ? (Bytef*)output : &empty;
+        stream.avail_out = outputSize > 0u ? (uInt)outputSize : 1u;
+
+        int result = inflate(&stream, Z_FINISH);
+        bool ok = (result == Z_STREAM_END && stream.total_out == outputSize);
+        inflateEnd(&stream);
+        return ok;
+    }
+
+    bool checkCRC(const char* data, std::size_t size, std::uint32_t expected)
+    {
+        uLong crc = crc32(0L, Z_NULL, 0);
+        while (size > 0u)
+        {
+            uInt chunk = (uInt)std::min(size, (std::size_t)UINT_MAX);
+            crc = crc32(crc, (const Bytef*)data, chunk);
+            data += chunk;
+            size -= chunk;
+        }
+        return (std::uint32_t)crc == expected;
+    }
+#endif
+
+    //! Read-only stream buffer over a slice of memory, so readers can
+    //! decode an entry straight out of the mapped archive without a copy.
+    class MemoryStreamBuf : public std::streambuf
+    {
+    public:
+        MemoryStreamBuf(const char* data, std::size_t size)
+        {
+            char* p = const_cast<char*>(data);
+            setg(p, p, p + size);
+        }
+
+    protected:
+        pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override
+        {
+            if (which & std::ios_base::out)
+                return pos_type(off_type(-1));
+
+            off_type base =
+                dir == std::ios_base::beg ? 0 :
+                dir == std::ios_base::cur ? gptr() - eback() :
+                egptr() - eback();
+
+            off_type pos = base + off;
+            if (pos < 0 || pos > egptr() - eback())
+                return pos_type(off_type(-1));
+
+            setg(eback(), eback() + pos, egptr());
+            return pos_type(pos);
+        }
+
+        pos_type seekpos(pos_type pos, std::ios_base::openmode which) override
+        {
+            return seekoff(off_type(pos), std::ios_base::beg, which);
+        }
+    };
+
+    class MemoryStream : public std::istream
+    {
+    public:
+        MemoryStream(const char* data, std::size_t size) :
+            std::istream(nullptr),
+            _buf(data, size)
+        {
+            rdbuf(&_buf);
+        }
+
+    private:
+        MemoryStreamBuf _buf;
+    };
+}
 
 ZipArchive::ZipArchive()  :
 _zipLoaded( false )
@@ -48,16 +311,21 @@ void ZipArchive::close()
         std::lock_guard<std::mutex> lock(_zipMutex);
         if ( _zipLoaded )
         {
-            // close the file (on one thread since it's a shared file)
-            const PerThreadData& data = getDataNoLock();
-
-            zip_close(data._zipHandle);
+            // close the libzip handles opened by any thread
+            for (auto& i : _perThreadData)
+            {
+                if (i.second._zipHandle != NULL)
+                    zip_close(i.second._zipHandle);
+            }
             // clear out the file handles
             _perThreadData.clear();
 
             // clear out the index.
             _zipIndex.clear();
 
+            // release the mapping
+            _mapping.reset();
+
             _zipLoaded = false;
         }
     }
@@ -124,15 +392,21 @@ bool ZipArchive::open(const std::string& file, ArchiveStatus /*status*/, const o
 
             _password = ReadPassword(options);
 
-            // open the zip file in this thread:
-            const PerThreadData& data = getDataNoLock();
-
-            // establish a shared (read-only) index:
-            if ( data._zipHandle != NULL )
+            // establish a shared (read-only) index, parsed once from the mapped
+            // archive if possible. Otherwise let libzip parse it in this thread.
+            if (IndexCentralDirectory())
             {
-                IndexZipFiles( data._zipHandle );
                 _zipLoaded = true;
             }
+            else
+            {
+                const PerThreadData& data = getDataNoLock();
+                if ( data._zipHandle != NULL )
+                {
+                    IndexZipFiles( data._zipHandle );
+                    _zipLoaded = true;
+                }
+            }
         }
     }
 
@@ -146,11 +420,13 @@ osgDB::ReaderWriter::ReadResult ZipArchive::readObject(const std::string& file,
     std::string ext = osgDB::getLowerCaseFileExtension(file);
     if (!_zipLoaded || !acceptsExtension(ext)) return osgDB::ReaderWriter::ReadResult::FILE_NOT_HANDLED;
 
-    std::stringstream buffer;
+    EntryData entryData;
 
-    osgDB::ReaderWriter* rw = ReadFromZipIndex(file, options, buffer);
+    osgDB::ReaderWriter* rw = ReadFromZipIndex(file, options, entryData);
     if (rw != NULL)
     {
+        MemoryStream buffer(entryData.data, entryData.size);
+
         // Setup appropriate options
         osg::ref_ptr<osgDB::ReaderWriter::Options> local_opt = options ?
             static_cast<osgDB::ReaderWriter::Options*>(options->clone(osg::CopyOp::SHALLOW_COPY)) :
@@ -174,10 +450,13 @@ osgDB::ReaderWriter::ReadResult ZipArchive::readImage(const std::string& file,co
     std::string ext = osgDB::getLowerCaseFileExtension(file);
     if (!_zipLoaded || !acceptsExtension(ext)) return osgDB::ReaderWriter::ReadResult::FILE_NOT_HANDLED;
 
-    std::stringstream buffer;
-    osgDB::ReaderWriter* rw = ReadFromZipIndex(file, options, buffer);
+    EntryData entryData;
+
+    osgDB::ReaderWriter* rw = ReadFromZipIndex(file, options, entryData);
     if (rw != NULL)
     {
+        MemoryStream buffer(entryData.data, entryData.size);
+
         // Setup appropriate options
         osg::ref_ptr<osgDB::ReaderWriter::Options> local_opt = options ?
             static_cast<osgDB::ReaderWriter::Options*>(options->clone(osg::CopyOp::SHALLOW_COPY)) :
@@ -201,11 +480,13 @@ osgDB::ReaderWriter::ReadResult ZipArchive::readHeightField(const std::string& f
     std::string ext = osgDB::getLowerCaseFileExtension(file);
     if (!_zipLoaded || !acceptsExtension(ext)) return osgDB::ReaderWriter::ReadResult::FILE_NOT_HANDLED;
 
-    std::stringstream buffer;
+    EntryData entryData;
 
-    osgDB::ReaderWriter* rw = ReadFromZipIndex(file, options, buffer);
+    osgDB::ReaderWriter* rw = ReadFromZipIndex(file, options, entryData);
     if (rw != NULL)
     {
+        MemoryStream buffer(entryData.data, entryData.size);
+
         // Setup appropriate options
         osg::ref_ptr<osgDB::ReaderWriter::Options> local_opt = options ?
             static_cast<osgDB::ReaderWriter::Options*>(options->clone(osg::CopyOp::SHALLOW_COPY)) :
@@ -230,11 +511,13 @@ osgDB::ReaderWriter::ReadResult ZipArchive::readNode(const std::string& file,con
     std::string ext = osgDB::getLowerCaseFileExtension(file);
     if (!_zipLoaded || !acceptsExtension(ext)) return osgDB::ReaderWriter::ReadResult::FILE_NOT_HANDLED;
 
-    std::stringstream buffer;
+    EntryData entryData;
 
-    osgDB::ReaderWriter* rw = ReadFromZipIndex(file, options, buffer);
+    osgDB::ReaderWriter* rw = ReadFromZipIndex(file, options, entryData);
     if (rw != NULL)
     {
+        MemoryStream buffer(entryData.data, entryData.size);
+
         // Setup appropriate options
         osg::ref_ptr<osgDB::ReaderWriter::Options> local_opt = options ?
             static_cast<osgDB::ReaderWriter::Options*>(options->clone(osg::CopyOp::SHALLOW_COPY)) :
@@ -259,11 +542,13 @@ osgDB::ReaderWriter::ReadResult ZipArchive::readScript(const std::string& file,c
     std::string ext = osgDB::getLowerCaseFileExtension(file);
     if (!_zipLoaded || !acceptsExtension(ext)) return osgDB::ReaderWriter::ReadResult::FILE_NOT_HANDLED;
 
-    std::stringstream buffer;
+    EntryData entryData;
 
-    osgDB::ReaderWriter* rw = ReadFromZipIndex(file, options, buffer);
+    osgDB::ReaderWriter* rw = ReadFromZipIndex(file, options, entryData);
     if (rw != NULL)
     {
+        MemoryStream buffer(entryData.data, entryData.size);
+
         // Setup appropriate options
         osg::ref_ptr<osgDB::ReaderWriter::Options> local_opt = options ?
             static_cast<osgDB::ReaderWriter::Options*>(options->clone(osg::CopyOp::SHALLOW_COPY)) :
@@ -288,11 +573,13 @@ osgDB::ReaderWriter::ReadResult ZipArchive::readShader(const std::string& file,c
     std::string ext = osgDB::getLowerCaseFileExtension(file);
     if (!_zipLoaded || !acceptsExtension(ext)) return osgDB::ReaderWriter::ReadResult::FILE_NOT_HANDLED;
 
-    std::stringstream buffer;
+    EntryData entryData;
 
-    osgDB::ReaderWriter* rw = ReadFromZipIndex(file, options, buffer);
+    osgDB::ReaderWriter* rw = ReadFromZipIndex(file, options, entryData);
     if (rw != NULL)
     {
+        MemoryStream buffer(entryData.data, entryData.size);
+
         // Setup appropriate options
         osg::ref_ptr<osgDB::ReaderWriter::Options> local_opt = options ?
             static_cast<osgDB::ReaderWriter::Options*>(options->clone(osg::CopyOp::SHALLOW_COPY)) :
@@ -340,37 +627,137 @@ osgDB::ReaderWriter::WriteResult ZipArchive::writeShader(const osg::Shader& /*sh
     return osgDB::ReaderWriter::WriteResult(osgDB::ReaderWriter::WriteResult::FILE_NOT_HANDLED);
 }
 
-osgDB::ReaderWriter* ZipArchive::ReadFromZipIndex(const std::string& filename, const osgDB::ReaderWriter::Options* options, std::stringstream& streamIn) const
+osgDB::ReaderWriter* ZipArchive::ReadFromZipIndex(const std::string& filename, const osgDB::ReaderWriter::Options* options, EntryData& entryData) const
 {
-    zip_uint64_t idx;
-    if (GetZipIndex(filename, idx))
+    const ZipEntry* entry = GetZipEntry(filename);
+    if (entry != NULL && ReadEntry(*entry, entryData))
     {
-        // fetch the handle for the current thread:
-        const PerThreadData& data = getData();
-        if (data._zipHandle != NULL)
+        std::string file_ext = osgDB::getFileExtension(filename);
+        osgDB::ReaderWriter* rw = osgDB::Registry::instance()->getReaderWriterForExtension(file_ext);
+        if (rw != NULL)
         {
-            zip_file_t* zf;
-            if ((zf = zip_fopen_index(data._zipHandle, idx, 0)) != NULL)
+            return rw;
+        }
+    }
+
+    return NULL;
+}
+
+bool ZipArchive::ReadEntry(const ZipEntry& entry, EntryData& entryData) const
+{
+    const char* source = NULL;
+
+    if (_mapping && !entry.encrypted &&
+        findEntryData(_mapping->data(), _mapping->size(), entry.localHeaderOffset, entry.compressedSize, source))
+    {
+        // stored: hand out the mapped bytes as they are
+        if (entry.method == 0 && entry.compressedSize == entry.size)
+        {
+#ifdef OSGEARTH_ZIP_HAVE_ZLIB
+            if (!checkCRC(source, (std::size_t)entry.size, entry.crc))
             {
-                char buf[8192];
-                zip_int64_t n;
-                while ((n = zip_fread(zf, buf, sizeof(buf))) > 0) {
-                    streamIn.write(buf, (size_t)n);
-                }
-                zip_fclose(zf);
+                OSG_WARN << "CRC error in zip " << _filename << " entry " << entry.index << std::endl;
+                return false;
+            }
+#endif
+            entryData.data = source;
+            entryData.size = (std::size_t)entry.size;
+            return true;
+        }
 
-                std::string file_ext = osgDB::getFileExtension(filename);
-                osgDB::ReaderWriter* rw = osgDB::Registry::instance()->getReaderWriterForExtension(file_ext);
-                if (rw != NULL)
-                {
-                    return rw;
-                }
+#ifdef OSGEARTH_ZIP_HAVE_ZLIB
+        // deflated: inflate into a pooled buffer
+        if (entry.method == 8)
+        {
+            entryData._owner = this;
+            entryData._buffer = takeBuffer();
+            entryData._buffer->resize((std::size_t)entry.size);
 
+            if (inflateEntry(source, entry.compressedSize, entryData._buffer->data(), entry.size) &&
+                checkCRC(entryData._buffer->data(), (std::size_t)entry.size, entry.crc))
+            {
+                entryData.data = entryData._buffer->data();
+                entryData.size = (std::size_t)entry.size;
+                return true;
             }
+
+            // leave anything unexpected to libzip
+            entryData._buffer->clear();
         }
+#endif
     }
 
-    return NULL;
+    // encrypted, other compression methods, or no mapping:
+    return ReadEntryWithLibzip(entry, entryData);
+}
+
+bool ZipArchive::ReadEntryWithLibzip(const ZipEntry& entry, EntryData& entryData) const
+{
+    // fetch the handle for the current thread:
+    const PerThreadData& data = getData();
+    if (data._zipHandle == NULL)
+        return false;
+
+    zip_file_t* zf = zip_fopen_index(data._zipHandle, entry.index, 0);
+    if (zf == NULL)
+        return false;
+
+    if (!entryData._buffer)
+    {
+        entryData._owner = this;
+        entryData._buffer = takeBuffer();
+    }
+
+    std::vector<char>& buffer = *entryData._buffer;
+    buffer.clear();
+
+    char buf[8192];
+    zip_int64_t n;
+    while ((n = zip_fread(zf, buf, sizeof(buf))) > 0) {
+        buffer.insert(buffer.end(), buf, buf + n);
+    }
+    zip_fclose(zf);
+
+    if (n < 0)
+        return false;
+
+    entryData.data = buffer.data();
+    entryData.size = buffer.size();
+    return true;
+}
+
+ZipArchive::EntryData::~EntryData()
+{
+    if (_owner && _buffer)
+    {
+        _owner->returnBuffer(std::move(_buffer));
+    }
+}
+
+std::unique_ptr<std::vector<char>> ZipArchive::takeBuffer() const
+{
+    {
+        std::lock_guard<std::mutex> lock(_bufferMutex);
+        if (!_buffers.empty())
+        {
+            std::unique_ptr<std::vector<char>> buffer = std::move(_buffers.back());
+            _buffers.pop_back();
+            return buffer;
+        }
+    }
+    return std::unique_ptr<std::vector<char>>(new std::vector<char>());
+}
+
+void ZipArchive::returnBuffer(std::unique_ptr<std::vector<char>> buffer) const
+{
+    if (buffer->capacity() > MAX_POOLED_BUFFER_BYTES)
+        return;
+
+    std::lock_guard<std::mutex> lock(_bufferMutex);
+    if (_buffers.size() < MAX_POOLED_BUFFERS)
+    {
+        _buffers.push_back(std::move(buffer));
+    }
 }
 
 
@@ -408,23 +795,79 @@ void ZipArchive::IndexZipFiles(zip_t* zip)
             CleanupFileString(name);
             if (!name.empty())
             {
-                _zipIndex.insert(ZipEntryMapping(name, i));
+                // method unknown, so reads go through libzip
+                ZipEntry entry;
+                entry.index = i;
+                _zipIndex.insert(ZipEntryMapping(name, entry));
             }
         }
     }
 }
 
+bool ZipArchive::IndexCentralDirectory()
+{
+    _mapping.reset(new osgEarth::Util::MappedFile(_filename));
+    if (!_mapping->valid())
+    {
+        _mapping.reset();
+        return false;
+    }
+
+    ZipEntryMap index;
+    zip_uint64_t count = 0u;
+
+    bool ok = parseCentralDirectory(_mapping->data(), _mapping->size(),
+        [&](const CentralDirectoryRecord& record)
+        {
+            ZipEntry entry;
+            entry.index = count++;
+            entry.method = record.method;
+            entry.encrypted = (record.flags & 0x0001u) != 0u;
+            entry.crc = record.crc;
+            entry.compressedSize = record.compressedSize;
+            entry.size = record.size;
+            entry.localHeaderOffset = record.localHeaderOffset;
+
+            std::string name = record.name;
+            CleanupFileString(name);
+            if (!name.empty())
+            {
+                index.insert(ZipEntryMapping(name, entry));
+            }
+        });
+
+    if (!ok)
+    {
+        // libzip will build the index and do all the reading
+        _mapping.reset();
+        return false;
+    }
+
+    _zipIndex.swap(index);
+    return true;
+}
+
 bool ZipArchive::GetZipIndex(const std::string& filename, zip_uint64_t& idx) const
 {
-    const ZipEntryMap::iterator iter = const_cast<ZipEntryMap*>(&_zipIndex)->find(filename);
-    if (iter != _zipIndex.end())
+    const ZipEntry* entry = GetZipEntry(filename);
+    if (entry != NULL)
     {
-        idx = (*iter).second;
+        idx = entry->index;
         return true;
     }
     return false;
 }
 
+const ZipArchive::ZipEntry* ZipArchive::GetZipEntry(const std::string& filename) const
+{
+    ZipEntryMap::const_iterator iter = _zipIndex.find(filename);
+    if (iter != _zipIndex.end())
+    {
+        return &iter->second;
+    }
+    return NULL;
+}
+
 osgDB::FileType ZipArchive::getFileType(const std::string& filename) const
 {
     zip_uint64_t idx;
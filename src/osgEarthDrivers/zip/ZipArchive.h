@@ -5,8 +5,12 @@
 #include <osgDB/FileUtils>
 
 #include <osgDB/Archive>
+#include <osgEarth/FileUtils>
+#include <cstdint>
+#include <memory>
 #include <mutex>
 #include <thread>
+#include <vector>
 
 #include <zip.h>
 
@@ -63,22 +67,70 @@ class ZipArchive : public osgDB::Archive
 
     protected:
 
+        //! Location of one file in the archive, from the central directory
+        struct ZipEntry
+        {
+            zip_uint64_t index = 0u;            // libzip entry index
+            int method = -1;                    // 0 = stored, 8 = deflated, -1 = unknown (read through libzip)
+            bool encrypted = false;
+            std::uint32_t crc = 0u;
+            std::uint64_t compressedSize = 0u;
+            std::uint64_t size = 0u;
+            std::uint64_t localHeaderOffset = 0u;
+        };
+
+        //! Contents of one archived file. Stored entries point straight into
+        //! the mapped archive; anything else is decoded into a pooled buffer,
+        //! which goes back to the pool when this object is destroyed.
+        class EntryData
+        {
+        public:
+            EntryData() { }
+            EntryData(const EntryData&) = delete;
+            EntryData& operator=(const EntryData&) = delete;
+            ~EntryData();
+
+            const char* data = nullptr;
+            std::size_t size = 0u;
+
+        private:
+            friend class ZipArchive;
+            const ZipArchive* _owner = nullptr;
+            std::unique_ptr<std::vector<char>> _buffer;
+        };
+
         void IndexZipFiles(zip_t* zip);
+        bool IndexCentralDirectory();
         bool GetZipIndex(const std::string& filename, zip_uint64_t& idx) const;
-        osgDB::ReaderWriter* ReadFromZipIndex(const std::string& filename, const osgDB::ReaderWriter::Options* options, std::stringstream& streamIn) const;
+        const ZipEntry* GetZipEntry(const std::string& filename) const;
+        osgDB::ReaderWriter* ReadFromZipIndex(const std::string& filename, const osgDB::ReaderWriter::Options* options, EntryData& entryData) const;
+        bool ReadEntry(const ZipEntry& entry, EntryData& entryData) const;
+        bool ReadEntryWithLibzip(const ZipEntry& entry, EntryData& entryData) const;
         std::string ReadPassword(const osgDB::ReaderWriter::Options* options) const;
 
     private:
 
-        typedef std::pair<std::string, zip_uint64_t > ZipEntryMapping;
-        typedef std::map<std::string, zip_uint64_t > ZipEntryMap;
+        typedef std::pair<std::string, ZipEntry> ZipEntryMapping;
+        typedef std::map<std::string, ZipEntry> ZipEntryMap;
 
         std::string _filename, _password, _membuffer;
 
         mutable std::mutex _zipMutex;
         bool _zipLoaded;
+
+        // Built once in open() and read-only until close(), so
+        // every thread shares a single central directory parse.
         ZipEntryMap _zipIndex;
 
+        // Whole archive mapped into memory, if the platform allows it
+        std::unique_ptr<osgEarth::Util::MappedFile> _mapping;
+
+        // Recycled buffers for decoded entries
+        mutable std::mutex _bufferMutex;
+        mutable std::vector<std::unique_ptr<std::vector<char>>> _buffers;
+        std::unique_ptr<std::vector<char>> takeBuffer() const;
+        void returnBuffer(std::unique_ptr<std::vector<char>> buffer) const;
+
         struct PerThreadData {
             zip_t* _zipHandle;
         };
@@ -10,7 +10,9 @@
 #include <osgEarth/Math>
 #include <osgEarth/MetaTile>
 #include <osgEarth/TerrainEngineNode>
-#include <random>
+#include <osgEarth/Threading>
+#include <osg/Timer>
+#include <thread>
 
 #define LC "[" << className() << "] \"" << getName() << "\" "
 
@@ -34,6 +36,7 @@ LifeMapLayer::Options::getConfig() const
     conf.set("color_weight", colorWeight());
     conf.set("noise_weight", noiseWeight());
     conf.set("lush_factor", lushFactor());
+    conf.set("threads", threads());
     return conf;
 }
 
@@ -51,6 +54,7 @@ LifeMapLayer::Options::fromConfig(const Config& conf)
     conf.get("color_weight", colorWeight());
     conf.get("noise_weight", noiseWeight());
     conf.get("lush_factor", lushFactor());
+    conf.get("threads", threads());
 }
 
 //........................................................................
@@ -79,7 +83,7 @@ namespace
             _invFactor = 1.0f / _factor;
         }
 
-        void scaleCoordsToRefLOD(osg::Vec2d& tc, const TileKey& key)
+        void scaleCoordsToRefLOD(osg::Vec2d& tc, const TileKey& key) const
         {
             if (key.getLOD() <= _refLOD)
                 return;
@@ -121,13 +125,140 @@ namespace
 
     inline void getNoise(
         osg::Vec4& noise,
-        ImageUtils::PixelReader& read,
+        const ImageUtils::PixelReader& read,
         const osg::Vec2d& coords)
     {
         read(noise, coords.x(), coords.y());
         noise *= 2.0;
         noise.r() -= 1.0, noise.g() -= 1.0, noise.b() -= 1.0, noise.a() -= 1.0;
     }
+
+    // Converts a color sample to lifemap values. Greenness implies
+    // vegetation and redness implies ruggedness/rock.
+    inline void colorContribution(
+        const osg::Vec4f& rgba,
+        float colorWeight,
+        float& dense,
+        float& lush,
+        float& rugged,
+        float& weight)
+    {
+        // convert to HSL:
+        Color c(rgba.r(), rgba.g(), rgba.b(), 0.0f);
+        osg::Vec4f hsl = c.asHSL();
+
+        constexpr float red = 0.0f;
+        constexpr float green = 0.3333333f;
+
+        // amplification factors for greenness and redness,
+        // obtained empirically
+        constexpr float green_amp = 2.0f;
+        constexpr float red_amp = 5.0f;
+
+        // Set lower limits for saturation and lightness, because
+        // when these levels get too low, the HUE channel starts to
+        // introduce math errors that can result in bad color values
+        // that we do not want. (We determined these empirically
+        // using an interactive shader.)
+        constexpr float saturation_threshold = 0.2f;
+        constexpr float lightness_threshold = 0.03f;
+
+        // "Greenness" implies vegetation
+        float dist_to_green = fabs(green - hsl[0]);
+        if (dist_to_green > 0.5f)
+            dist_to_green = 1.0f - dist_to_green;
+        float greenness = 1.0f - 2.0f * dist_to_green;
+
+        // "redness" implies ruggedness/rock
+        float dist_to_red = fabs(red - hsl[0]);
+        if (dist_to_red > 0.5f)
+            dist_to_red = 1.0f - dist_to_red;
+        float redness = 1.0f - 2.0f * dist_to_red;
+
+        if (hsl[1] < saturation_threshold)
+        {
+            greenness *= hsl[1] / saturation_threshold;
+            redness *= hsl[1] / saturation_threshold;
+        }
+        if (hsl[2] < lightness_threshold)
+        {
+            greenness *= hsl[2] / lightness_threshold;
+            redness *= hsl[2] / lightness_threshold;
+        }
+
+        greenness = pow(greenness, green_amp);
+        redness = pow(redness, red_amp);
+
+        dense = greenness;
+        lush = greenness * (1.0 - hsl.z()); // lighter green is less lush.
+        rugged = redness;
+
+        // if the lightness value is too high, it's white, which is usually
+        // snow or clouds, and we can't use it for anything meaningful
+        if (pow(hsl[2], 5.0f) > 0.5f)
+            weight = 0.0f;
+        else
+            weight = colorWeight;
+    }
+
+    // Land cover samples for a whole tile, one float per pixel per channel
+    // (indexed by LIFEMAP_RUGGED/DENSE/LUSH).
+    struct LandCoverPlanes
+    {
+        std::vector<float> value[3];
+        std::vector<float> weight;
+        std::vector<unsigned> material;
+
+        void allocate(unsigned size)
+        {
+            for (auto& plane : value)
+                plane.assign(size, 0.0f);
+            weight.assign(size, 0.0f);
+            material.assign(size, 0u);
+        }
+    };
+
+    // Scratch planes for one row of the rasterizer, one float per pixel.
+    struct RowPlanes
+    {
+        std::vector<float> noise[3];
+        std::vector<float> color[3];
+        std::vector<float> colorWeight;
+        std::vector<float> terrain;
+        std::vector<float> densityMask;
+        std::vector<float> waterMask;
+        std::vector<float> output[3];
+        std::vector<float> zero;
+
+        void allocate(unsigned width)
+        {
+            for (unsigned c = 0; c < 3; ++c)
+            {
+                noise[c].resize(width);
+                color[c].resize(width);
+                output[c].resize(width);
+            }
+            colorWeight.resize(width);
+            terrain.resize(width);
+            densityMask.resize(width);
+            waterMask.resize(width);
+            zero.assign(width, 0.0f);
+        }
+
+        // inputs that are not in use must not affect the result
+        void clear()
+        {
+            for (unsigned c = 0; c < 3; ++c)
+            {
+                std::fill(noise[c].begin(), noise[c].end(), 0.0f);
+                std::fill(color[c].begin(), color[c].end(), 0.0f);
+            }
+            std::fill(colorWeight.begin(), colorWeight.end(), 0.0f);
+            std::fill(terrain.begin(), terrain.end(), 0.0f);
+            std::fill(densityMask.begin(), densityMask.end(), 1.0f);
+            std::fill(waterMask.begin(), waterMask.end(), 1.0f);
+        }
+    };
 }
 
 //........................................................................
@@ -375,14 +506,12 @@ LifeMapLayer::getUseNoise() const
     return getNoiseWeight() > 0.0f;
 }
 
-#define NUM_INPUTS 4
+#define NOISE_LEVELS 2
 
-#define NOISE 0
-#define TERRAIN 1
-#define LANDCOVER 2
-#define COLOR 3
+#define LIFEMAP_POOL_NAME "oe.lifemap"
 
-#define NOISE_LEVELS 2
+// smallest number of rows worth handing to a worker thread
+#define ROWS_PER_BAND 16u
 
 GeoImage
 LifeMapLayer::createImageImplementation(
@@ -503,25 +632,13 @@ LifeMapLayer::createImageImplementation(
         GL_RGBA,
         GL_UNSIGNED_BYTE);
 
-    ImageUtils::PixelWriter write(image.get());
-
-    float elevation;
-    osg::Vec3 normal;
-    float slope;
-    const osg::Vec3 up(0, 0, 1);
-
-    std::string lu_id;
-    osg::Vec4f hsl;
-
-    osg::Vec2d noiseCoords[NOISE_LEVELS];
-    osg::Vec4 noise[NOISE_LEVELS];
     const unsigned noiseLOD[NOISE_LEVELS] = { 10u, 14u };
     //    12u, 13u, 14u, 15u //, 16u // 0u, 9u, 13u, 16u
     //};
     const unsigned noisePattern[NOISE_LEVELS] = { RANDOM, CLUMPY };
     //RANDOM, SMOOTH, CLUMPY, RANDOM2 };
 
-    CoordScaler coordScalers[NOISE_LEVELS] = {
+    const CoordScaler coordScalers[NOISE_LEVELS] = {
         CoordScaler(key.getProfile(), key.getLOD(), noiseLOD[0]),
         CoordScaler(key.getProfile(), key.getLOD(), noiseLOD[1]) //,
         //CoordScaler(key.getProfile(), key.getLOD(), noiseLOD[2]),
@@ -539,8 +656,6 @@ LifeMapLayer::createImageImplementation(
 
     // land cover blurring values
     double lc_blur_m = std::max(0.0, options().landCoverBlur()->as(Units::METERS));
-    double lc_blur_u = lc_blur_m / width_m;
-    double lc_blur_v = lc_blur_m / height_m;
 
     double mpp_x = width_m / (double)getTileSize();
     double mpp_y = height_m / (double)getTileSize();
@@ -556,168 +671,174 @@ LifeMapLayer::createImageImplementation(
         }
     }
 
-    std::minstd_rand gen(key.hash());
-
     GeoImage result(image.get(), extent);
 
+    const unsigned width = image->s();
+    const unsigned height = image->t();
+    const double bu = 0.5 / (double)width;
+    const double bv = 0.5 / (double)height;
+
+    const bool useNoise = getUseNoise();
+    const bool useTerrain = getUseTerrain() && elevTile.valid();
+    const bool useLandCover = getLandCoverLayer() && landcover.valid();
+    const float noiseWeight = useNoise ? getNoiseWeight() : 0.0f;
+    const float terrainWeight = useTerrain ? getTerrainWeight() : 0.0f;
+    const float landCoverWeight = getLandCoverWeight();
+    const float colorWeight = getColorWeight();
+    const float slopeIntensity = options().slopeIntensity().get();
+
+    // The land cover metatile loads its neighbors lazily as it is sampled,
+    // so it can't be shared across threads. Read it up front into planes.
+    LandCoverPlanes lcPlanes;
+    if (useLandCover)
     {
-        OE_PROFILING_ZONE_NAMED("RasterizeLifeMap");
+        OE_PROFILING_ZONE_NAMED("PrefetchLandCover");
 
-        double bu = 0.5 / (double)image->s();
-        double bv = 0.5 / (double)image->t();
+        lcPlanes.allocate(width * height);
 
-        for (unsigned int t = 0; t < result.t(); ++t)
+        for (unsigned t = 0; t < height; ++t)
         {
             double v = bv + ((double)t * 2.0 * bv);
-            double y = result.getExtent().yMin() + result.getExtent().height() * v;
 
-            for (unsigned int s = 0; s < result.s(); ++s)
+            for (unsigned s = 0; s < width; ++s)
             {
                 double u = bu + ((double)s * 2.0 * bu);
-                double x = result.getExtent().xMin() + result.getExtent().width() * u;
+                unsigned i = t * width + s;
 
-                osg::Vec4f pixel[NUM_INPUTS];
-                float weight[NUM_INPUTS] = { 0,0,0,0 };
-                osg::Vec4f temp;
-
-                // in case the land cover specifies a custom material.
-                unsigned customMaterialIndex = 0u;
-
-                // NOISE contribution
-                if (getUseNoise())
+                if (equivalent(lc_blur_m, 0.0))
                 {
-                    for (int n = 0; n < NOISE_LEVELS; ++n)
+                    const LandCoverSample* temp = landcover.read(u, v);
+                    if (temp)
                     {
-                        if (key.getLOD() >= coordScalers[n]._refLOD)
-                        {
-                            noiseCoords[n].set(u, v);
-                            coordScalers[n].scaleCoordsToRefLOD(noiseCoords[n], key);
-                            getNoise(noise[n], noiseSampler, noiseCoords[n]);
-
-                            //double L = 1.0; // 1.0 / pow(2.0, double(NOISE_LEVELS - 1 - n));
-                            int p = noisePattern[n];
-                            double L = 1.0; //  n == 0 ? 0.25 : 1.0;
-
-                            pixel[NOISE][LIFEMAP_DENSE] += noise[n][p] * L; // 3
-                            pixel[NOISE][LIFEMAP_LUSH] = 0.0; // += noise[n][p] * L; // = 0.0;
+                        lcPlanes.value[LIFEMAP_DENSE][i] = temp->dense().get();
+                        lcPlanes.value[LIFEMAP_LUSH][i] = temp->lush().get();
+                        lcPlanes.value[LIFEMAP_RUGGED][i] = temp->rugged().get();
+                        lcPlanes.weight[i] = landCoverWeight;
 
-                            noiseCoords[n].set(v, u);
-                            getNoise(noise[n], noiseSampler, noiseCoords[n]);
-                            pixel[NOISE][LIFEMAP_RUGGED] += noise[n][p] * L; // 2
+                        if (temp->material().isSet() && getBiomeLayer())
+                        {
+                            // land cover asked for a custom material. Find its index.
+                            auto iter = materialLUT.find(temp->material().get());
+                            if (iter != materialLUT.end())
+                                lcPlanes.material[i] = iter->second + 1;
                         }
                     }
-
-                    //pixel[NOISE][LIFEMAP_DENSE] = clamp(pixel[NOISE][LIFEMAP_DENSE], 0.0f, 1.0f);
-                    //pixel[NOISE][LIFEMAP_RUGGED] = clamp(pixel[NOISE][LIFEMAP_RUGGED], 0.0f, 1.0f);
-
-                    weight[NOISE] = getNoiseWeight();
                 }
-
-                // LAND COVER CONTRIBUTION
-                if (getLandCoverLayer() && landcover.valid())
+                else
                 {
-                    const LandCoverSample* temp;
+                    // read the landcover with a blurring filter.
                     LandCoverSample sample;
                     int dense_samples = 0;
                     int lush_samples = 0;
                     int rugged_samples = 0;
 
-                    if (equivalent(lc_blur_m, 0.0))
-                    {
-                        //temp = landcover.read((int)s, (int)t);
-                        temp = landcover.read(u, v);
-                        if (temp)
-                        {
-#if 0
-                            // RNG with normal distribution between approx +1/-1
-                            const float coverage_stddev = 1.0f / 12.0f; // 6.0f;
-                            {
-                                std::normal_distribution<float> normal_dist(temp->dense().get(), coverage_stddev);
-                                pixel[LANDCOVER][LIFEMAP_DENSE] = clamp(normal_dist(gen), 0.0f, 1.0f);
-                            }
-                            {
-                                std::normal_distribution<float> normal_dist(temp->lush().get(), coverage_stddev);
-                                pixel[LANDCOVER][LIFEMAP_LUSH] = clamp(normal_dist(gen), 0.0f, 1.0f);
-                            }
-                            {
-                                std::normal_distribution<float> normal_dist(temp->rugged().get(), coverage_stddev);
-                                pixel[LANDCOVER][LIFEMAP_RUGGED] = clamp(normal_dist(gen), 0.0f, 1.0f);
-                            }
-#else
-                            pixel[LANDCOVER][LIFEMAP_DENSE] = temp->dense().get();
-                            pixel[LANDCOVER][LIFEMAP_LUSH] = temp->lush().get();
-                            pixel[LANDCOVER][LIFEMAP_RUGGED] = temp->rugged().get();
-#endif
-                            weight[LANDCOVER] = getLandCoverWeight();
-
-                            if (temp->material().isSet() && getBiomeLayer())
-                            {
-                                // land cover asked for a custom material. Find its index.
-                                auto i = materialLUT.find(temp->material().get());
-                                if (i != materialLUT.end())
-                                    customMaterialIndex = i->second + 1;
-                            }
-                        }
-                    }
-                    else
+                    for (int a = -1; a <= 1; ++a)
                     {
-                        // read the landcover with a blurring filter.
-                        for (int a = -1; a <= 1; ++a)
+                        for (int b = -1; b <= 1; ++b)
                         {
-                            for (int b = -1; b <= 1; ++b)
+                            int ss = a * (int)(lc_blur_m / mpp_x);
+                            int tt = b * (int)(lc_blur_m / mpp_y);
+
+                            const LandCoverSample* temp = landcover.read((int)s + ss, (int)t + tt);
+
+                            if (temp)
                             {
-                                int ss = a * (int)(lc_blur_m / mpp_x);
-                                int tt = b * (int)(lc_blur_m / mpp_y);
+                                if (temp->dense().isSet())
+                                {
+                                    sample.dense() = sample.dense().get() + temp->dense().get();
+                                    ++dense_samples;
+                                }
 
-                                temp = landcover.read((int)s + ss, (int)t + tt);
+                                if (temp->lush().isSet())
+                                {
+                                    sample.lush() = sample.lush().get() + temp->lush().get();
+                                    ++lush_samples;
+                                }
 
-                                if (temp)
+                                if (temp->rugged().isSet())
                                 {
-                                    if (temp->dense().isSet())
-                                    {
-                                        sample.dense() = sample.dense().get() + temp->dense().get();
-                                        ++dense_samples;
-                                    }
-
-                                    if (temp->lush().isSet())
-                                    {
-                                        sample.lush() = sample.lush().get() + temp->lush().get();
-                                        ++lush_samples;
-                                    }
-
-                                    if (temp->rugged().isSet())
-                                    {
-                                        sample.rugged() = sample.rugged().get() + temp->rugged().get();
-                                        ++rugged_samples;
-                                    }
-
-                                    if (temp->material().isSet() && getBiomeLayer())
-                                    {
-                                        // land cover asked for a custom material. Find its index.
-                                        auto i = materialLUT.find(temp->material().get());
-                                        if (i != materialLUT.end())
-                                            customMaterialIndex = i->second + 1;
-                                    }
+                                    sample.rugged() = sample.rugged().get() + temp->rugged().get();
+                                    ++rugged_samples;
+                                }
+
+                                if (temp->material().isSet() && getBiomeLayer())
+                                {
+                                    // land cover asked for a custom material. Find its index.
+                                    auto iter = materialLUT.find(temp->material().get());
+                                    if (iter != materialLUT.end())
+                                        lcPlanes.material[i] = iter->second + 1;
                                 }
                             }
                         }
+                    }
+
+                    if (dense_samples > 0)
+                    {
+                        lcPlanes.value[LIFEMAP_DENSE][i] = sample.dense().get() / (float)dense_samples;
+                        lcPlanes.weight[i] = landCoverWeight;
+                    }
+                    if (lush_samples > 0)
+                    {
+                        lcPlanes.value[LIFEMAP_LUSH][i] = sample.lush().get() / (float)lush_samples;
+                        lcPlanes.weight[i] = landCoverWeight;
+                    }
+                    if (rugged_samples > 0)
+                    {
+                        lcPlanes.value[LIFEMAP_RUGGED][i] = sample.rugged().get() / (float)rugged_samples;
+                        lcPlanes.weight[i] = landCoverWeight;
+                    }
+                }
+            }
+        }
+    }
 
-                        weight[LANDCOVER] = 0.0f;
+    // Rasterizes rows [t0, t1). Each row is first sampled into float planes,
+    // one per input channel, and then the planes are blended in tight loops
+    // over contiguous arrays that the compiler can vectorize.
+    auto rasterizeRows = [&](unsigned t0, unsigned t1)
+    {
+        RowPlanes row;
+        row.allocate(width);
 
-                        if (dense_samples > 0)
-                        {
-                            pixel[LANDCOVER][LIFEMAP_DENSE] = sample.dense().get() / (float)dense_samples;
-                            weight[LANDCOVER] = getLandCoverWeight();
-                        }
-                        if (lush_samples > 0)
-                        {
-                            pixel[LANDCOVER][LIFEMAP_LUSH] = sample.lush().get() / (float)lush_samples;
-                            weight[LANDCOVER] = getLandCoverWeight();
-                        }
-                        if (rugged_samples > 0)
+        ImageUtils::PixelWriter write(image.get());
+        osg::Vec2d noiseCoords;
+        osg::Vec4f noise;
+        osg::Vec4f temp;
+        const osg::Vec3 up(0, 0, 1);
+
+        for (unsigned t = t0; t < t1; ++t)
+        {
+            if (progress && progress->isCanceled())
+                return;
+
+            double v = bv + ((double)t * 2.0 * bv);
+            double y = extent.yMin() + extent.height() * v;
+
+            row.clear();
+
+            // SAMPLING PASS
+            for (unsigned s = 0; s < width; ++s)
+            {
+                double u = bu + ((double)s * 2.0 * bu);
+                double x = extent.xMin() + extent.width() * u;
+
+                // NOISE contribution
+                if (useNoise)
+                {
+                    for (int n = 0; n < NOISE_LEVELS; ++n)
+                    {
+                        if (key.getLOD() >= coordScalers[n]._refLOD)
                         {
-                            pixel[LANDCOVER][LIFEMAP_RUGGED] = sample.rugged().get() / (float)rugged_samples;
-                            weight[LANDCOVER] = getLandCoverWeight();
+                            int p = noisePattern[n];
+
+                            noiseCoords.set(u, v);
+                            coordScalers[n].scaleCoordsToRefLOD(noiseCoords, key);
+                            getNoise(noise, noiseSampler, noiseCoords);
+                            row.noise[LIFEMAP_DENSE][s] += noise[p];
+
+                            noiseCoords.set(v, u);
+                            getNoise(noise, noiseSampler, noiseCoords);
+                            row.noise[LIFEMAP_RUGGED][s] += noise[p];
                         }
                     }
                 }
@@ -729,118 +850,29 @@ LifeMapLayer::createImageImplementation(
                     double vv = v * color_matrix(1, 1) + color_matrix(3, 1);
                     readColor(temp, uu, vv);
 
-                    // convert to HSL:
-                    Color c(temp.r(), temp.g(), temp.b(), 0.0f);
-                    hsl = c.asHSL();
-
-                    constexpr float red = 0.0f;
-                    constexpr float green = 0.3333333f;
-                    constexpr float blue = 0.6666667f;
-
-                    // amplification factors for greenness and redness,
-                    // obtained empirically
-                    constexpr float green_amp = 2.0f;
-                    constexpr float red_amp = 5.0f;
-
-                    // Set lower limits for saturation and lightness, because
-                    // when these levels get too low, the HUE channel starts to
-                    // introduce math errors that can result in bad color values
-                    // that we do not want. (We determined these empirically
-                    // using an interactive shader.)
-                    constexpr float saturation_threshold = 0.2f;
-                    constexpr float lightness_threshold = 0.03f;
-
-                    // "Greenness" implies vegetation
-                    float dist_to_green = fabs(green - hsl[0]);
-                    if (dist_to_green > 0.5f)
-                        dist_to_green = 1.0f - dist_to_green;
-                    float greenness = 1.0f - 2.0f * dist_to_green;
-
-                    // "redness" implies ruggedness/rock
-                    float dist_to_red = fabs(red - hsl[0]);
-                    if (dist_to_red > 0.5f)
-                        dist_to_red = 1.0f - dist_to_red;
-                    float redness = 1.0f - 2.0f * dist_to_red;
-
-                    if (hsl[1] < saturation_threshold)
-                    {
-                        greenness *= hsl[1] / saturation_threshold;
-                        redness *= hsl[1] / saturation_threshold;
-                    }
-                    if (hsl[2] < lightness_threshold)
-                    {
-                        greenness *= hsl[2] / lightness_threshold;
-                        redness *= hsl[2] / lightness_threshold;
-                    }
-
-                    greenness = pow(greenness, green_amp);
-                    redness = pow(redness, red_amp);
-
-                    float w = options().colorWeight().get();
-
-                    pixel[COLOR][LIFEMAP_DENSE] = greenness;
-                    pixel[COLOR][LIFEMAP_LUSH] = greenness * (1.0 - hsl.z()); // lighter green is less lush.
-                    pixel[COLOR][LIFEMAP_RUGGED] = redness;
-
-                    // if the lightness value is too high, it's white, which is usually
-                    // snow or clouds, and we can't use it for anything meaningful
-                    if (pow(hsl[2], 5.0f) > 0.5f)
-                        weight[COLOR] = 0.0f;
-                    else
-                        weight[COLOR] = getColorWeight(); // * max(greeness, redness) ...???
+                    colorContribution(temp, colorWeight,
+                        row.color[LIFEMAP_DENSE][s],
+                        row.color[LIFEMAP_LUSH][s],
+                        row.color[LIFEMAP_RUGGED][s],
+                        row.colorWeight[s]);
                 }
 
                 // TERRAIN CONTRIBUTION:
-                if (getUseTerrain() && elevTile.valid())
+                if (useTerrain)
                 {
-                    // Establish elevation at this pixel:
-                    elevation = elevTile->getElevation(x, y).elevation().as(Units::METERS);
-
-                    // Normal map at this pixel:
-                    normal = elevTile->getNormal(x, y);
-
                     // exaggerate the slope value
-                    slope = 1.0 - (normal * up);
-                    float r = decel(slope * options().slopeIntensity().get());
-                    pixel[TERRAIN][LIFEMAP_RUGGED] = r;
-                    pixel[TERRAIN][LIFEMAP_DENSE] = -r;
-                    pixel[TERRAIN][LIFEMAP_LUSH] = -r;
-
-                    weight[TERRAIN] = getTerrainWeight();
+                    osg::Vec3 normal = elevTile->getNormal(x, y);
+                    float slope = 1.0 - (normal * up);
+                    row.terrain[s] = decel(slope * slopeIntensity);
                 }
 
-                // CONBINE WITH WEIGHTS:
-                osg::Vec4f combined_pixel;
-
-                // first, combine landcover and color by relative weight.
-                float w2 = weight[LANDCOVER] + weight[COLOR];
-                if (w2 > 0.0f)
-                {
-                    combined_pixel =
-                        pixel[LANDCOVER] * weight[LANDCOVER] / w2 +
-                        pixel[COLOR] * weight[COLOR] / w2;
-                }
-
-                // apply terrain additively:
-                combined_pixel += pixel[TERRAIN] * weight[TERRAIN];
-
-                // apply the noise additively:
-                combined_pixel += pixel[NOISE] * weight[NOISE];
-
-                // apply the lushness static factor
-                //combined_pixel[LIFEMAP_LUSH] *= options().lushFactor().get();
-
-                // MASK CONTRIBUTION (applied to final combined pixel data)
+                // MASK CONTRIBUTION
                 if (densityMask.valid())
                 {
                     double uu = clamp(u * dm_matrix(0, 0) + dm_matrix(3, 0), 0.0, 1.0);
                     double vv = clamp(v * dm_matrix(1, 1) + dm_matrix(3, 1), 0.0, 1.0);
                     readDensityMask(temp, uu, vv);
-
-                    // multiply all 3 so that roads can have a barren look
-                    combined_pixel[LIFEMAP_DENSE] *= temp.r();
-                    combined_pixel[LIFEMAP_LUSH] *= temp.r();
-                    combined_pixel[LIFEMAP_RUGGED] *= temp.r();
+                    row.densityMask[s] = temp.r();
                 }
 
                 // WATER MASK
@@ -849,28 +881,114 @@ LifeMapLayer::createImageImplementation(
                     double uu = clamp(u * wm_matrix(0, 0) + wm_matrix(3, 0), 0.0, 1.0);
                     double vv = clamp(v * wm_matrix(1, 1) + wm_matrix(3, 1), 0.0, 1.0);
                     readWaterMask(temp, uu, vv);
-
-                    combined_pixel[LIFEMAP_DENSE] *= temp.r();
-                    combined_pixel[LIFEMAP_LUSH] *= temp.r();
-                    combined_pixel[LIFEMAP_RUGGED] *= temp.r();
-                    combined_pixel[3] = 1.0f - temp.r();
+                    row.waterMask[s] = temp.r();
                 }
-                else combined_pixel[3] = 0.0f;
+            }
 
-                if (customMaterialIndex > 0)
-                {
-                    combined_pixel[3] = (float)customMaterialIndex / 255.0f;
-                }
+            // WEIGHTING PASS
+            const unsigned offset = t * width;
+            const float* lcWeight = useLandCover ? &lcPlanes.weight[offset] : row.zero.data();
+            const float* colWeight = row.colorWeight.data();
 
-                // Clamp everything to [0..1] and write it out.
-                for (int i = 0; i < 4; ++i)
+            for (unsigned c = 0; c < 3; ++c)
+            {
+                const float* lc = useLandCover ? &lcPlanes.value[c][offset] : row.zero.data();
+                const float* col = row.color[c].data();
+                const float* noi = row.noise[c].data();
+                const float* ter = row.terrain.data();
+                const float* dm = row.densityMask.data();
+                const float* wm = row.waterMask.data();
+                float* out = row.output[c].data();
+
+                // terrain reads as ruggedness, and against density/lushness
+                const float terrainSign = (c == LIFEMAP_RUGGED) ? 1.0f : -1.0f;
+
+                for (unsigned s = 0; s < width; ++s)
                 {
-                    combined_pixel[i] = clamp(combined_pixel[i], 0.0f, 1.0f);
+                    // first, combine landcover and color by relative weight.
+                    float w2 = lcWeight[s] + colWeight[s];
+                    float value = w2 > 0.0f ?
+                        lc[s] * lcWeight[s] / w2 + col[s] * colWeight[s] / w2 :
+                        0.0f;
+
+                    // apply terrain and noise additively:
+                    value += (terrainSign * ter[s]) * terrainWeight;
+                    value += noi[s] * noiseWeight;
+
+                    // masks zero out the final combined data
+                    // (multiply all 3 so that roads can have a barren look)
+                    value *= dm[s];
+                    value *= wm[s];
+
+                    out[s] = clamp(value, 0.0f, 1.0f);
                 }
+            }
+
+            // Write it out.
+            osg::Vec4f combined_pixel;
+            for (unsigned s = 0; s < width; ++s)
+            {
+                combined_pixel[LIFEMAP_RUGGED] = row.output[LIFEMAP_RUGGED][s];
+                combined_pixel[LIFEMAP_DENSE] = row.output[LIFEMAP_DENSE][s];
+                combined_pixel[LIFEMAP_LUSH] = row.output[LIFEMAP_LUSH][s];
+
+                unsigned customMaterialIndex = useLandCover ? lcPlanes.material[offset + s] : 0u;
+                if (customMaterialIndex > 0)
+                    combined_pixel[3] = clamp((float)customMaterialIndex / 255.0f, 0.0f, 1.0f);
+                else if (waterMask.valid())
+                    combined_pixel[3] = clamp(1.0f - row.waterMask[s], 0.0f, 1.0f);
+                else
+                    combined_pixel[3] = 0.0f;
 
                 write(combined_pixel, s, t);
             }
         }
+    };
+
+    {
+        OE_PROFILING_ZONE_NAMED("RasterizeLifeMap");
+
+        osg::Timer_t start = osg::Timer::instance()->tick();
+
+        unsigned numThreads = options().threads().get() > 0u ?
+            options().threads().get() :
+            std::max(std::thread::hardware_concurrency(), 1u);
+
+        if (numThreads <= 1u || height < 2u * ROWS_PER_BAND)
+        {
+            rasterizeRows(0u, height);
+        }
+        else
+        {
+            jobs::context job;
+            job.name = "LifeMap rows";
+            job.pool = jobs::get_pool(LIFEMAP_POOL_NAME, std::max(std::thread::hardware_concurrency(), 1u));
+            // the caller blocks on the bands, so a worker must not steal
+            // a job that then waits on this pool
+            job.pool->set_can_steal_work(false);
+            job.group = jobs::jobgroup::create();
+
+            unsigned rowsPerBand = std::max(ROWS_PER_BAND, (height + numThreads - 1u) / numThreads);
+
+            for (unsigned t0 = 0; t0 < height; t0 += rowsPerBand)
+            {
+                unsigned t1 = std::min(t0 + rowsPerBand, height);
+                jobs::dispatch([&rasterizeRows, t0, t1]()
+                    {
+                        rasterizeRows(t0, t1);
+                    },
+                    job);
+            }
+
+            job.group->join();
+        }
+
+        if (progress && progress->isCanceled())
+            return GeoImage::INVALID;
+
+        OE_DEBUG << LC << "Rasterized " << key.str() << " in "
+            << osg::Timer::instance()->delta_m(start, osg::Timer::instance()->tick())
+            << " ms (" << numThreads << " threads)" << std::endl;
     }
 
     return std::move(result);
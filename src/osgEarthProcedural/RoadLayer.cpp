@@ -1275,6 +1275,8 @@ namespace
     class Clipper2OffsetFilter : public FeatureFilter
     {
     public:
+        const char* name() const override { return "Clipper2OffsetFilter"; }
+
         FilterContext push(FeatureList& input, FilterContext& context) override
         {
             if (input.empty())
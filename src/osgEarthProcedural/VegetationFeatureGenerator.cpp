@@ -6,6 +6,7 @@
 #include <osgEarth/NoiseTextureFactory>
 #include <osgEarth/ImageUtils>
 #include <osgEarth/Math>
+#include <osgEarth/Threading>
 #include <osg/ComputeBoundsVisitor>
 
 using namespace osgEarth;
@@ -13,8 +14,11 @@ using namespace osgEarth::Procedural;
 
 #define LC "[VegetationFeatureGenerator] "
 
+#define FEATURE_GEN_POOL_NAME "oe.vegetationfeatures"
+
 VegetationFeatureGenerator::VegetationFeatureGenerator() :
-    _status(Status::ConfigurationError)
+    _status(Status::ConfigurationError),
+    _numThreads(std::max(std::thread::hardware_concurrency(), 1u))
 {
     //nop
 }
@@ -39,6 +43,12 @@ VegetationFeatureGenerator::addAssetPropertyName(const std::string& name)
     _propNames.push_back(name);
 }
 
+void
+VegetationFeatureGenerator::setNumThreads(unsigned value)
+{
+    _numThreads = std::max(value, 1u);
+}
+
 const Status&
 VegetationFeatureGenerator::getStatus() const
 {
@@ -100,12 +110,47 @@ VegetationFeatureGenerator::getFeatures(const GeoExtent& extent, FeatureList& ou
     if (keys.empty())
         return Status(Status::AssertionFailure, "No keys intersect extent");
     
-    for(auto& key : keys)
+    if (_numThreads <= 1u || keys.size() == 1u)
+    {
+        for (auto& key : keys)
+        {
+            Status s = getFeatures(key, output);
+
+            if (s.isError())
+                return s;
+        }
+        return Status::NoError;
+    }
+
+    // Each job writes to its own slot; the slots are then appended in
+    // key order so the output does not depend on job scheduling.
+    std::vector<FeatureList> outputs(keys.size());
+    std::vector<Status> statuses(keys.size());
+
+    jobs::get_pool(FEATURE_GEN_POOL_NAME)->set_concurrency(_numThreads);
+
+    jobs::context job;
+    job.name = "Vegetation features";
+    job.pool = jobs::get_pool(FEATURE_GEN_POOL_NAME);
+    job.group = jobs::jobgroup::create();
+
+    for (unsigned i = 0; i < keys.size(); ++i)
+    {
+        jobs::dispatch([this, &keys, &outputs, &statuses, i]()
+            {
+                statuses[i] = getFeatures(keys[i], outputs[i]);
+            },
+            job);
+    }
+
+    job.group->join();
+
+    for (unsigned i = 0; i < keys.size(); ++i)
     {
-        Status s = getFeatures(key, output);
+        if (statuses[i].isError())
+            return statuses[i];
 
-        if (s.isError())
-            return s;
+        output.insert(output.end(), outputs[i].begin(), outputs[i].end());
     }
 
     return Status::NoError;
@@ -120,6 +120,7 @@ VegetationLayer::Options::getConfig() const
     conf.set("max_texture_size", maxTextureSize());
     conf.set("render_bin_number", renderBinNumber());
     conf.set("threads", threads());
+    conf.set("placement_cache_size", placementCacheSize());
 
     Config layers("layers");
     for (auto group_name : { GROUP_TREES, GROUP_BUSHES, GROUP_UNDERGROWTH })
@@ -198,6 +199,7 @@ VegetationLayer::Options::fromConfig(const Config& conf)
     conf.get("max_texture_size", maxTextureSize());
     conf.get("render_bin_number", renderBinNumber());
     conf.get("threads", threads());
+    conf.get("placement_cache_size", placementCacheSize());
 
     // some nice default group settings
     groups()[GROUP_TREES].lod().setDefault(14);
@@ -348,6 +350,8 @@ VegetationLayer::openImplementation()
 
     _lastVisit.setFrameNumber(~0);
 
+    _placementCache.setCapacity(options().placementCacheSize().get());
+
     return PatchLayer::openImplementation();
 }
 
@@ -404,6 +408,7 @@ VegetationLayer::update(osg::NodeVisitor& nv)
         {
             std::lock_guard<std::mutex> lock(_assets.mutex());
             _assets = std::move(_newAssets.release());
+            ++_assetsRevision;
         }
 
         // do we need to activate A2C?
@@ -414,6 +419,8 @@ VegetationLayer::update(osg::NodeVisitor& nv)
 void
 VegetationLayer::dirty()
 {
+    _placementCache.clear();
+
     _tiles.scoped_lock([this]()
         {
             _tiles.clear();
@@ -1165,8 +1172,11 @@ VegetationLayer::reset()
     _assets.scoped_lock([this]()
         {
             _assets.clear();
+            ++_assetsRevision;
         });
 
+    _placementCache.clear();
+
     _tiles.scoped_lock([this]()
         {
             _tiles.clear();
@@ -1228,6 +1238,68 @@ VegetationLayer::getAssetPlacements(
     bool loadBiomesOnDemand,
     std::vector<VegetationLayer::Placement>& output,
     ProgressCallback* progress) const
+{
+    int assetsRevision = -1;
+
+    if (options().placementCacheSize() == 0u)
+    {
+        return createAssetPlacements(key, group, loadBiomesOnDemand, output, assetsRevision, progress);
+    }
+
+    // Everything the placements depend on goes into the cache key, so any
+    // change to the map, the source layers, or the resident assets misses.
+    osg::ref_ptr<const Map> map;
+    _map.lock(map);
+
+    int currentAssetsRevision = _assetsRevision;
+
+    std::string cacheKey = Stringify()
+        << key.str() << '/' << group << '/' << (loadBiomesOnDemand ? 1 : 0)
+        << '/' << (map.valid() ? (int)map->getDataModelRevision() : -1)
+        << '/' << getRevision()
+        << '/' << (getLifeMapLayer() ? getLifeMapLayer()->getRevision() : -1)
+        << '/' << (getBiomeLayer() ? getBiomeLayer()->getRevision() : -1)
+        << '/' << (getBiomeLayer() ? getBiomeLayer()->getBiomeManager().getRevision() : -1)
+        << '/' << currentAssetsRevision;
+
+    auto cached = _placementCache.get(cacheKey);
+    if (cached.has_value())
+    {
+        output = *cached.value();
+        return true;
+    }
+
+    std::vector<Placement> result;
+    if (!createAssetPlacements(key, group, loadBiomesOnDemand, result, assetsRevision, progress))
+    {
+        return false;
+    }
+
+    // Only cache complete results made with the assets the key describes;
+    // if the assets changed underway, the next call will cache instead.
+    if (assetsRevision == currentAssetsRevision &&
+        (progress == nullptr || !progress->isCanceled()))
+    {
+        auto shared = std::make_shared<const std::vector<Placement>>(std::move(result));
+        _placementCache.insert(cacheKey, shared);
+        output = *shared;
+    }
+    else
+    {
+        output = std::move(result);
+    }
+
+    return true;
+}
+
+bool
+VegetationLayer::createAssetPlacements(
+    const TileKey& key,
+    const std::string& group,
+    bool loadBiomesOnDemand,
+    std::vector<VegetationLayer::Placement>& output,
+    int& assetsRevision,
+    ProgressCallback* progress) const
 {
     OE_PROFILING_ZONE;
 
@@ -1266,6 +1338,7 @@ VegetationLayer::getAssetPlacements(
         else
         {
             groupAssets = iter->second; //shallow copy
+            assetsRevision = _assetsRevision;
         }
 
         // if it's empty, bail out (and probably return later)
@@ -1323,6 +1396,8 @@ VegetationLayer::getAssetPlacements(
     // after loading the biome map.
     if (loadBiomesOnDemand)
     {
+        std::lock_guard<std::mutex> loadLock(_loadAssetsOnDemandMutex);
+
         if (checkForNewAssets() == true)
         {
             _newAssets.join(progress);
@@ -1331,6 +1406,7 @@ VegetationLayer::getAssetPlacements(
             {
                 std::lock_guard<std::mutex> lock(_assets.mutex());
                 _assets = std::move(newAssets);
+                ++_assetsRevision;
             }
         }
 
@@ -1346,6 +1422,7 @@ VegetationLayer::getAssetPlacements(
             else
             {
                 groupAssets = iter->second; // shallow copy
+                assetsRevision = _assetsRevision;
             }
         }
 
@@ -1802,6 +1879,8 @@ VegetationLayer::simulateAssetPlacement(const GeoPoint& point, const std::string
     // after loading the biome map.
     if (loadBiomesOnDemand)
     {
+        std::lock_guard<std::mutex> loadLock(_loadAssetsOnDemandMutex);
+
         if (checkForNewAssets() == true)
         {
             _newAssets.join(progress);
@@ -1810,6 +1889,7 @@ VegetationLayer::simulateAssetPlacement(const GeoPoint& point, const std::string
             {
                 std::lock_guard<std::mutex> lock(_assets.mutex());
                 _assets = std::move(newAssets);
+                ++_assetsRevision;
             }
         }
 